@@ -494,21 +494,29 @@ public class GameController implements Initializable {
      * Handles game end notification from server.
      * Displays result dialog and returns to lobby.
      *
-     * Protocol format: "winner_name,reason"
+     * Protocol format: "winner_name,reason" (empty winner means a draw)
      *
      * @param message GAME_END message from server
      */
     private void handleGameEnd(Message message) {
         Platform.runLater(() -> {
-            String[] parts = message.getData().split(",");
+            String[] parts = message.getData().split(",", -1);
             String winner = parts.length > 0 ? parts[0] : "Neznámý";
             String reason = parts.length > 1 ? parts[1] : "konec hry";
 
+            boolean draw = winner.isEmpty();
             boolean iWon = winner.equals(clientManager.getCurrentClientId());
 
+            String title;
+            if (draw) {
+                title = "Remíza";
+            } else {
+                title = iWon ? "Gratulujeme! Vyhráli jste!" : "Prohráli jste";
+            }
+
             new GameAlertDialog(
-                    iWon ? AlertVariant.SUCCESS : AlertVariant.WARNING,
-                    iWon ? "Gratulujeme! Vyhráli jste!" : "Prohráli jste",
+                    draw ? AlertVariant.INFO : (iWon ? AlertVariant.SUCCESS : AlertVariant.WARNING),
+                    title,
                     "Důvod: " + reason,
                     this::returnToLobby,
                     null,
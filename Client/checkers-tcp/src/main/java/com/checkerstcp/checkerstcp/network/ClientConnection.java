@@ -38,6 +38,8 @@ public class ClientConnection {
     private String serverHost;
     private int serverPort;
     private String clientId;
+    private volatile String sessionToken;  // Issued with LOGIN_OK, proves identity on reconnect
+    private volatile long lastSeq;         // Session frames received since LOGIN_OK, 0 if unknown
 
     // Spam protection: track duplicate message counts
     private final ConcurrentHashMap<Integer, AtomicInteger> messageCounters = new ConcurrentHashMap<>();
@@ -100,6 +102,8 @@ public class ClientConnection {
             this.serverHost = host;
             this.serverPort = port;
             this.clientId = clientId;
+            this.sessionToken = null;
+            this.lastSeq = 0;
 
             socket = new Socket();
 
@@ -442,6 +446,8 @@ public class ClientConnection {
                 return;
             }
 
+            countSessionFrame(message);
+
             if (!checkMessageSpam(message)) {
                 System.err.println("Too many duplicate messages, ignoring: " + message.getOpCode());
                 return;
@@ -457,6 +463,43 @@ public class ClientConnection {
         }
     }
 
+    /**
+     * Numbers session frames the way the server does, so a reconnect can
+     * ask for only the frames missed meanwhile. LOGIN_OK is frame 1;
+     * PING and the reconnect replies are not numbered. RECONNECT_OK
+     * carries the number of the next frame.
+     *
+     * @param message Received message
+     */
+    private void countSessionFrame(Message message) {
+        switch (message.getOpCode()) {
+            case LOGIN_OK:
+                lastSeq = 1;
+                break;
+            case PING:
+                break;
+            case RECONNECT_OK: {
+                String data = message.getData();
+                int comma = data != null ? data.lastIndexOf(',') : -1;
+                try {
+                    lastSeq = comma >= 0 ? Long.parseLong(data.substring(comma + 1).trim()) - 1 : 0;
+                } catch (NumberFormatException e) {
+                    lastSeq = 0;
+                }
+                break;
+            }
+            case RECONNECT_FAIL:
+                // Numbering restarts with the LOGIN_OK that follows
+                lastSeq = 0;
+                break;
+            default:
+                if (lastSeq > 0) {
+                    lastSeq++;
+                }
+                break;
+        }
+    }
+
     /**
      * Handles invalid message received from server.
      * Tracks violation count and forcefully disconnects after threshold exceeded.
@@ -678,6 +721,27 @@ public class ClientConnection {
         sendMessage(msg);
     }
 
+    /**
+     * Asks the server to match the player with an opponent.
+     *
+     * @param playerName Name of the player
+     */
+    public void sendQuickMatch(String playerName) {
+        Message msg = new Message(OpCode.QUICK_MATCH, playerName);
+        sendMessage(msg);
+    }
+
+    /**
+     * Requests a page of the leaderboard.
+     *
+     * @param firstRank Rank of the first entry, from 1
+     * @param count Number of entries (at most 40)
+     */
+    public void sendLeaderboard(int firstRank, int count) {
+        Message msg = new Message(OpCode.LEADERBOARD, firstRank + "," + count);
+        sendMessage(msg);
+    }
+
     /**
      * Requests list of available rooms from server.
      */
@@ -720,20 +784,34 @@ public class ClientConnection {
 
     /**
      * Sends reconnection request to server.
-     * Used to restore session after connection loss.
+     * Used to restore session after connection loss; the server identifies
+     * the session by the token received with LOGIN_OK.
+     *
+     * Protocol format: "room_name,player_name,token,last_seq" with an
+     * empty room name for the lobby. Without a known last_seq the request
+     * omits it and the server resyncs the full state instead of
+     * replaying missed frames: "room_name,player_name,token" or
+     * "player_name,token"
      *
      * @param roomName Room to reconnect to (null for lobby)
      * @param playerName Player identifier
      */
     public void sendReconnectRequest(String roomName, String playerName) {
         String data;
-
-        if (roomName == null || roomName.isEmpty()) {
-            data = playerName;
+        String token = sessionToken != null ? sessionToken : "";
+        long seq = lastSeq;
+
+        if (seq > 0) {
+            String room = roomName != null ? roomName : "";
+            data = room + "," + playerName + "," + token + "," + seq;
+            System.out.println("Sending RECONNECT_REQUEST (resume after frame " + seq + "): " +
+                    (room.isEmpty() ? "lobby" : room) + "," + playerName);
+        } else if (roomName == null || roomName.isEmpty()) {
+            data = playerName + "," + token;
             System.out.println("Sending RECONNECT_REQUEST (lobby): " + playerName);
         } else {
-            data = roomName + "," + playerName;
-            System.out.println("Sending RECONNECT_REQUEST (room): " + data);
+            data = roomName + "," + playerName + "," + token;
+            System.out.println("Sending RECONNECT_REQUEST (room): " + roomName + "," + playerName);
         }
 
         Message msg = new Message(OpCode.RECONNECT_REQUEST, data);
@@ -816,6 +894,20 @@ public class ClientConnection {
         return clientId;
     }
 
+    /**
+     * Stores the session token from a LOGIN_OK message.
+     *
+     * Protocol format: "player_name,token"
+     *
+     * @param loginData LOGIN_OK payload
+     */
+    public void setSessionFromLogin(String loginData) {
+        int comma = loginData != null ? loginData.lastIndexOf(',') : -1;
+        if (comma >= 0) {
+            sessionToken = loginData.substring(comma + 1).trim();
+        }
+    }
+
     /**
      * Sets the message handler callback.
      * Called when a complete message is received and parsed.
@@ -238,6 +238,7 @@ public class ClientManager {
         // Global message handling
         switch (message.getOpCode()) {
             case LOGIN_OK:
+                connection.setSessionFromLogin(message.getData());
                 Platform.runLater(() -> {
                     statusMessage.set("Logged in as " + currentClientId);
                     requestRoomsList();
@@ -267,6 +268,12 @@ public class ClientManager {
                 connection.transitionToLobby();
                 break;
 
+            case QUICK_MATCH_QUEUED:
+                Platform.runLater(() -> {
+                    statusMessage.set("Waiting for an opponent (rating " + message.getData() + ")");
+                });
+                break;
+
             case ERROR:
                 Platform.runLater(() -> {
                     statusMessage.set("Error: " + message.getData());
@@ -411,11 +418,11 @@ public class ClientManager {
      * Handles successful reconnection confirmation.
      * Hides dialog, updates room state, and confirms to ReconnectManager.
      *
-     * @param message RECONNECT_OK message with room name
+     * @param message RECONNECT_OK message with room name and next frame number
      */
     private void handleReconnectOk(Message message) {
         Platform.runLater(() -> {
-            String roomName = message.getData();
+            String roomName = message.getData().split(",", 2)[0];
             System.out.println("Successfully reconnected to room: " + roomName);
             currentRoom = roomName;
             statusMessage.set("Připojeno ke hře: " + roomName);
@@ -630,6 +637,35 @@ public class ClientManager {
         connection.sendJoinRoom(currentClientId, roomName);
     }
 
+    /**
+     * Asks for a game against an opponent of similar rating.
+     * The server answers with QUICK_MATCH_QUEUED while waiting, then
+     * ROOM_JOINED and GAME_START once an opponent is found.
+     */
+    public void quickMatch() {
+        if (!connection.isConnected()) {
+            System.err.println("Not connected");
+            return;
+        }
+        connection.sendQuickMatch(currentClientId);
+    }
+
+    /**
+     * Requests a page of the leaderboard. The LEADERBOARD_PAGE reply also
+     * carries the player's own rank; register a handler for it with
+     * {@link #registerMessageHandler}.
+     *
+     * @param firstRank Rank of the first entry, from 1
+     * @param count Number of entries (at most 40)
+     */
+    public void requestLeaderboard(int firstRank, int count) {
+        if (!connection.isConnected()) {
+            System.err.println("Not connected");
+            return;
+        }
+        connection.sendLeaderboard(firstRank, count);
+    }
+
     /**
      * Leaves current game room.
      */
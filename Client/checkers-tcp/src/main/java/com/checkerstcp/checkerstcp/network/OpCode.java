@@ -15,6 +15,8 @@ package com.checkerstcp.checkerstcp.network;
  *   <li>Game flow (9-13, 21, 28-29): Game start, moves, state updates</li>
  *   <li>Connection monitoring (16-17): PING/PONG heartbeat</li>
  *   <li>Reconnection (22-27): Disconnect/reconnect handling</li>
+ *   <li>Matchmaking (31-32): Quick match queue</li>
+ *   <li>Leaderboard (33-34): Ranks by rating</li>
  *   <li>Error handling (500): General errors</li>
  * </ul>
  */
@@ -36,6 +38,14 @@ public enum OpCode {
     LIST_ROOMS(18, "LIST_ROOMS"),         // Request room list
     ROOMS_LIST(19, "ROOMS_LIST"),         // Room list response (JSON)
 
+    // Matchmaking
+    QUICK_MATCH(31, "QUICK_MATCH"),       // Request a rating-matched game
+    QUICK_MATCH_QUEUED(32, "QUICK_MATCH_QUEUED"), // Waiting for an opponent
+
+    // Leaderboard
+    LEADERBOARD(33, "LEADERBOARD"),       // Request a leaderboard page
+    LEADERBOARD_PAGE(34, "LEADERBOARD_PAGE"), // Leaderboard page (JSON)
+
     // Game flow
     GAME_START(9, "GAME_START"),          // Game started with both players
     MOVE(10, "MOVE"),                     // Single move
@@ -0,0 +1,160 @@
+#include <stdio.h>
+#include "adjudicate.h"
+#include "movegen.h"
+#include "search.h"
+#include "tablebase.h"
+
+/**
+ * Evaluates the game position from player 1's point of view.
+ * Uses an exact tablebase result when available, otherwise a bounded search.
+ *
+ * @param game Game to evaluate
+ * @param exact Output flag, true if the score comes from the tablebase
+ * @return Score in centi-men, positive when player 1 is better
+ */
+static int evaluate_for_player1(const Game *game, bool *exact) {
+    Position pos;
+    position_from_game(&pos, game);
+
+    int score;
+    *exact = false;
+
+    TBResult tb = tb_probe(&pos);
+    if (tb != TB_UNKNOWN) {
+        *exact = true;
+        score = tb == TB_WIN ? SCORE_TB_WIN : (tb == TB_LOSS ? -SCORE_TB_WIN : 0);
+    } else {
+        SearchLimits limits = {
+            .max_depth = ADJUDICATION_DEPTH,
+            .threads = 1,
+            .time_limit_ms = ADJUDICATION_TIME_MS
+        };
+        SearchResult result;
+        search_position(&pos, &limits, &result);
+        score = result.score;
+    }
+
+    return pos.side == game->player1_color ? score : -score;
+}
+
+/**
+ * Checks if a running game must be adjudicated.
+ * A side to move without legal moves loses; a game that reached
+ * GAME_MOVE_LIMIT is decided by evaluating the position.
+ *
+ * @param game Game state after the last move
+ * @param verdict Output verdict
+ * @return true if verdict holds a final result
+ */
+bool adjudicate_if_needed(const Game *game, Adjudication *verdict) {
+    verdict->outcome = ADJUDICATION_NONE;
+    verdict->reason = "";
+    verdict->score = 0;
+
+    Position pos;
+    position_from_game(&pos, game);
+
+    MoveList list;
+    generate_moves(&pos, &list);
+
+    if (list.count == 0) {
+        bool player1_to_move = pos.side == game->player1_color;
+        verdict->outcome = player1_to_move ? ADJUDICATION_PLAYER2_WINS
+                                           : ADJUDICATION_PLAYER1_WINS;
+        verdict->reason = "no_moves";
+        verdict->score = player1_to_move ? -SCORE_WIN : SCORE_WIN;
+        return true;
+    }
+
+    if (game->move_count >= GAME_MOVE_LIMIT) {
+        adjudicate_position(game, verdict);
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * Decides a game by evaluating the current position.
+ * A tablebase result is final; a search score must exceed
+ * ADJUDICATION_MARGIN to award a win, otherwise the game is drawn.
+ *
+ * @param game Game to decide
+ * @param verdict Output verdict
+ */
+void adjudicate_position(const Game *game, Adjudication *verdict) {
+    bool exact;
+    int score = evaluate_for_player1(game, &exact);
+
+    verdict->score = score;
+
+    if (score >= ADJUDICATION_MARGIN) {
+        verdict->outcome = ADJUDICATION_PLAYER1_WINS;
+    } else if (score <= -ADJUDICATION_MARGIN) {
+        verdict->outcome = ADJUDICATION_PLAYER2_WINS;
+    } else {
+        verdict->outcome = ADJUDICATION_DRAW;
+    }
+
+    if (verdict->outcome == ADJUDICATION_DRAW) {
+        verdict->reason = exact ? "tablebase_draw" : "adjudicated_draw";
+    } else {
+        verdict->reason = exact ? "tablebase" : "adjudicated";
+    }
+
+    printf("Adjudication %s vs %s: score %d (%s) -> %s\n",
+           symtab_name(game->player1), symtab_name(game->player2), score,
+           exact ? "tablebase" : "search", verdict->reason);
+}
+
+/**
+ * Decides a game abandoned by one player.
+ * The present player wins unless the position is lost for them,
+ * in which case the game is drawn instead of rewarding the absent player.
+ *
+ * @param game Game to decide
+ * @param absent_player Player who left
+ * @param verdict Output verdict
+ */
+void adjudicate_abandoned(const Game *game, PlayerId absent_player, Adjudication *verdict) {
+    bool absent_is_player1 = game->player1 == absent_player;
+
+    bool exact;
+    int score = evaluate_for_player1(game, &exact);
+    int present_score = absent_is_player1 ? -score : score;
+
+    verdict->score = score;
+
+    if (present_score <= -ADJUDICATION_MARGIN) {
+        verdict->outcome = ADJUDICATION_DRAW;
+        verdict->reason = "abandoned_draw";
+    } else {
+        verdict->outcome = absent_is_player1 ? ADJUDICATION_PLAYER2_WINS
+                                             : ADJUDICATION_PLAYER1_WINS;
+        verdict->reason = "opponent_timeout";
+    }
+
+    printf("Adjudication of abandoned game (%s left): score %d (%s) -> %s\n",
+           symtab_name(absent_player), score, exact ? "tablebase" : "search", verdict->reason);
+}
+
+/**
+ * Formats the OP_GAME_END payload for a verdict.
+ * Format: "winner,reason", or ",reason" for a draw.
+ *
+ * @param game Decided game
+ * @param verdict Verdict to format
+ * @param buffer Output buffer
+ * @param size Buffer size
+ */
+void adjudication_format_end(const Game *game, const Adjudication *verdict, char *buffer, int size) {
+    const char *winner = "";
+
+    if (verdict->outcome == ADJUDICATION_PLAYER1_WINS) {
+        winner = symtab_name(game->player1);
+    } else if (verdict->outcome == ADJUDICATION_PLAYER2_WINS) {
+        winner = symtab_name(game->player2);
+    }
+
+    snprintf(buffer, size, "%s,%s", winner, verdict->reason);
+}
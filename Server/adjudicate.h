@@ -0,0 +1,53 @@
+#ifndef SERVER_ADJUDICATE_H
+#define SERVER_ADJUDICATE_H
+
+#include <stdbool.h>
+#include "game.h"
+
+#define GAME_MOVE_LIMIT 200              // Completed moves before a game is adjudicated
+#define ADJUDICATION_DEPTH 12            // Search depth ceiling for adjudication
+#define ADJUDICATION_TIME_MS 250         // Search time budget for adjudication
+#define ADJUDICATION_MARGIN 150          // Advantage (centi-men) needed to award a win
+
+/**
+ * Result of an adjudication.
+ */
+typedef enum {
+    ADJUDICATION_NONE,           // Game can continue
+    ADJUDICATION_PLAYER1_WINS,
+    ADJUDICATION_PLAYER2_WINS,
+    ADJUDICATION_DRAW
+} AdjudicationOutcome;
+
+/**
+ * Adjudication verdict with the method used to reach it.
+ */
+typedef struct {
+    AdjudicationOutcome outcome;
+    const char *reason;          // Reason sent in OP_GAME_END
+    int score;                   // Evaluation from player 1's point of view
+} Adjudication;
+
+/**
+ * Checks if a running game must be adjudicated (no legal move or move limit).
+ * @return true if verdict holds a final result
+ */
+bool adjudicate_if_needed(const Game *game, Adjudication *verdict);
+
+/**
+ * Decides a game by evaluating the current position.
+ */
+void adjudicate_position(const Game *game, Adjudication *verdict);
+
+/**
+ * Decides a game abandoned by one player.
+ * The present player wins unless the position is lost for them (then draw).
+ */
+void adjudicate_abandoned(const Game *game, PlayerId absent_player, Adjudication *verdict);
+
+/**
+ * Formats OP_GAME_END payload ("winner,reason", empty winner for a draw).
+ */
+void adjudication_format_end(const Game *game, const Adjudication *verdict, char *buffer, int size);
+
+#endif //SERVER_ADJUDICATE_H
@@ -0,0 +1,331 @@
+#include <errno.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include "admin.h"
+#include "bufpool.h"
+#include "matchmaking.h"
+#include "metrics.h"
+#include "protocol.h"
+
+ServerStats server_stats;
+
+static Server *admin_server = NULL;
+static int admin_socket = -1;
+static pthread_t admin_thread;
+static char admin_path[sizeof(((struct sockaddr_un*)0)->sun_path)];
+static uint64_t admin_started_ns = 0;
+
+// ========== SNAPSHOT ==========
+
+// Closes the latency list when entries had to be left out
+static const char STATS_TRUNCATED_TAIL[] = "],\"latency_truncated\":true}";
+
+/**
+ * Appends formatted text to a buffer if all of it fits, so no entry is
+ * ever cut off midway. The buffer stays terminated either way.
+ *
+ * @param buffer Output buffer
+ * @param size Buffer size
+ * @param pos Current length, advanced by the written length
+ * @param fmt printf format
+ * @return true if appended, false if it did not fit
+ */
+static bool append(char *buffer, int size, int *pos, const char *fmt, ...) {
+    if (*pos >= size - 1) {
+        return false;
+    }
+
+    va_list args;
+    va_start(args, fmt);
+    int written = vsnprintf(buffer + *pos, size - *pos, fmt, args);
+    va_end(args);
+
+    if (written < 0 || written >= size - *pos) {
+        buffer[*pos] = '\0';
+        return false;
+    }
+    *pos += written;
+    return true;
+}
+
+/**
+ * Records the duration of one heartbeat sweep.
+ *
+ * @param duration_us Sweep duration in microseconds
+ */
+void admin_record_sweep(uint64_t duration_us) {
+    STATS_ADD(heartbeat_sweeps, 1);
+    __atomic_store_n(&server_stats.last_sweep_us, duration_us, __ATOMIC_RELAXED);
+    if (duration_us > STATS_LOAD(max_sweep_us)) {
+        __atomic_store_n(&server_stats.max_sweep_us, duration_us, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * Formats the stats snapshot as JSON.
+ * Reads only counters and metrics shards; no server mutex is taken.
+ * Latency entries that do not fit are left out and the object gets
+ * "latency_truncated":true, so the reply is always well-formed.
+ *
+ * @param server Pointer to the server
+ * @param buffer Output buffer
+ * @param size Buffer size
+ * @return Length written (excluding terminator)
+ */
+int admin_format_stats(Server *server, char *buffer, int size) {
+    int pos = 0;
+    buffer[0] = '\0';
+
+    uint64_t now = metrics_now_ns();
+    append(buffer, size, &pos, "{\"uptime_s\":%llu,\"client_count\":%d,\"room_count\":%d",
+           (unsigned long long)(admin_started_ns ? (now - admin_started_ns) / 1000000000ull : 0),
+           __atomic_load_n(&server->client_count, __ATOMIC_RELAXED),
+           __atomic_load_n(&server->room_count, __ATOMIC_RELAXED));
+
+    append(buffer, size, &pos, ",\"clients\":{");
+    for (int s = 0; s < CLIENT_STATE_COUNT; s++) {
+        append(buffer, size, &pos, "%s\"%s\":%d", s ? "," : "",
+               client_get_state_string((ClientState)s), STATS_LOAD(clients_by_state[s]));
+    }
+    append(buffer, size, &pos, "},\"client_transitions\":{");
+    for (int s = 0; s < CLIENT_STATE_COUNT; s++) {
+        append(buffer, size, &pos, "%s\"%s\":%llu", s ? "," : "",
+               client_get_state_string((ClientState)s),
+               (unsigned long long)STATS_LOAD(client_transitions[s]));
+    }
+    append(buffer, size, &pos, "},\"rooms\":{");
+    for (int s = 0; s < ROOM_STATE_COUNT; s++) {
+        append(buffer, size, &pos, "%s\"%s\":%d", s ? "," : "",
+               room_get_state_string((RoomState)s), STATS_LOAD(rooms_by_state[s]));
+    }
+
+    append(buffer, size, &pos,
+           "},\"connections\":{\"accepted\":%llu,\"rejected\":%llu}"
+           ",\"games\":{\"started\":%llu,\"finished\":%llu}"
+           ",\"reconnects\":{\"succeeded\":%llu,\"failed\":%llu"
+           ",\"replayed\":%llu,\"frames_replayed\":%llu}",
+           (unsigned long long)STATS_LOAD(connections_accepted),
+           (unsigned long long)STATS_LOAD(connections_rejected),
+           (unsigned long long)STATS_LOAD(games_started),
+           (unsigned long long)STATS_LOAD(games_finished),
+           (unsigned long long)STATS_LOAD(reconnects_succeeded),
+           (unsigned long long)STATS_LOAD(reconnects_failed),
+           (unsigned long long)STATS_LOAD(reconnects_replayed),
+           (unsigned long long)STATS_LOAD(frames_replayed));
+
+    append(buffer, size, &pos, ",\"dispatch\":{\"rejected\":%llu,\"rate_limited\":%llu}",
+           (unsigned long long)STATS_LOAD(frames_rejected),
+           (unsigned long long)STATS_LOAD(frames_rate_limited));
+
+    append(buffer, size, &pos, ",\"matchmaking\":{\"queued\":%d,\"matched\":%llu}",
+           matchmaking_size(), (unsigned long long)STATS_LOAD(quick_matches));
+
+    BufPoolStats pool;
+    bufpool_stats(&pool);
+    append(buffer, size, &pos, ",\"buffers\":{\"in_use\":%zu,\"free\":%zu}",
+           pool.in_use, pool.free);
+
+    append(buffer, size, &pos,
+           ",\"heartbeat\":{\"pings_sent\":%llu,\"pongs_received\":%llu,\"missed_pongs\":%llu"
+           ",\"sweeps\":%llu,\"last_sweep_us\":%llu,\"max_sweep_us\":%llu}",
+           (unsigned long long)STATS_LOAD(pings_sent),
+           (unsigned long long)STATS_LOAD(pongs_received),
+           (unsigned long long)STATS_LOAD(missed_pongs),
+           (unsigned long long)STATS_LOAD(heartbeat_sweeps),
+           (unsigned long long)STATS_LOAD(last_sweep_us),
+           (unsigned long long)STATS_LOAD(max_sweep_us));
+
+    MetricsSnapshot *snap = malloc(sizeof(MetricsSnapshot));
+    if (snap) {
+        metrics_snapshot(snap);
+
+        append(buffer, size, &pos,
+               ",\"traffic\":{\"frames_in\":%llu,\"frames_out\":%llu,\"bytes_in\":%llu"
+               ",\"bytes_out\":%llu,\"parse_errors\":%llu}",
+               (unsigned long long)snap->frames_in, (unsigned long long)snap->frames_out,
+               (unsigned long long)snap->bytes_in, (unsigned long long)snap->bytes_out,
+               (unsigned long long)snap->parse_errors);
+
+        append(buffer, size, &pos, ",\"latency_us\":[");
+        // Entries stop short of the room needed to close the object
+        int limit = size - (int)(sizeof(STATS_TRUNCATED_TAIL) - 1);
+        bool first = true;
+        bool truncated = false;
+        for (int p = 0; p < METRICS_PHASE_COUNT && !truncated; p++) {
+            for (int s = 0; s < METRICS_OP_SLOTS && !truncated; s++) {
+                const MetricsHistogram *hist = &snap->hist[p][s];
+                if (hist->count == 0) {
+                    continue;
+                }
+                truncated = !append(buffer, limit, &pos,
+                       "%s{\"phase\":\"%s\",\"op\":\"%s\",\"count\":%llu"
+                       ",\"p50\":%.1f,\"p99\":%.1f,\"max\":%.1f}",
+                       first ? "" : ",", metrics_phase_name((MetricsPhase)p), metrics_slot_name(s),
+                       (unsigned long long)hist->count,
+                       metrics_percentile(hist, 0.50) / 1000.0,
+                       metrics_percentile(hist, 0.99) / 1000.0,
+                       hist->max_ns / 1000.0);
+                first = false;
+            }
+        }
+        free(snap);
+
+        if (truncated) {
+            append(buffer, size, &pos, "%s", STATS_TRUNCATED_TAIL);
+            return pos;
+        }
+        append(buffer, size, &pos, "]");
+    }
+
+    append(buffer, size, &pos, "}");
+    return pos;
+}
+
+// ========== LISTENER ==========
+
+/**
+ * Serves one admin connection: reads a single DENTCP frame and answers
+ * OP_ADMIN_STATS with the JSON snapshot, anything else with OP_ERROR.
+ *
+ * @param fd Accepted admin socket
+ */
+static void admin_serve(int fd) {
+    struct timeval tv = {ADMIN_RECV_TIMEOUT_SEC, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    char request[256];
+    int len = 0;
+    while (len < (int)sizeof(request) - 1) {
+        ssize_t n = recv(fd, request + len, sizeof(request) - 1 - len, 0);
+        if (n <= 0) {
+            return;
+        }
+        len += (int)n;
+        if (memchr(request, '\n', len)) {
+            break;
+        }
+    }
+    request[len] = '\0';
+    request[strcspn(request, "\r\n")] = '\0';
+
+    Message msg;
+    DisconnectReason reason;
+    char reply[MAX_MESSAGE_LEN];
+    int reply_len;
+
+    if (parse_message(request, &msg, &reason) == 0 && msg.op == OP_ADMIN_STATS) {
+        char stats[MAX_DATA_LEN - 8];            // Leaves room for the frame header
+        admin_format_stats(admin_server, stats, sizeof(stats));
+        reply_len = create_message(reply, OP_ADMIN_STATS, stats);
+    } else {
+        reply_len = create_message(reply, OP_ERROR, "Unsupported admin request");
+    }
+
+    if (reply_len > 0) {
+        send(fd, reply, reply_len, MSG_NOSIGNAL);
+    }
+}
+
+/**
+ * Admin listener thread. Connections are served one at a time;
+ * each request only reads counters, so it never blocks game threads.
+ *
+ * @param arg Unused
+ * @return NULL when the listener is closed
+ */
+static void* admin_thread_main(void *arg) {
+    (void)arg;
+
+    while (1) {
+        int fd = accept(admin_socket, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        admin_serve(fd);
+        close(fd);
+    }
+
+    return NULL;
+}
+
+/**
+ * Starts the admin listener thread on a Unix domain socket.
+ * A stale socket file from a previous run is replaced.
+ *
+ * @param server Pointer to the server
+ * @param socket_path Filesystem path of the socket
+ * @return 0 on success, -1 on failure
+ */
+int admin_start(Server *server, const char *socket_path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+
+    if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Admin socket path too long: %s\n", socket_path);
+        return -1;
+    }
+    strcpy(addr.sun_path, socket_path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("Admin socket creation failed");
+        return -1;
+    }
+
+    unlink(socket_path);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("Admin bind failed");
+        close(fd);
+        return -1;
+    }
+
+    if (listen(fd, ADMIN_MAX_PENDING) < 0) {
+        perror("Admin listen failed");
+        close(fd);
+        unlink(socket_path);
+        return -1;
+    }
+
+    admin_server = server;
+    admin_socket = fd;
+    admin_started_ns = metrics_now_ns();
+    strcpy(admin_path, socket_path);
+
+    if (pthread_create(&admin_thread, NULL, admin_thread_main, NULL) != 0) {
+        perror("Failed to create admin thread");
+        close(fd);
+        unlink(socket_path);
+        admin_socket = -1;
+        return -1;
+    }
+
+    printf("Admin listener on %s\n", socket_path);
+    return 0;
+}
+
+/**
+ * Stops the admin listener and removes its socket file.
+ */
+void admin_stop(void) {
+    if (admin_socket < 0) {
+        return;
+    }
+
+    // shutdown wakes the blocked accept
+    shutdown(admin_socket, SHUT_RDWR);
+    pthread_join(admin_thread, NULL);
+    close(admin_socket);
+    unlink(admin_path);
+    admin_socket = -1;
+}
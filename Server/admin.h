@@ -0,0 +1,70 @@
+#ifndef SERVER_ADMIN_H
+#define SERVER_ADMIN_H
+
+#include <stdint.h>
+#include "server.h"
+
+#define ADMIN_MAX_PENDING 4              // Admin listen backlog
+#define ADMIN_RECV_TIMEOUT_SEC 2         // Time an admin client has to send its request
+
+/**
+ * Live server counters, updated where the event happens so a stats
+ * request never scans the client or room tables.
+ * Fields are modified with relaxed atomics (see STATS_ADD).
+ */
+typedef struct {
+    int clients_by_state[CLIENT_STATE_COUNT];    // Client slots currently in each ClientState
+    int rooms_by_state[ROOM_STATE_COUNT];        // Rooms currently in each RoomState
+    uint64_t client_transitions[CLIENT_STATE_COUNT]; // Entries into each ClientState
+    uint64_t connections_accepted;               // Sockets returned by accept
+    uint64_t connections_rejected;               // Refused because the server was full
+    uint64_t games_started;
+    uint64_t games_finished;
+    uint64_t quick_matches;                      // Games started by matchmaking
+    uint64_t disconnect_reasons[DISCONNECT_REASON_COUNT]; // Forced disconnects per reason
+    uint64_t reconnects_succeeded;               // Sessions moved to a new socket
+    uint64_t reconnects_failed;                  // OP_RECONNECT_REQUEST rejected
+    uint64_t reconnects_replayed;                // Resumed from the outbox instead of a resync
+    uint64_t frames_replayed;                    // Missed frames resent from outboxes
+    uint64_t frames_rejected;                    // Payload did not match the opcode's schema
+    uint64_t frames_rate_limited;                // Dropped over a rate-class limit
+
+    // Heartbeat
+    uint64_t pings_sent;
+    uint64_t pongs_received;
+    uint64_t missed_pongs;
+    uint64_t heartbeat_sweeps;
+    uint64_t last_sweep_us;                      // Duration of the latest sweep
+    uint64_t max_sweep_us;                       // Longest sweep since start
+} ServerStats;
+
+extern ServerStats server_stats;
+
+#define STATS_ADD(field, n) __atomic_fetch_add(&server_stats.field, (n), __ATOMIC_RELAXED)
+#define STATS_LOAD(field) __atomic_load_n(&server_stats.field, __ATOMIC_RELAXED)
+
+// ========== ADMIN LISTENER ==========
+
+/**
+ * Starts the admin listener thread on a Unix domain socket.
+ * @return 0 on success, -1 on failure
+ */
+int admin_start(Server *server, const char *socket_path);
+
+/**
+ * Stops the admin listener and removes its socket file.
+ */
+void admin_stop(void);
+
+/**
+ * Formats the stats snapshot as JSON.
+ * @return Length written (excluding terminator)
+ */
+int admin_format_stats(Server *server, char *buffer, int size);
+
+/**
+ * Records the duration of one heartbeat sweep.
+ */
+void admin_record_sweep(uint64_t duration_us);
+
+#endif //SERVER_ADMIN_H
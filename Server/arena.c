@@ -0,0 +1,81 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include "arena.h"
+
+/**
+ * Allocates memory from an arena.
+ *
+ * Bumps within the pooled block while it has room; otherwise the
+ * allocation gets an exact-size block of its own.
+ *
+ * @param arena Arena to allocate from
+ * @param size Bytes needed
+ * @return ARENA_ALIGN-aligned memory, NULL if out of memory
+ */
+void* arena_alloc(Arena *arena, size_t size) {
+    size_t offset = (arena->used + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+
+    if (size <= ARENA_BLOCK_SIZE && offset <= ARENA_BLOCK_SIZE - size) {
+        if (!arena->base) {
+            arena->base = bufpool_alloc(ARENA_BLOCK_SIZE);
+            if (!arena->base) {
+                return NULL;
+            }
+        }
+        arena->used = offset + size;
+        return arena->base + offset;
+    }
+
+    if (size > SIZE_MAX - ARENA_ALIGN) {
+        return NULL;
+    }
+    ArenaBlock *block = malloc(ARENA_ALIGN + size);
+    if (!block) {
+        return NULL;
+    }
+    block->next = arena->extra;
+    arena->extra = block;
+    return (char*)block + ARENA_ALIGN;
+}
+
+/**
+ * Gets the current position of an arena.
+ *
+ * @param arena Arena
+ * @return Mark to pass to arena_release
+ */
+ArenaMark arena_mark(const Arena *arena) {
+    ArenaMark mark = { arena->used, arena->extra };
+    return mark;
+}
+
+/**
+ * Releases everything allocated since a mark. Oversized blocks go back
+ * to the heap, and the pooled block goes back to the pool once nothing
+ * is allocated from it.
+ *
+ * @param arena Arena
+ * @param mark Position taken with arena_mark
+ */
+void arena_release(Arena *arena, ArenaMark mark) {
+    while (arena->extra != mark.extra) {
+        ArenaBlock *block = arena->extra;
+        arena->extra = block->next;
+        free(block);
+    }
+    arena->used = mark.used;
+
+    if (arena->used == 0 && arena->base) {
+        bufpool_free(arena->base, ARENA_BLOCK_SIZE);
+        arena->base = NULL;
+    }
+}
+
+/**
+ * Releases all memory of an arena.
+ *
+ * @param arena Arena
+ */
+void arena_free(Arena *arena) {
+    arena_release(arena, (ArenaMark){ 0, NULL });
+}
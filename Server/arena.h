@@ -0,0 +1,62 @@
+#ifndef SERVER_ARENA_H
+#define SERVER_ARENA_H
+
+#include <stddef.h>
+#include "bufpool.h"
+
+#define ARENA_BLOCK_SIZE BUFPOOL_BLOCK_SIZE // Bytes of the pooled block allocations bump in
+#define ARENA_ALIGN 16                   // Alignment of every allocation
+
+/**
+ * Block of an allocation that did not fit the pooled block.
+ */
+typedef struct ArenaBlock {
+    struct ArenaBlock *next;             // Older block; data follows at ARENA_ALIGN
+} ArenaBlock;
+
+/**
+ * Bump allocator for short-lived buffers sized to their contents.
+ *
+ * Allocations come from one ARENA_BLOCK_SIZE block taken from the
+ * buffer pool on first use and returned once the arena is empty again;
+ * larger ones get a block of their own that is returned to the heap
+ * when released. Allocations are released together by going back to a
+ * mark, so nested users (a frame sent while a heartbeat sweep holds its
+ * list) share the arena. A zeroed Arena is empty.
+ */
+typedef struct {
+    char *base;                          // Pooled block, NULL while the arena is empty
+    size_t used;                         // Bytes of base handed out
+    ArenaBlock *extra;                   // Oversized blocks, newest first
+} Arena;
+
+/**
+ * Position to release an arena back to.
+ */
+typedef struct {
+    size_t used;
+    ArenaBlock *extra;
+} ArenaMark;
+
+/**
+ * Allocates ARENA_ALIGN-aligned memory, valid until released.
+ * @return Memory, NULL if out of memory
+ */
+void* arena_alloc(Arena *arena, size_t size);
+
+/**
+ * Gets the current position of an arena.
+ */
+ArenaMark arena_mark(const Arena *arena);
+
+/**
+ * Releases everything allocated since a mark.
+ */
+void arena_release(Arena *arena, ArenaMark mark);
+
+/**
+ * Releases all memory of an arena; it can be used again afterwards.
+ */
+void arena_free(Arena *arena);
+
+#endif //SERVER_ARENA_H
@@ -0,0 +1,116 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bufpool.h"
+
+/**
+ * Free block, linked through its first bytes.
+ */
+typedef struct FreeBlock {
+    struct FreeBlock *next;
+} FreeBlock;
+
+static FreeBlock *free_blocks;           // Stack of free blocks
+static BufPoolStats pool_stats;
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Allocates a buffer. Blocks of BUFPOOL_BLOCK_SIZE bytes are reused
+ * from the pool when one is free.
+ *
+ * @param size Bytes needed
+ * @return Buffer, NULL if out of memory
+ */
+void* bufpool_alloc(size_t size) {
+    if (size != BUFPOOL_BLOCK_SIZE) {
+        return malloc(size);
+    }
+
+    pthread_mutex_lock(&pool_mutex);
+    FreeBlock *block = free_blocks;
+    if (block) {
+        free_blocks = block->next;
+        pool_stats.free--;
+    }
+    pool_stats.in_use++;
+    pthread_mutex_unlock(&pool_mutex);
+
+    if (!block && !(block = malloc(BUFPOOL_BLOCK_SIZE))) {
+        pthread_mutex_lock(&pool_mutex);
+        pool_stats.in_use--;
+        pthread_mutex_unlock(&pool_mutex);
+    }
+    return block;
+}
+
+/**
+ * Resizes a buffer, moving it in or out of the pool as its size
+ * changes to or from BUFPOOL_BLOCK_SIZE.
+ *
+ * @param buffer Buffer, or NULL to allocate
+ * @param size Current size of the buffer
+ * @param new_size Size needed
+ * @return Resized buffer, NULL if out of memory (the old one is kept)
+ */
+void* bufpool_resize(void *buffer, size_t size, size_t new_size) {
+    if (!buffer) {
+        return bufpool_alloc(new_size);
+    }
+    if (size != BUFPOOL_BLOCK_SIZE && new_size != BUFPOOL_BLOCK_SIZE) {
+        return realloc(buffer, new_size);
+    }
+    if (size == new_size) {
+        return buffer;
+    }
+
+    void *resized = bufpool_alloc(new_size);
+    if (resized) {
+        memcpy(resized, buffer, size < new_size ? size : new_size);
+        bufpool_free(buffer, size);
+    }
+    return resized;
+}
+
+/**
+ * Frees a buffer. Blocks of BUFPOOL_BLOCK_SIZE bytes go back to the
+ * pool unless it already keeps BUFPOOL_MAX_FREE of them.
+ *
+ * @param buffer Buffer, or NULL
+ * @param size Size the buffer was allocated or resized to
+ */
+void bufpool_free(void *buffer, size_t size) {
+    if (!buffer) {
+        return;
+    }
+    if (size != BUFPOOL_BLOCK_SIZE) {
+        free(buffer);
+        return;
+    }
+
+    pthread_mutex_lock(&pool_mutex);
+    pool_stats.in_use--;
+    bool keep = pool_stats.free < BUFPOOL_MAX_FREE;
+    if (keep) {
+        FreeBlock *block = buffer;
+        block->next = free_blocks;
+        free_blocks = block;
+        pool_stats.free++;
+    }
+    pthread_mutex_unlock(&pool_mutex);
+
+    if (!keep) {
+        free(buffer);
+    }
+}
+
+/**
+ * Gets the pool usage counters.
+ *
+ * @param stats Output counters
+ */
+void bufpool_stats(BufPoolStats *stats) {
+    pthread_mutex_lock(&pool_mutex);
+    *stats = pool_stats;
+    pthread_mutex_unlock(&pool_mutex);
+}
@@ -0,0 +1,51 @@
+#ifndef SERVER_BUFPOOL_H
+#define SERVER_BUFPOOL_H
+
+#include <stddef.h>
+
+#define BUFPOOL_BLOCK_SIZE 1024          // Bytes of a pooled buffer
+#ifndef BUFPOOL_MAX_FREE
+#define BUFPOOL_MAX_FREE 256             // Free blocks kept for reuse; more go back to the heap
+#endif
+
+/**
+ * Pool usage counters.
+ */
+typedef struct {
+    size_t in_use;                       // Pooled blocks held by connections
+    size_t free;                         // Blocks kept for reuse
+} BufPoolStats;
+
+/**
+ * Shared pool of connection buffers.
+ *
+ * Receive buffers, transport queues, outboxes and worker arenas take
+ * their storage from here while they hold data and return it when
+ * they drain, so idle connections hold no buffers. Buffers of exactly
+ * BUFPOOL_BLOCK_SIZE bytes are pooled; other sizes use the heap. A
+ * buffer is always freed with the size it was allocated or resized to.
+ */
+
+/**
+ * Allocates a buffer.
+ * @return Buffer of size bytes, NULL if out of memory
+ */
+void* bufpool_alloc(size_t size);
+
+/**
+ * Resizes a buffer like realloc, keeping min(size, new_size) bytes.
+ * @return Resized buffer, NULL if out of memory (the old one is kept)
+ */
+void* bufpool_resize(void *buffer, size_t size, size_t new_size);
+
+/**
+ * Frees a buffer; NULL is ignored.
+ */
+void bufpool_free(void *buffer, size_t size);
+
+/**
+ * Gets the pool usage counters.
+ */
+void bufpool_stats(BufPoolStats *stats);
+
+#endif //SERVER_BUFPOOL_H
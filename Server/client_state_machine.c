@@ -4,6 +4,7 @@
 
 #include "client_state_machine.h"
 #include "server.h"
+#include "probes.h"
 #include <stdio.h>
 #include <string.h>
 
@@ -28,78 +29,61 @@ const char* client_game_state_to_string(ClientGameState state) {
     }
 }
 
+// ========== OPERATION PERMISSIONS ==========
+
+_Static_assert(OPCODE_COUNT <= 64, "permission masks hold one bit per dense opcode index");
+_Static_assert(OPS_NOT_LOGGED_IN == 1u << CLIENT_GAME_STATE_NOT_LOGGED_IN &&
+               OPS_LOBBY == 1u << CLIENT_GAME_STATE_IN_LOBBY &&
+               OPS_WAITING == 1u << CLIENT_GAME_STATE_IN_ROOM_WAITING &&
+               OPS_GAME == 1u << CLIENT_GAME_STATE_IN_GAME,
+               "OPS_* bits follow ClientGameState");
+
+// Bit of an opcode in the mask of a state if its OPCODE_LIST entry allows that state
+#define ALLOW_BIT(name, states, state) \
+    ((uint64_t)(((states) >> (state)) & 1u) << OPCODE_INDEX_##name)
+#define ALLOW_NOT_LOGGED_IN(name, code, states, payload) \
+    | ALLOW_BIT(name, states, CLIENT_GAME_STATE_NOT_LOGGED_IN)
+#define ALLOW_IN_LOBBY(name, code, states, payload) \
+    | ALLOW_BIT(name, states, CLIENT_GAME_STATE_IN_LOBBY)
+#define ALLOW_IN_ROOM_WAITING(name, code, states, payload) \
+    | ALLOW_BIT(name, states, CLIENT_GAME_STATE_IN_ROOM_WAITING)
+#define ALLOW_IN_GAME(name, code, states, payload) \
+    | ALLOW_BIT(name, states, CLIENT_GAME_STATE_IN_GAME)
+
 /**
- * Gets list of operations allowed in a given game state.
- * Implements the client state machine's operation whitelist.
+ * Operation whitelist of the client state machine: per game state, one
+ * bit per dense opcode index, built at compile time from OPCODE_LIST.
+ */
+static const uint64_t allowed_operations[CLIENT_GAME_STATE_COUNT] = {
+    [CLIENT_GAME_STATE_NOT_LOGGED_IN] = 0 OPCODE_LIST(ALLOW_NOT_LOGGED_IN),
+    [CLIENT_GAME_STATE_IN_LOBBY] = 0 OPCODE_LIST(ALLOW_IN_LOBBY),
+    [CLIENT_GAME_STATE_IN_ROOM_WAITING] = 0 OPCODE_LIST(ALLOW_IN_ROOM_WAITING),
+    [CLIENT_GAME_STATE_IN_GAME] = 0 OPCODE_LIST(ALLOW_IN_GAME)
+};
+
+/**
+ * Gets the operations allowed in a given game state.
  *
  * @param state Current game state
- * @return Structure containing allowed operations
+ * @return Bitmask over dense opcode indices, 0 for an invalid state
  */
-AllowedOperations get_allowed_operations(ClientGameState state) {
-    AllowedOperations ops;
-    ops.count = 0;
-
-    switch (state) {
-        case CLIENT_GAME_STATE_NOT_LOGGED_IN:
-            ops.allowed_ops[ops.count++] = OP_LOGIN;
-            ops.allowed_ops[ops.count++] = OP_PONG;
-            ops.allowed_ops[ops.count++] = OP_PING;
-            ops.allowed_ops[ops.count++] = OP_RECONNECT_REQUEST;
-            ops.allowed_ops[ops.count++] = OP_ERROR;
-            break;
-
-        case CLIENT_GAME_STATE_IN_LOBBY:
-            ops.allowed_ops[ops.count++] = OP_CREATE_ROOM;
-            ops.allowed_ops[ops.count++] = OP_JOIN_ROOM;
-            ops.allowed_ops[ops.count++] = OP_LIST_ROOMS;
-            ops.allowed_ops[ops.count++] = OP_PONG;
-            ops.allowed_ops[ops.count++] = OP_PING;
-            ops.allowed_ops[ops.count++] = OP_RECONNECT_REQUEST;
-            ops.allowed_ops[ops.count++] = OP_ERROR;
-            break;
-
-        case CLIENT_GAME_STATE_IN_ROOM_WAITING:
-            ops.allowed_ops[ops.count++] = OP_LEAVE_ROOM;
-            ops.allowed_ops[ops.count++] = OP_JOIN_ROOM;
-            ops.allowed_ops[ops.count++] = OP_LIST_ROOMS;
-            ops.allowed_ops[ops.count++] = OP_PONG;
-            ops.allowed_ops[ops.count++] = OP_PING;
-            ops.allowed_ops[ops.count++] = OP_RECONNECT_REQUEST;
-            ops.allowed_ops[ops.count++] = OP_ERROR;
-            break;
-
-        case CLIENT_GAME_STATE_IN_GAME:
-            ops.allowed_ops[ops.count++] = OP_MOVE;
-            ops.allowed_ops[ops.count++] = OP_MULTI_MOVE;
-            ops.allowed_ops[ops.count++] = OP_LIST_ROOMS;
-            ops.allowed_ops[ops.count++] = OP_LEAVE_ROOM;
-            ops.allowed_ops[ops.count++] = OP_PONG;
-            ops.allowed_ops[ops.count++] = OP_PING;
-            ops.allowed_ops[ops.count++] = OP_RECONNECT_REQUEST;
-            ops.allowed_ops[ops.count++] = OP_ERROR;
-            break;
+uint64_t get_allowed_operations(ClientGameState state) {
+    if ((unsigned int)state >= CLIENT_GAME_STATE_COUNT) {
+        return 0;
     }
-
-    return ops;
+    return allowed_operations[state];
 }
 
 /**
  * Checks if an operation is allowed in the current game state.
+ * Unknown opcodes map to index 0, which no state allows.
  *
  * @param state Current game state
  * @param op Operation to validate
  * @return true if operation is allowed, false otherwise
  */
 bool is_operation_allowed(ClientGameState state, OpCode op) {
-    AllowedOperations ops = get_allowed_operations(state);
-
-    for (int i = 0; i < ops.count; i++) {
-        if (ops.allowed_ops[i] == op) {
-            return true;
-        }
-    }
-
-    return false;
+    return (get_allowed_operations(state) >> opcode_index(op)) & 1u;
 }
 
 /**
@@ -110,6 +94,7 @@ bool is_operation_allowed(ClientGameState state, OpCode op) {
  * @param new_state New game state to transition to
  */
 void transition_client_state(Client *client, ClientGameState new_state) {
+    PROBE3(client__game_state, client->client_id, (int)client->game_state, (int)new_state);
     printf("Client %s: %s → %s\n",
            client->client_id[0] ? client->client_id : "anonymous",
            client_game_state_to_string(client->game_state),
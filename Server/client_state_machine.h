@@ -6,6 +6,7 @@
 #define SERVER_CLIENT_STATE_MACHINE_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "protocol.h"
 
 // Forward declaration to avoid circular dependency
@@ -23,13 +24,7 @@ typedef enum {
     CLIENT_GAME_STATE_IN_GAME // Active game in progress
 } ClientGameState;
 
-/**
- * Structure containing allowed operations for a state.
- */
-typedef struct {
-    OpCode allowed_ops[30];
-    int count;
-} AllowedOperations;
+#define CLIENT_GAME_STATE_COUNT (CLIENT_GAME_STATE_IN_GAME + 1)
 
 // ========== STATE MACHINE FUNCTIONS ==========
 
@@ -39,9 +34,10 @@ typedef struct {
 const char* client_game_state_to_string(ClientGameState state);
 
 /**
- * Gets list of operations allowed in given state.
+ * Gets the operations allowed in given state as a bitmask over dense
+ * opcode indices (bit opcode_index(op)).
  */
-AllowedOperations get_allowed_operations(ClientGameState state);
+uint64_t get_allowed_operations(ClientGameState state);
 
 /**
  * Checks if operation is allowed in current state.
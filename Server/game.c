@@ -3,6 +3,20 @@
 #include <string.h>
 #include <stdlib.h>
 
+static bool game_logging = true;   // Per-step rule tracing to stdout
+
+#define GAME_LOG(...) do { if (game_logging) printf(__VA_ARGS__); } while (0)
+
+/**
+ * Enables or disables per-step rule tracing.
+ * Tools that validate millions of moves turn it off.
+ *
+ * @param enabled true to print validation and apply traces
+ */
+void game_set_logging(bool enabled) {
+    game_logging = enabled;
+}
+
 /**
  * Initializes a new checkers game with starting board configuration.
  * Sets up the standard 8x8 checkers board with pieces in starting positions:
@@ -10,10 +24,10 @@
  * - Black pieces (3) on rows 0-2
  *
  * @param game Pointer to game structure to initialize
- * @param player1 Name of player 1 (white pieces)
- * @param player2 Name of player 2 (black pieces)
+ * @param player1 Player 1 (white pieces), who moves first
+ * @param player2 Player 2 (black pieces)
  */
-void init_game(Game *game, const char *player1, const char *player2) {
+void init_game(Game *game, PlayerId player1, PlayerId player2) {
     int initial_board[BOARD_SIZE][BOARD_SIZE] = {
         {3, 0, 3, 0, 3, 0, 3, 0},
         {0, 3, 0, 3, 0, 3, 0, 3},
@@ -26,12 +40,13 @@ void init_game(Game *game, const char *player1, const char *player2) {
     };
     
     memcpy(game->board, initial_board, sizeof(initial_board));
-    strncpy(game->player1, player1, MAX_PLAYER_NAME - 1);
-    strncpy(game->player2, player2, MAX_PLAYER_NAME - 1);
-    strncpy(game->current_turn, player1, MAX_PLAYER_NAME - 1);
+    game->player1 = player1;
+    game->player2 = player2;
+    game->player2_to_move = false;
     game->player1_color = COLOR_WHITE;
     game->player2_color = COLOR_BLACK;
     game->game_active = true;
+    game->move_count = 0;
 }
 
 /**
@@ -45,15 +60,16 @@ void reset_game(Game *game) {
 
 /**
  * Converts game board state to JSON format for client transmission.
- * Returns a static buffer containing the JSON representation.
+ * Returns a per-thread static buffer containing the JSON representation,
+ * so concurrent room broadcasts cannot overwrite each other's state.
  *
  * Format: {"board":[[...]],"current_turn":"name","player1":"name","player2":"name"}
  *
  * @param game Pointer to game state
- * @return Pointer to static JSON string buffer
+ * @return Pointer to thread-local JSON string buffer
  */
 char* game_board_to_json(const Game *game) {
-    static char json[4096];
+    static __thread char json[4096];
     char *ptr = json;
     
     ptr += sprintf(ptr, "{\"board\":[");
@@ -69,7 +85,8 @@ char* game_board_to_json(const Game *game) {
     }
     
     ptr += sprintf(ptr, "],\"current_turn\":\"%s\",\"player1\":\"%s\",\"player2\":\"%s\"}",
-                  game->current_turn, game->player1, game->player2);
+                  symtab_name(game_turn_player(game)), symtab_name(game->player1),
+                  symtab_name(game->player2));
     
     return json;
 }
@@ -141,36 +158,36 @@ bool piece_belongs_to_color(int piece, PlayerColor color) {
  * @return true if move is valid
  */
 bool validate_single_step(const Game *game, int from_row, int from_col,
-                         int to_row, int to_col, const char *player) {
-    printf(" Validating step: (%d,%d) -> (%d,%d)\n", from_row, from_col, to_row, to_col);
+                         int to_row, int to_col, PlayerId player) {
+    GAME_LOG(" Validating step: (%d,%d) -> (%d,%d)\n", from_row, from_col, to_row, to_col);
 
     // Bounds check
     if (from_row < 0 || from_row >= BOARD_SIZE || from_col < 0 || from_col >= BOARD_SIZE ||
         to_row < 0 || to_row >= BOARD_SIZE || to_col < 0 || to_col >= BOARD_SIZE) {
-        printf("Out of bounds\n");
+        GAME_LOG("Out of bounds\n");
         return false;
     }
 
     // Destination must be empty
     if (game->board[to_row][to_col] != EMPTY) {
-        printf("Destination not empty\n");
+        GAME_LOG("Destination not empty\n");
         return false;
     }
 
     // Source must have a piece
     int piece = game->board[from_row][from_col];
     if (piece == EMPTY) {
-        printf("Source empty\n");
+        GAME_LOG("Source empty\n");
         return false;
     }
 
     // Determine player's color
-    PlayerColor player_color = (strcmp(player, game->player1) == 0) ?
+    PlayerColor player_color = (player == game->player1) ?
                                game->player1_color : game->player2_color;
 
     // Piece must belong to player
     if (!piece_belongs_to_color(piece, player_color)) {
-        printf("Wrong color (piece: %d, player: %s)\n", piece, player);
+        GAME_LOG("Wrong color (piece: %d, player: %s)\n", piece, symtab_name(player));
         return false;
     }
 
@@ -180,7 +197,7 @@ bool validate_single_step(const Game *game, int from_row, int from_col,
 
     // Must move diagonally
     if (abs_row_diff != col_diff) {
-        printf("Not diagonal (row_diff: %d, col_diff: %d)\n", abs_row_diff, col_diff);
+        GAME_LOG("Not diagonal (row_diff: %d, col_diff: %d)\n", abs_row_diff, col_diff);
         return false;
     }
 
@@ -200,7 +217,7 @@ bool validate_single_step(const Game *game, int from_row, int from_col,
 
             if (check_piece != EMPTY) {
                 if (piece_belongs_to_color(check_piece, player_color)) {
-                    printf("Own piece blocks at (%d,%d)\n", check_row, check_col);
+                    GAME_LOG("Own piece blocks at (%d,%d)\n", check_row, check_col);
                     return false;
                 }
 
@@ -209,7 +226,7 @@ bool validate_single_step(const Game *game, int from_row, int from_col,
                 last_enemy_col = check_col;
 
                 if (enemies > 1) {
-                    printf("Multiple enemies in path\n");
+                    GAME_LOG("Multiple enemies in path\n");
                     return false;
                 }
             }
@@ -217,10 +234,10 @@ bool validate_single_step(const Game *game, int from_row, int from_col,
 
         // King can move freely (0 enemies) or capture (1 enemy)
         if (enemies == 0) {
-            printf("Valid king move (distance: %d)\n", abs_row_diff);
+            GAME_LOG("Valid king move (distance: %d)\n", abs_row_diff);
             return true;
         } else if (enemies == 1) {
-            printf("Valid king capture at (%d,%d)\n", last_enemy_row, last_enemy_col);
+            GAME_LOG("Valid king capture at (%d,%d)\n", last_enemy_row, last_enemy_col);
             return true;
         }
 
@@ -233,13 +250,13 @@ bool validate_single_step(const Game *game, int from_row, int from_col,
     if (abs_row_diff == 1 && col_diff == 1) {
         // Check direction (regular pieces can only move forward)
         if (piece == WHITE_PIECE && row_diff == -1) {
-            printf("Valid WHITE move forward\n");
+            GAME_LOG("Valid WHITE move forward\n");
             return true;
         } else if (piece == BLACK_PIECE && row_diff == 1) {
-            printf("Valid BLACK move forward\n");
+            GAME_LOG("Valid BLACK move forward\n");
             return true;
         } else {
-            printf("Regular piece cannot move backward\n");
+            GAME_LOG("Regular piece cannot move backward\n");
             return false;
         }
     }
@@ -252,7 +269,7 @@ bool validate_single_step(const Game *game, int from_row, int from_col,
         int mid_piece = game->board[mid_row][mid_col];
 
         if (mid_piece == EMPTY) {
-            printf("No piece to capture at (%d,%d)\n", mid_row, mid_col);
+            GAME_LOG("No piece to capture at (%d,%d)\n", mid_row, mid_col);
             return false;
         }
 
@@ -265,17 +282,17 @@ bool validate_single_step(const Game *game, int from_row, int from_col,
         }
 
         if (is_enemy) {
-            printf("Valid capture (can jump backward!): captured piece at (%d,%d)\n",
+            GAME_LOG("Valid capture (can jump backward!): captured piece at (%d,%d)\n",
                    mid_row, mid_col);
             return true;
         } else {
-            printf("Cannot capture own piece at (%d,%d)\n", mid_row, mid_col);
+            GAME_LOG("Cannot capture own piece at (%d,%d)\n", mid_row, mid_col);
             return false;
         }
     }
 
     // Invalid move distance
-    printf("Invalid move distance (%d) for regular piece\n", abs_row_diff);
+    GAME_LOG("Invalid move distance (%d) for regular piece\n", abs_row_diff);
     return false;
 }
 
@@ -291,11 +308,11 @@ bool validate_single_step(const Game *game, int from_row, int from_col,
  * @return true if move is valid
  */
 bool validate_move(const Game *game, int from_row, int from_col,
-                  int to_row, int to_col, const char *player) {
-    printf("\n=== VALIDATE MOVE ===\n");
+                  int to_row, int to_col, PlayerId player) {
+    GAME_LOG("\n=== VALIDATE MOVE ===\n");
 
-    if (strcmp(game->current_turn, player) != 0) {
-        printf("Not player's turn\n");
+    if (game_turn_player(game) != player) {
+        GAME_LOG("Not player's turn\n");
         return false;
     }
 
@@ -314,7 +331,7 @@ bool validate_move(const Game *game, int from_row, int from_col,
  */
 void apply_single_step(Game *game, int from_row, int from_col, int to_row, int to_col) {
     int piece = game->board[from_row][from_col];
-    printf("Applying: (%d,%d)->(%d,%d)\n", from_row, from_col, to_row, to_col);
+    GAME_LOG("Applying: (%d,%d)->(%d,%d)\n", from_row, from_col, to_row, to_col);
     // Move piece
     game->board[to_row][to_col] = piece;
     game->board[from_row][from_col] = EMPTY;
@@ -331,7 +348,7 @@ void apply_single_step(Game *game, int from_row, int from_col, int to_row, int t
             int mid_col = from_col + dCol * step;
 
             if (game->board[mid_row][mid_col] != EMPTY) {
-                printf("  Removing (%d,%d)\n", mid_row, mid_col);
+                GAME_LOG("  Removing (%d,%d)\n", mid_row, mid_col);
                 game->board[mid_row][mid_col] = EMPTY;
             }
         }
@@ -340,10 +357,10 @@ void apply_single_step(Game *game, int from_row, int from_col, int to_row, int t
     // King promotion when reaching opposite end
     if (piece == WHITE_PIECE && to_row == 0) {
         game->board[to_row][to_col] = WHITE_KING;
-        printf("  WHITE -> KING\n");
+        GAME_LOG("  WHITE -> KING\n");
     } else if (piece == BLACK_PIECE && to_row == BOARD_SIZE - 1) {
         game->board[to_row][to_col] = BLACK_KING;
-        printf("  BLACK -> KING\n");
+        GAME_LOG("  BLACK -> KING\n");
     }
 }
 
@@ -397,28 +414,33 @@ void print_board(const Game *game) {
 }
 
 /**
- * Switches turn to the other player.
+ * Switches turn to the other player and counts the completed move.
  *
  * @param game Game state to modify
  */
 void change_turn(Game *game) {
-    if (strcmp(game->current_turn, game->player1) == 0) {
-        strncpy(game->current_turn, game->player2, MAX_PLAYER_NAME - 1);
-        game->current_turn[MAX_PLAYER_NAME - 1] = '\0';
-    } else {
-        strncpy(game->current_turn, game->player1, MAX_PLAYER_NAME - 1);
-        game->current_turn[MAX_PLAYER_NAME - 1] = '\0';
-    }
+    game->move_count++;
+    game->player2_to_move = !game->player2_to_move;
+}
+
+/**
+ * Gets the player whose turn it is.
+ *
+ * @param game Current game state
+ * @return player1 or player2
+ */
+PlayerId game_turn_player(const Game *game) {
+    return game->player2_to_move ? game->player2 : game->player1;
 }
 
 /**
  * Checks if game is over (one player has no pieces remaining).
  *
  * @param game Current game state
- * @param winner Output buffer for winner's name
+ * @param winner Output for the winner
  * @return true if game is over
  */
-bool check_game_over(const Game *game, char *winner) {
+bool check_game_over(const Game *game, PlayerId *winner) {
     int white_pieces = 0, black_pieces = 0;
     
     for (int i = 0; i < BOARD_SIZE; i++) {
@@ -430,11 +452,11 @@ bool check_game_over(const Game *game, char *winner) {
     }
     
     if (white_pieces == 0) {
-        strcpy(winner, game->player2);
+        *winner = game->player2;
         return true;
     }
     if (black_pieces == 0) {
-        strcpy(winner, game->player1);
+        *winner = game->player1;
         return true;
     }
     
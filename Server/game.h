@@ -8,6 +8,7 @@
 #include <stdbool.h>
 #include <pthread.h>
 #include <time.h>
+#include "symtab.h"
 
 #define BOARD_SIZE 8
 #define MAX_ROOM_NAME 64
@@ -48,33 +49,38 @@ typedef enum {
  */
 typedef struct {
     int board[BOARD_SIZE][BOARD_SIZE];  // 8x8 board grid
-    char player1[MAX_PLAYER_NAME];      // Player 1 name
-    char player2[MAX_PLAYER_NAME];      // Player 2 name
-    char current_turn[MAX_PLAYER_NAME]; // Who's turn it is
+    PlayerId player1;                   // Player 1 (white pieces)
+    PlayerId player2;                   // Player 2 (black pieces)
+    bool player2_to_move;               // Side to move: false = player1
     PlayerColor player1_color;          // Player 1's piece color
     PlayerColor player2_color;          // Player 2's piece color
     bool game_active;                   // Game is ongoing
+    int move_count;                     // Completed moves (both players)
 } Game;
 
 /**
  * Room structure.
  * Represents a game room that can hold up to 2 players.
+ * Metadata read by lookups and the pause sweep comes first; the board,
+ * touched only by moves, comes last.
  */
 typedef struct {
     char name[MAX_ROOM_NAME];           // Room name
-    char owner[MAX_ROOM_NAME];          // Room creator
-    char player1[MAX_PLAYER_NAME];      // First player
-    char player2[MAX_PLAYER_NAME];      // Second player
+    PlayerId owner;                     // Room creator, PLAYER_NONE if the slot is free
+    PlayerId player1;                   // First player
+    PlayerId player2;                   // Second player
     int players_count;                  // Current player count (0-2)
-    Game game;                          // Game state
     bool game_started;                  // Game has begun
 
     // Disconnect handling
     RoomState state;                    // Current room state
+    bool state_tallied;                 // state is counted in server_stats.rooms_by_state
     time_t pause_start_time;           // When game was paused
-    char disconnected_player[MAX_PLAYER_NAME]; // Who disconnected
+    PlayerId disconnected_player;      // Who disconnected (player1 or player2)
     bool waiting_for_reconnect;        // Waiting for player return
     pthread_mutex_t room_mutex;        // Thread-safe room access
+
+    Game game;                          // Game state
 } Room;
 
 // ========== GAME FUNCTIONS ==========
@@ -82,7 +88,7 @@ typedef struct {
 /**
  * Initializes new game with starting board.
  */
-void init_game(Game *game, const char *player1, const char *player2);
+void init_game(Game *game, PlayerId player1, PlayerId player2);
 
 /**
  * Resets game to initial state.
@@ -97,7 +103,7 @@ char* game_board_to_json(const Game *game);
 /**
  * Validates move according to checkers rules.
  */
-bool validate_move(const Game *game, int from_row, int from_col, int to_row, int to_col, const char *player);
+bool validate_move(const Game *game, int from_row, int from_col, int to_row, int to_col, PlayerId player);
 
 /**
  * Applies validated move to board.
@@ -109,10 +115,15 @@ void apply_move(Game *game, int from_row, int from_col, int to_row, int to_col);
  */
 void change_turn(Game *game);
 
+/**
+ * Gets the player whose turn it is.
+ */
+PlayerId game_turn_player(const Game *game);
+
 /**
  * Checks if game is over (no pieces remaining).
  */
-bool check_game_over(const Game *game, char *winner);
+bool check_game_over(const Game *game, PlayerId *winner);
 
 /**
  * Rotates board 180 degrees (for perspective conversion).
@@ -124,4 +135,9 @@ void rotate_board(const Game *game, int rotated[BOARD_SIZE][BOARD_SIZE]);
  */
 void print_board(const Game *game);
 
+/**
+ * Enables or disables move validation tracing.
+ */
+void game_set_logging(bool enabled);
+
 #endif //SERVER_GAME_H
\ No newline at end of file
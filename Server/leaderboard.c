@@ -0,0 +1,277 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "leaderboard.h"
+
+/**
+ * Forward link of a skip list node: the next node on this level and
+ * the number of ranks it skips, which makes rank lookups O(log n).
+ */
+typedef struct {
+    struct LeaderboardNode *next;
+    uint32_t span;
+} LeaderboardLink;
+
+/**
+ * Skip list node, with as many links as its level.
+ */
+typedef struct LeaderboardNode {
+    uint32_t id;
+    int rating;
+    int level;
+    LeaderboardLink links[];
+} LeaderboardNode;
+
+static LeaderboardNode *head;            // Sorts before every player, allocated on first use
+static int level = 1;                    // Levels in use
+static int length;                       // Players on the leaderboard
+static LeaderboardNode **nodes;          // By ID, NULL if not on the leaderboard
+static uint32_t node_capacity;
+static uint32_t random_state = 2463534242u;
+
+/**
+ * Draws a level for a new node, each one a quarter as likely as the
+ * one below (xorshift32).
+ *
+ * @return Level, 1..LEADERBOARD_MAX_LEVEL
+ */
+static int random_level(void) {
+    int node_level = 1;
+    for (;;) {
+        random_state ^= random_state << 13;
+        random_state ^= random_state >> 17;
+        random_state ^= random_state << 5;
+        if ((random_state & 3) != 0 || node_level == LEADERBOARD_MAX_LEVEL) {
+            return node_level;
+        }
+        node_level++;
+    }
+}
+
+/**
+ * Checks the leaderboard order of two nodes.
+ *
+ * @param a Node
+ * @param b Node
+ * @return true if a ranks above b
+ */
+static bool ranks_above(const LeaderboardNode *a, const LeaderboardNode *b) {
+    if (a->rating != b->rating) {
+        return a->rating > b->rating;
+    }
+    return a->id < b->id;
+}
+
+/**
+ * Links a node in at its sorted position.
+ *
+ * @param node Node not on the leaderboard
+ */
+static void skiplist_insert(LeaderboardNode *node) {
+    LeaderboardNode *update[LEADERBOARD_MAX_LEVEL];
+    uint32_t rank[LEADERBOARD_MAX_LEVEL];
+    LeaderboardNode *x = head;
+
+    // Rightmost node before the new one on each level, and its rank
+    for (int i = level - 1; i >= 0; i--) {
+        rank[i] = i == level - 1 ? 0 : rank[i + 1];
+        while (x->links[i].next && ranks_above(x->links[i].next, node)) {
+            rank[i] += x->links[i].span;
+            x = x->links[i].next;
+        }
+        update[i] = x;
+    }
+
+    if (node->level > level) {
+        for (int i = level; i < node->level; i++) {
+            rank[i] = 0;
+            update[i] = head;
+            head->links[i].span = (uint32_t)length;
+        }
+        level = node->level;
+    }
+
+    for (int i = 0; i < node->level; i++) {
+        node->links[i].next = update[i]->links[i].next;
+        update[i]->links[i].next = node;
+        node->links[i].span = update[i]->links[i].span - (rank[0] - rank[i]);
+        update[i]->links[i].span = rank[0] - rank[i] + 1;
+    }
+    for (int i = node->level; i < level; i++) {
+        update[i]->links[i].span++;
+    }
+    length++;
+}
+
+/**
+ * Unlinks a node.
+ *
+ * @param node Node on the leaderboard
+ */
+static void skiplist_remove(LeaderboardNode *node) {
+    LeaderboardNode *update[LEADERBOARD_MAX_LEVEL];
+    LeaderboardNode *x = head;
+
+    for (int i = level - 1; i >= 0; i--) {
+        while (x->links[i].next && ranks_above(x->links[i].next, node)) {
+            x = x->links[i].next;
+        }
+        update[i] = x;
+    }
+
+    for (int i = 0; i < level; i++) {
+        if (update[i]->links[i].next == node) {
+            update[i]->links[i].span += node->links[i].span - 1;
+            update[i]->links[i].next = node->links[i].next;
+        } else {
+            update[i]->links[i].span--;
+        }
+    }
+    while (level > 1 && !head->links[level - 1].next) {
+        level--;
+    }
+    length--;
+}
+
+/**
+ * Adds a player or moves them to a new rating.
+ *
+ * @param id Player's ID
+ * @param rating Player's rating
+ * @return 0 on success, -1 if out of memory
+ */
+int leaderboard_set(uint32_t id, int rating) {
+    if (id >= node_capacity) {
+        uint32_t capacity = node_capacity ? node_capacity : 1024;
+        while (capacity <= id) {
+            capacity *= 2;
+        }
+        LeaderboardNode **grown = realloc(nodes, capacity * sizeof(LeaderboardNode*));
+        if (!grown) {
+            return -1;
+        }
+        memset(grown + node_capacity, 0, (capacity - node_capacity) * sizeof(LeaderboardNode*));
+        nodes = grown;
+        node_capacity = capacity;
+    }
+
+    if (!head) {
+        head = calloc(1, sizeof(LeaderboardNode) + LEADERBOARD_MAX_LEVEL * sizeof(LeaderboardLink));
+        if (!head) {
+            return -1;
+        }
+        head->level = LEADERBOARD_MAX_LEVEL;
+    }
+
+    LeaderboardNode *node = nodes[id];
+    if (node) {
+        if (node->rating == rating) {
+            return 0;
+        }
+        // Keeps its level; only its position changes
+        skiplist_remove(node);
+    } else {
+        int node_level = random_level();
+        node = malloc(sizeof(LeaderboardNode) + (size_t)node_level * sizeof(LeaderboardLink));
+        if (!node) {
+            return -1;
+        }
+        node->id = id;
+        node->level = node_level;
+        nodes[id] = node;
+    }
+
+    node->rating = rating;
+    skiplist_insert(node);
+    return 0;
+}
+
+/**
+ * Removes every player.
+ */
+void leaderboard_clear(void) {
+    LeaderboardNode *x = head;
+    while (x) {
+        LeaderboardNode *next = x->links[0].next;
+        free(x);
+        x = next;
+    }
+    free(nodes);
+    nodes = NULL;
+    node_capacity = 0;
+    head = NULL;
+    level = 1;
+    length = 0;
+}
+
+/**
+ * Gets the rank of a player by summing the spans along the search path.
+ *
+ * @param id Player's ID
+ * @return Rank (1 for the highest rating), 0 if not on the leaderboard
+ */
+int leaderboard_rank(uint32_t id) {
+    if (id >= node_capacity || !nodes[id]) {
+        return 0;
+    }
+
+    const LeaderboardNode *node = nodes[id];
+    const LeaderboardNode *x = head;
+    uint32_t rank = 0;
+    for (int i = level - 1; i >= 0; i--) {
+        while (x->links[i].next &&
+               (x->links[i].next == node || ranks_above(x->links[i].next, node))) {
+            rank += x->links[i].span;
+            x = x->links[i].next;
+        }
+        if (x == node) {
+            return (int)rank;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Copies the players from a rank on: one O(log n) descent to the first
+ * rank, then a walk along the bottom level.
+ *
+ * @param first_rank Rank of the first entry, from 1
+ * @param entries Destination
+ * @param max_entries Capacity of entries
+ * @return Entries written, 0 past the last rank
+ */
+int leaderboard_page(int first_rank, LeaderboardEntry *entries, int max_entries) {
+    if (first_rank < 1 || first_rank > length) {
+        return 0;
+    }
+
+    const LeaderboardNode *x = head;
+    uint32_t traversed = 0;
+    for (int i = level - 1; i >= 0; i--) {
+        while (x->links[i].next && traversed + x->links[i].span <= (uint32_t)first_rank) {
+            traversed += x->links[i].span;
+            x = x->links[i].next;
+        }
+        if (traversed == (uint32_t)first_rank) {
+            break;
+        }
+    }
+
+    int count = 0;
+    while (x && count < max_entries) {
+        entries[count].id = x->id;
+        entries[count].rating = x->rating;
+        count++;
+        x = x->links[0].next;
+    }
+    return count;
+}
+
+/**
+ * Gets the number of players on the leaderboard.
+ *
+ * @return Players
+ */
+int leaderboard_size(void) {
+    return length;
+}
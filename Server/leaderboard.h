@@ -0,0 +1,49 @@
+#ifndef SERVER_LEADERBOARD_H
+#define SERVER_LEADERBOARD_H
+
+#include <stdint.h>
+
+#define LEADERBOARD_MAX_LEVEL 16         // Skip list levels, enough for 4^16 entries
+
+/**
+ * Leaderboard position of a rated player.
+ */
+typedef struct {
+    uint32_t id;                         // Caller's ID of the player (ratings record)
+    int rating;
+} LeaderboardEntry;
+
+/*
+ * Players ordered by rating, highest first, ties by lower ID. Not
+ * thread-safe: the ratings store serializes access under its mutex.
+ */
+
+/**
+ * Adds a player or moves them to a new rating.
+ * @return 0 on success, -1 if out of memory
+ */
+int leaderboard_set(uint32_t id, int rating);
+
+/**
+ * Removes every player.
+ */
+void leaderboard_clear(void);
+
+/**
+ * Gets the rank of a player, 1 for the highest rating.
+ * @return Rank, 0 if the player is not on the leaderboard
+ */
+int leaderboard_rank(uint32_t id);
+
+/**
+ * Copies the players from a rank on, in rank order.
+ * @return Entries written
+ */
+int leaderboard_page(int first_rank, LeaderboardEntry *entries, int max_entries);
+
+/**
+ * Gets the number of players on the leaderboard.
+ */
+int leaderboard_size(void);
+
+#endif //SERVER_LEADERBOARD_H
@@ -5,8 +5,17 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <signal.h>
+#include <string.h>
 #include <unistd.h>
 #include "server.h"
+#include "tablebase.h"
+#include "metrics.h"
+#include "admin.h"
+#include "metrics_http.h"
+#include "recorder.h"
+#include "uring.h"
+#include "ratings.h"
+#include "search.h"
 
 static Server server;
 
@@ -22,15 +31,40 @@ void signal_handler(int signum) {
     exit(0);
 }
 
+/**
+ * Signal handler for metrics reports.
+ * Only sets a flag; the heartbeat thread prints the report.
+ *
+ * @param signum Signal number received
+ */
+void metrics_signal_handler(int signum) {
+    (void)signum;
+    metrics_request_report();
+}
+
 /**
  * Prints usage information for the server program.
  *
  * @param program_name Name of the executable
  */
 void print_usage(const char *program_name) {
-    printf("Usage: %s [port] [bind_address]\n", program_name);
+    printf("Usage: %s [options] [port] [bind_address]\n", program_name);
     printf("  port         - Port number (default: 12345)\n");
     printf("  bind_address - IP address to bind to (default: 0.0.0.0 - all interfaces)\n");
+    printf("\nOptions:\n");
+    printf("  --tablebase FILE  Endgame tablebase to map (default: %s if present)\n",
+           TB_DEFAULT_PATH);
+    printf("  --unix PATH          Also accept clients on a Unix-domain socket\n");
+    printf("  --backend NAME       blocking (default) or io_uring; falls back if unsupported\n");
+    printf("  --admin-socket PATH  Unix socket answering OP_ADMIN_STATS (see tools/adminctl)\n");
+    printf("  --metrics-port PORT  Serve Prometheus metrics on http://ADDR:PORT/metrics\n");
+    printf("  --metrics-bind ADDR  Address for the metrics listener (default: %s)\n",
+           METRICS_HTTP_DEFAULT_BIND);
+    printf("  --record FILE        Capture all client traffic for tools/replay\n");
+    printf("  --ratings FILE       Keep player ratings in FILE across restarts (default: memory only)\n");
+    printf("  --serialize          Handle one client frame at a time (replay target)\n");
+    printf("  --opcodes            Print the protocol opcode reference and exit\n");
+    printf("\nSend SIGUSR1 to print latency and traffic metrics.\n");
     printf("\nExamples:\n");
     printf("  %s 8080                  # Port 8080, all interfaces\n", program_name);
     printf("  %s 8080 127.0.0.1        # Port 8080, localhost only\n", program_name);
@@ -48,37 +82,121 @@ void print_usage(const char *program_name) {
 int main(int argc, char *argv[]) {
     int port = 12345; // Default port
     const char *bind_address = NULL; // NULL means INADDR_ANY (0.0.0.0)
+    const char *tablebase_path = NULL;
+    const char *admin_socket_path = NULL;
+    const char *unix_path = NULL;
+    const char *backend = "blocking";
+    const char *metrics_bind = NULL;
+    int metrics_port = 0;
+    const char *record_path = NULL;
+    const char *ratings_path = NULL;
+    const char *positional[2];
+    int positional_count = 0;
 
-    if (argc > 1) {
-        if (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0) {
+    // Options may appear anywhere; remaining arguments are positional
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
             print_usage(argv[0]);
             return 0;
+        } else if (strcmp(argv[i], "--opcodes") == 0) {
+            protocol_print_opcodes(stdout);
+            return 0;
+        } else if (strcmp(argv[i], "--tablebase") == 0 && i + 1 < argc) {
+            tablebase_path = argv[++i];
+        } else if (strcmp(argv[i], "--unix") == 0 && i + 1 < argc) {
+            unix_path = argv[++i];
+        } else if (strcmp(argv[i], "--backend") == 0 && i + 1 < argc) {
+            backend = argv[++i];
+        } else if (strcmp(argv[i], "--admin-socket") == 0 && i + 1 < argc) {
+            admin_socket_path = argv[++i];
+        } else if (strcmp(argv[i], "--metrics-port") == 0 && i + 1 < argc) {
+            metrics_port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--metrics-bind") == 0 && i + 1 < argc) {
+            metrics_bind = argv[++i];
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            record_path = argv[++i];
+        } else if (strcmp(argv[i], "--ratings") == 0 && i + 1 < argc) {
+            ratings_path = argv[++i];
+        } else if (strcmp(argv[i], "--serialize") == 0) {
+            recorder_serialize();
+        } else if (argv[i][0] == '-' && argv[i][1] == '-') {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            print_usage(argv[0]);
+            return 1;
+        } else if (positional_count < 2) {
+            positional[positional_count++] = argv[i];
         }
+    }
 
-        port = atoi(argv[1]);
+    if (positional_count > 0) {
+        port = atoi(positional[0]);
         if (port <= 0 || port > 65535) {
             fprintf(stderr, "Invalid port number. Using default: 12345\n");
             port = 12345;
         }
     }
 
-
-    if (argc > 2) {
-        bind_address = argv[2];
+    if (positional_count > 1) {
+        bind_address = positional[1];
     }
 
     // Setup signal handlers
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
+    signal(SIGUSR1, metrics_signal_handler);
 
     printf("=== Checkers Server ===\n");
     printf("Initializing server on port %d...\n", port);
 
+    // Endgame tables are optional; the default file is used only if present
+    if (tablebase_path) {
+        if (tb_init(tablebase_path) < 0) {
+            fprintf(stderr, "Continuing without tablebase\n");
+        }
+    } else if (access(TB_DEFAULT_PATH, R_OK) == 0) {
+        tb_init(TB_DEFAULT_PATH);
+    }
+
+    // Adjudication searches share one table, so it exists before any client can search
+    if (tt_init(SEARCH_DEFAULT_TT_MB) < 0) {
+        fprintf(stderr, "Continuing; the first search will retry the transposition table\n");
+    }
+
+    if (ratings_path && ratings_open(ratings_path) < 0) {
+        fprintf(stderr, "Continuing with ratings kept in memory\n");
+    }
+
     if (server_init(&server, port, bind_address) < 0) {
         fprintf(stderr, "Failed to initialize server\n");
         return 1;
     }
 
+    if (unix_path && server_listen_unix(&server, unix_path) < 0) {
+        fprintf(stderr, "Continuing without Unix-domain listener\n");
+    }
+
+    if (strcmp(backend, "io_uring") == 0) {
+        if (uring_supported()) {
+            server.backend = SERVER_BACKEND_URING;
+        } else {
+            fprintf(stderr, "io_uring backend unsupported by this kernel, using blocking\n");
+        }
+    } else if (strcmp(backend, "blocking") != 0) {
+        fprintf(stderr, "Unknown backend '%s', using blocking\n", backend);
+    }
+
+    if (admin_socket_path && admin_start(&server, admin_socket_path) < 0) {
+        fprintf(stderr, "Continuing without admin listener\n");
+    }
+
+    if (metrics_port > 0 && metrics_http_start(&server, metrics_bind, metrics_port) < 0) {
+        fprintf(stderr, "Continuing without metrics endpoint\n");
+    }
+
+    if (record_path && recorder_open(record_path) < 0) {
+        fprintf(stderr, "Continuing without traffic capture\n");
+    }
+
     printf("Server ready!\n");
     printf("Press Ctrl+C to stop the server\n\n");
 
@@ -0,0 +1,367 @@
+#include <pthread.h>
+#include <stdint.h>
+#include "matchmaking.h"
+
+/**
+ * Queued player, a node of the rating treap.
+ */
+typedef struct {
+    int rating;
+    uint32_t seq;                        // Enqueue order; orders equal ratings oldest first
+    time_t since;                        // Enqueue time, widens the band
+    uint32_t priority;                   // Heap order of the treap, 0 for PLAYER_NONE
+    PlayerId left;
+    PlayerId right;
+    bool queued;
+} QueueEntry;
+
+// Indexed by player ID, so a player is found without searching; entry 0 stays empty
+static QueueEntry entries[SYMTAB_CAPACITY];
+static PlayerId order[SYMTAB_CAPACITY];  // Sweep scratch, queued players by rating
+static PlayerId root;
+static int queued_count;
+static uint32_t next_seq;
+static uint32_t random_state = 2463534242u;
+static pthread_mutex_t matchmaking_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Draws a treap priority (xorshift32). Caller holds matchmaking_mutex.
+ *
+ * @return Priority, never 0
+ */
+static uint32_t next_priority(void) {
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state | 1u;
+}
+
+/**
+ * Compares the keys (rating, seq) of two queued players.
+ *
+ * @param a Player
+ * @param b Player
+ * @return true if a sorts before b
+ */
+static bool entry_before(PlayerId a, PlayerId b) {
+    if (entries[a].rating != entries[b].rating) {
+        return entries[a].rating < entries[b].rating;
+    }
+    return entries[a].seq < entries[b].seq;
+}
+
+/**
+ * Gets the rating difference a queued player accepts after waiting.
+ *
+ * @param player Queued player
+ * @param now Current time
+ * @return Band half-width
+ */
+static int match_band(PlayerId player, time_t now) {
+    time_t waited = now > entries[player].since ? now - entries[player].since : 0;
+    if (waited >= (MATCH_BAND_MAX - MATCH_BAND_BASE) / MATCH_BAND_WIDEN_PER_SEC) {
+        return MATCH_BAND_MAX;
+    }
+    return MATCH_BAND_BASE + (int)waited * MATCH_BAND_WIDEN_PER_SEC;
+}
+
+/**
+ * Checks whether two players may be matched: the rating gap must lie
+ * within the band of either, so a long wait opens up the whole queue.
+ *
+ * @param a Player
+ * @param b Player
+ * @param now Current time
+ * @return Rating gap, -1 if too wide
+ */
+static int match_gap(PlayerId a, PlayerId b, time_t now) {
+    int gap = entries[a].rating - entries[b].rating;
+    if (gap < 0) {
+        gap = -gap;
+    }
+    int band_a = match_band(a, now);
+    int band_b = match_band(b, now);
+    return gap <= (band_a > band_b ? band_a : band_b) ? gap : -1;
+}
+
+static PlayerId rotate_right(PlayerId node) {
+    PlayerId top = entries[node].left;
+    entries[node].left = entries[top].right;
+    entries[top].right = node;
+    return top;
+}
+
+static PlayerId rotate_left(PlayerId node) {
+    PlayerId top = entries[node].right;
+    entries[node].right = entries[top].left;
+    entries[top].left = node;
+    return top;
+}
+
+/**
+ * Inserts a player into a subtree.
+ *
+ * @param node Subtree root
+ * @param player Player to insert
+ * @return New subtree root
+ */
+static PlayerId treap_insert(PlayerId node, PlayerId player) {
+    if (node == PLAYER_NONE) {
+        return player;
+    }
+    if (entry_before(player, node)) {
+        entries[node].left = treap_insert(entries[node].left, player);
+        if (entries[entries[node].left].priority > entries[node].priority) {
+            node = rotate_right(node);
+        }
+    } else {
+        entries[node].right = treap_insert(entries[node].right, player);
+        if (entries[entries[node].right].priority > entries[node].priority) {
+            node = rotate_left(node);
+        }
+    }
+    return node;
+}
+
+/**
+ * Joins two subtrees, every key of the first sorting before the second.
+ *
+ * @return Root of the joined subtree
+ */
+static PlayerId treap_merge(PlayerId low, PlayerId high) {
+    if (low == PLAYER_NONE) {
+        return high;
+    }
+    if (high == PLAYER_NONE) {
+        return low;
+    }
+    if (entries[low].priority > entries[high].priority) {
+        entries[low].right = treap_merge(entries[low].right, high);
+        return low;
+    }
+    entries[high].left = treap_merge(low, entries[high].left);
+    return high;
+}
+
+/**
+ * Removes a queued player from a subtree.
+ *
+ * @param node Subtree root
+ * @param player Player in the subtree
+ * @return New subtree root
+ */
+static PlayerId treap_remove(PlayerId node, PlayerId player) {
+    if (node == player) {
+        return treap_merge(entries[node].left, entries[node].right);
+    }
+    if (entry_before(player, node)) {
+        entries[node].left = treap_remove(entries[node].left, player);
+    } else {
+        entries[node].right = treap_remove(entries[node].right, player);
+    }
+    return node;
+}
+
+/**
+ * Finds the queued player sorting right before or after a key.
+ *
+ * @param player Player holding the key, not in the tree
+ * @param after Whether to find the next player rather than the previous one
+ * @return Neighbour, PLAYER_NONE if none
+ */
+static PlayerId treap_neighbor(PlayerId player, bool after) {
+    PlayerId found = PLAYER_NONE;
+    PlayerId node = root;
+    while (node != PLAYER_NONE) {
+        if (entry_before(player, node)) {
+            if (after) {
+                found = node;
+            }
+            node = entries[node].left;
+        } else {
+            if (!after) {
+                found = node;
+            }
+            node = entries[node].right;
+        }
+    }
+    return found;
+}
+
+/**
+ * Lists a subtree in key order.
+ *
+ * @param node Subtree root
+ * @param count Entries of order filled so far
+ */
+static void treap_collect(PlayerId node, int *count) {
+    while (node != PLAYER_NONE) {
+        treap_collect(entries[node].left, count);
+        order[(*count)++] = node;
+        node = entries[node].right;
+    }
+}
+
+/**
+ * Takes a player out of the tree. Caller holds matchmaking_mutex.
+ *
+ * @param player Queued player
+ */
+static void dequeue(PlayerId player) {
+    root = treap_remove(root, player);
+    entries[player].left = PLAYER_NONE;
+    entries[player].right = PLAYER_NONE;
+    entries[player].queued = false;
+    queued_count--;
+}
+
+/**
+ * Builds a pair, the player who waited longer first.
+ */
+static MatchPair make_pair(PlayerId a, PlayerId b) {
+    MatchPair pair;
+    bool a_first = entries[a].seq < entries[b].seq;
+    pair.first = a_first ? a : b;
+    pair.second = a_first ? b : a;
+    return pair;
+}
+
+/**
+ * Puts a player in the matchmaking queue, or matches them right away.
+ *
+ * Only the two players next to the new one in rating order can be the
+ * closest, so finding an opponent is two O(log n) descents of the treap.
+ * The queue keeps a reference to each queued player's name, which is
+ * handed over with a pair.
+ *
+ * @param player Player to queue
+ * @param rating Player's rating
+ * @param now Current time
+ * @param pair Filled when matched
+ * @return 1 if matched, 0 if queued, -1 if already queued or PLAYER_NONE
+ */
+int matchmaking_enqueue(PlayerId player, int rating, time_t now, MatchPair *pair) {
+    if (player == PLAYER_NONE) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&matchmaking_mutex);
+    if (entries[player].queued) {
+        pthread_mutex_unlock(&matchmaking_mutex);
+        return -1;
+    }
+
+    QueueEntry *entry = &entries[player];
+    entry->rating = rating;
+    entry->seq = next_seq++;
+    entry->since = now;
+    entry->priority = next_priority();
+    entry->left = PLAYER_NONE;
+    entry->right = PLAYER_NONE;
+    symtab_retain(player);
+
+    PlayerId below = treap_neighbor(player, false);
+    PlayerId above = treap_neighbor(player, true);
+    int gap_below = below != PLAYER_NONE ? match_gap(player, below, now) : -1;
+    int gap_above = above != PLAYER_NONE ? match_gap(player, above, now) : -1;
+
+    PlayerId opponent = PLAYER_NONE;
+    if (gap_below >= 0 && (gap_above < 0 || gap_below < gap_above ||
+                           (gap_below == gap_above && entries[below].seq < entries[above].seq))) {
+        opponent = below;
+    } else if (gap_above >= 0) {
+        opponent = above;
+    }
+
+    if (opponent != PLAYER_NONE) {
+        dequeue(opponent);
+        *pair = make_pair(player, opponent);
+        pthread_mutex_unlock(&matchmaking_mutex);
+        return 1;
+    }
+
+    entry->queued = true;
+    root = treap_insert(root, player);
+    queued_count++;
+    pthread_mutex_unlock(&matchmaking_mutex);
+    return 0;
+}
+
+/**
+ * Takes a player out of the queue and drops the queue's reference.
+ *
+ * @param player Player, PLAYER_NONE is ignored
+ * @return true if the player was queued
+ */
+bool matchmaking_remove(PlayerId player) {
+    pthread_mutex_lock(&matchmaking_mutex);
+    if (player == PLAYER_NONE || !entries[player].queued) {
+        pthread_mutex_unlock(&matchmaking_mutex);
+        return false;
+    }
+    dequeue(player);
+    pthread_mutex_unlock(&matchmaking_mutex);
+
+    symtab_release(player);
+    return true;
+}
+
+/**
+ * Matches queued players whose bands have widened enough.
+ *
+ * Walks the queue in rating order and matches neighbours whose gap is
+ * within a band, preferring the closer of two candidates, so every
+ * player is compared with the closest ratings still unmatched on either
+ * side. Run periodically; O(n) per sweep.
+ *
+ * @param now Current time
+ * @param pairs Destination for matched pairs
+ * @param max_pairs Capacity of pairs
+ * @return Pairs written
+ */
+int matchmaking_sweep(time_t now, MatchPair *pairs, int max_pairs) {
+    int pair_count = 0;
+    int count = 0;
+
+    pthread_mutex_lock(&matchmaking_mutex);
+    treap_collect(root, &count);
+
+    // Player left unmatched below order[i]; pairs taken in between make them neighbours
+    PlayerId waiting = PLAYER_NONE;
+    for (int i = 0; i < count && pair_count < max_pairs; i++) {
+        PlayerId player = order[i];
+        int gap = waiting != PLAYER_NONE ? match_gap(waiting, player, now) : -1;
+        if (gap < 0) {
+            waiting = player;
+            continue;
+        }
+        // A closer player right above takes this one instead
+        int next_gap = i + 1 < count ? match_gap(player, order[i + 1], now) : -1;
+        if (next_gap >= 0 && next_gap < gap) {
+            dequeue(player);
+            dequeue(order[i + 1]);
+            pairs[pair_count++] = make_pair(player, order[i + 1]);
+            i++;
+            continue;
+        }
+        dequeue(waiting);
+        dequeue(player);
+        pairs[pair_count++] = make_pair(waiting, player);
+        waiting = PLAYER_NONE;
+    }
+
+    pthread_mutex_unlock(&matchmaking_mutex);
+    return pair_count;
+}
+
+/**
+ * Gets the number of queued players.
+ *
+ * @return Queued players
+ */
+int matchmaking_size(void) {
+    pthread_mutex_lock(&matchmaking_mutex);
+    int count = queued_count;
+    pthread_mutex_unlock(&matchmaking_mutex);
+    return count;
+}
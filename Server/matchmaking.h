@@ -0,0 +1,47 @@
+#ifndef SERVER_MATCHMAKING_H
+#define SERVER_MATCHMAKING_H
+
+#include <stdbool.h>
+#include <time.h>
+#include "symtab.h"
+
+#define MATCH_BAND_BASE 100              // Rating difference accepted on entering the queue
+#define MATCH_BAND_WIDEN_PER_SEC 10      // Added to a player's band per second waited
+#define MATCH_BAND_MAX 1000              // Widest band
+
+/**
+ * Two queued players matched with each other. Both IDs carry a
+ * reference the receiver releases once the game is set up.
+ */
+typedef struct {
+    PlayerId first;                      // Waited longer
+    PlayerId second;
+} MatchPair;
+
+/**
+ * Puts a player in the matchmaking queue, or matches them right away
+ * with the closest-rated queued player whose band allows it.
+ * @param pair Filled when matched
+ * @return 1 if matched, 0 if queued, -1 if already queued or PLAYER_NONE
+ */
+int matchmaking_enqueue(PlayerId player, int rating, time_t now, MatchPair *pair);
+
+/**
+ * Takes a player out of the queue.
+ * @return true if the player was queued
+ */
+bool matchmaking_remove(PlayerId player);
+
+/**
+ * Matches queued players whose bands have widened enough since they
+ * were queued, closest ratings first.
+ * @return Pairs written to pairs
+ */
+int matchmaking_sweep(time_t now, MatchPair *pairs, int max_pairs);
+
+/**
+ * Gets the number of queued players.
+ */
+int matchmaking_size(void);
+
+#endif //SERVER_MATCHMAKING_H
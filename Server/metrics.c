@@ -0,0 +1,491 @@
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "metrics.h"
+#include "protocol.h"
+
+/**
+ * Per-thread histogram. Only the owning thread writes it; readers
+ * load the fields with relaxed atomics and may see a frame half-counted.
+ */
+typedef struct {
+    uint32_t count;
+    uint32_t max_ns;
+    uint64_t sum_ns;
+    uint32_t buckets[METRICS_BUCKETS];
+} ShardHistogram;
+
+/**
+ * Counters of one thread, linked into the live shard list.
+ * A thread sees few opcodes, so each histogram is allocated on its
+ * first sample and the shard itself stays small.
+ */
+typedef struct MetricsShard {
+    uint64_t bytes_in;
+    uint64_t bytes_out;
+    uint64_t frames_in;
+    uint64_t frames_out;
+    uint64_t parse_errors;
+    ShardHistogram *hist[METRICS_PHASE_COUNT][METRICS_OP_SLOTS]; // NULL until recorded
+    struct MetricsShard *prev;
+    struct MetricsShard *next;
+} MetricsShard;
+
+static __thread MetricsShard *local_shard = NULL;
+
+static pthread_once_t key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t shard_key;
+
+// Registry lock: taken on thread start/exit and by snapshots, never per frame
+static pthread_mutex_t registry_mutex = PTHREAD_MUTEX_INITIALIZER;
+static MetricsShard *live_shards = NULL;
+static MetricsSnapshot retired;          // Totals of threads that have exited
+static uint64_t first_shard_ns = 0;      // Baseline for the first report's rates
+
+static pthread_mutex_t report_mutex = PTHREAD_MUTEX_INITIALIZER;
+static MetricsSnapshot *last_report = NULL;
+static volatile sig_atomic_t report_requested = 0;
+
+static const char *phase_names[METRICS_PHASE_COUNT] = {"parse", "handler", "send"};
+
+// ========== SHARD HELPERS ==========
+
+static inline void add64(uint64_t *field, uint64_t value) {
+    __atomic_store_n(field, __atomic_load_n(field, __ATOMIC_RELAXED) + value, __ATOMIC_RELAXED);
+}
+
+static inline void add32(uint32_t *field, uint32_t value) {
+    __atomic_store_n(field, __atomic_load_n(field, __ATOMIC_RELAXED) + value, __ATOMIC_RELAXED);
+}
+
+static inline uint64_t load64(const uint64_t *field) {
+    return __atomic_load_n(field, __ATOMIC_RELAXED);
+}
+
+static inline uint32_t load32(const uint32_t *field) {
+    return __atomic_load_n(field, __ATOMIC_RELAXED);
+}
+
+/**
+ * Maps a duration to its log-linear bucket.
+ * Values below 2^METRICS_SUB_BITS get one bucket each; every following
+ * power of two is split into 2^METRICS_SUB_BITS equal buckets.
+ *
+ * @param ns Duration in nanoseconds, already clamped below 2^METRICS_MAX_BITS
+ * @return Bucket index
+ */
+static inline int bucket_index(uint32_t ns) {
+    const uint32_t sub = 1u << METRICS_SUB_BITS;
+    if (ns < sub) {
+        return (int)ns;
+    }
+    int msb = 31 - __builtin_clz(ns);
+    int shift = msb - METRICS_SUB_BITS;
+    return (int)(((uint32_t)(shift + 1) << METRICS_SUB_BITS) + ((ns >> shift) & (sub - 1)));
+}
+
+/**
+ * Returns the largest value that falls into a bucket.
+ */
+static uint64_t bucket_upper(int index) {
+    const int sub = 1 << METRICS_SUB_BITS;
+    if (index < sub) {
+        return (uint64_t)index;
+    }
+    int shift = index / sub - 1;
+    uint64_t lower = (uint64_t)(sub + index % sub) << shift;
+    return lower + ((uint64_t)1 << shift) - 1;
+}
+
+static void fold_shard(MetricsSnapshot *out, const MetricsShard *shard) {
+    out->bytes_in += load64(&shard->bytes_in);
+    out->bytes_out += load64(&shard->bytes_out);
+    out->frames_in += load64(&shard->frames_in);
+    out->frames_out += load64(&shard->frames_out);
+    out->parse_errors += load64(&shard->parse_errors);
+
+    for (int p = 0; p < METRICS_PHASE_COUNT; p++) {
+        for (int s = 0; s < METRICS_OP_SLOTS; s++) {
+            const ShardHistogram *src = __atomic_load_n(&shard->hist[p][s], __ATOMIC_ACQUIRE);
+            uint32_t count = src ? load32(&src->count) : 0;
+            if (count == 0) {
+                continue;
+            }
+
+            MetricsHistogram *dst = &out->hist[p][s];
+            dst->count += count;
+            dst->sum_ns += load64(&src->sum_ns);
+            uint32_t max = load32(&src->max_ns);
+            if (max > dst->max_ns) {
+                dst->max_ns = max;
+            }
+            for (int b = 0; b < METRICS_BUCKETS; b++) {
+                dst->buckets[b] += load32(&src->buckets[b]);
+            }
+        }
+    }
+}
+
+/**
+ * Thread exit destructor: moves the shard totals into the retired
+ * snapshot so counts survive short-lived client threads.
+ */
+static void release_shard(void *arg) {
+    MetricsShard *shard = (MetricsShard*)arg;
+
+    pthread_mutex_lock(&registry_mutex);
+    fold_shard(&retired, shard);
+    if (shard->prev) {
+        shard->prev->next = shard->next;
+    } else {
+        live_shards = shard->next;
+    }
+    if (shard->next) {
+        shard->next->prev = shard->prev;
+    }
+    pthread_mutex_unlock(&registry_mutex);
+
+    for (int p = 0; p < METRICS_PHASE_COUNT; p++) {
+        for (int s = 0; s < METRICS_OP_SLOTS; s++) {
+            free(shard->hist[p][s]);
+        }
+    }
+    free(shard);
+}
+
+static void create_key(void) {
+    pthread_key_create(&shard_key, release_shard);
+}
+
+/**
+ * Returns the calling thread's shard, registering it on first use.
+ *
+ * @return Shard pointer, or NULL if allocation failed
+ */
+static MetricsShard* get_shard(void) {
+    if (local_shard) {
+        return local_shard;
+    }
+
+    pthread_once(&key_once, create_key);
+
+    MetricsShard *shard = calloc(1, sizeof(MetricsShard));
+    if (!shard) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&registry_mutex);
+    if (first_shard_ns == 0) {
+        first_shard_ns = metrics_now_ns();
+    }
+    shard->next = live_shards;
+    if (live_shards) {
+        live_shards->prev = shard;
+    }
+    live_shards = shard;
+    pthread_mutex_unlock(&registry_mutex);
+
+    pthread_setspecific(shard_key, shard);
+    local_shard = shard;
+    return shard;
+}
+
+// ========== RECORDING ==========
+
+/**
+ * Returns monotonic time in nanoseconds.
+ *
+ * @return Current CLOCK_MONOTONIC time
+ */
+uint64_t metrics_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * Maps an opcode to its histogram slot, the opcode's dense index.
+ * Unknown opcodes share slot 0.
+ *
+ * @param op Operation code
+ * @return Slot index
+ */
+int metrics_op_slot(int op) {
+    return opcode_index(op);
+}
+
+/**
+ * Returns the opcode name of a histogram slot.
+ *
+ * @param slot Slot index
+ * @return Name without the OP_ prefix
+ */
+const char* metrics_slot_name(int slot) {
+    return opcode_name(slot);
+}
+
+/**
+ * Returns the name of a phase.
+ *
+ * @param phase Timed phase
+ * @return Lowercase phase name
+ */
+const char* metrics_phase_name(MetricsPhase phase) {
+    return (phase >= 0 && phase < METRICS_PHASE_COUNT) ? phase_names[phase] : "unknown";
+}
+
+/**
+ * Records a phase duration for an opcode in the calling thread's shard.
+ *
+ * @param phase Timed phase
+ * @param op Operation code
+ * @param ns Duration in nanoseconds
+ */
+void metrics_record(MetricsPhase phase, int op, uint64_t ns) {
+    MetricsShard *shard = get_shard();
+    if (!shard) {
+        return;
+    }
+
+    uint32_t value = ns >= ((uint64_t)1 << METRICS_MAX_BITS) ? UINT32_MAX : (uint32_t)ns;
+    ShardHistogram **slot = &shard->hist[phase][metrics_op_slot(op)];
+    ShardHistogram *hist = *slot;
+    if (!hist) {
+        hist = calloc(1, sizeof(ShardHistogram));
+        if (!hist) {
+            return;
+        }
+        // Published zeroed, so a snapshot never reads it half-initialized
+        __atomic_store_n(slot, hist, __ATOMIC_RELEASE);
+    }
+
+    add32(&hist->count, 1);
+    add64(&hist->sum_ns, value);
+    add32(&hist->buckets[bucket_index(value)], 1);
+    if (value > hist->max_ns) {
+        __atomic_store_n(&hist->max_ns, value, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * Records bytes read from a socket.
+ *
+ * @param bytes Byte count returned by recv
+ */
+void metrics_record_recv(size_t bytes) {
+    MetricsShard *shard = get_shard();
+    if (shard) {
+        add64(&shard->bytes_in, bytes);
+    }
+}
+
+/**
+ * Records a complete received frame.
+ *
+ * @param parse_ok false if parse_message rejected the frame
+ */
+void metrics_record_frame_in(bool parse_ok) {
+    MetricsShard *shard = get_shard();
+    if (!shard) {
+        return;
+    }
+    add64(&shard->frames_in, 1);
+    if (!parse_ok) {
+        add64(&shard->parse_errors, 1);
+    }
+}
+
+/**
+ * Records a sent frame and its send duration.
+ *
+ * @param op Operation code sent
+ * @param bytes Bytes accepted by send
+ * @param ns Time spent in send
+ */
+void metrics_record_send(int op, size_t bytes, uint64_t ns) {
+    MetricsShard *shard = get_shard();
+    if (!shard) {
+        return;
+    }
+    add64(&shard->frames_out, 1);
+    add64(&shard->bytes_out, bytes);
+    metrics_record(METRICS_PHASE_SEND, op, ns);
+}
+
+// ========== AGGREGATION ==========
+
+/**
+ * Sums all live and exited thread shards.
+ * Writers never wait: the registry lock only keeps shards from being
+ * freed while they are read.
+ *
+ * @param out Output snapshot
+ */
+void metrics_snapshot(MetricsSnapshot *out) {
+    pthread_mutex_lock(&registry_mutex);
+    memcpy(out, &retired, sizeof(*out));
+    for (MetricsShard *shard = live_shards; shard; shard = shard->next) {
+        fold_shard(out, shard);
+    }
+    pthread_mutex_unlock(&registry_mutex);
+
+    out->taken_ns = metrics_now_ns();
+}
+
+/**
+ * Returns the value at a quantile of a histogram.
+ * The result is the upper bound of the bucket holding the quantile,
+ * capped at the recorded maximum.
+ *
+ * @param hist Histogram
+ * @param q Quantile between 0 and 1
+ * @return Duration in nanoseconds, 0 if the histogram is empty
+ */
+uint64_t metrics_percentile(const MetricsHistogram *hist, double q) {
+    if (hist->count == 0) {
+        return 0;
+    }
+
+    uint64_t rank = (uint64_t)(q * (double)hist->count);
+    if (rank >= hist->count) {
+        rank = hist->count - 1;
+    }
+
+    uint64_t seen = 0;
+    for (int b = 0; b < METRICS_BUCKETS; b++) {
+        seen += hist->buckets[b];
+        if (seen > rank) {
+            uint64_t upper = bucket_upper(b);
+            return upper < hist->max_ns ? upper : hist->max_ns;
+        }
+    }
+    return hist->max_ns;
+}
+
+/**
+ * Returns how many recorded values are at most ns.
+ * Whole buckets below ns are counted exactly; the bucket straddling ns
+ * contributes the share of its width that lies at or below ns, assuming
+ * its values are spread evenly.
+ *
+ * @param hist Histogram
+ * @param ns Upper bound in nanoseconds
+ * @return Cumulative count
+ */
+uint64_t metrics_count_at_most(const MetricsHistogram *hist, uint64_t ns) {
+    uint64_t count = 0;
+    for (int b = 0; b < METRICS_BUCKETS; b++) {
+        uint64_t upper = bucket_upper(b);
+        if (upper <= ns) {
+            count += hist->buckets[b];
+            continue;
+        }
+        uint64_t lower = b == 0 ? 0 : bucket_upper(b - 1) + 1;
+        if (ns >= lower && hist->buckets[b] > 0) {
+            double share = (double)(ns - lower + 1) / (double)(upper - lower + 1);
+            count += (uint64_t)(hist->buckets[b] * share);
+        }
+        break;
+    }
+    return count;
+}
+
+static double rate(uint64_t now, uint64_t before, double seconds) {
+    return seconds > 0 ? (double)(now - before) / seconds : 0.0;
+}
+
+/**
+ * Prints totals, rates since the previous report and per-opcode latencies.
+ *
+ * @param out Output stream
+ */
+void metrics_print_report(FILE *out) {
+    MetricsSnapshot *snap = malloc(sizeof(MetricsSnapshot));
+    if (!snap) {
+        return;
+    }
+    metrics_snapshot(snap);
+
+    pthread_mutex_lock(&report_mutex);
+
+    // The first report counts from the first recorded event; its zero
+    // baseline is as large as a snapshot, so it is not kept on the stack
+    MetricsSnapshot *empty = NULL;
+    const MetricsSnapshot *prev = last_report;
+    if (!prev) {
+        empty = calloc(1, sizeof(*empty));
+        if (!empty) {
+            pthread_mutex_unlock(&report_mutex);
+            free(snap);
+            return;
+        }
+        pthread_mutex_lock(&registry_mutex);
+        empty->taken_ns = first_shard_ns ? first_shard_ns : snap->taken_ns;
+        pthread_mutex_unlock(&registry_mutex);
+        prev = empty;
+    }
+    double seconds = (double)(snap->taken_ns - prev->taken_ns) / 1e9;
+
+    fprintf(out, "\n=== Server metrics (interval %.1f s) ===\n", seconds);
+    fprintf(out, "Frames in:  %llu (%.1f/s), parse errors %llu\n",
+            (unsigned long long)snap->frames_in,
+            rate(snap->frames_in, prev->frames_in, seconds),
+            (unsigned long long)snap->parse_errors);
+    fprintf(out, "Frames out: %llu (%.1f/s)\n",
+            (unsigned long long)snap->frames_out,
+            rate(snap->frames_out, prev->frames_out, seconds));
+    fprintf(out, "Bytes in:   %llu (%.1f/s)\n",
+            (unsigned long long)snap->bytes_in,
+            rate(snap->bytes_in, prev->bytes_in, seconds));
+    fprintf(out, "Bytes out:  %llu (%.1f/s)\n",
+            (unsigned long long)snap->bytes_out,
+            rate(snap->bytes_out, prev->bytes_out, seconds));
+
+    fprintf(out, "%-8s %-20s %10s %9s %9s %9s %9s %9s (us)\n",
+            "Phase", "Opcode", "Count", "Mean", "p50", "p99", "p999", "Max");
+    for (int p = 0; p < METRICS_PHASE_COUNT; p++) {
+        for (int s = 0; s < METRICS_OP_SLOTS; s++) {
+            const MetricsHistogram *hist = &snap->hist[p][s];
+            if (hist->count == 0) {
+                continue;
+            }
+            fprintf(out, "%-8s %-20s %10llu %9.1f %9.1f %9.1f %9.1f %9.1f\n",
+                    phase_names[p], metrics_slot_name(s),
+                    (unsigned long long)hist->count,
+                    (double)hist->sum_ns / (double)hist->count / 1000.0,
+                    metrics_percentile(hist, 0.50) / 1000.0,
+                    metrics_percentile(hist, 0.99) / 1000.0,
+                    metrics_percentile(hist, 0.999) / 1000.0,
+                    hist->max_ns / 1000.0);
+        }
+    }
+    fflush(out);
+
+    free(empty);
+    free(last_report);
+    last_report = snap;
+
+    pthread_mutex_unlock(&report_mutex);
+}
+
+/**
+ * Asks for a report; safe to call from a signal handler.
+ */
+void metrics_request_report(void) {
+    report_requested = 1;
+}
+
+/**
+ * Consumes a pending report request.
+ *
+ * @return true if a report was requested since the last call
+ */
+bool metrics_take_report_request(void) {
+    if (!report_requested) {
+        return false;
+    }
+    report_requested = 0;
+    return true;
+}
@@ -0,0 +1,125 @@
+#ifndef SERVER_METRICS_H
+#define SERVER_METRICS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "opcodes.h"
+
+#define METRICS_OP_SLOTS OPCODE_COUNT    // Dense opcode indices; slot 0 collects unknown ops
+#define METRICS_SUB_BITS 3               // Linear sub-buckets per power of two (2^bits, 12.5% wide)
+#define METRICS_MAX_BITS 32              // Values are clamped below 2^32 ns (~4.3 s)
+#define METRICS_BUCKETS (((METRICS_MAX_BITS - METRICS_SUB_BITS) + 1) << METRICS_SUB_BITS)
+
+/**
+ * Timed phases of one frame.
+ */
+typedef enum {
+    METRICS_PHASE_PARSE,         // parse_message, keyed by received opcode
+    METRICS_PHASE_HANDLER,       // Dispatch including the sends it triggers, keyed by received opcode
+    METRICS_PHASE_SEND,          // send_message, keyed by sent opcode
+    METRICS_PHASE_COUNT
+} MetricsPhase;
+
+/**
+ * Aggregated latency histogram.
+ * Bucket i holds values in [metrics_bucket_lower(i), metrics_bucket_upper(i)].
+ */
+typedef struct {
+    uint64_t count;
+    uint64_t sum_ns;
+    uint64_t max_ns;
+    uint64_t buckets[METRICS_BUCKETS];
+} MetricsHistogram;
+
+/**
+ * Totals of all threads at one point in time.
+ */
+typedef struct {
+    uint64_t taken_ns;                   // Monotonic time of the snapshot
+    uint64_t bytes_in;                   // Bytes returned by recv
+    uint64_t bytes_out;                  // Bytes accepted by send
+    uint64_t frames_in;                  // Complete frames received
+    uint64_t frames_out;                 // Frames sent
+    uint64_t parse_errors;               // Frames rejected by parse_message
+    MetricsHistogram hist[METRICS_PHASE_COUNT][METRICS_OP_SLOTS];
+} MetricsSnapshot;
+
+// ========== RECORDING (hot path) ==========
+
+/**
+ * Returns monotonic time in nanoseconds.
+ */
+uint64_t metrics_now_ns(void);
+
+/**
+ * Records a phase duration for an opcode in the calling thread's shard.
+ */
+void metrics_record(MetricsPhase phase, int op, uint64_t ns);
+
+/**
+ * Records bytes read from a socket.
+ */
+void metrics_record_recv(size_t bytes);
+
+/**
+ * Records a complete received frame (parse_ok false for rejected frames).
+ */
+void metrics_record_frame_in(bool parse_ok);
+
+/**
+ * Records a sent frame and its send duration.
+ */
+void metrics_record_send(int op, size_t bytes, uint64_t ns);
+
+// ========== AGGREGATION ==========
+
+/**
+ * Sums all live and exited thread shards without blocking writers.
+ */
+void metrics_snapshot(MetricsSnapshot *out);
+
+/**
+ * Returns the value at quantile q (0..1) of a histogram, 0 if empty.
+ */
+uint64_t metrics_percentile(const MetricsHistogram *hist, double q);
+
+/**
+ * Returns how many recorded values are at most ns, interpolating
+ * linearly within the bucket that contains ns.
+ */
+uint64_t metrics_count_at_most(const MetricsHistogram *hist, uint64_t ns);
+
+/**
+ * Maps an opcode to its histogram slot.
+ */
+int metrics_op_slot(int op);
+
+/**
+ * Returns the opcode name of a histogram slot.
+ */
+const char* metrics_slot_name(int slot);
+
+/**
+ * Returns the name of a phase ("parse", "handler", "send").
+ */
+const char* metrics_phase_name(MetricsPhase phase);
+
+/**
+ * Prints totals, rates since the previous report and per-opcode latencies.
+ */
+void metrics_print_report(FILE *out);
+
+/**
+ * Asks for a report from a signal handler (async-signal-safe).
+ */
+void metrics_request_report(void);
+
+/**
+ * Consumes a pending report request.
+ * @return true if a report was requested since the last call
+ */
+bool metrics_take_report_request(void);
+
+#endif //SERVER_METRICS_H
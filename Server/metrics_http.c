@@ -0,0 +1,353 @@
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include "metrics_http.h"
+#include "admin.h"
+#include "metrics.h"
+
+static Server *http_server = NULL;
+static int http_socket = -1;
+static pthread_t http_thread;
+
+// Histogram bounds in seconds; the +Inf bucket is the total count
+static const double LATENCY_BOUNDS[] = {
+    1e-6, 2.5e-6, 5e-6, 1e-5, 2.5e-5, 5e-5, 1e-4, 2.5e-4, 5e-4,
+    1e-3, 2.5e-3, 5e-3, 1e-2, 2.5e-2, 5e-2, 0.1, 0.25, 0.5, 1.0, 2.5
+};
+
+static const char *REASON_LABELS[DISCONNECT_REASON_COUNT] = {
+    "invalid_prefix", "invalid_format", "invalid_opcode", "invalid_length",
+    "data_mismatch", "buffer_overflow", "too_many_violations", "suspicious_activity"
+};
+
+// ========== RENDERING ==========
+
+static void counter_header(FILE *out, const char *name, const char *help) {
+    fprintf(out, "# HELP %s %s\n# TYPE %s counter\n", name, help, name);
+}
+
+static void gauge_header(FILE *out, const char *name, const char *help) {
+    fprintf(out, "# HELP %s %s\n# TYPE %s gauge\n", name, help, name);
+}
+
+/**
+ * Writes all metrics in Prometheus text format (version 0.0.4).
+ * Values come from server_stats atomics and the metrics shards;
+ * clients_mutex and rooms_mutex are never taken.
+ *
+ * @param server Pointer to the server
+ * @param out Output stream
+ */
+void metrics_http_render(Server *server, FILE *out) {
+    MetricsSnapshot *snap = malloc(sizeof(MetricsSnapshot));
+    if (!snap) {
+        return;
+    }
+    metrics_snapshot(snap);
+
+    // Connections and sessions
+    gauge_header(out, "checkers_clients", "Client slots in use.");
+    fprintf(out, "checkers_clients %d\n", __atomic_load_n(&server->client_count, __ATOMIC_RELAXED));
+
+    gauge_header(out, "checkers_clients_by_state", "Client slots per connection state.");
+    for (int s = 0; s < CLIENT_STATE_COUNT; s++) {
+        fprintf(out, "checkers_clients_by_state{state=\"%s\"} %d\n",
+                client_get_state_string((ClientState)s), STATS_LOAD(clients_by_state[s]));
+    }
+
+    counter_header(out, "checkers_connections_total", "Accepted TCP connections by result.");
+    fprintf(out, "checkers_connections_total{result=\"accepted\"} %llu\n",
+            (unsigned long long)STATS_LOAD(connections_accepted));
+    fprintf(out, "checkers_connections_total{result=\"rejected\"} %llu\n",
+            (unsigned long long)STATS_LOAD(connections_rejected));
+
+    counter_header(out, "checkers_disconnects_total", "Forced disconnects by DisconnectReason.");
+    for (int r = 0; r < DISCONNECT_REASON_COUNT; r++) {
+        fprintf(out, "checkers_disconnects_total{reason=\"%s\"} %llu\n",
+                REASON_LABELS[r], (unsigned long long)STATS_LOAD(disconnect_reasons[r]));
+    }
+
+    counter_header(out, "checkers_reconnects_total", "Reconnect requests by result.");
+    fprintf(out, "checkers_reconnects_total{result=\"success\"} %llu\n",
+            (unsigned long long)STATS_LOAD(reconnects_succeeded));
+    fprintf(out, "checkers_reconnects_total{result=\"failure\"} %llu\n",
+            (unsigned long long)STATS_LOAD(reconnects_failed));
+
+    counter_header(out, "checkers_reconnects_replayed_total",
+                   "Reconnects resumed by replaying missed frames.");
+    fprintf(out, "checkers_reconnects_replayed_total %llu\n",
+            (unsigned long long)STATS_LOAD(reconnects_replayed));
+    counter_header(out, "checkers_frames_replayed_total", "Missed frames resent on reconnect.");
+    fprintf(out, "checkers_frames_replayed_total %llu\n",
+            (unsigned long long)STATS_LOAD(frames_replayed));
+
+    counter_header(out, "checkers_frames_dropped_total", "Client frames not handled, by reason.");
+    fprintf(out, "checkers_frames_dropped_total{reason=\"invalid_payload\"} %llu\n",
+            (unsigned long long)STATS_LOAD(frames_rejected));
+    fprintf(out, "checkers_frames_dropped_total{reason=\"rate_limited\"} %llu\n",
+            (unsigned long long)STATS_LOAD(frames_rate_limited));
+
+    // Rooms and games
+    gauge_header(out, "checkers_rooms", "Rooms per room state.");
+    for (int s = 0; s < ROOM_STATE_COUNT; s++) {
+        fprintf(out, "checkers_rooms{state=\"%s\"} %d\n",
+                room_get_state_string((RoomState)s), STATS_LOAD(rooms_by_state[s]));
+    }
+
+    gauge_header(out, "checkers_active_games", "Games in progress (active rooms).");
+    fprintf(out, "checkers_active_games %d\n", STATS_LOAD(rooms_by_state[ROOM_STATE_ACTIVE]));
+
+    counter_header(out, "checkers_games_started_total", "Games started.");
+    fprintf(out, "checkers_games_started_total %llu\n",
+            (unsigned long long)STATS_LOAD(games_started));
+    counter_header(out, "checkers_games_finished_total", "Games finished.");
+    fprintf(out, "checkers_games_finished_total %llu\n",
+            (unsigned long long)STATS_LOAD(games_finished));
+
+    // Heartbeat
+    counter_header(out, "checkers_heartbeat_pings_total", "PING frames sent by the heartbeat.");
+    fprintf(out, "checkers_heartbeat_pings_total %llu\n", (unsigned long long)STATS_LOAD(pings_sent));
+    counter_header(out, "checkers_heartbeat_pongs_total", "PONG frames received.");
+    fprintf(out, "checkers_heartbeat_pongs_total %llu\n", (unsigned long long)STATS_LOAD(pongs_received));
+    counter_header(out, "checkers_heartbeat_missed_pongs_total", "PONG replies that timed out.");
+    fprintf(out, "checkers_heartbeat_missed_pongs_total %llu\n",
+            (unsigned long long)STATS_LOAD(missed_pongs));
+    gauge_header(out, "checkers_heartbeat_sweep_seconds", "Duration of the latest heartbeat sweep.");
+    fprintf(out, "checkers_heartbeat_sweep_seconds %.6f\n", STATS_LOAD(last_sweep_us) / 1e6);
+
+    // Traffic
+    counter_header(out, "checkers_bytes_received_total", "Bytes read from client sockets.");
+    fprintf(out, "checkers_bytes_received_total %llu\n", (unsigned long long)snap->bytes_in);
+    counter_header(out, "checkers_bytes_sent_total", "Bytes written to client sockets.");
+    fprintf(out, "checkers_bytes_sent_total %llu\n", (unsigned long long)snap->bytes_out);
+    counter_header(out, "checkers_parse_errors_total", "Frames rejected by the parser.");
+    fprintf(out, "checkers_parse_errors_total %llu\n", (unsigned long long)snap->parse_errors);
+
+    counter_header(out, "checkers_frames_received_total", "Parsed frames received per opcode.");
+    for (int s = 0; s < METRICS_OP_SLOTS; s++) {
+        uint64_t count = snap->hist[METRICS_PHASE_PARSE][s].count;
+        if (count > 0) {
+            fprintf(out, "checkers_frames_received_total{op=\"%s\"} %llu\n",
+                    metrics_slot_name(s), (unsigned long long)count);
+        }
+    }
+
+    counter_header(out, "checkers_frames_sent_total", "Frames sent per opcode.");
+    for (int s = 0; s < METRICS_OP_SLOTS; s++) {
+        uint64_t count = snap->hist[METRICS_PHASE_SEND][s].count;
+        if (count > 0) {
+            fprintf(out, "checkers_frames_sent_total{op=\"%s\"} %llu\n",
+                    metrics_slot_name(s), (unsigned long long)count);
+        }
+    }
+
+    // Latency histograms; each le count interpolates within the bucket holding the bound
+    fprintf(out, "# HELP checkers_frame_duration_seconds Time per frame phase and opcode.\n");
+    fprintf(out, "# TYPE checkers_frame_duration_seconds histogram\n");
+    for (int p = 0; p < METRICS_PHASE_COUNT; p++) {
+        const char *phase = metrics_phase_name((MetricsPhase)p);
+        for (int s = 0; s < METRICS_OP_SLOTS; s++) {
+            const MetricsHistogram *hist = &snap->hist[p][s];
+            if (hist->count == 0) {
+                continue;
+            }
+            const char *op = metrics_slot_name(s);
+            for (size_t b = 0; b < sizeof(LATENCY_BOUNDS) / sizeof(LATENCY_BOUNDS[0]); b++) {
+                uint64_t le_ns = (uint64_t)(LATENCY_BOUNDS[b] * 1e9 + 0.5);
+                fprintf(out, "checkers_frame_duration_seconds_bucket{phase=\"%s\",op=\"%s\",le=\"%g\"} %llu\n",
+                        phase, op, LATENCY_BOUNDS[b],
+                        (unsigned long long)metrics_count_at_most(hist, le_ns));
+            }
+            fprintf(out, "checkers_frame_duration_seconds_bucket{phase=\"%s\",op=\"%s\",le=\"+Inf\"} %llu\n",
+                    phase, op, (unsigned long long)hist->count);
+            fprintf(out, "checkers_frame_duration_seconds_sum{phase=\"%s\",op=\"%s\"} %.9f\n",
+                    phase, op, hist->sum_ns / 1e9);
+            fprintf(out, "checkers_frame_duration_seconds_count{phase=\"%s\",op=\"%s\"} %llu\n",
+                    phase, op, (unsigned long long)hist->count);
+        }
+    }
+
+    free(snap);
+}
+
+// ========== HTTP LISTENER ==========
+
+static void send_all(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+}
+
+static void send_status(int fd, const char *status) {
+    char response[256];
+    int len = snprintf(response, sizeof(response),
+                       "HTTP/1.1 %s\r\nContent-Type: text/plain\r\nContent-Length: %zu\r\n"
+                       "Connection: close\r\n\r\n%s\n",
+                       status, strlen(status) + 1, status);
+    send_all(fd, response, (size_t)len);
+}
+
+/**
+ * Serves one scrape: reads the request head and answers GET /metrics.
+ * Every response closes the connection.
+ *
+ * @param fd Accepted socket
+ */
+static void http_serve(int fd) {
+    struct timeval tv = {METRICS_HTTP_TIMEOUT_SEC, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    char request[METRICS_HTTP_MAX_REQUEST];
+    int len = 0;
+    while (len < (int)sizeof(request) - 1) {
+        ssize_t n = recv(fd, request + len, sizeof(request) - 1 - len, 0);
+        if (n <= 0) {
+            return;
+        }
+        len += (int)n;
+        request[len] = '\0';
+        if (strstr(request, "\r\n\r\n") || strstr(request, "\n\n")) {
+            break;
+        }
+    }
+    request[len] = '\0';
+
+    char method[8];
+    char path[256];
+    if (sscanf(request, "%7s %255s", method, path) != 2) {
+        send_status(fd, "400 Bad Request");
+        return;
+    }
+
+    path[strcspn(path, "?")] = '\0';
+    if (strcmp(path, "/metrics") != 0) {
+        send_status(fd, "404 Not Found");
+        return;
+    }
+    if (strcmp(method, "GET") != 0 && strcmp(method, "HEAD") != 0) {
+        send_status(fd, "405 Method Not Allowed");
+        return;
+    }
+
+    char *body = NULL;
+    size_t body_len = 0;
+    FILE *out = open_memstream(&body, &body_len);
+    if (!out) {
+        send_status(fd, "500 Internal Server Error");
+        return;
+    }
+    metrics_http_render(http_server, out);
+    fclose(out);
+
+    char head[256];
+    int head_len = snprintf(head, sizeof(head),
+                            "HTTP/1.1 200 OK\r\n"
+                            "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                            "Content-Length: %zu\r\nConnection: close\r\n\r\n",
+                            body_len);
+    send_all(fd, head, (size_t)head_len);
+    if (strcmp(method, "GET") == 0) {
+        send_all(fd, body, body_len);
+    }
+    free(body);
+}
+
+/**
+ * Listener thread; scrapes are served one at a time.
+ *
+ * @param arg Unused
+ * @return NULL when the listener is closed
+ */
+static void* http_thread_main(void *arg) {
+    (void)arg;
+
+    while (1) {
+        int fd = accept(http_socket, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        http_serve(fd);
+        close(fd);
+    }
+
+    return NULL;
+}
+
+/**
+ * Starts the Prometheus exposition listener thread.
+ *
+ * @param server Pointer to the server
+ * @param bind_address IPv4 address to bind (NULL for loopback)
+ * @param port TCP port
+ * @return 0 on success, -1 on failure
+ */
+int metrics_http_start(Server *server, const char *bind_address, int port) {
+    if (!bind_address) {
+        bind_address = METRICS_HTTP_DEFAULT_BIND;
+    }
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, bind_address, &addr.sin_addr) <= 0) {
+        fprintf(stderr, "Invalid metrics bind address: %s\n", bind_address);
+        return -1;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("Metrics socket creation failed");
+        return -1;
+    }
+
+    int opt = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 8) < 0) {
+        perror("Metrics listener failed");
+        close(fd);
+        return -1;
+    }
+
+    http_server = server;
+    http_socket = fd;
+
+    if (pthread_create(&http_thread, NULL, http_thread_main, NULL) != 0) {
+        perror("Failed to create metrics thread");
+        close(fd);
+        http_socket = -1;
+        return -1;
+    }
+
+    printf("Prometheus metrics on http://%s:%d/metrics\n", bind_address, port);
+    return 0;
+}
+
+/**
+ * Stops the exposition listener.
+ */
+void metrics_http_stop(void) {
+    if (http_socket < 0) {
+        return;
+    }
+
+    shutdown(http_socket, SHUT_RDWR);
+    pthread_join(http_thread, NULL);
+    close(http_socket);
+    http_socket = -1;
+}
@@ -0,0 +1,27 @@
+#ifndef SERVER_METRICS_HTTP_H
+#define SERVER_METRICS_HTTP_H
+
+#include <stdio.h>
+#include "server.h"
+
+#define METRICS_HTTP_DEFAULT_BIND "127.0.0.1"  // Loopback unless --metrics-bind says otherwise
+#define METRICS_HTTP_MAX_REQUEST 2048          // Request head bytes read before answering
+#define METRICS_HTTP_TIMEOUT_SEC 2             // Time a scraper has to send its request
+
+/**
+ * Starts the Prometheus exposition listener thread.
+ * @return 0 on success, -1 on failure
+ */
+int metrics_http_start(Server *server, const char *bind_address, int port);
+
+/**
+ * Stops the exposition listener.
+ */
+void metrics_http_stop(void);
+
+/**
+ * Writes all metrics in Prometheus text format (version 0.0.4).
+ */
+void metrics_http_render(Server *server, FILE *out);
+
+#endif //SERVER_METRICS_HTTP_H
@@ -0,0 +1,469 @@
+#include "movegen.h"
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+#define DIRECTION_COUNT 4
+
+// Diagonal directions: up-left, up-right, down-left, down-right
+static const int DIR_ROW[DIRECTION_COUNT] = {-1, -1, 1, 1};
+static const int DIR_COL[DIRECTION_COUNT] = {-1, 1, -1, 1};
+
+static uint8_t ray_squares[SQUARE_COUNT][DIRECTION_COUNT][BOARD_SIZE];
+static uint8_t ray_length[SQUARE_COUNT][DIRECTION_COUNT];
+
+// Zobrist keys indexed by [PieceType - 1][square]
+static uint64_t zobrist_piece[4][SQUARE_COUNT];
+static uint64_t zobrist_side;
+
+static pthread_once_t movegen_once = PTHREAD_ONCE_INIT;
+
+/**
+ * SplitMix64 step used to fill Zobrist tables deterministically.
+ *
+ * @param state Generator state (advanced in place)
+ * @return Next pseudo-random value
+ */
+static uint64_t splitmix64(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * Builds diagonal ray tables and Zobrist keys.
+ * Called exactly once through pthread_once.
+ */
+static void movegen_init_tables(void) {
+    for (int sq = 0; sq < SQUARE_COUNT; sq++) {
+        for (int dir = 0; dir < DIRECTION_COUNT; dir++) {
+            int row = SQUARE_ROW(sq) + DIR_ROW[dir];
+            int col = SQUARE_COL(sq) + DIR_COL[dir];
+            int len = 0;
+
+            while (row >= 0 && row < BOARD_SIZE && col >= 0 && col < BOARD_SIZE) {
+                ray_squares[sq][dir][len++] = (uint8_t)SQUARE(row, col);
+                row += DIR_ROW[dir];
+                col += DIR_COL[dir];
+            }
+            ray_length[sq][dir] = (uint8_t)len;
+        }
+    }
+
+    uint64_t seed = 0x436865636B657273ULL; // "Checkers"
+    for (int piece = 0; piece < 4; piece++) {
+        for (int sq = 0; sq < SQUARE_COUNT; sq++) {
+            zobrist_piece[piece][sq] = splitmix64(&seed);
+        }
+    }
+    zobrist_side = splitmix64(&seed);
+}
+
+/**
+ * Initializes lookup tables and Zobrist keys.
+ * Safe to call from multiple threads; tables are built only once.
+ */
+void movegen_init(void) {
+    pthread_once(&movegen_once, movegen_init_tables);
+}
+
+/**
+ * Returns the piece type standing on a square.
+ *
+ * @param pos Position to inspect
+ * @param sq Square index (row * 8 + col)
+ * @return PieceType value (EMPTY if no piece)
+ */
+int position_piece_at(const Position *pos, int sq) {
+    uint64_t bit = 1ULL << sq;
+    bool king = (pos->kings & bit) != 0;
+
+    if (pos->white & bit) return king ? WHITE_KING : WHITE_PIECE;
+    if (pos->black & bit) return king ? BLACK_KING : BLACK_PIECE;
+    return EMPTY;
+}
+
+/**
+ * Computes the Zobrist key of a position from scratch.
+ *
+ * @param pos Position to hash
+ * @return 64-bit Zobrist key
+ */
+uint64_t position_compute_hash(const Position *pos) {
+    movegen_init();
+
+    uint64_t hash = 0;
+    uint64_t occupied = pos->white | pos->black;
+
+    while (occupied) {
+        int sq = __builtin_ctzll(occupied);
+        occupied &= occupied - 1;
+        hash ^= zobrist_piece[position_piece_at(pos, sq) - 1][sq];
+    }
+
+    if (pos->side == COLOR_BLACK) {
+        hash ^= zobrist_side;
+    }
+    return hash;
+}
+
+/**
+ * Builds an engine position from an 8x8 board of PieceType values.
+ *
+ * @param pos Output position
+ * @param board Source board (Game.board layout)
+ * @param side Side to move
+ */
+void position_from_board(Position *pos, const int board[BOARD_SIZE][BOARD_SIZE], PlayerColor side) {
+    memset(pos, 0, sizeof(*pos));
+
+    for (int row = 0; row < BOARD_SIZE; row++) {
+        for (int col = 0; col < BOARD_SIZE; col++) {
+            uint64_t bit = 1ULL << SQUARE(row, col);
+
+            switch (board[row][col]) {
+                case WHITE_PIECE: pos->white |= bit; break;
+                case WHITE_KING:  pos->white |= bit; pos->kings |= bit; break;
+                case BLACK_PIECE: pos->black |= bit; break;
+                case BLACK_KING:  pos->black |= bit; pos->kings |= bit; break;
+                default: break;
+            }
+        }
+    }
+
+    pos->side = side;
+    pos->hash = position_compute_hash(pos);
+}
+
+/**
+ * Builds an engine position from a game.
+ * Side to move is taken from the game's turn bit.
+ *
+ * @param pos Output position
+ * @param game Source game
+ */
+void position_from_game(Position *pos, const Game *game) {
+    PlayerColor side = game->player2_to_move ? game->player2_color : game->player1_color;
+    position_from_board(pos, game->board, side);
+}
+
+/**
+ * Writes a position back into an 8x8 board of PieceType values.
+ *
+ * @param pos Source position
+ * @param board Output board
+ */
+void position_to_board(const Position *pos, int board[BOARD_SIZE][BOARD_SIZE]) {
+    for (int row = 0; row < BOARD_SIZE; row++) {
+        for (int col = 0; col < BOARD_SIZE; col++) {
+            board[row][col] = position_piece_at(pos, SQUARE(row, col));
+        }
+    }
+}
+
+/**
+ * Checks if a square is on the promotion row for a color.
+ *
+ * @param sq Square index
+ * @param side Color of the moving man
+ * @return true if a man of that color is crowned on this square
+ */
+static inline bool is_promotion_square(int sq, PlayerColor side) {
+    return side == COLOR_WHITE ? SQUARE_ROW(sq) == 0 : SQUARE_ROW(sq) == BOARD_SIZE - 1;
+}
+
+/**
+ * State shared by the recursive capture search.
+ */
+typedef struct {
+    MoveList *list;
+    Move current;         // Chain built so far
+    uint64_t own;         // Own pieces without the moving one
+    uint64_t enemy;       // Enemy pieces not captured yet
+    PlayerColor side;
+} CaptureContext;
+
+/**
+ * Appends a move to the list, ignoring overflow.
+ *
+ * @param list Move list
+ * @param move Move to append
+ */
+static inline void push_move(MoveList *list, const Move *move) {
+    if (list->count < MAX_MOVES) {
+        list->moves[list->count++] = *move;
+    }
+}
+
+static void extend_capture(CaptureContext *ctx, int sq, bool king);
+
+/**
+ * Records one capture step and continues the chain from the landing square.
+ * Captured pieces are removed immediately, matching apply_single_step.
+ *
+ * @param ctx Capture search state
+ * @param victim Square of the captured piece
+ * @param landing Landing square
+ * @param king Whether the moving piece is a king before this step
+ */
+static void capture_step(CaptureContext *ctx, int victim, int landing, bool king) {
+    uint64_t victim_bit = 1ULL << victim;
+    bool promotes = !king && is_promotion_square(landing, ctx->side);
+    bool was_promoted = ctx->current.promotes;
+
+    ctx->current.path[ctx->current.path_len++] = (uint8_t)landing;
+    ctx->current.captured |= victim_bit;
+    ctx->current.capture_count++;
+    ctx->current.promotes = was_promoted || promotes;
+    ctx->enemy &= ~victim_bit;
+
+    extend_capture(ctx, landing, king || promotes);
+
+    ctx->enemy |= victim_bit;
+    ctx->current.promotes = was_promoted;
+    ctx->current.capture_count--;
+    ctx->current.captured &= ~victim_bit;
+    ctx->current.path_len--;
+}
+
+/**
+ * Depth-first search over capture chains from a square.
+ * Emits a move when the chain cannot be continued (captures are played to the end).
+ *
+ * @param ctx Capture search state
+ * @param sq Current square of the moving piece
+ * @param king Whether the moving piece is (now) a king
+ */
+static void extend_capture(CaptureContext *ctx, int sq, bool king) {
+    bool extended = false;
+    uint64_t occupied = ctx->own | ctx->enemy;
+
+    if (ctx->current.path_len < MAX_MOVE_PATH) {
+        for (int dir = 0; dir < DIRECTION_COUNT; dir++) {
+            const uint8_t *ray = ray_squares[sq][dir];
+            int len = ray_length[sq][dir];
+
+            if (!king) {
+                if (len < 2) continue;
+                int victim = ray[0];
+                int landing = ray[1];
+                if ((ctx->enemy >> victim & 1) && !(occupied >> landing & 1)) {
+                    extended = true;
+                    capture_step(ctx, victim, landing, king);
+                }
+                continue;
+            }
+
+            // Flying king: slide to the first piece, jump it if it is an enemy
+            int k = 0;
+            while (k < len && !(occupied >> ray[k] & 1)) k++;
+            if (k >= len || !(ctx->enemy >> ray[k] & 1)) continue;
+
+            int victim = ray[k];
+            for (int j = k + 1; j < len && !(occupied >> ray[j] & 1); j++) {
+                extended = true;
+                capture_step(ctx, victim, ray[j], king);
+            }
+        }
+    }
+
+    if (!extended && ctx->current.capture_count > 0) {
+        push_move(ctx->list, &ctx->current);
+    }
+}
+
+/**
+ * Checks if a single piece can capture from its square.
+ *
+ * @param sq Square of the piece
+ * @param king Whether the piece is a king
+ * @param occupied All pieces on the board
+ * @param enemy Enemy pieces
+ * @return true if at least one capture exists
+ */
+static bool piece_can_capture(int sq, bool king, uint64_t occupied, uint64_t enemy) {
+    for (int dir = 0; dir < DIRECTION_COUNT; dir++) {
+        const uint8_t *ray = ray_squares[sq][dir];
+        int len = ray_length[sq][dir];
+        int k = 0;
+
+        if (king) {
+            while (k < len && !(occupied >> ray[k] & 1)) k++;
+        }
+        if (k + 1 < len && (enemy >> ray[k] & 1) && !(occupied >> ray[k + 1] & 1)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Checks whether the side to move has any capture available.
+ *
+ * @param pos Position to inspect
+ * @return true if a capture exists
+ */
+bool position_has_capture(const Position *pos) {
+    movegen_init();
+
+    uint64_t own = pos->side == COLOR_WHITE ? pos->white : pos->black;
+    uint64_t enemy = pos->side == COLOR_WHITE ? pos->black : pos->white;
+    uint64_t occupied = own | enemy;
+
+    while (own) {
+        int sq = __builtin_ctzll(own);
+        own &= own - 1;
+        if (piece_can_capture(sq, (pos->kings >> sq) & 1, occupied, enemy)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Generates all legal moves for the side to move.
+ *
+ * Rules follow the server's validate_single_step:
+ * - Men step one square forward, capture by short jumps in all four directions
+ * - Kings fly along diagonals and capture a single enemy anywhere on the ray
+ * - A man reaching the far row is crowned at once, even in the middle of a chain
+ * Capturing is mandatory and chains are played until no further capture exists,
+ * as the client enforces.
+ *
+ * @param pos Position to generate moves for
+ * @param list Output move list
+ * @return Number of moves generated
+ */
+int generate_moves(const Position *pos, MoveList *list) {
+    movegen_init();
+    list->count = 0;
+
+    uint64_t own = pos->side == COLOR_WHITE ? pos->white : pos->black;
+    uint64_t enemy = pos->side == COLOR_WHITE ? pos->black : pos->white;
+    uint64_t occupied = own | enemy;
+
+    // ========== CAPTURES ==========
+    CaptureContext ctx;
+    ctx.list = list;
+    ctx.side = pos->side;
+    ctx.enemy = enemy;
+
+    for (uint64_t pieces = own; pieces; pieces &= pieces - 1) {
+        int sq = __builtin_ctzll(pieces);
+        bool king = (pos->kings >> sq) & 1;
+
+        if (!piece_can_capture(sq, king, occupied, enemy)) continue;
+
+        memset(&ctx.current, 0, sizeof(ctx.current));
+        ctx.current.path[0] = (uint8_t)sq;
+        ctx.current.path_len = 1;
+        ctx.own = own & ~(1ULL << sq);
+        extend_capture(&ctx, sq, king);
+    }
+
+    if (list->count > 0) {
+        return list->count;
+    }
+
+    // ========== QUIET MOVES ==========
+    int first_dir = pos->side == COLOR_WHITE ? 0 : 2;
+
+    for (uint64_t pieces = own; pieces; pieces &= pieces - 1) {
+        int sq = __builtin_ctzll(pieces);
+        bool king = (pos->kings >> sq) & 1;
+        Move move;
+        memset(&move, 0, sizeof(move));
+        move.path[0] = (uint8_t)sq;
+        move.path_len = 2;
+
+        if (king) {
+            for (int dir = 0; dir < DIRECTION_COUNT; dir++) {
+                const uint8_t *ray = ray_squares[sq][dir];
+                for (int k = 0; k < ray_length[sq][dir] && !(occupied >> ray[k] & 1); k++) {
+                    move.path[1] = ray[k];
+                    push_move(list, &move);
+                }
+            }
+        } else {
+            for (int dir = first_dir; dir < first_dir + 2; dir++) {
+                if (ray_length[sq][dir] == 0) continue;
+                int to = ray_squares[sq][dir][0];
+                if (occupied >> to & 1) continue;
+                move.path[1] = (uint8_t)to;
+                move.promotes = is_promotion_square(to, pos->side);
+                push_move(list, &move);
+            }
+        }
+    }
+
+    return list->count;
+}
+
+/**
+ * Applies a move and passes the turn to the opponent.
+ * Updates the Zobrist key incrementally.
+ *
+ * @param pos Position to modify
+ * @param move Move produced by generate_moves
+ */
+void make_move(Position *pos, const Move *move) {
+    int from = move->path[0];
+    int to = move->path[move->path_len - 1];
+    uint64_t from_bit = 1ULL << from;
+    uint64_t to_bit = 1ULL << to;
+    bool white = pos->side == COLOR_WHITE;
+    int piece = position_piece_at(pos, from);
+    int new_piece = piece;
+
+    if (move->promotes) {
+        new_piece = white ? WHITE_KING : BLACK_KING;
+    }
+
+    // Remove captured pieces
+    for (uint64_t victims = move->captured; victims; victims &= victims - 1) {
+        int sq = __builtin_ctzll(victims);
+        pos->hash ^= zobrist_piece[position_piece_at(pos, sq) - 1][sq];
+    }
+    if (white) {
+        pos->black &= ~move->captured;
+    } else {
+        pos->white &= ~move->captured;
+    }
+    pos->kings &= ~move->captured;
+
+    // Move the piece (origin and destination may coincide on circular king chains)
+    pos->hash ^= zobrist_piece[piece - 1][from];
+    if (white) {
+        pos->white = (pos->white & ~from_bit) | to_bit;
+    } else {
+        pos->black = (pos->black & ~from_bit) | to_bit;
+    }
+    pos->kings &= ~from_bit;
+    if (new_piece == WHITE_KING || new_piece == BLACK_KING) {
+        pos->kings |= to_bit;
+    }
+    pos->hash ^= zobrist_piece[new_piece - 1][to];
+
+    pos->side = white ? COLOR_BLACK : COLOR_WHITE;
+    pos->hash ^= zobrist_side;
+}
+
+/**
+ * Formats a move as "r,c,r,c,..." (the OP_MULTI_MOVE path layout).
+ *
+ * @param move Move to format
+ * @param buffer Output buffer
+ * @param size Buffer size
+ * @return Number of characters written
+ */
+int move_to_string(const Move *move, char *buffer, int size) {
+    int written = 0;
+
+    if (size > 0) buffer[0] = '\0';
+    for (int i = 0; i < move->path_len && written < size; i++) {
+        written += snprintf(buffer + written, size - written, "%s%d,%d",
+                            i ? "," : "", SQUARE_ROW(move->path[i]), SQUARE_COL(move->path[i]));
+    }
+    return written < size ? written : size - 1;
+}
@@ -0,0 +1,102 @@
+#ifndef SERVER_MOVEGEN_H
+#define SERVER_MOVEGEN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "game.h"
+
+#define SQUARE_COUNT (BOARD_SIZE * BOARD_SIZE)
+#define MAX_MOVE_PATH 16                 // Squares in one move (origin + landings)
+#define MAX_MOVES 256                    // Upper bound for generated moves per position
+
+#define SQUARE(row, col) ((row) * BOARD_SIZE + (col))
+#define SQUARE_ROW(sq) ((sq) / BOARD_SIZE)
+#define SQUARE_COL(sq) ((sq) % BOARD_SIZE)
+
+/**
+ * Compact board representation used by the engine.
+ * One bit per square (index = row * 8 + col), same orientation as Game.board.
+ */
+typedef struct {
+    uint64_t white;          // White men and kings
+    uint64_t black;          // Black men and kings
+    uint64_t kings;          // Kings of either color
+    PlayerColor side;        // Side to move
+    uint64_t hash;           // Zobrist key of the position
+} Position;
+
+/**
+ * One complete move: a simple step or a full capture chain.
+ * path[0] is the origin, path[path_len - 1] the final square.
+ */
+typedef struct {
+    uint8_t path[MAX_MOVE_PATH];
+    uint8_t path_len;
+    uint8_t capture_count;
+    bool promotes;
+    uint64_t captured;       // Squares of captured pieces
+} Move;
+
+/**
+ * List of generated moves.
+ */
+typedef struct {
+    Move moves[MAX_MOVES];
+    int count;
+} MoveList;
+
+// ========== MOVE GENERATION ==========
+
+/**
+ * Initializes lookup tables and Zobrist keys (idempotent, thread-safe).
+ */
+void movegen_init(void);
+
+/**
+ * Builds position from an 8x8 board of PieceType values.
+ */
+void position_from_board(Position *pos, const int board[BOARD_SIZE][BOARD_SIZE], PlayerColor side);
+
+/**
+ * Builds position from a game, side to move taken from current_turn.
+ */
+void position_from_game(Position *pos, const Game *game);
+
+/**
+ * Writes position back into an 8x8 board of PieceType values.
+ */
+void position_to_board(const Position *pos, int board[BOARD_SIZE][BOARD_SIZE]);
+
+/**
+ * Returns PieceType on a square.
+ */
+int position_piece_at(const Position *pos, int sq);
+
+/**
+ * Recomputes the Zobrist key from scratch.
+ */
+uint64_t position_compute_hash(const Position *pos);
+
+/**
+ * Generates all legal moves (captures are mandatory and played to the end).
+ * @return Number of moves generated
+ */
+int generate_moves(const Position *pos, MoveList *list);
+
+/**
+ * Checks whether side to move has any capture available.
+ */
+bool position_has_capture(const Position *pos);
+
+/**
+ * Applies move and passes the turn to the opponent.
+ */
+void make_move(Position *pos, const Move *move);
+
+/**
+ * Formats move as "r,c,r,c,..." path for logging and protocol payloads.
+ * @return Number of characters written
+ */
+int move_to_string(const Move *move, char *buffer, int size);
+
+#endif //SERVER_MOVEGEN_H
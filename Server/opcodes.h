@@ -0,0 +1,84 @@
+#ifndef SERVER_OPCODES_H
+#define SERVER_OPCODES_H
+
+// Client game states in which a client may send an opcode (1 << ClientGameState)
+#define OPS_NONE 0u                      // Sent by the server only
+#define OPS_NOT_LOGGED_IN (1u << 0)
+#define OPS_LOBBY (1u << 1)
+#define OPS_WAITING (1u << 2)
+#define OPS_GAME (1u << 3)
+#define OPS_ANY (OPS_NOT_LOGGED_IN | OPS_LOBBY | OPS_WAITING | OPS_GAME)
+
+/**
+ * Every protocol operation, one entry each:
+ * X(name, code, states, payload)
+ *
+ * - name: OpCode is OP_<name>
+ * - code: Wire value
+ * - states: OPS_* mask of client game states allowed to send it
+ * - payload: Data format, for the generated protocol reference
+ *
+ * The OpCode enum, the per-state permission masks, metric labels and
+ * the protocol reference (checkers_server --opcodes) are generated from
+ * this list, so a new opcode is added here only.
+ */
+#define OPCODE_LIST(X) \
+    /* Authentication */ \
+    X(LOGIN,               1,   OPS_NOT_LOGGED_IN, "player_name") \
+    X(LOGIN_OK,            2,   OPS_NONE, "player_name,session_token") \
+    X(LOGIN_FAIL,          3,   OPS_NONE, "reason") \
+    /* Room management */ \
+    X(CREATE_ROOM,         4,   OPS_LOBBY, "player_name,room_name") \
+    X(JOIN_ROOM,           5,   OPS_LOBBY | OPS_WAITING, "player_name,room_name") \
+    X(ROOM_JOINED,         6,   OPS_NONE, "room_name,players_count") \
+    X(ROOM_FULL,           7,   OPS_NONE, "reason") \
+    X(ROOM_FAIL,           8,   OPS_NONE, "reason") \
+    X(ROOM_CREATED,        20,  OPS_NONE, "room_name") \
+    X(LEAVE_ROOM,          14,  OPS_WAITING | OPS_GAME, "room_name,player_name") \
+    X(ROOM_LEFT,           15,  OPS_NONE, "room_name[,player_name]") \
+    X(LIST_ROOMS,          18,  OPS_LOBBY | OPS_WAITING | OPS_GAME, "") \
+    X(ROOMS_LIST,          19,  OPS_NONE, "rooms JSON") \
+    /* Matchmaking */ \
+    X(QUICK_MATCH,         31,  OPS_LOBBY, "player_name") \
+    X(QUICK_MATCH_QUEUED,  32,  OPS_NONE, "rating") \
+    /* Leaderboard */ \
+    X(LEADERBOARD,         33,  OPS_LOBBY | OPS_WAITING | OPS_GAME, "[first_rank[,count]]") \
+    X(LEADERBOARD_PAGE,    34,  OPS_NONE, "leaderboard JSON") \
+    /* Game flow */ \
+    X(GAME_START,          9,   OPS_NONE, "room_name,player1,player2,current_turn") \
+    X(MOVE,                10,  OPS_GAME, "room_name,player_name,from_row,from_col,to_row,to_col") \
+    X(MULTI_MOVE,          21,  OPS_GAME, "room_name,player_name,path_length,r1,c1,r2,c2,...") \
+    X(INVALID_MOVE,        11,  OPS_NONE, "reason") \
+    X(GAME_STATE,          12,  OPS_NONE, "board JSON") \
+    X(GAME_END,            13,  OPS_NONE, "winner,reason") \
+    X(GAME_PAUSED,         28,  OPS_NONE, "room_name") \
+    X(GAME_RESUMED,        29,  OPS_NONE, "room_name") \
+    /* Connection monitoring */ \
+    X(PING,                16,  OPS_ANY, "") \
+    X(PONG,                17,  OPS_ANY, "") \
+    /* Reconnection */ \
+    X(PLAYER_DISCONNECTED, 22,  OPS_NONE, "[room_name,]player_name") \
+    X(PLAYER_RECONNECTING, 23,  OPS_NONE, "room_name,player_name") \
+    X(PLAYER_RECONNECTED,  24,  OPS_NONE, "room_name,player_name") \
+    X(RECONNECT_REQUEST,   25,  OPS_ANY, "[room_name],player_name,session_token[,last_seq]") \
+    X(RECONNECT_OK,        26,  OPS_NONE, "room_name/lobby,from_seq") \
+    X(RECONNECT_FAIL,      27,  OPS_NONE, "reason") \
+    /* Administration (admin listener only) */ \
+    X(ADMIN_STATS,         30,  OPS_NONE, "stats JSON") \
+    /* Error handling */ \
+    X(ERROR,               500, OPS_ANY, "message")
+
+/**
+ * Dense opcode indices in list order; 0 stands for unknown opcodes.
+ */
+typedef enum {
+    OPCODE_INDEX_UNKNOWN,
+#define OPCODE_INDEX_ENTRY(name, code, states, payload) OPCODE_INDEX_##name,
+    OPCODE_LIST(OPCODE_INDEX_ENTRY)
+#undef OPCODE_INDEX_ENTRY
+    OPCODE_COUNT                         // Dense indices including OPCODE_INDEX_UNKNOWN
+} OpcodeIndex;
+
+#define OPCODE_MAX_CODE 500              // Highest wire value (OP_ERROR)
+
+#endif //SERVER_OPCODES_H
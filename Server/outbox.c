@@ -0,0 +1,179 @@
+#include <stdlib.h>
+#include <string.h>
+#include "outbox.h"
+#include "bufpool.h"
+
+/**
+ * Gets the length of the frame starting at a buffer offset.
+ *
+ * @param box Outbox
+ * @param offset Logical offset from head of a frame start
+ * @return Frame length including the newline
+ */
+static size_t frame_length_at(const Outbox *box, size_t offset) {
+    size_t start = (box->head + offset) % box->capacity;
+    size_t available = box->length - offset;
+    size_t contiguous = box->capacity - start;
+
+    if (contiguous > available) {
+        contiguous = available;
+    }
+    const char *end = memchr(box->data + start, '\n', contiguous);
+    if (end) {
+        return (size_t)(end - (box->data + start)) + 1;
+    }
+    end = memchr(box->data, '\n', available - contiguous);
+    return contiguous + (size_t)(end - box->data) + 1;
+}
+
+/**
+ * Grows the storage, up to OUTBOX_CAPACITY, until needed bytes fit.
+ * Stored frames move to the front of the new storage.
+ *
+ * @param box Outbox
+ * @param needed Bytes to hold
+ * @return 0 on success, -1 if out of memory
+ */
+static int outbox_grow(Outbox *box, size_t needed) {
+    size_t capacity = box->capacity ? box->capacity : BUFPOOL_BLOCK_SIZE;
+    while (capacity < needed && capacity < OUTBOX_CAPACITY) {
+        capacity *= 2;
+    }
+    if (capacity > OUTBOX_CAPACITY) {
+        capacity = OUTBOX_CAPACITY;
+    }
+    if (capacity == box->capacity) {
+        return 0;
+    }
+
+    char *data = bufpool_alloc(capacity);
+    if (!data) {
+        return -1;
+    }
+    if (box->length > 0) {
+        size_t contiguous = box->capacity - box->head;
+        size_t part = contiguous < box->length ? contiguous : box->length;
+        memcpy(data, box->data + box->head, part);
+        memcpy(data + part, box->data, box->length - part);
+    }
+    bufpool_free(box->data, box->capacity);
+    box->data = data;
+    box->capacity = capacity;
+    box->head = 0;
+    return 0;
+}
+
+/**
+ * Restarts numbering at 1 and drops stored frames; storage is kept.
+ *
+ * @param box Outbox
+ */
+void outbox_reset(Outbox *box) {
+    box->head = 0;
+    box->length = 0;
+    box->first_seq = 1;
+    box->next_seq = 1;
+}
+
+/**
+ * Releases the storage.
+ *
+ * @param box Outbox
+ */
+void outbox_free(Outbox *box) {
+    bufpool_free(box->data, box->capacity);
+    box->data = NULL;
+    box->capacity = 0;
+    outbox_reset(box);
+}
+
+/**
+ * Numbers and stores a frame, evicting the oldest frames as needed.
+ * A frame that cannot be stored (too long, or no memory to grow) is
+ * still numbered, since the client counts it; the stored frames are
+ * dropped so a resume from before it gets a full resync.
+ *
+ * @param box Outbox
+ * @param frame Complete frame ending with its newline
+ * @param length Frame length
+ * @return Number of the frame
+ */
+uint32_t outbox_push(Outbox *box, const char *frame, size_t length) {
+    bool keep = length > 0 && length <= OUTBOX_CAPACITY && frame[length - 1] == '\n';
+    if (keep && box->length + length > box->capacity &&
+        outbox_grow(box, box->length + length) < 0 && length > box->capacity) {
+        keep = false;
+    }
+
+    uint32_t seq = box->next_seq++;
+    if (!keep) {
+        // Cannot be kept; a client that missed it needs a full resync
+        box->head = 0;
+        box->length = 0;
+        box->first_seq = box->next_seq;
+        return seq;
+    }
+
+    while (box->length + length > box->capacity) {
+        size_t evicted = frame_length_at(box, 0);
+        box->head = (box->head + evicted) % box->capacity;
+        box->length -= evicted;
+        box->first_seq++;
+    }
+
+    if (box->length == 0) {
+        box->first_seq = seq;
+    }
+
+    size_t tail = (box->head + box->length) % box->capacity;
+    size_t part = box->capacity - tail < length ? box->capacity - tail : length;
+    memcpy(box->data + tail, frame, part);
+    memcpy(box->data, frame + part, length - part);
+    box->length += length;
+    return seq;
+}
+
+/**
+ * Gets the stored frames numbered after last_seen as up to two segments.
+ *
+ * @param box Outbox
+ * @param last_seen Number of the last frame the client received
+ * @param first First segment
+ * @param first_length Bytes in the first segment
+ * @param second Second segment (after wrapping around)
+ * @param second_length Bytes in the second segment
+ * @return true if every frame after last_seen is still stored
+ */
+bool outbox_since(const Outbox *box, uint32_t last_seen,
+                  const char **first, size_t *first_length,
+                  const char **second, size_t *second_length) {
+    *first = NULL;
+    *second = NULL;
+    *first_length = 0;
+    *second_length = 0;
+
+    // Frames never sent, or evicted since
+    if (last_seen >= box->next_seq || last_seen + 1 < box->first_seq) {
+        return false;
+    }
+
+    size_t skipped = 0;
+    for (uint32_t seq = box->first_seq; seq <= last_seen; seq++) {
+        skipped += frame_length_at(box, skipped);
+    }
+
+    size_t remaining = box->length - skipped;
+    if (remaining == 0) {
+        return true;
+    }
+
+    size_t start = (box->head + skipped) % box->capacity;
+    size_t contiguous = box->capacity - start;
+    *first = box->data + start;
+    *first_length = contiguous < remaining ? contiguous : remaining;
+    if (*first_length < remaining) {
+        *second = box->data;
+        *second_length = remaining - *first_length;
+    }
+    return true;
+}
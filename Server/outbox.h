@@ -0,0 +1,62 @@
+#ifndef SERVER_OUTBOX_H
+#define SERVER_OUTBOX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define OUTBOX_CAPACITY 16384            // Most bytes of recent frames kept per session
+
+/**
+ * Numbered outbound frames of one session, kept so a reconnecting
+ * client can be sent exactly the frames it missed.
+ *
+ * Frames to a logged-in client are numbered from its OP_LOGIN_OK,
+ * which is frame 1; OP_PING, OP_RECONNECT_OK and OP_RECONNECT_FAIL are
+ * not numbered. The client counts the frames it receives the same way
+ * and reports the last number with OP_RECONNECT_REQUEST.
+ *
+ * Storage is a circular byte buffer of whole frames. Frames end with
+ * their newline and contain no other, so no per-frame index is needed.
+ * It starts as a pooled block with the first frame and doubles as
+ * frames accumulate; at OUTBOX_CAPACITY the oldest frames are evicted
+ * when a new one does not fit.
+ */
+typedef struct {
+    char *data;                  // capacity bytes, allocated with the first frame
+    size_t capacity;             // Up to OUTBOX_CAPACITY
+    size_t head;                 // Offset of the oldest stored frame
+    size_t length;               // Bytes stored
+    uint32_t first_seq;          // Number of the oldest stored frame
+    uint32_t next_seq;           // Number the next frame gets
+} Outbox;
+
+/**
+ * Restarts numbering at 1 and drops stored frames; storage is kept.
+ */
+void outbox_reset(Outbox *box);
+
+/**
+ * Releases the storage; the outbox can be reused after outbox_reset.
+ */
+void outbox_free(Outbox *box);
+
+/**
+ * Numbers and stores a frame, evicting the oldest frames as needed.
+ * A frame that cannot be kept (larger than the buffer, or out of memory)
+ * is numbered anyway and drops the stored frames, forcing a full resync.
+ * @return Number of the frame
+ */
+uint32_t outbox_push(Outbox *box, const char *frame, size_t length);
+
+/**
+ * Gets the stored frames numbered after last_seen. The bytes may wrap
+ * around the buffer, so they are returned as up to two segments.
+ * Valid until the next push.
+ * @return true if every frame after last_seen is still stored
+ */
+bool outbox_since(const Outbox *box, uint32_t last_seen,
+                  const char **first, size_t *first_length,
+                  const char **second, size_t *second_length);
+
+#endif //SERVER_OUTBOX_H
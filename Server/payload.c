@@ -0,0 +1,197 @@
+#include <stdbool.h>
+#include "payload.h"
+
+/**
+ * Checks for a character ending the payload.
+ */
+#define PAYLOAD_END(c) ((c) == '\0' || (c) == '\r' || (c) == '\n')
+
+/**
+ * Checks for a blank skipped before numbers (as by %d).
+ */
+#define PAYLOAD_BLANK(c) ((c) == ' ' || (c) == '\t' || (c) == '\v' || (c) == '\f')
+
+/**
+ * Parses a decimal number that must end at a comma or the payload end.
+ *
+ * @param cursor Parse position, advanced past the number
+ * @param min Lowest accepted value
+ * @param max Highest accepted value
+ * @param value Parsed value
+ * @return 0 on success, -1 if not a number in range
+ */
+static int parse_number(const char **cursor, long min, long max, long *value) {
+    const char *p = *cursor;
+    bool negative = false;
+
+    while (PAYLOAD_BLANK(*p)) {
+        p++;
+    }
+    if (*p == '-' || *p == '+') {
+        negative = *p == '-';
+        p++;
+    }
+    if (*p < '0' || *p > '9') {
+        return -1;
+    }
+
+    // Checked after every digit, so the magnitude cannot overflow
+    unsigned long limit = negative ? (unsigned long)-(min < 0 ? min : 0) : (unsigned long)max;
+    unsigned long magnitude = 0;
+    do {
+        magnitude = magnitude * 10 + (unsigned long)(*p++ - '0');
+        if (magnitude > limit) {
+            return -1;
+        }
+    } while (*p >= '0' && *p <= '9');
+
+    if (*p != ',' && !PAYLOAD_END(*p)) {
+        return -1;
+    }
+
+    long parsed = negative ? -(long)magnitude : (long)magnitude;
+    if (parsed < min) {
+        return -1;
+    }
+    *value = parsed;
+    *cursor = p;
+    return 0;
+}
+
+/**
+ * Copies text up to the next comma or the payload end.
+ *
+ * @param cursor Parse position, advanced past the text
+ * @param out Destination buffer
+ * @param size Buffer size
+ * @param min_length Shortest accepted length
+ * @param blanks Whether blanks are accepted
+ * @return 0 on success, -1 if too short, too long or containing a blank
+ */
+static int parse_text(const char **cursor, char *out, size_t size, size_t min_length, bool blanks) {
+    const char *p = *cursor;
+    size_t length = 0;
+
+    while (*p != ',' && !PAYLOAD_END(*p)) {
+        if (length + 1 >= size || (!blanks && PAYLOAD_BLANK(*p))) {
+            return -1;
+        }
+        out[length++] = *p++;
+    }
+    if (length < min_length) {
+        return -1;
+    }
+    out[length] = '\0';
+    *cursor = p;
+    return 0;
+}
+
+/**
+ * Sets a field that was left out to its empty value.
+ *
+ * @param field Field definition
+ * @param args Argument struct
+ */
+static void clear_field(const PayloadField *field, char *args) {
+    switch (field->type) {
+        case FIELD_TEXT:
+        case FIELD_WORD:
+            args[field->offset] = '\0';
+            break;
+        case FIELD_INT:
+            *(int*)(args + field->offset) = 0;
+            break;
+        case FIELD_SEQ:
+            *(uint32_t*)(args + field->offset) = 0;
+            break;
+        case FIELD_INT_LIST:
+            *(int*)(args + field->count_offset) = 0;
+            break;
+    }
+}
+
+/**
+ * Decodes a payload into an argument struct.
+ *
+ * One pass over the payload: each field is parsed in place up to its
+ * comma, copying text straight into the argument struct, and nothing
+ * may follow the last field.
+ *
+ * @param schema Payload layout
+ * @param data Payload
+ * @param args Argument struct the schema describes
+ * @return Fields decoded, -1 if the payload does not match the schema
+ */
+int payload_decode(const PayloadSchema *schema, const char *data, void *args) {
+    char *out = args;
+    const char *p = data;
+    long value;
+
+    for (int decoded = 0; decoded < schema->field_count; decoded++) {
+        const PayloadField *field = &schema->fields[decoded];
+
+        // A field is present after a comma, or at the start unless an
+        // empty payload leaves out every field
+        bool present = decoded > 0 ? *p == ','
+                                   : schema->required > 0 || !PAYLOAD_END(*p);
+        if (!present) {
+            if (decoded < schema->required) {
+                return -1;
+            }
+            for (int i = decoded; i < schema->field_count; i++) {
+                clear_field(&schema->fields[i], out);
+            }
+            return decoded;
+        }
+        if (decoded > 0) {
+            p++;
+        }
+
+        switch (field->type) {
+            case FIELD_TEXT:
+            case FIELD_WORD:
+                if (parse_text(&p, out + field->offset, field->size, (size_t)field->min,
+                               field->type == FIELD_TEXT) < 0) {
+                    return -1;
+                }
+                break;
+
+            case FIELD_INT:
+                if (parse_number(&p, field->min, field->max, &value) < 0) {
+                    return -1;
+                }
+                *(int*)(out + field->offset) = (int)value;
+                break;
+
+            case FIELD_SEQ:
+                if (parse_number(&p, field->min, field->max, &value) < 0) {
+                    return -1;
+                }
+                *(uint32_t*)(out + field->offset) = (uint32_t)value;
+                break;
+
+            case FIELD_INT_LIST: {
+                int *items = (int*)(out + field->offset);
+                size_t count = 0;
+
+                // Takes every remaining field
+                for (;;) {
+                    if (count == field->size ||
+                        parse_number(&p, field->min, field->max, &value) < 0) {
+                        return -1;
+                    }
+                    items[count++] = (int)value;
+                    if (*p != ',') {
+                        break;
+                    }
+                    p++;
+                }
+                *(int*)(out + field->count_offset) = (int)count;
+                return decoded + 1;
+            }
+        }
+    }
+
+    // Trailing fields
+    return *p == ',' ? -1 : schema->field_count;
+}
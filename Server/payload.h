@@ -0,0 +1,66 @@
+#ifndef SERVER_PAYLOAD_H
+#define SERVER_PAYLOAD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define PAYLOAD_MAX_FIELDS 8             // Fields in one schema
+
+/**
+ * Payload field types.
+ */
+typedef enum {
+    FIELD_TEXT,          // char array; min is the shortest accepted length
+    FIELD_WORD,          // Non-empty char array without blanks
+    FIELD_INT,           // Decimal int within min..max
+    FIELD_SEQ,           // Decimal uint32_t (frame numbers)
+    FIELD_INT_LIST       // Decimal ints within min..max, up to the end of the payload
+} PayloadFieldType;
+
+/**
+ * One comma-separated payload field and where it is stored.
+ */
+typedef struct {
+    PayloadFieldType type;
+    size_t offset;                       // Of the value in the argument struct
+    size_t size;                         // FIELD_TEXT: buffer bytes, FIELD_INT_LIST: max items
+    long min;
+    long max;
+    size_t count_offset;                 // FIELD_INT_LIST: int receiving the item count
+} PayloadField;
+
+/**
+ * Layout of an opcode's payload: comma-separated fields decoded into
+ * an argument struct. Fields after the required ones may be left out;
+ * their values are then empty or 0. Without required fields an empty
+ * payload leaves out all of them.
+ */
+typedef struct {
+    int field_count;                     // Fields in the schema
+    int required;                        // Leading fields that must be present
+    PayloadField fields[PAYLOAD_MAX_FIELDS];
+} PayloadSchema;
+
+// Field definitions for PayloadSchema initializers
+#define PAYLOAD_TEXT(type, member, min_length) \
+    { FIELD_TEXT, offsetof(type, member), sizeof(((type*)0)->member), (min_length), 0, 0 }
+#define PAYLOAD_WORD(type, member) \
+    { FIELD_WORD, offsetof(type, member), sizeof(((type*)0)->member), 1, 0, 0 }
+#define PAYLOAD_INT(type, member, lowest, highest) \
+    { FIELD_INT, offsetof(type, member), sizeof(int), (lowest), (highest), 0 }
+#define PAYLOAD_SEQ(type, member) \
+    { FIELD_SEQ, offsetof(type, member), sizeof(uint32_t), 0, UINT32_MAX, 0 }
+#define PAYLOAD_INT_LIST(type, member, count, lowest, highest) \
+    { FIELD_INT_LIST, offsetof(type, member), sizeof(((type*)0)->member) / sizeof(int), \
+      (lowest), (highest), offsetof(type, count) }
+
+/**
+ * Decodes a payload into an argument struct in one pass. The payload
+ * ends at the first CR or LF. Text must fit its buffer, numbers are
+ * decimal with an optional sign and leading blanks, independent of the
+ * locale, and must fill their field.
+ * @return Fields decoded, -1 if the payload does not match the schema
+ */
+int payload_decode(const PayloadSchema *schema, const char *data, void *args);
+
+#endif //SERVER_PAYLOAD_H
@@ -0,0 +1,51 @@
+#ifndef SERVER_PROBES_H
+#define SERVER_PROBES_H
+
+/**
+ * USDT (sdt.h) tracepoints of the "checkers" provider.
+ *
+ * Probes are compiled in when <sys/sdt.h> is available (systemtap-sdt-dev)
+ * and compile to nothing otherwise, or when built with -DCHECKERS_NO_USDT
+ * (make LIMITS="-DCHECKERS_NO_USDT"). A disabled USDT probe is a single nop.
+ *
+ * Probe                      Arguments
+ * frame__received            socket, frame length
+ * parse__done                socket, opcode (0 on failure), parse result
+ * handler__enter             socket, opcode
+ * handler__exit              socket, opcode
+ * move__validated            room, player, valid (1/0), steps
+ * move__applied              room, player, steps
+ * broadcast__sent            room, opcode, recipients
+ * heartbeat__tick            sweep duration (us), clients in use
+ * client__state              client id, old ClientState, new ClientState
+ * client__game_state         client id, old ClientGameState, new ClientGameState
+ * room__state                room, old RoomState, new RoomState
+ *
+ * Example, handler latency per opcode:
+ *   bpftrace -e 'usdt:./checkers_server:checkers:handler__enter { @s[tid] = nsecs; }
+ *                usdt:./checkers_server:checkers:handler__exit /@s[tid]/ {
+ *                    @us[arg1] = hist((nsecs - @s[tid]) / 1000); delete(@s[tid]); }'
+ */
+
+#if !defined(CHECKERS_NO_USDT) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#define CHECKERS_USDT 1
+#endif
+#endif
+
+#ifdef CHECKERS_USDT
+#include <sys/sdt.h>
+#define PROBE1(name, a) DTRACE_PROBE1(checkers, name, a)
+#define PROBE2(name, a, b) DTRACE_PROBE2(checkers, name, a, b)
+#define PROBE3(name, a, b, c) DTRACE_PROBE3(checkers, name, a, b, c)
+#define PROBE4(name, a, b, c, d) DTRACE_PROBE4(checkers, name, a, b, c, d)
+#else
+// Arguments stay type-checked but are never evaluated
+#define PROBE1(name, a) do { (void)sizeof(a); } while (0)
+#define PROBE2(name, a, b) do { (void)sizeof(a); (void)sizeof(b); } while (0)
+#define PROBE3(name, a, b, c) do { (void)sizeof(a); (void)sizeof(b); (void)sizeof(c); } while (0)
+#define PROBE4(name, a, b, c, d) \
+    do { (void)sizeof(a); (void)sizeof(b); (void)sizeof(c); (void)sizeof(d); } while (0)
+#endif
+
+#endif //SERVER_PROBES_H
@@ -41,14 +41,106 @@ const char* get_disconnect_reason_string(DisconnectReason reason) {
     }
 }
 
+// ========== OPCODE TABLE ==========
+
+_Static_assert(OPCODE_COUNT <= 256, "dense opcode index must fit in a byte");
+
+/**
+ * Dense index of every wire value; unlisted values stay OPCODE_INDEX_UNKNOWN.
+ */
+static const unsigned char dense_index[OPCODE_MAX_CODE + 1] = {
+#define OPCODE_DENSE_ENTRY(name, code, states, payload) [code] = OPCODE_INDEX_##name,
+    OPCODE_LIST(OPCODE_DENSE_ENTRY)
+#undef OPCODE_DENSE_ENTRY
+};
+
+/**
+ * Opcode metadata by dense index.
+ */
+static const struct {
+    OpCode op;
+    const char *name;
+    unsigned int states;
+    const char *payload;
+} opcode_info[OPCODE_COUNT] = {
+    [OPCODE_INDEX_UNKNOWN] = {0, "OTHER", OPS_NONE, ""},
+#define OPCODE_INFO_ENTRY(name, code, states, payload) \
+    [OPCODE_INDEX_##name] = {OP_##name, #name, states, payload},
+    OPCODE_LIST(OPCODE_INFO_ENTRY)
+#undef OPCODE_INFO_ENTRY
+};
+
+/**
+ * Maps a wire opcode to its dense index.
+ *
+ * @param op Operation code from the wire
+ * @return Dense index, OPCODE_INDEX_UNKNOWN if op is not a protocol opcode
+ */
+int opcode_index(int op) {
+    return (op >= 0 && op <= OPCODE_MAX_CODE) ? dense_index[op] : OPCODE_INDEX_UNKNOWN;
+}
+
+/**
+ * Gets the opcode at a dense index.
+ *
+ * @param index Dense index
+ * @return Operation code, 0 for OPCODE_INDEX_UNKNOWN or out of range
+ */
+OpCode opcode_at(int index) {
+    return (index > 0 && index < OPCODE_COUNT) ? opcode_info[index].op : 0;
+}
+
+/**
+ * Gets the name of the opcode at a dense index.
+ *
+ * @param index Dense index
+ * @return Name without the OP_ prefix, "OTHER" for unknown
+ */
+const char* opcode_name(int index) {
+    return (index > 0 && index < OPCODE_COUNT) ? opcode_info[index].name : "OTHER";
+}
+
+/**
+ * Prints the protocol reference as a Markdown table: wire value, name,
+ * client states allowed to send it ("-" if no client may) and
+ * payload format.
+ *
+ * @param out Output stream
+ */
+void protocol_print_opcodes(FILE *out) {
+    static const struct { unsigned int bit; const char *label; } states[] = {
+        {OPS_NOT_LOGGED_IN, "login"}, {OPS_LOBBY, "lobby"},
+        {OPS_WAITING, "waiting"}, {OPS_GAME, "game"}
+    };
+
+    fprintf(out, "| Code | Opcode | Client may send in | Payload |\n");
+    fprintf(out, "|------|--------|--------------------|---------|\n");
+    for (int i = 1; i < OPCODE_COUNT; i++) {
+        char allowed[64] = "-";
+        if (opcode_info[i].states != OPS_NONE) {
+            size_t pos = 0;
+            allowed[0] = '\0';
+            for (size_t s = 0; s < sizeof(states) / sizeof(states[0]); s++) {
+                if (opcode_info[i].states & states[s].bit) {
+                    pos += snprintf(allowed + pos, sizeof(allowed) - pos, "%s%s",
+                                    pos ? ", " : "", states[s].label);
+                }
+            }
+        }
+        fprintf(out, "| %d | OP_%s | %s | %s |\n", (int)opcode_info[i].op,
+                opcode_info[i].name, allowed,
+                opcode_info[i].payload[0] ? opcode_info[i].payload : "(empty)");
+    }
+}
+
 /**
- * Validates if operation code is within valid range.
+ * Validates if operation code is a protocol opcode.
  *
  * @param op Operation code to validate
  * @return true if valid, false otherwise
  */
 bool is_valid_opcode(int op) {
-    return (op >= OP_LOGIN && op <= OP_GAME_RESUMED) || op == OP_ERROR;
+    return opcode_index(op) != OPCODE_INDEX_UNKNOWN;
 }
 
 /**
@@ -207,7 +299,7 @@ int parse_message(const char *buffer, Message *msg, DisconnectReason *disconnect
         return -1;
     }
 
-    // Extract DATA field
+    // DATA field stays in the frame
     ptr = next_pipe + 1;
     int data_len = strlen(ptr);
     if (data_len > MAX_DATA_LEN - 1) {
@@ -217,11 +309,7 @@ int parse_message(const char *buffer, Message *msg, DisconnectReason *disconnect
         return -1;
     }
 
-
-
-    strncpy(msg->data, ptr, MAX_DATA_LEN - 1);
-    msg->data[MAX_DATA_LEN - 1] = '\0';
-
+    msg->data = ptr;
 
     // printf("Message data %s",msg->data);
     // printf("\n");
@@ -236,17 +324,31 @@ int parse_message(const char *buffer, Message *msg, DisconnectReason *disconnect
  *
  * Format: DENTCP|OP|LEN|DATA\n
  *
- * @param buffer Output buffer to write message to
+ * @param buffer Output buffer of MAX_MESSAGE_LEN bytes
  * @param op Operation code
  * @param data Message payload (NULL for empty data)
  * @return Number of bytes written, or -1 on error
  */
 int create_message(char *buffer, OpCode op, const char *data) {
+    return format_message(buffer, MAX_MESSAGE_LEN, op, data);
+}
+
+/**
+ * Creates a protocol message in a buffer of the given size.
+ * Messages of MAX_MESSAGE_LEN bytes or more are refused whatever the size.
+ *
+ * @param buffer Output buffer
+ * @param size Buffer size, see message_frame_size
+ * @param op Operation code
+ * @param data Message payload (NULL for empty data)
+ * @return Number of bytes written, or -1 on error
+ */
+int format_message(char *buffer, size_t size, OpCode op, const char *data) {
     int data_len = data ? strlen(data) : 0;
-    int written = snprintf(buffer, MAX_MESSAGE_LEN, "%s|%02d|%04d|%s\n",
+    int written = snprintf(buffer, size, "%s|%02d|%04d|%s\n",
                           PREFIX, op, data_len, data ? data : "");
 
-    if (written >= MAX_MESSAGE_LEN) {
+    if (written < 0 || (size_t)written >= size || written >= MAX_MESSAGE_LEN) {
         fprintf(stderr, "Message too long\n");
         return -1;
     }
@@ -254,6 +356,37 @@ int create_message(char *buffer, OpCode op, const char *data) {
     return written;
 }
 
+/**
+ * Counts the decimal digits of a field printed with a minimum width.
+ *
+ * @param value Non-negative field value
+ * @param width Minimum width (zero padded)
+ * @return Characters printed
+ */
+static size_t field_width(size_t value, size_t width) {
+    size_t digits = 1;
+    while (value >= 10) {
+        value /= 10;
+        digits++;
+    }
+    return digits > width ? digits : width;
+}
+
+/**
+ * Gets the buffer size format_message needs for a message, so the
+ * buffer can be sized to the message instead of MAX_MESSAGE_LEN.
+ *
+ * @param op Operation code
+ * @param data Message payload (NULL for empty data)
+ * @return Bytes needed, including the terminating NUL
+ */
+size_t message_frame_size(OpCode op, const char *data) {
+    size_t data_len = data ? strlen(data) : 0;
+    // PREFIX|OP|LEN|DATA\n and the NUL
+    return PREFIX_LEN + 1 + field_width((size_t)op, 2) + 1 +
+           field_width(data_len, 4) + 1 + data_len + 2;
+}
+
 /**
  * Logs a parsed message for debugging.
  *
@@ -8,69 +8,34 @@
 #include <stdbool.h>
 #include <time.h>
 #include <ctype.h>
+#include <stdio.h>
+#include "opcodes.h"
 
 // Protocol constants
 #define PREFIX "DENTCP"              // Protocol identifier prefix
 #define PREFIX_LEN 6                 // Length of prefix string
 #define MAX_MESSAGE_LEN 8192         // Maximum total message length
 #define MAX_DATA_LEN (MAX_MESSAGE_LEN - PREFIX_LEN - 7) // Max payload size
+#define SESSION_TOKEN_LEN 32         // Hex digits of a session token (OP_LOGIN_OK)
 
 /**
- * Protocol operation codes.
- * Defines all supported client-server operations.
+ * Protocol operation codes, generated from OPCODE_LIST (opcodes.h).
  */
 typedef enum {
-    // Authentication
-    OP_LOGIN = 1,
-    OP_LOGIN_OK = 2,
-    OP_LOGIN_FAIL = 3,
-
-    // Room management
-    OP_CREATE_ROOM = 4,
-    OP_JOIN_ROOM = 5,
-    OP_ROOM_JOINED = 6,
-    OP_ROOM_FULL = 7,
-    OP_ROOM_FAIL = 8,
-    OP_ROOM_CREATED = 20,
-    OP_LEAVE_ROOM = 14,
-    OP_ROOM_LEFT = 15,
-    OP_LIST_ROOMS = 18,
-    OP_ROOMS_LIST = 19,
-
-    // Game flow
-    OP_GAME_START = 9,
-    OP_MOVE = 10,
-    OP_MULTI_MOVE = 21,
-    OP_INVALID_MOVE = 11,
-    OP_GAME_STATE = 12,
-    OP_GAME_END = 13,
-    OP_GAME_PAUSED = 28,
-    OP_GAME_RESUMED = 29,
-
-    // Connection monitoring
-    OP_PING = 16,
-    OP_PONG = 17,
-
-    // Reconnection
-    OP_PLAYER_DISCONNECTED = 22,
-    OP_PLAYER_RECONNECTING = 23,
-    OP_PLAYER_RECONNECTED = 24,
-    OP_RECONNECT_REQUEST = 25,
-    OP_RECONNECT_OK = 26,
-    OP_RECONNECT_FAIL = 27,
-
-    // Error handling
-    OP_ERROR = 500
+#define OPCODE_ENUM_ENTRY(name, code, states, payload) OP_##name = code,
+    OPCODE_LIST(OPCODE_ENUM_ENTRY)
+#undef OPCODE_ENUM_ENTRY
 } OpCode;
 
 /**
  * Parsed message structure.
- * Represents a complete protocol message after parsing.
+ * Represents a complete protocol message after parsing. The payload is
+ * not copied: data points into the parsed frame, which must outlive it.
  */
 typedef struct {
     OpCode op;              // Operation code
     int len;                // Data length
-    char data[MAX_DATA_LEN]; // Message payload
+    const char *data;       // Message payload, NUL-terminated with the frame
 } Message;
 
 /**
@@ -88,6 +53,8 @@ typedef enum {
     DISCONNECT_REASON_SUSPICIOUS_ACTIVITY  // Pattern of malicious behavior
 } DisconnectReason;
 
+#define DISCONNECT_REASON_COUNT (DISCONNECT_REASON_SUSPICIOUS_ACTIVITY + 1)
+
 /**
  * Client protocol violation tracking.
  * Tracks repeated violations to detect malicious clients.
@@ -113,6 +80,16 @@ int parse_message(const char *buffer, Message *msg, DisconnectReason *disconnect
  */
 int create_message(char *buffer, OpCode op, const char *data);
 
+/**
+ * Creates protocol message in a buffer of the given size.
+ */
+int format_message(char *buffer, size_t size, OpCode op, const char *data);
+
+/**
+ * Gets the buffer size format_message needs for a message, including the NUL.
+ */
+size_t message_frame_size(OpCode op, const char *data);
+
 /**
  * Logs message for debugging.
  */
@@ -123,6 +100,26 @@ void log_message(const char *prefix, const Message *msg);
  */
 bool is_valid_opcode(int op);
 
+/**
+ * Maps a wire opcode to its dense index (OPCODE_INDEX_UNKNOWN if invalid).
+ */
+int opcode_index(int op);
+
+/**
+ * Gets the opcode at a dense index.
+ */
+OpCode opcode_at(int index);
+
+/**
+ * Gets the name (without OP_) of the opcode at a dense index.
+ */
+const char* opcode_name(int index);
+
+/**
+ * Prints the protocol reference generated from OPCODE_LIST.
+ */
+void protocol_print_opcodes(FILE *out);
+
 /**
  * Checks if string contains only numeric characters.
  */
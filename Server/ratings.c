@@ -0,0 +1,450 @@
+#include <fcntl.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "leaderboard.h"
+#include "ratings.h"
+
+/**
+ * Ratings file header, followed by RATINGS_CAPACITY records.
+ */
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t record_size;                // sizeof(RatingRecord) when written
+    uint32_t capacity;
+    uint32_t count;                      // Records in use, filled from the start
+    uint32_t reserved[3];
+} RatingsHeader;
+
+#define RATINGS_MAP_SIZE (sizeof(RatingsHeader) + (size_t)RATINGS_CAPACITY * sizeof(RatingRecord))
+
+static RatingsHeader *store;             // Mapped header, NULL until opened or first used
+static RatingRecord *records;            // Mapped records, following the header
+static bool store_is_file;               // Mapped from a file rather than anonymous memory
+static uint32_t name_index[RATINGS_INDEX_SIZE]; // Name -> record + 1 (linear probing, 0 = empty)
+static uint32_t id_records[SYMTAB_CAPACITY];    // Player ID -> record + 1, checked by name on use
+static bool full_reported;
+static pthread_mutex_t ratings_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Finds the index slot holding a name, or the empty slot ending its
+ * probe chain (FNV-1a). Caller holds ratings_mutex.
+ *
+ * @param name Player name
+ * @return Slot index
+ */
+static size_t ratings_find_slot(const char *name) {
+    uint32_t hash = 2166136261u;
+    for (const char *p = name; *p; p++) {
+        hash = (hash ^ (unsigned char)*p) * 16777619u;
+    }
+
+    size_t slot = hash % RATINGS_INDEX_SIZE;
+    while (name_index[slot] && strcmp(records[name_index[slot] - 1].name, name) != 0) {
+        slot = (slot + 1) % RATINGS_INDEX_SIZE;
+    }
+    return slot;
+}
+
+/**
+ * Reports once that the store has no room for new players.
+ * Caller holds ratings_mutex.
+ */
+static void ratings_report_full(void) {
+    if (!full_reported) {
+        fprintf(stderr, "Ratings store full (%d players), new players stay unrated\n",
+                RATINGS_CAPACITY);
+        full_reported = true;
+    }
+}
+
+/**
+ * Places a record on the leaderboard, reporting a failure: the
+ * leaderboard then lacks the player until their next rated game.
+ * Caller holds ratings_mutex.
+ *
+ * @param index Record index
+ * @param rating Record's rating
+ */
+static void ratings_rank_record(uint32_t index, int rating) {
+    if (leaderboard_set(index, rating) < 0) {
+        fprintf(stderr, "Leaderboard out of memory, %s not ranked at %d\n",
+                records[index].name, rating);
+    }
+}
+
+/**
+ * Installs a mapped store and indexes its records by name and rating.
+ * Caller holds ratings_mutex.
+ *
+ * @param map Mapping of RATINGS_MAP_SIZE bytes with a valid header
+ * @param is_file Whether the mapping is backed by a file
+ */
+static void ratings_install(void *map, bool is_file) {
+    store = map;
+    records = (RatingRecord*)(store + 1);
+    store_is_file = is_file;
+    store->capacity = RATINGS_CAPACITY;
+    full_reported = false;
+
+    memset(name_index, 0, sizeof(name_index));
+    memset(id_records, 0, sizeof(id_records));
+    for (uint32_t i = 0; i < store->count; i++) {
+        records[i].name[MAX_PLAYER_NAME - 1] = '\0';
+        name_index[ratings_find_slot(records[i].name)] = i + 1;
+        ratings_rank_record(i, records[i].rating);
+    }
+}
+
+/**
+ * Unmaps the store, writing a file back first.
+ * Caller holds ratings_mutex.
+ */
+static void ratings_unmap(void) {
+    if (!store) {
+        return;
+    }
+    if (store_is_file) {
+        msync(store, RATINGS_MAP_SIZE, MS_SYNC);
+    }
+    munmap(store, RATINGS_MAP_SIZE);
+    store = NULL;
+    records = NULL;
+    leaderboard_clear();
+}
+
+/**
+ * Writes a fresh header.
+ *
+ * @param header Header to fill
+ */
+static void ratings_init_header(RatingsHeader *header) {
+    memcpy(header->magic, RATINGS_MAGIC, 4);
+    header->version = RATINGS_VERSION;
+    header->record_size = sizeof(RatingRecord);
+    header->capacity = RATINGS_CAPACITY;
+    header->count = 0;
+}
+
+/**
+ * Maps an in-memory store if no file was opened.
+ * Caller holds ratings_mutex.
+ *
+ * @return true if a store is mapped
+ */
+static bool ratings_ensure_store(void) {
+    if (store) {
+        return true;
+    }
+
+    void *map = mmap(NULL, RATINGS_MAP_SIZE, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (map == MAP_FAILED) {
+        perror("Ratings mmap failed");
+        return false;
+    }
+    ratings_init_header(map);
+    ratings_install(map, false);
+    return true;
+}
+
+/**
+ * Maps a ratings file, creating it if missing.
+ *
+ * The file is a header followed by fixed-size records in the order
+ * players got their first result. The mapping is shared, so an update
+ * is a store into the record, written back by the kernel.
+ *
+ * @param path Path to the ratings file
+ * @return 0 on success, -1 on failure
+ */
+int ratings_open(const char *path) {
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        perror("Ratings open failed");
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        perror("Ratings stat failed");
+        close(fd);
+        return -1;
+    }
+
+    RatingsHeader header;
+    bool fresh = st.st_size == 0;
+    if (fresh) {
+        ratings_init_header(&header);
+    } else if (pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+               memcmp(header.magic, RATINGS_MAGIC, 4) != 0 ||
+               header.version != RATINGS_VERSION ||
+               header.record_size != sizeof(RatingRecord) ||
+               header.count > RATINGS_CAPACITY ||
+               (size_t)st.st_size < sizeof(RatingsHeader) + (size_t)header.count * sizeof(RatingRecord)) {
+        fprintf(stderr, "Ratings file %s has invalid header\n", path);
+        close(fd);
+        return -1;
+    }
+
+    if ((size_t)st.st_size < RATINGS_MAP_SIZE && ftruncate(fd, RATINGS_MAP_SIZE) < 0) {
+        perror("Ratings resize failed");
+        close(fd);
+        return -1;
+    }
+
+    void *map = mmap(NULL, RATINGS_MAP_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror("Ratings mmap failed");
+        return -1;
+    }
+    if (fresh) {
+        memcpy(map, &header, sizeof(header));
+    }
+
+    pthread_mutex_lock(&ratings_mutex);
+    ratings_unmap();
+    ratings_install(map, true);
+    uint32_t count = store->count;
+    pthread_mutex_unlock(&ratings_mutex);
+
+    printf("Ratings loaded: %s (%u players)\n", path, count);
+    return 0;
+}
+
+/**
+ * Writes the ratings file back and unmaps it.
+ */
+void ratings_close(void) {
+    pthread_mutex_lock(&ratings_mutex);
+    ratings_unmap();
+    pthread_mutex_unlock(&ratings_mutex);
+}
+
+/**
+ * Finds a player's record. The record found for an ID is cached and
+ * used while the ID still names the same player, so a lookup is one
+ * name comparison. Caller holds ratings_mutex.
+ *
+ * @param player Interned player
+ * @param create Whether to add a record for a player without one
+ * @return Record index, -1 if none
+ */
+static int ratings_find_record(PlayerId player, bool create) {
+    if (player == PLAYER_NONE || !ratings_ensure_store()) {
+        return -1;
+    }
+
+    const char *name = symtab_name(player);
+    uint32_t cached = id_records[player];
+    if (cached && strcmp(records[cached - 1].name, name) == 0) {
+        return (int)cached - 1;
+    }
+
+    size_t slot = ratings_find_slot(name);
+    uint32_t index = name_index[slot];
+    if (!index) {
+        if (!create) {
+            return -1;
+        }
+        if (store->count >= RATINGS_CAPACITY) {
+            ratings_report_full();
+            return -1;
+        }
+
+        RatingRecord *record = &records[store->count];
+        memset(record, 0, sizeof(RatingRecord));
+        strncpy(record->name, name, MAX_PLAYER_NAME - 1);
+        record->rating = RATING_INITIAL;
+        // Counted once written, so a crash never leaves a half-written record in use
+        index = ++store->count;
+        name_index[slot] = index;
+    }
+
+    id_records[player] = index;
+    return (int)index - 1;
+}
+
+/**
+ * Gets a player's rating.
+ *
+ * @param player Interned player
+ * @return Rating, RATING_INITIAL for a player without games
+ */
+int ratings_get(PlayerId player) {
+    pthread_mutex_lock(&ratings_mutex);
+    int index = ratings_find_record(player, false);
+    int rating = index >= 0 ? records[index].rating : RATING_INITIAL;
+    pthread_mutex_unlock(&ratings_mutex);
+    return rating;
+}
+
+/**
+ * Gets a player's record.
+ *
+ * @param player Interned player
+ * @param record Copy of the record
+ * @return 0 if the player has one, -1 if not
+ */
+int ratings_lookup(PlayerId player, RatingRecord *record) {
+    pthread_mutex_lock(&ratings_mutex);
+    int index = ratings_find_record(player, false);
+    if (index >= 0) {
+        *record = records[index];
+    }
+    pthread_mutex_unlock(&ratings_mutex);
+    return index >= 0 ? 0 : -1;
+}
+
+/**
+ * Gets the K-factor of a player: larger for the first games, so a new
+ * player's rating moves quickly towards their strength.
+ *
+ * @param record Player's record
+ * @return K-factor
+ */
+static int ratings_k_factor(const RatingRecord *record) {
+    uint32_t games = record->wins + record->losses + record->draws;
+    return games < RATING_PROVISIONAL_GAMES ? RATING_K_PROVISIONAL : RATING_K_FACTOR;
+}
+
+/**
+ * Applies a rating change, keeping the rating above the floor.
+ *
+ * @param record Player's record
+ * @param delta Rating change
+ */
+static void ratings_apply(RatingRecord *record, int delta) {
+    record->rating += delta;
+    if (record->rating < RATING_FLOOR) {
+        record->rating = RATING_FLOOR;
+    }
+}
+
+/**
+ * Updates both players' ratings with the result of a finished game (Elo).
+ *
+ * @param player1 First player
+ * @param player2 Second player
+ * @param result Result for player 1
+ */
+void ratings_record_game(PlayerId player1, PlayerId player2, RatingResult result) {
+    if (player1 == player2 || player1 == PLAYER_NONE || player2 == PLAYER_NONE) {
+        return;
+    }
+
+    pthread_mutex_lock(&ratings_mutex);
+    // Both records or neither: a record created for one player alone would
+    // hold a slot without ever reaching the leaderboard
+    int index1 = ratings_find_record(player1, false);
+    int index2 = ratings_find_record(player2, false);
+    uint32_t missing = (index1 < 0) + (index2 < 0);
+    if (!store || (missing > 0 && store->count + missing > RATINGS_CAPACITY)) {
+        if (store) {
+            ratings_report_full();
+        }
+        pthread_mutex_unlock(&ratings_mutex);
+        return;
+    }
+    if (index1 < 0) {
+        index1 = ratings_find_record(player1, true);
+    }
+    if (index2 < 0) {
+        index2 = ratings_find_record(player2, true);
+    }
+    if (index1 < 0 || index2 < 0) {
+        pthread_mutex_unlock(&ratings_mutex);
+        return;
+    }
+
+    RatingRecord *record1 = &records[index1];
+    RatingRecord *record2 = &records[index2];
+    double expected1 = 1.0 / (1.0 + pow(10.0, (record2->rating - record1->rating) / 400.0));
+    double score1 = result / 2.0;
+    int delta1 = (int)lround(ratings_k_factor(record1) * (score1 - expected1));
+    int delta2 = (int)lround(ratings_k_factor(record2) * (expected1 - score1));
+
+    ratings_apply(record1, delta1);
+    ratings_apply(record2, delta2);
+    ratings_rank_record((uint32_t)index1, record1->rating);
+    ratings_rank_record((uint32_t)index2, record2->rating);
+    if (result == RATING_RESULT_WIN) {
+        record1->wins++;
+        record2->losses++;
+    } else if (result == RATING_RESULT_LOSS) {
+        record1->losses++;
+        record2->wins++;
+    } else {
+        record1->draws++;
+        record2->draws++;
+    }
+
+    printf("Ratings updated: %s %d (%+d), %s %d (%+d)\n",
+           record1->name, record1->rating, delta1, record2->name, record2->rating, delta2);
+    pthread_mutex_unlock(&ratings_mutex);
+}
+
+/**
+ * Gets a player's leaderboard rank.
+ *
+ * @param player Interned player
+ * @param record Copy of the player's record, if ranked
+ * @return Rank from 1, 0 if the player has no games
+ */
+int ratings_rank(PlayerId player, RatingRecord *record) {
+    pthread_mutex_lock(&ratings_mutex);
+    int index = ratings_find_record(player, false);
+    int rank = index >= 0 ? leaderboard_rank((uint32_t)index) : 0;
+    if (rank > 0) {
+        *record = records[index];
+    }
+    pthread_mutex_unlock(&ratings_mutex);
+    return rank;
+}
+
+/**
+ * Copies the records from a leaderboard rank on, in rank order, without
+ * visiting the players ranked above.
+ *
+ * @param first_rank Rank of the first record, from 1
+ * @param page Destination
+ * @param max_records Capacity of page
+ * @return Records written
+ */
+int ratings_leaderboard(int first_rank, RatingRecord *page, int max_records) {
+    LeaderboardEntry entries[64];
+    int count = 0;
+
+    pthread_mutex_lock(&ratings_mutex);
+    while (count < max_records) {
+        int wanted = max_records - count < 64 ? max_records - count : 64;
+        int found = leaderboard_page(first_rank + count, entries, wanted);
+        for (int i = 0; i < found; i++) {
+            page[count + i] = records[entries[i].id];
+        }
+        count += found;
+        if (found < wanted) {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&ratings_mutex);
+    return count;
+}
+
+/**
+ * Gets the number of players with a rating.
+ *
+ * @return Rated players
+ */
+int ratings_count(void) {
+    pthread_mutex_lock(&ratings_mutex);
+    int count = leaderboard_size();
+    pthread_mutex_unlock(&ratings_mutex);
+    return count;
+}
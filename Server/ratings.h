@@ -0,0 +1,89 @@
+#ifndef SERVER_RATINGS_H
+#define SERVER_RATINGS_H
+
+#include <stdint.h>
+#include "game.h"
+#include "symtab.h"
+
+#define RATINGS_MAGIC "CKRT"
+#define RATINGS_VERSION 1
+#ifndef RATINGS_CAPACITY
+#define RATINGS_CAPACITY 65536           // Players the store holds
+#endif
+#define RATINGS_INDEX_SIZE (2 * RATINGS_CAPACITY) // Name index slots, at most half used
+
+#define RATING_INITIAL 1500              // Rating of a player without games
+#define RATING_FLOOR 100                 // Lowest rating
+#define RATING_K_FACTOR 24               // Elo K-factor
+#define RATING_K_PROVISIONAL 48          // K-factor for a player's first games
+#define RATING_PROVISIONAL_GAMES 20      // Games played at the provisional K-factor
+
+/**
+ * Result of a game from player 1's point of view.
+ */
+typedef enum {
+    RATING_RESULT_LOSS,
+    RATING_RESULT_DRAW,
+    RATING_RESULT_WIN
+} RatingResult;
+
+/**
+ * Player's record in the ratings file, fixed size so a player's record
+ * is updated in place.
+ */
+typedef struct {
+    char name[MAX_PLAYER_NAME];
+    int32_t rating;
+    uint32_t wins;
+    uint32_t losses;
+    uint32_t draws;
+} RatingRecord;
+
+/**
+ * Maps a ratings file, creating it if missing, so ratings survive
+ * restarts. Without one ratings are kept in memory.
+ * @return 0 on success, -1 on failure
+ */
+int ratings_open(const char *path);
+
+/**
+ * Writes the ratings file back and unmaps it.
+ */
+void ratings_close(void);
+
+/**
+ * Gets a player's rating.
+ * @return Rating, RATING_INITIAL for a player without games
+ */
+int ratings_get(PlayerId player);
+
+/**
+ * Gets a player's record.
+ * @return 0 if the player has one, -1 if not
+ */
+int ratings_lookup(PlayerId player, RatingRecord *record);
+
+/**
+ * Updates both players' ratings with the result of a finished game.
+ */
+void ratings_record_game(PlayerId player1, PlayerId player2, RatingResult result);
+
+/**
+ * Gets a player's leaderboard rank, highest rating first.
+ * @param record Copy of the player's record, if ranked
+ * @return Rank from 1, 0 if the player has no games
+ */
+int ratings_rank(PlayerId player, RatingRecord *record);
+
+/**
+ * Copies the records from a leaderboard rank on, in rank order.
+ * @return Records written
+ */
+int ratings_leaderboard(int first_rank, RatingRecord *page, int max_records);
+
+/**
+ * Gets the number of players with a rating.
+ */
+int ratings_count(void);
+
+#endif //SERVER_RATINGS_H
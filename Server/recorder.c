@@ -0,0 +1,205 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "recorder.h"
+
+static FILE *capture = NULL;
+static char *capture_buffer = NULL;
+static pthread_mutex_t capture_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t dispatch_mutex = PTHREAD_MUTEX_INITIALIZER; // Serializes input handling
+static atomic_bool capturing = false;
+static atomic_bool serializing = false;
+static __thread bool dispatch_held = false;
+static uint64_t capture_start_ns = 0;
+static uint32_t next_connection = 1;
+static uint32_t next_record = 1;
+static __thread uint32_t current_cause = 0;      // Last input record handled by this thread
+static uint32_t connection_ids[RECORDER_MAX_FDS]; // Socket -> current connection id
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * Appends one record under the capture lock.
+ * Connection ids are looked up under the same lock so a record never
+ * pairs a reused socket with the previous connection's id. Input records
+ * become the cause of everything this thread sends until its next input.
+ *
+ * @param socket Client socket
+ * @param direction Record direction
+ * @param payload Frame bytes (NULL for OPEN/CLOSE)
+ * @param length Payload length
+ */
+static void write_record(int socket, CaptureDirection direction,
+                         const char *payload, size_t length) {
+    if ((direction == CAPTURE_IN || direction == CAPTURE_CLOSE) && !dispatch_held &&
+        atomic_load_explicit(&serializing, memory_order_relaxed)) {
+        pthread_mutex_lock(&dispatch_mutex);
+        dispatch_held = true;
+    }
+
+    if (socket < 0 || socket >= RECORDER_MAX_FDS ||
+        !atomic_load_explicit(&capturing, memory_order_relaxed)) {
+        return;
+    }
+
+    pthread_mutex_lock(&capture_mutex);
+
+    if (!capture) {
+        pthread_mutex_unlock(&capture_mutex);
+        return;
+    }
+
+    if (direction == CAPTURE_OPEN) {
+        connection_ids[socket] = next_connection++;
+    }
+
+    uint32_t connection = connection_ids[socket];
+    if (connection != 0) {
+        CaptureRecord record;
+        memset(&record, 0, sizeof(record));
+        record.timestamp_ns = monotonic_ns() - capture_start_ns;
+        record.connection = connection;
+        record.cause = direction == CAPTURE_OUT ? current_cause : 0;
+        record.length = (uint16_t)(length > UINT16_MAX ? UINT16_MAX : length);
+        record.direction = (uint8_t)direction;
+
+        fwrite(&record, sizeof(record), 1, capture);
+        if (record.length > 0) {
+            fwrite(payload, 1, record.length, capture);
+        }
+
+        if (direction != CAPTURE_OUT) {
+            current_cause = next_record;
+        }
+        next_record++;
+    }
+
+    if (direction == CAPTURE_CLOSE) {
+        connection_ids[socket] = 0;
+    }
+
+    pthread_mutex_unlock(&capture_mutex);
+}
+
+/**
+ * Opens a capture file and writes its header.
+ *
+ * @param path Output file path
+ * @return 0 on success, -1 on failure
+ */
+int recorder_open(const char *path) {
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        perror("Failed to open capture file");
+        return -1;
+    }
+
+    capture_buffer = malloc(RECORDER_BUFFER_SIZE);
+    if (capture_buffer) {
+        setvbuf(file, capture_buffer, _IOFBF, RECORDER_BUFFER_SIZE);
+    }
+
+    CaptureHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CAPTURE_MAGIC, sizeof(header.magic));
+    header.version = CAPTURE_VERSION;
+
+    if (fwrite(&header, sizeof(header), 1, file) != 1) {
+        perror("Failed to write capture header");
+        fclose(file);
+        free(capture_buffer);
+        capture_buffer = NULL;
+        return -1;
+    }
+
+    pthread_mutex_lock(&capture_mutex);
+    capture = file;
+    capture_start_ns = monotonic_ns();
+    pthread_mutex_unlock(&capture_mutex);
+    recorder_serialize();
+    atomic_store(&capturing, true);
+
+    printf("Recording traffic to %s\n", path);
+    return 0;
+}
+
+/**
+ * Flushes and closes the capture file.
+ */
+void recorder_close(void) {
+    atomic_store(&capturing, false);
+    pthread_mutex_lock(&capture_mutex);
+    if (capture) {
+        fclose(capture);
+        capture = NULL;
+        free(capture_buffer);
+        capture_buffer = NULL;
+        printf("Capture closed (%u connections)\n", next_connection - 1);
+    }
+    pthread_mutex_unlock(&capture_mutex);
+}
+
+/**
+ * Handles client inputs one at a time, also without a capture file.
+ * Used for replay targets so each input sees the recorded state.
+ */
+void recorder_serialize(void) {
+    atomic_store(&serializing, true);
+}
+
+/**
+ * Assigns a new connection id to an accepted socket and records OPEN.
+ *
+ * @param socket Accepted socket
+ */
+void recorder_connection_opened(int socket) {
+    write_record(socket, CAPTURE_OPEN, NULL, 0);
+}
+
+/**
+ * Records that the client closed its connection.
+ *
+ * @param socket Client socket
+ */
+void recorder_connection_closed(int socket) {
+    write_record(socket, CAPTURE_CLOSE, NULL, 0);
+}
+
+/**
+ * Records a complete inbound frame.
+ *
+ * @param socket Client socket
+ * @param frame Raw frame including the newline
+ * @param length Frame length
+ */
+void recorder_frame_in(int socket, const char *frame, size_t length) {
+    write_record(socket, CAPTURE_IN, frame, length);
+}
+
+/**
+ * Ends handling of this thread's last input and lets the next one start.
+ */
+void recorder_input_done(void) {
+    if (dispatch_held) {
+        dispatch_held = false;
+        pthread_mutex_unlock(&dispatch_mutex);
+    }
+}
+
+/**
+ * Records an outbound frame.
+ *
+ * @param socket Client socket
+ * @param frame Raw frame including the newline
+ * @param length Frame length
+ */
+void recorder_frame_out(int socket, const char *frame, size_t length) {
+    write_record(socket, CAPTURE_OUT, frame, length);
+}
@@ -0,0 +1,99 @@
+#ifndef SERVER_RECORDER_H
+#define SERVER_RECORDER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define CAPTURE_MAGIC "DNTCAP1"          // 8 bytes including terminator
+#define CAPTURE_VERSION 1
+#define RECORDER_MAX_FDS 65536           // Sockets above this descriptor are not recorded
+#define RECORDER_BUFFER_SIZE (1 << 20)   // stdio buffer of the capture file
+
+/**
+ * Capture file layout (host byte order):
+ * CaptureHeader, then CaptureRecord entries each followed by
+ * `length` payload bytes (the raw frame including its newline).
+ */
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+} CaptureHeader;
+
+/**
+ * Direction of a capture record.
+ */
+typedef enum {
+    CAPTURE_OPEN = 0,            // Connection accepted (no payload)
+    CAPTURE_IN = 1,              // Frame received from the client
+    CAPTURE_OUT = 2,             // Frame sent to the client
+    CAPTURE_CLOSE = 3            // Client closed the connection (no payload)
+} CaptureDirection;
+
+/**
+ * Record header, 24 bytes. Records are numbered from 1 in file order.
+ * An OUT record's cause is the OPEN/IN/CLOSE record the sending thread
+ * was handling, which lets replay wait for all effects of one input
+ * before sending the next. Frames sent by the heartbeat have cause 0.
+ *
+ * While recording, IN and CLOSE records are handled one at a time
+ * (until recorder_input_done), so the file order is the order in which
+ * the server applied them. Replay targets need the same serialization
+ * (recorder_serialize) to reproduce the capture.
+ */
+typedef struct {
+    uint64_t timestamp_ns;       // Monotonic time since the capture started
+    uint32_t connection;         // Connection id, 1-based, unique per capture
+    uint32_t cause;              // OUT only: number of the causing record
+    uint16_t length;             // Payload bytes following the header
+    uint8_t direction;           // CaptureDirection
+    uint8_t reserved[5];
+} CaptureRecord;
+
+// ========== RECORDING ==========
+
+/**
+ * Opens a capture file; recording stays off if this is never called.
+ * @return 0 on success, -1 on failure
+ */
+int recorder_open(const char *path);
+
+/**
+ * Flushes and closes the capture file.
+ */
+void recorder_close(void);
+
+/**
+ * Handles client inputs one at a time, also without a capture file.
+ */
+void recorder_serialize(void);
+
+/**
+ * Assigns a new connection id to an accepted socket and records OPEN.
+ */
+void recorder_connection_opened(int socket);
+
+/**
+ * Records that the client closed its connection.
+ * Holds the dispatch lock until recorder_input_done.
+ */
+void recorder_connection_closed(int socket);
+
+/**
+ * Records a complete inbound frame.
+ * Holds the dispatch lock until recorder_input_done.
+ */
+void recorder_frame_in(int socket, const char *frame, size_t length);
+
+/**
+ * Ends handling of this thread's last input; no-op if none is pending.
+ */
+void recorder_input_done(void);
+
+/**
+ * Records an outbound frame.
+ */
+void recorder_frame_out(int socket, const char *frame, size_t length);
+
+#endif //SERVER_RECORDER_H
@@ -0,0 +1,648 @@
+#include "search.h"
+#include "tablebase.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+
+#define SEARCH_MAX_PLY 128
+// Stack of a worker: a move list and bookkeeping per ply, plus evaluation and probes
+#define SEARCH_STACK_SIZE (SEARCH_MAX_PLY * (sizeof(MoveList) + 4096) + 256 * 1024)
+#define TT_CLUSTER_SIZE 4                // Entries per 64-byte cluster
+#define TT_NO_MOVE 0xFF
+#define TIME_CHECK_INTERVAL 2048         // Nodes between clock reads
+
+#define SCORE_MAN 100
+#define SCORE_KING 300
+#define SCORE_ADVANCE 4
+
+/**
+ * Bound type stored with each transposition table entry.
+ */
+typedef enum {
+    BOUND_NONE = 0,
+    BOUND_LOWER = 1,
+    BOUND_UPPER = 2,
+    BOUND_EXACT = 3
+} BoundType;
+
+/**
+ * Lock-free transposition table entry (Hyatt's XOR trick).
+ * key_xor holds hash ^ data so torn writes from racing threads fail verification.
+ *
+ * Packed data layout:
+ *   bits  0-15  score (int16)
+ *   bits 16-23  depth
+ *   bits 24-25  bound
+ *   bits 26-33  move index in generate_moves order
+ *   bits 34-39  generation
+ */
+typedef struct {
+    _Atomic uint64_t key_xor;
+    _Atomic uint64_t data;
+} TTEntry;
+
+typedef struct {
+    TTEntry entries[TT_CLUSTER_SIZE];
+} TTCluster;
+
+/**
+ * Unpacked view of a transposition table entry.
+ */
+typedef struct {
+    int score;
+    int depth;
+    BoundType bound;
+    int move_index;
+} TTHit;
+
+static TTCluster *tt_table = NULL;
+static size_t tt_mask = 0;
+static atomic_uint tt_generation = 0;
+static int tt_active_searches = 0;      // Searches using tt_table, guarded by tt_init_mutex
+static pthread_mutex_t tt_init_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * State shared by all threads of one search.
+ */
+typedef struct {
+    atomic_bool stop;
+    struct timespec start;
+    SearchLimits limits;
+    SearchResult *result;
+} SearchShared;
+
+/**
+ * Per-thread search state. Each Lazy SMP worker owns one.
+ */
+typedef struct {
+    int id;
+    pthread_t thread;
+    SearchShared *shared;
+    Position root;
+
+    uint64_t nodes;
+    int completed_depth;
+    int best_score;
+    Move best_move;
+    bool has_move;
+
+    uint16_t killers[SEARCH_MAX_PLY][2];
+    uint32_t history[SQUARE_COUNT][SQUARE_COUNT];
+} SearchThread;
+
+// ========== TRANSPOSITION TABLE ==========
+
+/**
+ * Replaces the transposition table. Caller holds tt_init_mutex and has
+ * checked that no search is running.
+ *
+ * @param megabytes Table size in MiB
+ * @return 0 on success, -1 on allocation failure
+ */
+static int tt_allocate(size_t megabytes) {
+    size_t clusters = 1;
+    size_t wanted = (megabytes ? megabytes : 1) * 1024 * 1024 / sizeof(TTCluster);
+
+    while (clusters * 2 <= wanted) {
+        clusters *= 2;
+    }
+
+    free(tt_table);
+    tt_table = aligned_alloc(64, clusters * sizeof(TTCluster));
+    if (!tt_table) {
+        tt_mask = 0;
+        fprintf(stderr, "Failed to allocate %zu MB transposition table\n", megabytes);
+        return -1;
+    }
+    tt_mask = clusters - 1;
+    memset(tt_table, 0, clusters * sizeof(TTCluster));
+    return 0;
+}
+
+/**
+ * Allocates the shared transposition table.
+ * Size is rounded down to a power-of-two number of clusters.
+ * Refused while a search runs, since its threads read the table unlocked.
+ *
+ * @param megabytes Table size in MiB
+ * @return 0 on success, -1 on allocation failure or a running search
+ */
+int tt_init(size_t megabytes) {
+    pthread_mutex_lock(&tt_init_mutex);
+    if (tt_active_searches > 0) {
+        pthread_mutex_unlock(&tt_init_mutex);
+        fprintf(stderr, "Transposition table in use, not resized\n");
+        return -1;
+    }
+    int rc = tt_allocate(megabytes);
+    pthread_mutex_unlock(&tt_init_mutex);
+    return rc;
+}
+
+/**
+ * Clears all transposition table entries, unless a search is running.
+ */
+void tt_clear(void) {
+    pthread_mutex_lock(&tt_init_mutex);
+    if (tt_table && tt_active_searches == 0) {
+        memset(tt_table, 0, (tt_mask + 1) * sizeof(TTCluster));
+    }
+    pthread_mutex_unlock(&tt_init_mutex);
+}
+
+/**
+ * Releases the transposition table, unless a search is running.
+ */
+void tt_free(void) {
+    pthread_mutex_lock(&tt_init_mutex);
+    if (tt_active_searches > 0) {
+        pthread_mutex_unlock(&tt_init_mutex);
+        fprintf(stderr, "Transposition table in use, not freed\n");
+        return;
+    }
+    free(tt_table);
+    tt_table = NULL;
+    tt_mask = 0;
+    pthread_mutex_unlock(&tt_init_mutex);
+}
+
+/**
+ * Converts a win score to "distance from this node" before storing.
+ */
+static inline int score_to_tt(int score, int ply) {
+    if (score > SCORE_WIN - SEARCH_MAX_PLY) return score + ply;
+    if (score < -SCORE_WIN + SEARCH_MAX_PLY) return score - ply;
+    return score;
+}
+
+/**
+ * Converts a stored win score back to "distance from root".
+ */
+static inline int score_from_tt(int score, int ply) {
+    if (score > SCORE_WIN - SEARCH_MAX_PLY) return score - ply;
+    if (score < -SCORE_WIN + SEARCH_MAX_PLY) return score + ply;
+    return score;
+}
+
+/**
+ * Looks up a position in the transposition table.
+ *
+ * @param hash Zobrist key
+ * @param ply Distance from root (for win score adjustment)
+ * @param hit Output entry
+ * @return true if a verified entry was found
+ */
+static bool tt_probe(uint64_t hash, int ply, TTHit *hit) {
+    TTCluster *cluster = &tt_table[hash & tt_mask];
+
+    for (int i = 0; i < TT_CLUSTER_SIZE; i++) {
+        uint64_t data = atomic_load_explicit(&cluster->entries[i].data, memory_order_relaxed);
+        uint64_t key = atomic_load_explicit(&cluster->entries[i].key_xor, memory_order_relaxed);
+
+        if ((key ^ data) != hash || data == 0) continue;
+
+        hit->score = score_from_tt((int16_t)(data & 0xFFFF), ply);
+        hit->depth = (int)((data >> 16) & 0xFF);
+        hit->bound = (BoundType)((data >> 24) & 0x3);
+        hit->move_index = (int)((data >> 26) & 0xFF);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Stores a search result in the transposition table.
+ * Replaces the same key, otherwise the shallowest / oldest entry of the cluster.
+ *
+ * @param hash Zobrist key
+ * @param depth Remaining depth of the search
+ * @param score Score from side to move's point of view
+ * @param bound Bound type of the score
+ * @param move_index Index of best move, TT_NO_MOVE if none
+ * @param ply Distance from root
+ */
+static void tt_store(uint64_t hash, int depth, int score, BoundType bound, int move_index, int ply) {
+    TTCluster *cluster = &tt_table[hash & tt_mask];
+    unsigned generation = atomic_load_explicit(&tt_generation, memory_order_relaxed) & 0x3F;
+    TTEntry *replace = &cluster->entries[0];
+    int replace_value = 1 << 30;
+
+    for (int i = 0; i < TT_CLUSTER_SIZE; i++) {
+        TTEntry *entry = &cluster->entries[i];
+        uint64_t data = atomic_load_explicit(&entry->data, memory_order_relaxed);
+        uint64_t key = atomic_load_explicit(&entry->key_xor, memory_order_relaxed);
+
+        if (data == 0 || (key ^ data) == hash) {
+            replace = entry;
+            break;
+        }
+
+        int entry_depth = (int)((data >> 16) & 0xFF);
+        int age = (int)((generation - ((data >> 34) & 0x3F)) & 0x3F);
+        int value = entry_depth - 8 * age;
+        if (value < replace_value) {
+            replace_value = value;
+            replace = entry;
+        }
+    }
+
+    if (depth < 0) depth = 0;
+    uint64_t data = (uint64_t)(uint16_t)(int16_t)score_to_tt(score, ply)
+                  | (uint64_t)(depth & 0xFF) << 16
+                  | (uint64_t)bound << 24
+                  | (uint64_t)(move_index & 0xFF) << 26
+                  | (uint64_t)generation << 34;
+
+    atomic_store_explicit(&replace->key_xor, hash ^ data, memory_order_relaxed);
+    atomic_store_explicit(&replace->data, data, memory_order_relaxed);
+}
+
+// ========== EVALUATION ==========
+
+/**
+ * Static evaluation from side to move's point of view.
+ * Material plus a small bonus for advanced men.
+ *
+ * @param pos Position to evaluate
+ * @return Score in centi-men
+ */
+int evaluate_position(const Position *pos) {
+    int score = 0;
+
+    score += SCORE_MAN * __builtin_popcountll(pos->white & ~pos->kings);
+    score += SCORE_KING * __builtin_popcountll(pos->white & pos->kings);
+    score -= SCORE_MAN * __builtin_popcountll(pos->black & ~pos->kings);
+    score -= SCORE_KING * __builtin_popcountll(pos->black & pos->kings);
+
+    for (uint64_t men = pos->white & ~pos->kings; men; men &= men - 1) {
+        score += SCORE_ADVANCE * (BOARD_SIZE - 1 - SQUARE_ROW(__builtin_ctzll(men)));
+    }
+    for (uint64_t men = pos->black & ~pos->kings; men; men &= men - 1) {
+        score -= SCORE_ADVANCE * SQUARE_ROW(__builtin_ctzll(men));
+    }
+
+    return pos->side == COLOR_WHITE ? score : -score;
+}
+
+// ========== SEARCH ==========
+
+/**
+ * Returns milliseconds elapsed since the search started.
+ */
+static double elapsed_ms(const SearchShared *shared) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - shared->start.tv_sec) * 1000.0 +
+           (now.tv_nsec - shared->start.tv_nsec) / 1e6;
+}
+
+/**
+ * Compact from/to key used for killer moves.
+ */
+static inline uint16_t move_key(const Move *move) {
+    return (uint16_t)(move->path[0] << 8 | move->path[move->path_len - 1]);
+}
+
+/**
+ * Assigns ordering scores: TT move, longer captures, killers, then history.
+ *
+ * @param thread Searching thread
+ * @param list Generated moves
+ * @param ply Distance from root
+ * @param tt_move TT move index or TT_NO_MOVE
+ * @param scores Output ordering scores
+ */
+static void score_moves(const SearchThread *thread, const MoveList *list, int ply,
+                        int tt_move, int *scores) {
+    for (int i = 0; i < list->count; i++) {
+        const Move *move = &list->moves[i];
+        uint16_t key = move_key(move);
+
+        if (i == tt_move) {
+            scores[i] = 1 << 30;
+        } else if (move->capture_count > 0) {
+            scores[i] = (1 << 28) + move->capture_count * 1000 + (move->promotes ? 500 : 0);
+        } else if (ply < SEARCH_MAX_PLY && key == thread->killers[ply][0]) {
+            scores[i] = 1 << 27;
+        } else if (ply < SEARCH_MAX_PLY && key == thread->killers[ply][1]) {
+            scores[i] = (1 << 27) - 1;
+        } else {
+            scores[i] = (int)thread->history[move->path[0]][move->path[move->path_len - 1]]
+                      + (move->promotes ? (1 << 26) : 0);
+        }
+    }
+}
+
+/**
+ * Moves the best remaining candidate to position i (selection sort step).
+ *
+ * @return Original index of the selected move in generate_moves order
+ */
+static int pick_move(MoveList *list, int *scores, int *order, int i) {
+    int best = i;
+    for (int j = i + 1; j < list->count; j++) {
+        if (scores[j] > scores[best]) best = j;
+    }
+    if (best != i) {
+        Move tmp_move = list->moves[i];
+        list->moves[i] = list->moves[best];
+        list->moves[best] = tmp_move;
+        int tmp = scores[i]; scores[i] = scores[best]; scores[best] = tmp;
+        tmp = order[i]; order[i] = order[best]; order[best] = tmp;
+    }
+    return order[i];
+}
+
+/**
+ * Negamax alpha-beta with principal variation search.
+ * Depth is not reduced below zero while captures are pending,
+ * so forced capture sequences are always resolved (quiescence).
+ *
+ * @param thread Searching thread
+ * @param pos Current position
+ * @param depth Remaining depth
+ * @param alpha Lower bound
+ * @param beta Upper bound
+ * @param ply Distance from root
+ * @return Score from side to move's point of view
+ */
+static int negamax(SearchThread *thread, const Position *pos, int depth,
+                   int alpha, int beta, int ply) {
+    SearchShared *shared = thread->shared;
+
+    thread->nodes++;
+    if (thread->id == 0 && (thread->nodes % TIME_CHECK_INTERVAL) == 0 &&
+        shared->limits.time_limit_ms > 0 &&
+        elapsed_ms(shared) >= shared->limits.time_limit_ms) {
+        atomic_store(&shared->stop, true);
+    }
+    if (atomic_load_explicit(&shared->stop, memory_order_relaxed)) {
+        return 0;
+    }
+
+    MoveList list;
+    generate_moves(pos, &list);
+
+    if (list.count == 0) {
+        return -SCORE_WIN + ply;
+    }
+    if (ply >= SEARCH_MAX_PLY - 1) {
+        return evaluate_position(pos);
+    }
+
+    // Endgame tables resolve few-piece positions exactly
+    if (ply > 0 && __builtin_popcountll(pos->white | pos->black) <= tb_max_pieces()) {
+        TBResult value = tb_probe(pos);
+        if (value == TB_WIN) return SCORE_TB_WIN - ply;
+        if (value == TB_LOSS) return -SCORE_TB_WIN + ply;
+        if (value == TB_DRAW) return 0;
+    }
+
+    bool captures = list.moves[0].capture_count > 0;
+    if (depth <= 0 && !captures) {
+        return evaluate_position(pos);
+    }
+
+    int tt_move = TT_NO_MOVE;
+    TTHit hit;
+    if (tt_probe(pos->hash, ply, &hit)) {
+        tt_move = hit.move_index < list.count ? hit.move_index : TT_NO_MOVE;
+
+        if (ply > 0 && hit.depth >= depth) {
+            if (hit.bound == BOUND_EXACT ||
+                (hit.bound == BOUND_LOWER && hit.score >= beta) ||
+                (hit.bound == BOUND_UPPER && hit.score <= alpha)) {
+                return hit.score;
+            }
+        }
+    }
+
+    int scores[MAX_MOVES];
+    int order[MAX_MOVES];
+    for (int i = 0; i < list.count; i++) order[i] = i;
+    score_moves(thread, &list, ply, tt_move, scores);
+
+    int original_alpha = alpha;
+    int best_score = -SCORE_INFINITE;
+    int best_index = TT_NO_MOVE;
+
+    for (int i = 0; i < list.count; i++) {
+        int index = pick_move(&list, scores, order, i);
+        const Move *move = &list.moves[i];
+        Position child = *pos;
+        make_move(&child, move);
+
+        int score;
+        if (i == 0) {
+            score = -negamax(thread, &child, depth - 1, -beta, -alpha, ply + 1);
+        } else {
+            score = -negamax(thread, &child, depth - 1, -alpha - 1, -alpha, ply + 1);
+            if (score > alpha && score < beta) {
+                score = -negamax(thread, &child, depth - 1, -beta, -alpha, ply + 1);
+            }
+        }
+
+        if (atomic_load_explicit(&shared->stop, memory_order_relaxed)) {
+            return 0;
+        }
+
+        if (score > best_score) {
+            best_score = score;
+            best_index = index;
+
+            if (ply == 0) {
+                thread->best_move = *move;
+                thread->has_move = true;
+            }
+        }
+
+        if (score > alpha) {
+            alpha = score;
+        }
+
+        if (alpha >= beta) {
+            if (move->capture_count == 0 && ply < SEARCH_MAX_PLY) {
+                uint16_t key = move_key(move);
+                if (thread->killers[ply][0] != key) {
+                    thread->killers[ply][1] = thread->killers[ply][0];
+                    thread->killers[ply][0] = key;
+                }
+                int d = depth > 0 ? depth : 1;
+                thread->history[move->path[0]][move->path[move->path_len - 1]] += (uint32_t)(d * d);
+            }
+            break;
+        }
+    }
+
+    BoundType bound = best_score >= beta ? BOUND_LOWER :
+                      best_score > original_alpha ? BOUND_EXACT : BOUND_UPPER;
+    tt_store(pos->hash, depth, best_score, bound, best_index, ply);
+
+    return best_score;
+}
+
+/**
+ * Iterative deepening driver for one Lazy SMP worker.
+ * Helper threads start one ply deeper on odd ids so the workers
+ * desynchronize and fill the shared table with different subtrees.
+ *
+ * @param arg Pointer to SearchThread
+ * @return NULL
+ */
+static void* search_thread_main(void *arg) {
+    SearchThread *thread = (SearchThread*)arg;
+    SearchShared *shared = thread->shared;
+    int start_depth = 1 + (thread->id & 1);
+
+    for (int depth = start_depth; depth <= shared->limits.max_depth; depth++) {
+        Move previous_move = thread->best_move;
+        bool previous_has_move = thread->has_move;
+
+        int score = negamax(thread, &thread->root, depth, -SCORE_INFINITE, SCORE_INFINITE, 0);
+
+        if (atomic_load(&shared->stop)) {
+            // Keep the move of the last complete iteration
+            thread->best_move = previous_move;
+            thread->has_move = previous_has_move;
+            break;
+        }
+
+        thread->completed_depth = depth;
+        thread->best_score = score;
+
+        if (thread->id == 0) {
+            shared->result->depth_time_ms[depth] = elapsed_ms(shared);
+        }
+
+        // A decided game needs no deeper iterations
+        if (score > SCORE_WIN - SEARCH_MAX_PLY || score < -SCORE_WIN + SEARCH_MAX_PLY) {
+            break;
+        }
+    }
+
+    if (thread->id == 0) {
+        atomic_store(&shared->stop, true);
+    }
+    return NULL;
+}
+
+/**
+ * Marks a search as no longer using the transposition table.
+ */
+static void search_release_tt(void) {
+    pthread_mutex_lock(&tt_init_mutex);
+    tt_active_searches--;
+    pthread_mutex_unlock(&tt_init_mutex);
+}
+
+/**
+ * Runs an iterative deepening alpha-beta search.
+ * With limits->threads > 1 the search is parallelized with Lazy SMP:
+ * all threads search the same root and share only the lock-free
+ * transposition table; the result of the deepest completed iteration wins.
+ *
+ * @param pos Root position
+ * @param limits Depth, thread and time limits
+ * @param result Output search result
+ */
+void search_position(const Position *pos, const SearchLimits *limits, SearchResult *result) {
+    movegen_init();
+
+    // The server allocates the table at startup; tools may leave it to
+    // the first search. Either way it is created and pinned under the lock.
+    pthread_mutex_lock(&tt_init_mutex);
+    if (!tt_table && tt_allocate(SEARCH_DEFAULT_TT_MB) < 0) {
+        pthread_mutex_unlock(&tt_init_mutex);
+        memset(result, 0, sizeof(*result));
+        return;
+    }
+    tt_active_searches++;
+    pthread_mutex_unlock(&tt_init_mutex);
+    atomic_fetch_add(&tt_generation, 1);
+
+    memset(result, 0, sizeof(*result));
+
+    SearchShared shared;
+    atomic_init(&shared.stop, false);
+    shared.limits = *limits;
+    shared.result = result;
+    if (shared.limits.max_depth < 1) shared.limits.max_depth = 1;
+    if (shared.limits.max_depth > SEARCH_MAX_DEPTH) shared.limits.max_depth = SEARCH_MAX_DEPTH;
+    if (shared.limits.threads < 1) shared.limits.threads = 1;
+    if (shared.limits.threads > SEARCH_MAX_THREADS) shared.limits.threads = SEARCH_MAX_THREADS;
+    clock_gettime(CLOCK_MONOTONIC, &shared.start);
+
+    int thread_count = shared.limits.threads;
+    SearchThread *threads = calloc(thread_count, sizeof(SearchThread));
+    if (!threads) {
+        fprintf(stderr, "Failed to allocate search threads\n");
+        search_release_tt();
+        return;
+    }
+
+    for (int i = 0; i < thread_count; i++) {
+        threads[i].id = i;
+        threads[i].shared = &shared;
+        threads[i].root = *pos;
+    }
+
+    // Every worker runs in its own thread with a stack sized for the
+    // deepest search, so callers (client threads) can run on small stacks.
+    // The main worker falls back to the caller's thread.
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, SEARCH_STACK_SIZE);
+
+    int started = 0;
+    for (int i = 0; i < thread_count; i++) {
+        if (pthread_create(&threads[i].thread, &attr, search_thread_main, &threads[i]) != 0) {
+            fprintf(stderr, "Failed to start search thread %d\n", i);
+            break;
+        }
+        started++;
+    }
+    pthread_attr_destroy(&attr);
+
+    if (started == 0) {
+        search_thread_main(&threads[0]);
+    }
+
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i].thread, NULL);
+    }
+    if (started == 0) {
+        started = 1;
+    }
+
+    // Pick the deepest completed iteration, preferring the main thread on ties
+    SearchThread *best = &threads[0];
+    for (int i = 0; i < started; i++) {
+        result->nodes += threads[i].nodes;
+        if (threads[i].completed_depth > best->completed_depth && threads[i].has_move) {
+            best = &threads[i];
+        }
+    }
+
+    result->best_move = best->best_move;
+    result->has_move = best->has_move;
+    result->score = best->best_score;
+    result->depth = best->completed_depth;
+    result->elapsed_ms = elapsed_ms(&shared);
+
+    // Root without legal moves: report the loss even if no iteration completed
+    if (!result->has_move) {
+        MoveList list;
+        if (generate_moves(pos, &list) == 0) {
+            result->score = -SCORE_WIN;
+        } else if (list.count > 0) {
+            result->best_move = list.moves[0];
+            result->has_move = true;
+        }
+    }
+
+    free(threads);
+    search_release_tt();
+}
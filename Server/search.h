@@ -0,0 +1,69 @@
+#ifndef SERVER_SEARCH_H
+#define SERVER_SEARCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "movegen.h"
+
+#define SEARCH_MAX_DEPTH 64              // Iterative deepening ceiling
+#define SEARCH_MAX_THREADS 64            // Upper bound for Lazy SMP workers
+#define SEARCH_DEFAULT_TT_MB 64          // Default transposition table size
+
+#define SCORE_INFINITE 32000
+#define SCORE_WIN 30000                  // Win at ply 0; wins are SCORE_WIN - ply
+#define SCORE_TB_WIN 20000               // Tablebase win, below the forced-win range
+
+/**
+ * Limits for one search request.
+ */
+typedef struct {
+    int max_depth;           // Deepest iteration to run (1..SEARCH_MAX_DEPTH)
+    int threads;             // Lazy SMP thread count (1 = single threaded)
+    long time_limit_ms;      // Wall clock budget, 0 for none
+} SearchLimits;
+
+/**
+ * Outcome of a search.
+ */
+typedef struct {
+    Move best_move;          // Best move found (valid if has_move)
+    bool has_move;           // false if side to move has no legal move
+    int score;               // Score from side to move's point of view
+    int depth;               // Deepest fully completed iteration
+    uint64_t nodes;          // Nodes searched by all threads
+    double elapsed_ms;       // Wall clock time of the search
+    double depth_time_ms[SEARCH_MAX_DEPTH + 1]; // Time at which each depth completed
+} SearchResult;
+
+// ========== TRANSPOSITION TABLE ==========
+
+/**
+ * Allocates the shared transposition table.
+ * @return 0 on success, -1 on allocation failure
+ */
+int tt_init(size_t megabytes);
+
+/**
+ * Clears all transposition table entries.
+ */
+void tt_clear(void);
+
+/**
+ * Releases the transposition table.
+ */
+void tt_free(void);
+
+// ========== SEARCH ==========
+
+/**
+ * Static evaluation from side to move's point of view.
+ */
+int evaluate_position(const Position *pos);
+
+/**
+ * Runs an iterative deepening alpha-beta search (Lazy SMP when threads > 1).
+ */
+void search_position(const Position *pos, const SearchLimits *limits, SearchResult *result);
+
+#endif //SERVER_SEARCH_H
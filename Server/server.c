@@ -6,16 +6,88 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <errno.h>
+#include <poll.h>
+#include <stdint.h>
+#include <limits.h>
+#include <sys/random.h>
 #include "server.h"
 #include "protocol.h"
 #include "client_state_machine.h"
+#include "adjudicate.h"
+#include "metrics.h"
+#include "admin.h"
+#include "metrics_http.h"
+#include "probes.h"
+#include "recorder.h"
+#include "transport.h"
+#include "uring.h"
+#include "arena.h"
+#include "bufpool.h"
+#include "matchmaking.h"
+#include "ratings.h"
 
 #define PING_INTERVAL_SEC 5              // Ping interval
 #define PONG_TIMEOUT_SEC 3               // Pong wait timeout
 #define SHORT_DISCONNECT_THRESHOLD_SEC 40 // Short-term disconnection threshold
 #define LONG_DISCONNECT_THRESHOLD_SEC 80  // Long shutdown threshold
 #define MAX_MISSED_PONGS 3               // Maximum number of missed pongs
+#define MAX_FRAME_LEN (BUFFER_SIZE * 2 - 1) // Longest inbound frame, newline included
+#define ROOM_JSON_MAX (MAX_ROOM_NAME + 64) // Longest OP_ROOMS_LIST entry, comma included
+#define LEADERBOARD_PAGE_DEFAULT 20      // OP_LEADERBOARD entries when no count is given
+#define LEADERBOARD_PAGE_MAX 40          // Most OP_LEADERBOARD entries per page
+#define LEADERBOARD_JSON_MAX (MAX_PLAYER_NAME + 112) // Longest OP_LEADERBOARD_PAGE entry, comma included
 
+// A full leaderboard page with its header fits one frame
+_Static_assert(LEADERBOARD_PAGE_MAX * LEADERBOARD_JSON_MAX + 128 <= MAX_DATA_LEN,
+               "leaderboard page must fit in a message");
+
+// Logged-in clients and every room's owner and players hold interned names
+_Static_assert(SYMTAB_CAPACITY > MAX_CLIENTS + 3 * MAX_ROOMS,
+               "symbol table must hold every referenced player name");
+
+/**
+ * Scratch arena of the calling thread. Outgoing frames and the heartbeat
+ * sweep's action list come from here, sized to their contents, instead
+ * of fixed buffers on the stack. Client and heartbeat threads free it
+ * when they exit.
+ */
+static __thread Arena worker_arena;
+
+static void start_matched_game(Server *server, const MatchPair *pair);
+
+
+/**
+ * Sets a client's connection state.
+ * Keeps server_stats.clients_by_state in step so stats requests
+ * never scan the client table. Caller holds the client's state_mutex
+ * where the surrounding code requires it.
+ *
+ * @param client Pointer to the client
+ * @param state New connection state
+ */
+void client_set_state(Client *client, ClientState state) {
+    PROBE3(client__state, client->client_id, (int)client->state, (int)state);
+    if (client->state_tallied) {
+        STATS_ADD(clients_by_state[client->state], -1);
+    }
+    client->state = state;
+    client->state_tallied = true;
+    STATS_ADD(clients_by_state[state], 1);
+    STATS_ADD(client_transitions[state], 1);
+}
+
+/**
+ * Removes a released client slot from the per-state tallies.
+ * Safe to call more than once.
+ *
+ * @param client Pointer to the client whose slot is released
+ */
+void client_untrack(Client *client) {
+    if (client->state_tallied) {
+        STATS_ADD(clients_by_state[client->state], -1);
+        client->state_tallied = false;
+    }
+}
 
 /**
  * Initializes the heartbeat monitoring system for a client.
@@ -24,12 +96,13 @@
  * @param client Pointer to the client structure to initialize
  */
 void client_init_heartbeat(Client *client) {
-    client->state = CLIENT_STATE_CONNECTED;
+    client_set_state(client, CLIENT_STATE_CONNECTED);
     client->last_pong_time = time(NULL);
     client->disconnect_time = 0;
     client->missed_pongs = 0;
     client->waiting_for_pong = false;
     pthread_mutex_init(&client->state_mutex, NULL);
+    pthread_mutex_init(&client->outbox_mutex, NULL);
 }
 
 /**
@@ -45,6 +118,7 @@ void client_update_pong(Client *client) {
     client->last_pong_time = time(NULL);
     client->missed_pongs = 0;
     client->waiting_for_pong = false;
+    STATS_ADD(pongs_received, 1);
 
     if (client->state == CLIENT_STATE_RECONNECTING ||
         client->state == CLIENT_STATE_DISCONNECTED) {
@@ -78,6 +152,7 @@ bool client_check_timeout(Client *client) {
     if (client->waiting_for_pong && time_since_pong > PONG_TIMEOUT_SEC) {
         client->missed_pongs++;
         client->waiting_for_pong = false;
+        STATS_ADD(missed_pongs, 1);
 
         printf("Client %s missed PONG (total: %d/%d)\n",
                client->client_id, client->missed_pongs, MAX_MISSED_PONGS);
@@ -105,6 +180,23 @@ bool client_check_timeout(Client *client) {
 }
 
 
+/**
+ * Takes the socket away from a client's session under outbox_mutex, so a
+ * concurrent send_to_client cannot write to the descriptor once it is
+ * closed and possibly reused by another connection.
+ *
+ * @param client Pointer to the client
+ * @return Socket the client held, -1 if none
+ */
+static int client_detach_socket(Client *client) {
+    pthread_mutex_lock(&client->outbox_mutex);
+    int socket = client->socket;
+    client->socket = -1;
+    client->outbox_live = false;
+    pthread_mutex_unlock(&client->outbox_mutex);
+    return socket;
+}
+
 /**
  * Marks a client as disconnected and closes their socket.
  * Only transitions from CONNECTED state to prevent state conflicts.
@@ -114,13 +206,13 @@ bool client_check_timeout(Client *client) {
  */
 void client_mark_disconnected(Client *client) {
     if (client->state == CLIENT_STATE_CONNECTED) {
-        client->state = CLIENT_STATE_DISCONNECTED;
+        client_set_state(client, CLIENT_STATE_DISCONNECTED);
         client->disconnect_time = time(NULL);
 
-        if (client->socket > 0) {
-            printf("Closing socket %d to wake recv()\n", client->socket);
-            close(client->socket);
-            client->socket = -1;
+        int socket = client_detach_socket(client);
+        if (socket > 0) {
+            printf("Closing socket %d to wake recv()\n", socket);
+            transport_close(socket);
         }
 
         printf("Client %s marked as DISCONNECTED\n", client->client_id);
@@ -135,7 +227,7 @@ void client_mark_disconnected(Client *client) {
  */
 void client_mark_reconnecting(Client *client) {
     if (client->state == CLIENT_STATE_DISCONNECTED) {
-        client->state = CLIENT_STATE_RECONNECTING;
+        client_set_state(client, CLIENT_STATE_RECONNECTING);
         printf("Client %s is RECONNECTING\n", client->client_id);
     }
 }
@@ -154,7 +246,7 @@ void client_mark_reconnected(Client *client) {
     }
 
 
-    client->state = CLIENT_STATE_CONNECTED;
+    client_set_state(client, CLIENT_STATE_CONNECTED);
     client->disconnect_time = 0;
     client->missed_pongs = 0;
 
@@ -169,7 +261,7 @@ void client_mark_reconnected(Client *client) {
  * @param client Pointer to the client to mark as timed out
  */
 void client_mark_timeout(Client *client) {
-    client->state = CLIENT_STATE_TIMEOUT;
+    client_set_state(client, CLIENT_STATE_TIMEOUT);
     printf("Client %s marked as TIMEOUT\n", client->client_id);
 }
 
@@ -214,6 +306,37 @@ const char* client_get_state_string(ClientState state) {
     }
 }
 
+/**
+ * Sets a room's state.
+ * Keeps server_stats.rooms_by_state in step so stats requests
+ * never scan the room table.
+ *
+ * @param room Pointer to the room
+ * @param state New room state
+ */
+void room_set_state(Room *room, RoomState state) {
+    PROBE3(room__state, room->name, (int)room->state, (int)state);
+    if (room->state_tallied) {
+        STATS_ADD(rooms_by_state[room->state], -1);
+    }
+    room->state = state;
+    room->state_tallied = true;
+    STATS_ADD(rooms_by_state[state], 1);
+}
+
+/**
+ * Removes a room from the per-state tallies before its slot is cleared.
+ * Safe to call more than once.
+ *
+ * @param room Pointer to the room being released
+ */
+void room_untrack(Room *room) {
+    if (room->state_tallied) {
+        STATS_ADD(rooms_by_state[room->state], -1);
+        room->state_tallied = false;
+    }
+}
+
 /**
  * Initializes room state management system.
  * Sets up initial state, pause tracking, and mutex for thread-safe operations.
@@ -221,22 +344,40 @@ const char* client_get_state_string(ClientState state) {
  * @param room Pointer to the room structure to initialize
  */
 void room_init_state(Room *room) {
-    room->state = ROOM_STATE_WAITING;
+    room_set_state(room, ROOM_STATE_WAITING);
     room->pause_start_time = 0;
-    room->disconnected_player[0] = '\0';
+    room->disconnected_player = PLAYER_NONE;
     room->waiting_for_reconnect = false;
     pthread_mutex_init(&room->room_mutex, NULL);
 }
 
+/**
+ * Releases a room slot: drops the references to its players' names,
+ * clears its scan key and zeroes it. Caller holds rooms_mutex.
+ *
+ * @param server Pointer to the server
+ * @param room Room being removed
+ */
+static void room_free(Server *server, Room *room) {
+    pthread_mutex_destroy(&room->room_mutex);
+    room_untrack(room);
+    symtab_release(room->owner);
+    symtab_release(room->player1);
+    symtab_release(room->player2);
+    server->room_keys[room - server->rooms] = 0;
+    memset(room, 0, sizeof(Room));
+    server->room_count--;
+}
+
 /**
  * Pauses an active game when a player disconnects.
  * Records which player disconnected and when the pause started.
  * Only pauses games that are currently active.
  *
  * @param room Pointer to the room containing the game
- * @param player_name Name of the player who disconnected
+ * @param player Player who disconnected
  */
-void room_pause_game(Room *room, const char *player_name) {
+void room_pause_game(Room *room, PlayerId player) {
     pthread_mutex_lock(&room->room_mutex);
 
     if (room->state != ROOM_STATE_ACTIVE) {
@@ -244,16 +385,15 @@ void room_pause_game(Room *room, const char *player_name) {
         return;
     }
 
-    room->state = ROOM_STATE_PAUSED;
+    room_set_state(room, ROOM_STATE_PAUSED);
     room->pause_start_time = time(NULL);
-    strncpy(room->disconnected_player, player_name, MAX_PLAYER_NAME - 1);
-    room->disconnected_player[MAX_PLAYER_NAME - 1] = '\0';
+    room->disconnected_player = player;
     room->waiting_for_reconnect = true;
 
     pthread_mutex_unlock(&room->room_mutex);
 
     printf("Game PAUSED in room %s (player %s disconnected)\n",
-           room->name, player_name);
+           room->name, symtab_name(player));
 }
 
 /**
@@ -273,9 +413,9 @@ void room_resume_game(Room *room) {
 
     long pause_duration = room_get_pause_duration(room);
 
-    room->state = ROOM_STATE_ACTIVE;
+    room_set_state(room, ROOM_STATE_ACTIVE);
     room->pause_start_time = 0;
-    room->disconnected_player[0] = '\0';
+    room->disconnected_player = PLAYER_NONE;
     room->waiting_for_reconnect = false;
 
     pthread_mutex_unlock(&room->room_mutex);
@@ -293,7 +433,8 @@ void room_resume_game(Room *room) {
 void room_finish_game(Room *room, const char *reason) {
     pthread_mutex_lock(&room->room_mutex);
 
-    room->state = ROOM_STATE_FINISHED;
+    room_set_state(room, ROOM_STATE_FINISHED);
+    STATS_ADD(games_finished, 1);
     room->waiting_for_reconnect = false;
 
     pthread_mutex_unlock(&room->room_mutex);
@@ -368,6 +509,12 @@ void* heartbeat_thread(void *arg) {
     while (server->running) {
         sleep(PING_INTERVAL_SEC);
 
+        if (metrics_take_report_request()) {
+            metrics_print_report(stdout);
+        }
+
+        uint64_t sweep_start = metrics_now_ns();
+
         typedef struct {
             char client_id[MAX_PLAYER_NAME];
             int socket;
@@ -376,14 +523,25 @@ void* heartbeat_thread(void *arg) {
             char current_room[MAX_ROOM_NAME];
         } ClientAction;
 
-        ClientAction actions[MAX_CLIENTS];
+        ArenaMark mark = arena_mark(&worker_arena);
         int action_count = 0;
 
         pthread_mutex_lock(&server->clients_mutex);
+        // Only logged-in clients get an action, so client_count bounds the list
+        int action_capacity = server->client_count;
+        ClientAction *actions = action_capacity > 0
+            ? arena_alloc(&worker_arena, (size_t)action_capacity * sizeof(ClientAction))
+            : NULL;
+        if (!actions) {
+            action_capacity = 0;
+        }
 
         for (int i = 0; i < MAX_CLIENTS; i++) {
-            Client *client = &server->clients[i];
+            if (server->client_keys[i] == PLAYER_NONE) {
+                continue;
+            }
 
+            Client *client = &server->clients[i];
             if (!client->active || !client->logged_in) {
                 continue;
             }
@@ -401,9 +559,9 @@ void* heartbeat_thread(void *arg) {
                 continue;
             }
 
-            if (client->socket > 0 && !client->waiting_for_pong) {
-                send_message(client->socket, OP_PING, "");
+            if (!client->waiting_for_pong && send_control_to_client(client, OP_PING, "")) {
                 client->waiting_for_pong = true;
+                STATS_ADD(pings_sent, 1);
                 printf("💓 PING sent to %s (socket %d)\n",
                        client->client_id, client->socket);
             }
@@ -411,7 +569,7 @@ void* heartbeat_thread(void *arg) {
             bool should_remove = client_check_timeout(client);
 
             if (should_remove || state == CLIENT_STATE_DISCONNECTED) {
-                if (action_count < MAX_CLIENTS) {
+                if (action_count < action_capacity) {
                     strncpy(actions[action_count].client_id,
                            client->client_id, MAX_PLAYER_NAME - 1);
                     actions[action_count].client_id[MAX_PLAYER_NAME - 1] = '\0';
@@ -487,9 +645,26 @@ void* heartbeat_thread(void *arg) {
             }
         }
 
+        // Bands have widened since the last sweep
+        int queued = matchmaking_size();
+        MatchPair *pairs = queued >= 2
+            ? arena_alloc(&worker_arena, (size_t)(queued / 2) * sizeof(MatchPair))
+            : NULL;
+        int pair_count = pairs ? matchmaking_sweep(time(NULL), pairs, queued / 2) : 0;
+        for (int i = 0; i < pair_count; i++) {
+            start_matched_game(server, &pairs[i]);
+        }
+
+        arena_release(&worker_arena, mark);
         check_room_pause_timeouts(server);
+        transport_flush();
+
+        uint64_t sweep_us = (metrics_now_ns() - sweep_start) / 1000;
+        admin_record_sweep(sweep_us);
+        PROBE2(heartbeat__tick, sweep_us, server->client_count);
     }
 
+    arena_free(&worker_arena);
     printf("💓 Heartbeat thread stopped\n");
     return NULL;
 }
@@ -513,17 +688,21 @@ void remove_client_after_timeout(Server *server, const char *client_id) {
 
     printf("Removing timed-out client '%s'\n", client_id);
 
-    if (client->socket > 0) {
-        close(client->socket);
+    int socket = client_detach_socket(client);
+    if (socket > 0) {
+        transport_close(socket);
     }
 
+    session_revoke(server, client);
 
     pthread_mutex_lock(&client->state_mutex);
-    client->state = CLIENT_STATE_REMOVED;
+    client_set_state(client, CLIENT_STATE_REMOVED);
     client->active = false;
+    client_untrack(client);
     pthread_mutex_unlock(&client->state_mutex);
 
     pthread_mutex_destroy(&client->state_mutex);
+    pthread_mutex_destroy(&client->outbox_mutex);
 
     server->client_count--;
 
@@ -556,38 +735,34 @@ void handle_player_disconnect(Server *server, Client *client) {
                client->client_id, room->name);
 
         Client *other = NULL;
-        if (strcmp(room->player1, client->client_id) != 0 && room->player1[0] != '\0') {
-            other = find_client(server, room->player1);
-        } else if (room->player2[0] != '\0') {
-            other = find_client(server, room->player2);
+        if (room->player1 != client->player_id && room->player1 != PLAYER_NONE) {
+            other = find_client_by_id(server, room->player1);
+        } else if (room->player2 != PLAYER_NONE) {
+            other = find_client_by_id(server, room->player2);
         }
 
         if (other) {
-            send_message(other->socket, OP_PLAYER_DISCONNECTED,
+            send_to_client(other, OP_PLAYER_DISCONNECTED,
                         client->client_id);
         }
     }
 
     if (room->state == ROOM_STATE_ACTIVE) {
-        room_pause_game(room, client->client_id);
+        room_pause_game(room, client->player_id);
 
-        char *other_player = NULL;
-        if (strcmp(room->player1, client->client_id) == 0) {
-            other_player = room->player2;
-        } else {
-            other_player = room->player1;
-        }
+        PlayerId other_player = room->player1 == client->player_id ? room->player2
+                                                                    : room->player1;
 
-        if (other_player[0] != '\0') {
-            Client *other_client = find_client(server, other_player);
+        if (other_player != PLAYER_NONE) {
+            Client *other_client = find_client_by_id(server, other_player);
             if (other_client && other_client->state == CLIENT_STATE_CONNECTED) {
                 char msg[256];
                 snprintf(msg, sizeof(msg), "%s,%s", room->name, client->client_id);
-                send_message(other_client->socket, OP_PLAYER_DISCONNECTED, msg);
-                send_message(other_client->socket, OP_GAME_PAUSED, room->name);
+                send_to_client(other_client, OP_PLAYER_DISCONNECTED, msg);
+                send_to_client(other_client, OP_GAME_PAUSED, room->name);
 
                 printf("Notified %s about %s disconnect\n",
-                       other_player, client->client_id);
+                       other_client->client_id, client->client_id);
             }
         }
     }
@@ -595,9 +770,35 @@ void handle_player_disconnect(Server *server, Client *client) {
     pthread_mutex_unlock(&server->rooms_mutex);
 }
 
+/**
+ * Updates the players' ratings with the result announced in OP_GAME_END.
+ *
+ * @param game Finished game
+ * @param outcome Result; ADJUDICATION_NONE leaves the ratings alone
+ */
+static void rate_finished_game(const Game *game, AdjudicationOutcome outcome) {
+    RatingResult result;
+    switch (outcome) {
+        case ADJUDICATION_PLAYER1_WINS:
+            result = RATING_RESULT_WIN;
+            break;
+        case ADJUDICATION_PLAYER2_WINS:
+            result = RATING_RESULT_LOSS;
+            break;
+        case ADJUDICATION_DRAW:
+            result = RATING_RESULT_DRAW;
+            break;
+        default:
+            return;
+    }
+    ratings_record_game(game->player1, game->player2, result);
+}
+
 /**
  * Handles long-term player disconnection (exceeded 80 second threshold).
- * Awards victory to opponent by timeout and cleans up the room.
+ * A started game is decided by the adjudication service: the present player
+ * wins unless the position is lost for them, which is scored as a draw.
+ * The search runs on a snapshot without holding rooms_mutex.
  *
  * @param server Pointer to the server
  * @param client Pointer to the client who timed out
@@ -611,48 +812,83 @@ void handle_player_long_disconnect(Server *server, Client *client) {
         return;
     }
 
+    char room_name[MAX_ROOM_NAME];
+    strncpy(room_name, room->name, MAX_ROOM_NAME - 1);
+    room_name[MAX_ROOM_NAME - 1] = '\0';
+
+    bool in_game = room->game_started &&
+                   (room->state == ROOM_STATE_ACTIVE || room->state == ROOM_STATE_PAUSED);
+    Game snapshot = room->game;
+    // The snapshot's names must outlive the room
+    symtab_retain(snapshot.player1);
+    symtab_retain(snapshot.player2);
+
+    pthread_mutex_unlock(&server->rooms_mutex);
+
     printf("Player %s long disconnect in room %s\n",
-           client->client_id, room->name);
+           client->client_id, room_name);
 
-    char *winner = NULL;
-    if (strcmp(room->player1, client->client_id) == 0) {
-        winner = room->player2;
-    } else {
-        winner = room->player1;
+    Adjudication verdict = {ADJUDICATION_NONE, "opponent_timeout", 0};
+    if (in_game) {
+        adjudicate_abandoned(&snapshot, client->player_id, &verdict);
+    }
+
+    pthread_mutex_lock(&server->rooms_mutex);
+
+    room = find_room(server, room_name);
+    if (!room) {
+        pthread_mutex_unlock(&server->rooms_mutex);
+        symtab_release(snapshot.player1);
+        symtab_release(snapshot.player2);
+        client_set_state(client, CLIENT_STATE_REMOVED);
+        return;
     }
 
-    room_finish_game(room, "opponent_timeout");
+    PlayerId present = room->player1 == client->player_id ? room->player2 : room->player1;
 
-    if (winner[0] != '\0') {
-        Client *winner_client = find_client(server, winner);
-        if (winner_client && winner_client->state == CLIENT_STATE_CONNECTED) {
+    room_finish_game(room, verdict.reason);
+    if (in_game) {
+        rate_finished_game(&snapshot, verdict.outcome);
+    }
+
+    if (present != PLAYER_NONE) {
+        Client *present_client = find_client_by_id(server, present);
+        if (present_client && present_client->state == CLIENT_STATE_CONNECTED) {
             char end_msg[256];
-            snprintf(end_msg, sizeof(end_msg), "%s,opponent_timeout", winner);
-            send_message(winner_client->socket, OP_GAME_END, end_msg);
+            if (in_game) {
+                adjudication_format_end(&snapshot, &verdict, end_msg, sizeof(end_msg));
+            } else {
+                snprintf(end_msg, sizeof(end_msg), "%s,opponent_timeout", symtab_name(present));
+            }
+            send_to_client(present_client, OP_GAME_END, end_msg);
 
-            winner_client->current_room[0] = '\0';
+            present_client->current_room[0] = '\0';
 
-            printf("%s wins by opponent timeout\n", winner);
+            printf("Game in room %s ended: %s\n", room_name, end_msg);
         }
     }
 
-    pthread_mutex_destroy(&room->room_mutex);
-    memset(room, 0, sizeof(Room));
-    server->room_count--;
+    room_free(server, room);
 
     pthread_mutex_unlock(&server->rooms_mutex);
 
-    client->state = CLIENT_STATE_REMOVED;
+    symtab_release(snapshot.player1);
+    symtab_release(snapshot.player2);
+    client_set_state(client, CLIENT_STATE_REMOVED);
 }
 
 
 /**
  * Checks all paused rooms for timeout and handles expired pauses.
- * Called periodically by the heartbeat thread.
+ * Called periodically by the heartbeat thread. Expired rooms are
+ * collected first and adjudicated after rooms_mutex is released.
  *
  * @param server Pointer to the server
  */
 void check_room_pause_timeouts(Server *server) {
+    PlayerId expired[MAX_ROOMS];
+    int expired_count = 0;
+
     pthread_mutex_lock(&server->rooms_mutex);
 
     for (int i = 0; i < MAX_ROOMS; i++) {
@@ -666,60 +902,181 @@ void check_room_pause_timeouts(Server *server) {
         if (room_should_timeout(room, LONG_DISCONNECT_THRESHOLD_SEC)) {
             printf("Room %s pause timeout exceeded\n", room->name);
 
-            Client *disconnected = find_client(server, room->disconnected_player);
-
-            if (disconnected) {
-                handle_player_long_disconnect(server, disconnected);
-            }
+            expired[expired_count++] = room->disconnected_player;
         }
     }
 
     pthread_mutex_unlock(&server->rooms_mutex);
+
+    for (int i = 0; i < expired_count; i++) {
+        pthread_mutex_lock(&server->clients_mutex);
+        Client *disconnected = find_client_by_id(server, expired[i]);
+        pthread_mutex_unlock(&server->clients_mutex);
+
+        if (disconnected) {
+            handle_player_long_disconnect(server, disconnected);
+        }
+    }
+}
+
+
+/**
+ * Sends OP_LOGIN_OK with the client's name and session token.
+ *
+ * Protocol format: "player_name,session_token"
+ *
+ * @param client Logged-in client
+ */
+static void send_login_ok(Client *client) {
+    char data[MAX_PLAYER_NAME + SESSION_TOKEN_LEN + 2];
+    snprintf(data, sizeof(data), "%s,%s", client->client_id, client->session_token);
+    send_to_client(client, OP_LOGIN_OK, data);
+}
+
+/**
+ * Writes the stored frames numbered after a given one to the client's
+ * socket. Caller holds outbox_mutex.
+ *
+ * @param client Client whose outbox is written
+ * @param after Number of the last frame not to write
+ * @return Number of frames written, -1 if some of them were evicted
+ */
+static int write_stored_frames(Client *client, uint32_t after) {
+    const char *first;
+    const char *second;
+    size_t first_length;
+    size_t second_length;
+
+    if (!outbox_since(&client->outbox, after, &first, &first_length,
+                      &second, &second_length)) {
+        return -1;
+    }
+
+    size_t total = first_length + second_length;
+    if (total == 0) {
+        return 0;
+    }
+
+    char *frames = malloc(total);
+    if (!frames) {
+        return -1;
+    }
+    memcpy(frames, first, first_length);
+    if (second_length > 0) {
+        memcpy(frames + first_length, second, second_length);
+    }
+    transport_write(client->socket, frames, total);
+
+    int count = 0;
+    for (size_t pos = 0; pos < total; count++) {
+        const char *end = memchr(frames + pos, '\n', total - pos);
+        size_t length = (size_t)(end - (frames + pos)) + 1;
+        recorder_frame_out(client->socket, frames + pos, length);
+        pos += length;
+    }
+    free(frames);
+    return count;
+}
+
+/**
+ * Resumes a reconnected session on its new socket.
+ * Sends OP_RECONNECT_OK "target,from_seq", where from_seq is the number
+ * of the next frame the client receives. If the outbox still holds every
+ * frame after last_seq, those are resent and nothing else is needed.
+ * Otherwise only the frames kept during the handover are sent and the
+ * caller resyncs the client.
+ *
+ * @param client Client that took over the new socket
+ * @param target Room name or "lobby"
+ * @param has_seq Request carried the last sequence number seen
+ * @param last_seq Number of the last frame the client received
+ * @param handover_seq Number of the first frame kept during the handover
+ * @return true if the missed frames were replayed, false if the caller must resync
+ */
+static bool resume_session(Client *client, const char *target, bool has_seq,
+                           uint32_t last_seq, uint32_t handover_seq) {
+    char data[MAX_ROOM_NAME + 16];
+
+    pthread_mutex_lock(&client->outbox_mutex);
+    bool replay = has_seq && last_seq < client->outbox.next_seq &&
+                  last_seq + 1 >= client->outbox.first_seq;
+    uint32_t from = replay ? last_seq + 1 : handover_seq;
+
+    snprintf(data, sizeof(data), "%s,%u", target, from);
+    send_message(client->socket, OP_RECONNECT_OK, data);
+
+    int count = write_stored_frames(client, from - 1);
+    if (replay && count >= 0) {
+        STATS_ADD(reconnects_replayed, 1);
+        STATS_ADD(frames_replayed, count);
+        printf("Replayed %d missed frames to '%s'\n", count, client->client_id);
+    }
+
+    client->outbox_live = true;
+    pthread_mutex_unlock(&client->outbox_mutex);
+    return replay && count >= 0;
 }
 
+/**
+ * Rejects a reconnect after the socket was transferred.
+ * Sends OP_RECONNECT_FAIL followed by the frames kept during the handover.
+ *
+ * @param client Client that took over the new socket
+ * @param reason Failure reason for the client
+ * @param handover_seq Number of the first frame kept during the handover
+ */
+static void reject_resume(Client *client, const char *reason, uint32_t handover_seq) {
+    pthread_mutex_lock(&client->outbox_mutex);
+    send_message(client->socket, OP_RECONNECT_FAIL, reason);
+    write_stored_frames(client, handover_seq - 1);
+    client->outbox_live = true;
+    pthread_mutex_unlock(&client->outbox_mutex);
+}
 
 /**
  * Handles client reconnection requests.
- * Validates reconnection eligibility, transfers socket to existing client structure,
- * and restores client to their previous game state (lobby, waiting room, or active game).
+ * Resolves the session token issued with OP_LOGIN_OK through the token
+ * index and transfers the socket to the existing client structure. If
+ * the request carries the number of the last frame received and the
+ * outbox still holds everything after it, only the missed frames are
+ * resent; otherwise the client is restored to their previous game state
+ * (lobby, waiting room, or active game) from scratch. The name must
+ * match the token's owner.
  *
- * Protocol format: "room_name,player_name" or just "player_name" for lobby reconnect
+ * Protocol format: "room_name,player_name,session_token,last_seq" with
+ * room_name empty for the lobby, or without last_seq for a full resync:
+ * "room_name,player_name,session_token" or "player_name,session_token"
  *
  * @param server Pointer to the server
  * @param temp_client Temporary client structure for the new connection
- * @param data Reconnection request data containing room and player name
+ * @param args Room, player name, token and last received frame (0 for a resync)
  */
-void handle_reconnect_request(Server *server, Client *temp_client, const char *data) {
-    char room_name[MAX_ROOM_NAME];
-    char player_name[MAX_PLAYER_NAME];
-
-    // Parse reconnection data (room_name,player_name or just player_name)
-    int parsed = sscanf(data, "%[^,],%s", room_name, player_name);
-
-    if (parsed == 1) {
-        // Only player name provided (lobby reconnect)
-        strncpy(player_name, room_name, MAX_PLAYER_NAME - 1);
-        player_name[MAX_PLAYER_NAME - 1] = '\0';
-        room_name[0] = '\0';
-    } else if (parsed != 2) {
-        send_message(temp_client->socket, OP_RECONNECT_FAIL, "Invalid format");
-        return;
-    }
+void handle_reconnect_request(Server *server, Client *temp_client, const HandlerArgs *args) {
+    const ReconnectArgs *request = &args->reconnect;
+    const char *room_name = request->fields[0];
+    const char *player_name = request->fields[1];
+    const char *token = request->fields[2];
+    bool has_seq = request->last_seq != 0;
+    uint32_t last_seq = request->last_seq;
 
-    // Clean up input strings
-    player_name[strcspn(player_name, "\r\n")] = '\0';
-    room_name[strcspn(room_name, "\r\n")] = '\0';
+    if (token[0] == '\0') {
+        // Lobby reconnect: "player_name,session_token"
+        room_name = "";
+        player_name = request->fields[0];
+        token = request->fields[1];
+    }
 
     printf("Reconnect request from '%s' (room: %s)\n",
            player_name, room_name[0] ? room_name : "lobby");
 
-    pthread_mutex_lock(&server->clients_mutex);
-    Client *old_client = find_client(server, player_name);
+    pthread_mutex_lock(&server->sessions_mutex);
+    Client *old_client = session_find(server, token);
 
-    if (!old_client) {
-        pthread_mutex_unlock(&server->clients_mutex);
-        send_message(temp_client->socket, OP_RECONNECT_FAIL, "Client not found");
-        printf("Client '%s' not found\n", player_name);
+    if (!old_client || strcmp(old_client->client_id, player_name) != 0) {
+        pthread_mutex_unlock(&server->sessions_mutex);
+        STATS_ADD(reconnects_failed, 1);
+        send_message(temp_client->socket, OP_RECONNECT_FAIL, "Invalid session");
+        printf("No session for '%s'\n", player_name);
         return;
     }
 
@@ -730,7 +1087,8 @@ void handle_reconnect_request(Server *server, Client *temp_client, const char *d
     // Validate client is in a reconnectable state
     if (old_state == CLIENT_STATE_REMOVED) {
         pthread_mutex_unlock(&old_client->state_mutex);
-        pthread_mutex_unlock(&server->clients_mutex);
+        pthread_mutex_unlock(&server->sessions_mutex);
+        STATS_ADD(reconnects_failed, 1);
         send_message(temp_client->socket, OP_RECONNECT_FAIL, "Client was removed");
         printf("Client was removed\n");
         return;
@@ -739,11 +1097,12 @@ void handle_reconnect_request(Server *server, Client *temp_client, const char *d
     if (old_state != CLIENT_STATE_DISCONNECTED &&
         old_state != CLIENT_STATE_TIMEOUT) {
         pthread_mutex_unlock(&old_client->state_mutex);
-        pthread_mutex_unlock(&server->clients_mutex);
+        pthread_mutex_unlock(&server->sessions_mutex);
 
         char msg[128];
         snprintf(msg, sizeof(msg), "Cannot reconnect from state: %s",
                  client_get_state_string(old_state));
+        STATS_ADD(reconnects_failed, 1);
         send_message(temp_client->socket, OP_RECONNECT_FAIL, msg);
         printf("Wrong state: %s\n", client_get_state_string(old_state));
         return;
@@ -754,17 +1113,22 @@ void handle_reconnect_request(Server *server, Client *temp_client, const char *d
            old_client->socket, temp_client->socket);
 
     // Mark as reconnecting to prevent removal by heartbeat thread
-    old_client->state = CLIENT_STATE_RECONNECTING;
+    client_set_state(old_client, CLIENT_STATE_RECONNECTING);
     old_client->disconnect_time = 0;
 
-    // Close old socket if still open (safety measure)
+    // Transfer new socket and thread to existing client structure;
+    // frames are only kept until the session resumes on it
+    pthread_mutex_lock(&old_client->outbox_mutex);
+    old_client->outbox_live = false;
+    uint32_t handover_seq = old_client->outbox.next_seq;
     int old_socket = old_client->socket;
+    old_client->socket = temp_client->socket;
+    pthread_mutex_unlock(&old_client->outbox_mutex);
+
+    // Close old socket if still open (safety measure), now that no send can use it
     if (old_socket > 0) {
-        close(old_socket);
+        transport_close(old_socket);
     }
-
-    // Transfer new socket and thread to existing client structure
-    old_client->socket = temp_client->socket;
     old_client->thread = temp_client->thread;
     old_client->active = true;
     old_client->logged_in = true;
@@ -772,18 +1136,25 @@ void handle_reconnect_request(Server *server, Client *temp_client, const char *d
     client_mark_reconnected(old_client);
 
     pthread_mutex_unlock(&old_client->state_mutex);
+    pthread_mutex_unlock(&server->sessions_mutex);
+
+    // A logged-in connection reconnecting as someone else gives up its own session
+    session_revoke(server, temp_client);
 
     // Invalidate temporary client structure
+    pthread_mutex_lock(&server->clients_mutex);
     temp_client->active = false;
+    client_untrack(temp_client);
+    server->client_count--;
     temp_client->logged_in = false;
     temp_client->client_id[0] = '\0';
     temp_client->socket = -1;
+    pthread_mutex_unlock(&server->clients_mutex);
 
+    STATS_ADD(reconnects_succeeded, 1);
     printf("Socket %d transferred to '%s'\n",
            old_client->socket, player_name);
 
-    pthread_mutex_unlock(&server->clients_mutex);
-
     // Restore client to their previous game state
     ClientGameState game_state = old_client->game_state;
     printf("Restoring state: %s\n",
@@ -792,16 +1163,16 @@ void handle_reconnect_request(Server *server, Client *temp_client, const char *d
     switch (game_state) {
         case CLIENT_GAME_STATE_IN_LOBBY:
             // Reconnect to lobby
-            send_message(old_client->socket, OP_RECONNECT_OK, "lobby");
-            send_message(old_client->socket, OP_LOGIN_OK, player_name);
+            if (!resume_session(old_client, "lobby", has_seq, last_seq, handover_seq)) {
+                send_login_ok(old_client);
+            }
             printf("%s reconnected to lobby\n", player_name);
             break;
 
         case CLIENT_GAME_STATE_IN_ROOM_WAITING:
             // Reconnect to waiting room
             if (room_name[0] == '\0') {
-                send_message(old_client->socket, OP_RECONNECT_FAIL,
-                            "Room name required");
+                reject_resume(old_client, "Room name required", handover_seq);
                 break;
             }
 
@@ -813,18 +1184,18 @@ void handle_reconnect_request(Server *server, Client *temp_client, const char *d
                 pthread_mutex_unlock(&server->rooms_mutex);
                 old_client->current_room[0] = '\0';
                 transition_client_state(old_client, CLIENT_GAME_STATE_IN_LOBBY);
-                send_message(old_client->socket, OP_RECONNECT_FAIL,
-                            "Room was closed");
-                send_message(old_client->socket, OP_LOGIN_OK, player_name);
+                reject_resume(old_client, "Room was closed", handover_seq);
+                send_login_ok(old_client);
                 printf("Room closed, returning to lobby\n");
                 break;
             }
 
-            send_message(old_client->socket, OP_RECONNECT_OK, room_name);
-            char room_info[256];
-            snprintf(room_info, sizeof(room_info), "%s,%d",
-                    room_name, waiting_room->players_count);
-            send_message(old_client->socket, OP_ROOM_JOINED, room_info);
+            if (!resume_session(old_client, room_name, has_seq, last_seq, handover_seq)) {
+                char room_info[256];
+                snprintf(room_info, sizeof(room_info), "%s,%d",
+                        room_name, waiting_room->players_count);
+                send_to_client(old_client, OP_ROOM_JOINED, room_info);
+            }
             pthread_mutex_unlock(&server->rooms_mutex);
 
             printf("%s reconnected to waiting room %s\n",
@@ -834,8 +1205,7 @@ void handle_reconnect_request(Server *server, Client *temp_client, const char *d
         case CLIENT_GAME_STATE_IN_GAME:
             // Reconnect to active game
             if (room_name[0] == '\0') {
-                send_message(old_client->socket, OP_RECONNECT_FAIL,
-                            "Room name required");
+                reject_resume(old_client, "Room name required", handover_seq);
                 break;
             }
 
@@ -847,60 +1217,62 @@ void handle_reconnect_request(Server *server, Client *temp_client, const char *d
                 pthread_mutex_unlock(&server->rooms_mutex);
                 old_client->current_room[0] = '\0';
                 transition_client_state(old_client, CLIENT_GAME_STATE_IN_LOBBY);
-                send_message(old_client->socket, OP_RECONNECT_FAIL, "Game ended");
-                send_message(old_client->socket, OP_LOGIN_OK, player_name);
+                reject_resume(old_client, "Game ended", handover_seq);
+                send_login_ok(old_client);
                 printf("Game ended, returning to lobby\n");
                 break;
             }
 
             // Verify player is a member of this game
-            bool is_player1 = (strcmp(game_room->player1, player_name) == 0);
-            bool is_player2 = (strcmp(game_room->player2, player_name) == 0);
+            bool is_player1 = game_room->player1 == old_client->player_id;
+            bool is_player2 = game_room->player2 == old_client->player_id;
 
             if (!is_player1 && !is_player2) {
                 pthread_mutex_unlock(&server->rooms_mutex);
-                send_message(old_client->socket, OP_RECONNECT_FAIL,
-                            "Not a member");
+                reject_resume(old_client, "Not a member", handover_seq);
                 break;
             }
 
             if (game_room->state == ROOM_STATE_PAUSED) {
                 // Resume paused game
                 room_resume_game(game_room);
-                send_message(old_client->socket, OP_RECONNECT_OK, room_name);
-                send_message(old_client->socket, OP_GAME_RESUMED, room_name);
-                char *board_json = game_board_to_json(&game_room->game);
-                send_message(old_client->socket, OP_GAME_STATE, board_json);
+                bool replayed = resume_session(old_client, room_name, has_seq,
+                                               last_seq, handover_seq);
+                send_to_client(old_client, OP_GAME_RESUMED, room_name);
+                if (!replayed) {
+                    char *board_json = game_board_to_json(&game_room->game);
+                    send_to_client(old_client, OP_GAME_STATE, board_json);
+                }
 
                 // Notify opponent about reconnection and resume
-                char *other_player = is_player1 ? game_room->player2 :
-                                                   game_room->player1;
-                if (other_player[0] != '\0') {
-                    Client *other = find_client(server, other_player);
+                PlayerId other_player = is_player1 ? game_room->player2 :
+                                                     game_room->player1;
+                if (other_player != PLAYER_NONE) {
+                    Client *other = find_client_by_id(server, other_player);
                     if (other && other->state == CLIENT_STATE_CONNECTED) {
                         char msg[256];
                         snprintf(msg, sizeof(msg), "%s,%s",
                                 room_name, player_name);
-                        send_message(other->socket, OP_PLAYER_RECONNECTED, msg);
-                        send_message(other->socket, OP_GAME_RESUMED, room_name);
+                        send_to_client(other, OP_PLAYER_RECONNECTED, msg);
+                        send_to_client(other, OP_GAME_RESUMED, room_name);
                     }
                 }
                 printf("%s reconnected, game resumed\n", player_name);
 
             } else if (game_room->state == ROOM_STATE_ACTIVE) {
                 // Reconnect to already active game
-                send_message(old_client->socket, OP_RECONNECT_OK, room_name);
-                char *board_json = game_board_to_json(&game_room->game);
-                send_message(old_client->socket, OP_GAME_STATE, board_json);
+                if (!resume_session(old_client, room_name, has_seq, last_seq, handover_seq)) {
+                    char *board_json = game_board_to_json(&game_room->game);
+                    send_to_client(old_client, OP_GAME_STATE, board_json);
+                }
                 printf("%s reconnected to active game\n", player_name);
 
             } else {
                 // Game not in valid state, return to lobby
-                send_message(old_client->socket, OP_RECONNECT_FAIL,
-                            "Game not active");
+                reject_resume(old_client, "Game not active", handover_seq);
                 old_client->current_room[0] = '\0';
                 transition_client_state(old_client, CLIENT_GAME_STATE_IN_LOBBY);
-                send_message(old_client->socket, OP_LOGIN_OK, player_name);
+                send_login_ok(old_client);
                 printf("Game not active, returning to lobby\n");
             }
 
@@ -908,7 +1280,7 @@ void handle_reconnect_request(Server *server, Client *temp_client, const char *d
             break;
 
         default:
-            send_message(old_client->socket, OP_RECONNECT_FAIL, "Unknown state");
+            reject_resume(old_client, "Unknown state", handover_seq);
             break;
     }
 }
@@ -943,26 +1315,50 @@ bool can_client_reconnect(Server *server, const char *player_name) {
 
 
 /**
- * Initializes the server with the specified port.
- * Creates and configures the server socket, sets socket options,
- * binds to the port, and begins listening for connections.
+ * Initializes server state without any listener.
+ * Connections are handed over with server_attach.
  *
  * @param server Pointer to the server structure to initialize
- * @param port Port number to bind to
- * @param bind_address Adress to bind to
- * @return 0 on success, -1 on failure
+ * @return 0 on success
  */
-int server_init(Server *server, int port, const char *bind_address) {
-    server->port = port;
+int server_init_local(Server *server) {
+    server->server_socket = -1;
+    server->unix_socket = -1;
+    server->unix_path[0] = '\0';
+    server->backend = SERVER_BACKEND_BLOCKING;
+    server->port = 0;
     server->running = false;
     server->client_count = 0;
     server->room_count = 0;
 
     pthread_mutex_init(&server->clients_mutex, NULL);
     pthread_mutex_init(&server->rooms_mutex, NULL);
+    pthread_mutex_init(&server->sessions_mutex, NULL);
+    pthread_mutex_init(&server->handlers_mutex, NULL);
+    pthread_cond_init(&server->handlers_cond, NULL);
+    server->resume_head = 0;
+    server->resume_count = 0;
+    server->idle_handlers = 0;
 
     memset(server->clients, 0, sizeof(server->clients));
     memset(server->rooms, 0, sizeof(server->rooms));
+    memset(server->sessions, 0, sizeof(server->sessions));
+    return 0;
+}
+
+/**
+ * Initializes the server with the specified port.
+ * Creates and configures the server socket, sets socket options,
+ * binds to the port, and begins listening for connections.
+ *
+ * @param server Pointer to the server structure to initialize
+ * @param port Port number to bind to
+ * @param bind_address Adress to bind to
+ * @return 0 on success, -1 on failure
+ */
+int server_init(Server *server, int port, const char *bind_address) {
+    server_init_local(server);
+    server->port = port;
 
     // Create socket
     server->server_socket = socket(AF_INET, SOCK_STREAM, 0);
@@ -1006,7 +1402,7 @@ int server_init(Server *server, int port, const char *bind_address) {
     }
 
     // Listen
-    if (listen(server->server_socket, 10) < 0) {
+    if (listen(server->server_socket, SOMAXCONN) < 0) {
         perror("Listen failed");
         close(server->server_socket);
         return -1;
@@ -1026,12 +1422,82 @@ int server_init(Server *server, int port, const char *bind_address) {
  * @param data Message payload data
  */
 void send_message(int socket, OpCode op, const char *data) {
-    char buffer[MAX_MESSAGE_LEN];
-    int len = create_message(buffer, op, data);
+    ArenaMark mark = arena_mark(&worker_arena);
+    size_t size = message_frame_size(op, data);
+    char *buffer = arena_alloc(&worker_arena, size);
+    int len = buffer ? format_message(buffer, size, op, data) : -1;
     if (len > 0) {
         printf("Sending message: '%.*s'\n", len, buffer);
-        send(socket, buffer, len, 0);
+        uint64_t start = metrics_now_ns();
+        ssize_t sent = transport_write(socket, buffer, (size_t)len);
+        recorder_frame_out(socket, buffer, (size_t)len);
+        metrics_record_send(op, sent > 0 ? (size_t)sent : 0, metrics_now_ns() - start);
+    }
+    arena_release(&worker_arena, mark);
+}
+
+/**
+ * Sends a protocol message within a client's session.
+ * Once the client has a session token the frame is numbered and kept in
+ * the outbox, so it can be replayed if the client reconnects. OP_LOGIN_OK
+ * restarts the numbering at 1. While a reconnect takes the session over,
+ * frames are only kept; the reconnect replays them.
+ *
+ * @param client Receiving client
+ * @param op Operation code for the message
+ * @param data Message payload data
+ */
+void send_to_client(Client *client, OpCode op, const char *data) {
+    ArenaMark mark = arena_mark(&worker_arena);
+    size_t size = message_frame_size(op, data);
+    char *buffer = arena_alloc(&worker_arena, size);
+    int len = buffer ? format_message(buffer, size, op, data) : -1;
+    if (len <= 0) {
+        arena_release(&worker_arena, mark);
+        return;
+    }
+
+    pthread_mutex_lock(&client->outbox_mutex);
+    if (op == OP_LOGIN_OK) {
+        outbox_reset(&client->outbox);
+    }
+    if (client->session_token[0] != '\0') {
+        outbox_push(&client->outbox, buffer, (size_t)len);
+    }
+
+    int socket = client->socket;
+    if (client->outbox_live && socket >= 0) {
+        printf("Sending message: '%.*s'\n", len, buffer);
+        uint64_t start = metrics_now_ns();
+        ssize_t sent = transport_write(socket, buffer, (size_t)len);
+        recorder_frame_out(socket, buffer, (size_t)len);
+        metrics_record_send(op, sent > 0 ? (size_t)sent : 0, metrics_now_ns() - start);
     }
+    pthread_mutex_unlock(&client->outbox_mutex);
+    arena_release(&worker_arena, mark);
+}
+
+/**
+ * Sends an unnumbered control message (OP_PING) on a client's current
+ * socket. Taken under outbox_mutex like send_to_client, so it neither
+ * interleaves with a numbered frame nor writes to a socket that a
+ * disconnect or reconnect has just taken away.
+ *
+ * @param client Receiving client
+ * @param op Operation code for the message
+ * @param data Message payload data
+ * @return true if the message was written
+ */
+bool send_control_to_client(Client *client, OpCode op, const char *data) {
+    bool sent = false;
+    pthread_mutex_lock(&client->outbox_mutex);
+    int socket = client->socket;
+    if (client->outbox_live && socket >= 0) {
+        send_message(socket, op, data);
+        sent = true;
+    }
+    pthread_mutex_unlock(&client->outbox_mutex);
+    return sent;
 }
 
 /**
@@ -1058,13 +1524,17 @@ int add_client(Server *server, int socket) {
             server->clients[i].active = true;
             server->clients[i].logged_in = false;
             server->clients[i].client_id[0] = '\0';
+            server->clients[i].player_id = PLAYER_NONE;
             server->clients[i].current_room[0] = '\0';
+            outbox_reset(&server->clients[i].outbox);
+            server->clients[i].outbox_live = true;
 
             client_init_heartbeat(&server->clients[i]);
             server->clients[i].game_state = CLIENT_GAME_STATE_NOT_LOGGED_IN;
             server->clients[i].violations.invalid_message_count = 0;
             server->clients[i].violations.unknown_opcode_count = 0;
             server->clients[i].violations.last_violation_time = 0;
+            memset(server->clients[i].rate_buckets, 0, sizeof(server->clients[i].rate_buckets));
             printf("New client initialized in state: %s\n",
                               client_game_state_to_string(server->clients[i].game_state));
             server->client_count++;
@@ -1090,8 +1560,9 @@ int add_client(Server *server, int socket) {
  */
 void disconnect_malicious_client(Server *server, Client *client,
                                 DisconnectReason reason, const char *raw_message) {
-    (void)raw_message;
-    (void)reason;// Unused parameter
+    (void)raw_message; // Unused parameter
+
+    STATS_ADD(disconnect_reasons[reason], 1);
 
     printf("[DISCONNECT] Disconnecting malicious client: %s (socket %d)\n",
            client->client_id, client->socket);
@@ -1103,26 +1574,22 @@ void disconnect_malicious_client(Server *server, Client *client,
     }
 
     // Close connection
-    close(client->socket);
+    int socket = client_detach_socket(client);
+    if (socket >= 0) {
+        transport_close(socket);
+    }
+    session_revoke(server, client);
 
     // Mark as inactive and removed
     pthread_mutex_lock(&client->state_mutex);
     client->active = false;
-    client->state = CLIENT_STATE_REMOVED;
+    client_set_state(client, CLIENT_STATE_REMOVED);
+    client_untrack(client);
     pthread_mutex_unlock(&client->state_mutex);
 
-    //  Remove client from client list
+    // Release the slot; slots are reused through the active flag
     pthread_mutex_lock(&server->clients_mutex);
-    for (int i = 0; i < server->client_count; i++) {
-        if (strcmp(server->clients[i].client_id, client->client_id) == 0) {
-            // Зсуваємо елементи
-            for (int j = i; j < server->client_count - 1; j++) {
-                server->clients[j] = server->clients[j + 1];
-            }
-            server->client_count--;
-            break;
-        }
-    }
+    server->client_count--;
     pthread_mutex_unlock(&server->clients_mutex);
 }
 
@@ -1135,69 +1602,242 @@ void disconnect_malicious_client(Server *server, Client *client,
  * @return Pointer to the client, or NULL if not found
  */
 Client* find_client(Server *server, const char *client_id) {
-    for (int i = 0; i < MAX_CLIENTS; i++) {
-        if (server->clients[i].active &&
-            strcmp(server->clients[i].client_id, client_id) == 0) {
-            return &server->clients[i];
-        }
-    }
-    return NULL;
+    return find_client_by_id(server, symtab_lookup(client_id));
 }
 
 /**
- * Creates a new game room.
+ * Finds a logged-in client by its interned name.
+ * Thread-safe operation - caller should hold clients_mutex if needed.
  *
  * @param server Pointer to the server
- * @param room_name Name for the new room
- * @param creator Name of the player creating the room
- * @return Pointer to the created room, or NULL if room exists or server is full
+ * @param player Interned name of the client
+ * @return Pointer to the client, or NULL if not found
  */
-Room* create_room(Server *server, const char *room_name, const char *creator) {
-    pthread_mutex_lock(&server->rooms_mutex);
-
-    // Check if room already exists
-    for (int i = 0; i < MAX_ROOMS; i++) {
-        if ((server->rooms[i].players_count > 0 || strlen(server->rooms[i].owner) > 0 ) &&
-            strcmp(server->rooms[i].name, room_name) == 0) {
-            pthread_mutex_unlock(&server->rooms_mutex);
-            return NULL;
+Client* find_client_by_id(Server *server, PlayerId player) {
+    if (player == PLAYER_NONE) {
+        return NULL;
+    }
+    const PlayerId *keys = server->client_keys;
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (keys[i] == player) {
+            return server->clients[i].active ? &server->clients[i] : NULL;
         }
     }
+    return NULL;
+}
 
-    // Find empty slot
-    for (int i = 0; i < MAX_ROOMS; i++) {
-        if (server->rooms[i].players_count == 0 && strlen(server->rooms[i].owner) == 0 ) {
-            strncpy(server->rooms[i].name, room_name, MAX_ROOM_NAME - 1);
-            strncpy(server->rooms[i].owner, creator, MAX_PLAYER_NAME - 1);
-            server->rooms[i].owner[MAX_PLAYER_NAME - 1] = '\0';
-            server->rooms[i].player1[0] = '\0';
-            server->rooms[i].player2[0] = '\0';
-            server->rooms[i].players_count = 0;
-            server->rooms[i].game_started = false;
+// ========== SESSIONS ==========
 
-            room_init_state(&server->rooms[i]);
-            server->room_count++;
+/**
+ * Home slot of a token in the session index (FNV-1a).
+ *
+ * @param token Session token
+ * @return Slot index
+ */
+static size_t session_slot(const char *token) {
+    uint32_t hash = 2166136261u;
+    for (const char *p = token; *p; p++) {
+        hash = (hash ^ (unsigned char)*p) * 16777619u;
+    }
+    return hash % SESSION_INDEX_SIZE;
+}
 
-            pthread_mutex_unlock(&server->rooms_mutex);
-            return &server->rooms[i];
+/**
+ * Compares two tokens in time independent of where they differ.
+ *
+ * @return true if both tokens are equal
+ */
+static bool session_token_equal(const char *a, const char *b) {
+    unsigned char diff = 0;
+    for (int i = 0; i < SESSION_TOKEN_LEN; i++) {
+        diff |= (unsigned char)(a[i] ^ b[i]);
+        if (a[i] == '\0' || b[i] == '\0') {
+            return false;
         }
     }
-
-    pthread_mutex_unlock(&server->rooms_mutex);
-    return NULL;
+    return diff == 0;
 }
 
 /**
- * Finds a room by name.
- * Thread-safe operation - caller should hold rooms_mutex if needed.
+ * Issues a random session token to a logged-in client and indexes it.
+ * The token survives reconnects and is revoked when the slot is released.
+ *
+ * @param server Pointer to the server
+ * @param client Client that just logged in
+ * @return 0 on success, -1 if no random bytes were available
+ */
+int session_issue(Server *server, Client *client) {
+    static const char hex[] = "0123456789abcdef";
+    unsigned char bytes[SESSION_TOKEN_LEN / 2];
+
+    if (getrandom(bytes, sizeof(bytes), 0) != (ssize_t)sizeof(bytes)) {
+        perror("getrandom failed");
+        return -1;
+    }
+
+    session_revoke(server, client);
+
+    pthread_mutex_lock(&server->sessions_mutex);
+    for (size_t i = 0; i < sizeof(bytes); i++) {
+        client->session_token[2 * i] = hex[bytes[i] >> 4];
+        client->session_token[2 * i + 1] = hex[bytes[i] & 0x0f];
+    }
+    client->session_token[SESSION_TOKEN_LEN] = '\0';
+
+    size_t slot = session_slot(client->session_token);
+    while (server->sessions[slot]) {
+        slot = (slot + 1) % SESSION_INDEX_SIZE;
+    }
+    server->sessions[slot] = client;
+    pthread_mutex_unlock(&server->sessions_mutex);
+    return 0;
+}
+
+/**
+ * Finds the client owning a session token.
+ * Caller holds sessions_mutex.
+ *
+ * @param server Pointer to the server
+ * @param token Session token from the client
+ * @return Pointer to the client, or NULL if the token is unknown
+ */
+Client* session_find(Server *server, const char *token) {
+    if (strlen(token) != SESSION_TOKEN_LEN) {
+        return NULL;
+    }
+
+    for (size_t slot = session_slot(token); server->sessions[slot];
+         slot = (slot + 1) % SESSION_INDEX_SIZE) {
+        if (session_token_equal(server->sessions[slot]->session_token, token)) {
+            return server->sessions[slot];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Removes a client's token from the index, clears it and releases
+ * the session's outbox and interned name. Later entries of the probe
+ * chain are shifted back, so lookups never need tombstones.
+ *
+ * @param server Pointer to the server
+ * @param client Client whose slot is being released
+ */
+void session_revoke(Server *server, Client *client) {
+    server->client_keys[client - server->clients] = PLAYER_NONE;
+    matchmaking_remove(client->player_id);
+    symtab_release(client->player_id);
+    client->player_id = PLAYER_NONE;
+
+    pthread_mutex_lock(&server->sessions_mutex);
+    if (client->session_token[0] == '\0') {
+        pthread_mutex_unlock(&server->sessions_mutex);
+        return;
+    }
+
+    size_t hole = session_slot(client->session_token);
+    while (server->sessions[hole] && server->sessions[hole] != client) {
+        hole = (hole + 1) % SESSION_INDEX_SIZE;
+    }
+
+    if (server->sessions[hole] == client) {
+        server->sessions[hole] = NULL;
+        size_t next = hole;
+        for (;;) {
+            next = (next + 1) % SESSION_INDEX_SIZE;
+            if (!server->sessions[next]) {
+                break;
+            }
+            // An entry may fill the hole unless its home lies in (hole, next]
+            size_t home = session_slot(server->sessions[next]->session_token);
+            bool stays = hole < next ? (home > hole && home <= next)
+                                     : (home > hole || home <= next);
+            if (!stays) {
+                server->sessions[hole] = server->sessions[next];
+                server->sessions[next] = NULL;
+                hole = next;
+            }
+        }
+    }
+
+    client->session_token[0] = '\0';
+    pthread_mutex_unlock(&server->sessions_mutex);
+
+    pthread_mutex_lock(&client->outbox_mutex);
+    outbox_free(&client->outbox);
+    pthread_mutex_unlock(&client->outbox_mutex);
+}
+
+/**
+ * Creates a new game room.
+ *
+ * @param server Pointer to the server
+ * @param room_name Name for the new room
+ * @param creator Name of the player creating the room
+ * @return Pointer to the created room, or NULL if room exists or server is full
+ */
+Room* create_room(Server *server, const char *room_name, const char *creator) {
+    pthread_mutex_lock(&server->rooms_mutex);
+
+    // Check if room already exists
+    if (find_room(server, room_name)) {
+        pthread_mutex_unlock(&server->rooms_mutex);
+        return NULL;
+    }
+
+    // Find empty slot
+    for (int i = 0; i < MAX_ROOMS; i++) {
+        if (server->room_keys[i] == 0) {
+            PlayerId owner = symtab_intern(creator);
+            if (owner == PLAYER_NONE) {
+                break;
+            }
+            strncpy(server->rooms[i].name, room_name, MAX_ROOM_NAME - 1);
+            server->rooms[i].owner = owner;
+            server->room_keys[i] = room_key(server->rooms[i].name);
+            server->rooms[i].player1 = PLAYER_NONE;
+            server->rooms[i].player2 = PLAYER_NONE;
+            server->rooms[i].players_count = 0;
+            server->rooms[i].game_started = false;
+
+            room_init_state(&server->rooms[i]);
+            server->room_count++;
+
+            pthread_mutex_unlock(&server->rooms_mutex);
+            return &server->rooms[i];
+        }
+    }
+
+    pthread_mutex_unlock(&server->rooms_mutex);
+    return NULL;
+}
+
+/**
+ * Hashes a room name into its room_keys entry (FNV-1a).
+ *
+ * @param room_name Room name
+ * @return Key, never 0, which marks a free slot
+ */
+uint32_t room_key(const char *room_name) {
+    uint32_t hash = 2166136261u;
+    for (const char *p = room_name; *p; p++) {
+        hash = (hash ^ (unsigned char)*p) * 16777619u;
+    }
+    return hash | 1u;
+}
+
+/**
+ * Finds a room by name.
+ * Thread-safe operation - caller should hold rooms_mutex if needed.
  *
  * @param server Pointer to the server
  * @param room_name Name of the room to find
  * @return Pointer to the room, or NULL if not found
  */
 Room* find_room(Server *server, const char *room_name) {
+    uint32_t key = room_key(room_name);
     for (int i = 0; i < MAX_ROOMS; i++) {
-        if ((server->rooms[i].players_count > 0 || strlen(server->rooms[i].owner) > 0)&&
+        if (server->room_keys[i] == key &&
             strcmp(server->rooms[i].name, room_name) == 0) {
             return &server->rooms[i];
         }
@@ -1235,8 +1875,8 @@ int join_room(Server *server, const char *room_name, const char *player_name) {
     }
 
     // Check if player already in this room
-    if (strcmp(room->player1, player_name) == 0 ||
-        strcmp(room->player2, player_name) == 0) {
+    PlayerId player = symtab_lookup(player_name);
+    if (player != PLAYER_NONE && (room->player1 == player || room->player2 == player)) {
         pthread_mutex_unlock(&server->rooms_mutex);
         return -3;
     }
@@ -1244,7 +1884,7 @@ int join_room(Server *server, const char *room_name, const char *player_name) {
     pthread_mutex_unlock(&server->rooms_mutex);
     // Verify client exists and is not in another room
     pthread_mutex_lock(&server->clients_mutex);
-    Client *client = find_client(server, player_name);
+    Client *client = find_client_by_id(server, player);
     if (!client) {
         pthread_mutex_unlock(&server->clients_mutex);
         return -5;
@@ -1254,6 +1894,8 @@ int join_room(Server *server, const char *room_name, const char *player_name) {
         pthread_mutex_unlock(&server->clients_mutex);
         return -4;
     }
+    // The room's reference keeps the name after the client logs out
+    symtab_retain(player);
     pthread_mutex_unlock(&server->clients_mutex);
     // Re-acquire room lock and add player
     pthread_mutex_lock(&server->rooms_mutex);
@@ -1262,27 +1904,29 @@ int join_room(Server *server, const char *room_name, const char *player_name) {
     room = find_room(server, room_name);
     if (!room) {
         pthread_mutex_unlock(&server->rooms_mutex);
+        symtab_release(player);
         return -1;
     }
     // Add player to first available slot
-    if (room->player1[0] == '\0') {
-        strncpy(room->player1, player_name, MAX_PLAYER_NAME - 1);
-        room->player1[MAX_PLAYER_NAME - 1] = '\0';
+    if (room->player1 == PLAYER_NONE) {
+        room->player1 = player;
         room->players_count = 1;
-    } else if (room->player2[0] == '\0') {
-        strncpy(room->player2, player_name, MAX_PLAYER_NAME - 1);
-        room->player2[MAX_PLAYER_NAME - 1] = '\0';
+    } else if (room->player2 == PLAYER_NONE) {
+        room->player2 = player;
         room->players_count = 2;
+    } else {
+        symtab_release(player);
     }
 
     // Initialize game when both players have joined
     if (room->players_count == 2 && !room->game_started) {
         init_game(&room->game, room->player1, room->player2);
         room->game_started = true;
-        room->state = ROOM_STATE_ACTIVE;
+        room_set_state(room, ROOM_STATE_ACTIVE);
+        STATS_ADD(games_started, 1);
 
         printf("Game initialized in room %s: %s vs %s\n",
-               room_name, room->player1, room->player2);
+               room_name, symtab_name(room->player1), symtab_name(room->player2));
     }
 
     pthread_mutex_unlock(&server->rooms_mutex);
@@ -1337,30 +1981,26 @@ void leave_room(Server *server, const char *room_name, const char *player_name)
 
     if (room->players_count == 0) {
         // Last player left - destroy room
-        pthread_mutex_destroy(&room->room_mutex);
-        memset(room, 0, sizeof(Room));
-        server->room_count--;
+        room_free(server, room);
         printf("Room %s removed (no players left)\n", room_name);
     } else {
         // Find and notify the remaining player
         Client *other = NULL;
-        if (strcmp(room->player1, player_name) != 0) {
-            other = find_client(server, room->player1);
-        } else if (room->player2[0] != '\0') {
-            other = find_client(server, room->player2);
+        if (room->player1 != symtab_lookup(player_name)) {
+            other = find_client_by_id(server, room->player1);
+        } else if (room->player2 != PLAYER_NONE) {
+            other = find_client_by_id(server, room->player2);
         }
 
         if (other) {
             other->current_room[0] = '\0';
             char msg[256];
             snprintf(msg, sizeof(msg), "%s,%s", room_name, player_name);
-            send_message(other->socket, OP_ROOM_LEFT, msg);
+            send_to_client(other, OP_ROOM_LEFT, msg);
             transition_client_state(other, CLIENT_GAME_STATE_IN_LOBBY);
         }
         // Destroy room after notifying
-        pthread_mutex_destroy(&room->room_mutex);
-        memset(room, 0, sizeof(Room));
-        server->room_count--;
+        room_free(server, room);
         printf("Room %s removed (player left)\n", room_name);
     }
 
@@ -1379,11 +2019,12 @@ void broadcast_to_room(Server *server, const char *room_name, OpCode op, const c
     Room *room = find_room(server, room_name);
     if (!room) return;
 
-    Client *p1 = find_client(server, room->player1);
-    Client *p2 = (room->player2[0] != '\0') ? find_client(server, room->player2) : NULL;
+    Client *p1 = find_client_by_id(server, room->player1);
+    Client *p2 = find_client_by_id(server, room->player2);
 
-    if (p1) send_message(p1->socket, op, data);
-    if (p2) send_message(p2->socket, op, data);
+    if (p1) send_to_client(p1, op, data);
+    if (p2) send_to_client(p2, op, data);
+    PROBE3(broadcast__sent, room_name, (int)op, (p1 != NULL) + (p2 != NULL));
 }
 
 /**
@@ -1394,40 +2035,51 @@ void broadcast_to_room(Server *server, const char *room_name, OpCode op, const c
  *
  * @param server Pointer to the server
  * @param client Pointer to the client attempting to login
- * @param data Login data containing player name
+ * @param args Player name
  */
-void handle_login(Server *server, Client *client, const char *data) {
+void handle_login(Server *server, Client *client, const HandlerArgs *args) {
     pthread_mutex_lock(&server->clients_mutex);
 
-    // Clean input
-    char clean_id[MAX_PLAYER_NAME];
-    strncpy(clean_id, data, MAX_PLAYER_NAME - 1);
-    clean_id[MAX_PLAYER_NAME - 1] = '\0';
-    clean_id[strcspn(clean_id, "\r\n")] = '\0';
+    const char *clean_id = args->login.player;
 
     // Validate name length
     if (strlen(clean_id) == 0) {
         pthread_mutex_unlock(&server->clients_mutex);
-        send_message(client->socket, OP_LOGIN_FAIL, "Name cannot be empty");
+        send_to_client(client, OP_LOGIN_FAIL, "Name cannot be empty");
         printf("Login failed: empty name\n");
         return;
     }
 
     // Check if client_id already exists
-    for (int i = 0; i < MAX_CLIENTS; i++) {
-        if (server->clients[i].active &&
-            server->clients[i].logged_in &&
-            strcmp(server->clients[i].client_id, clean_id) == 0) {
-            pthread_mutex_unlock(&server->clients_mutex);
-            send_message(client->socket, OP_LOGIN_FAIL, "Client ID already in use");
-            printf("Login failed: '%s' already in use\n", clean_id);
-            return;
-            }
+    Client *existing = find_client(server, clean_id);
+    if (existing && existing->logged_in) {
+        pthread_mutex_unlock(&server->clients_mutex);
+        send_to_client(client, OP_LOGIN_FAIL, "Client ID already in use");
+        printf("Login failed: '%s' already in use\n", clean_id);
+        return;
+    }
+
+    PlayerId player_id = symtab_intern(clean_id);
+    if (player_id == PLAYER_NONE) {
+        pthread_mutex_unlock(&server->clients_mutex);
+        send_to_client(client, OP_LOGIN_FAIL, "Server full");
+        printf("Login failed: no name slot for '%s'\n", clean_id);
+        return;
+    }
+
+    if (session_issue(server, client) < 0) {
+        symtab_release(player_id);
+        pthread_mutex_unlock(&server->clients_mutex);
+        send_to_client(client, OP_LOGIN_FAIL, "Session unavailable");
+        printf("Login failed: no session token for '%s'\n", clean_id);
+        return;
     }
 
     // Save client_id
     strncpy(client->client_id, clean_id, MAX_PLAYER_NAME - 1);
     client->client_id[MAX_PLAYER_NAME - 1] = '\0';
+    client->player_id = player_id;
+    server->client_keys[client - server->clients] = player_id;
 
     transition_client_state(client, CLIENT_GAME_STATE_IN_LOBBY);
     client->logged_in = true;
@@ -1435,7 +2087,7 @@ void handle_login(Server *server, Client *client, const char *data) {
 
     pthread_mutex_unlock(&server->clients_mutex);
 
-    send_message(client->socket, OP_LOGIN_OK, clean_id);
+    send_login_ok(client);
     log_client(client);
     printf("Client logged in: '%s' (socket %d)\n", client->client_id, client->socket);
 }
@@ -1450,34 +2102,68 @@ void handle_login(Server *server, Client *client, const char *data) {
  *
  * @param server Pointer to the server
  * @param client Pointer to the client creating the room
- * @param data Room creation data
+ * @param args Player and room name
  */
-void handle_create_room(Server *server, Client *client, const char *data) {
-    if (!client->logged_in) {
-        send_message(client->socket, OP_ROOM_FAIL, "Not logged in");
-        return;
-    }
-
-    // Parse: player_name,room_name
-    char player_name[MAX_PLAYER_NAME];
-    char room_name[MAX_ROOM_NAME];
+void handle_create_room(Server *server, Client *client, const HandlerArgs *args) {
+    const char *player_name = args->room.player;
+    const char *room_name = args->room.room;
 
-    if (sscanf(data, "%[^,],%s", player_name, room_name) != 2) {
-        send_message(client->socket, OP_ROOM_FAIL, "Invalid format");
+    // Matchmaking numbers its rooms under this prefix
+    if (strncmp(room_name, QUICK_MATCH_ROOM_PREFIX, strlen(QUICK_MATCH_ROOM_PREFIX)) == 0) {
+        send_to_client(client, OP_ROOM_FAIL, "Room name reserved for quick matches");
         return;
     }
 
     Room *room = create_room(server, room_name, player_name);
     if (!room) {
-        send_message(client->socket, OP_ROOM_FAIL, "Room already exists or server full");
+        send_to_client(client, OP_ROOM_FAIL, "Room already exists or server full");
         return;
     }
 
-    send_message(client->socket, OP_ROOM_CREATED, room_name);
+    send_to_client(client, OP_ROOM_CREATED, room_name);
     printf("Room created: %s by %s. Players count=%d\n", room_name, player_name, room->players_count);
     log_client(client);
 }
 
+/**
+ * Moves both players of a room whose game has just been initialized
+ * into the game and sends them the start message and initial board.
+ * The room is read under rooms_mutex, since a leave or disconnect on
+ * another thread can change or free it.
+ *
+ * @param server Pointer to the server
+ * @param room_name Room with both players joined
+ */
+static void announce_game_start(Server *server, const char *room_name) {
+    char game_start_msg[512];
+    pthread_mutex_lock(&server->rooms_mutex);
+    Room *room = find_room(server, room_name);
+    if (!room || !room->game_started) {
+        pthread_mutex_unlock(&server->rooms_mutex);
+        return;
+    }
+    PlayerId player1 = room->player1;
+    PlayerId player2 = room->player2;
+    snprintf(game_start_msg, sizeof(game_start_msg), "%s,%s,%s,%s",
+            room->name, symtab_name(player1), symtab_name(player2),
+            symtab_name(game_turn_player(&room->game)));
+    // Thread-local buffer, valid until this thread formats another board
+    char *board_json = game_board_to_json(&room->game);
+    pthread_mutex_unlock(&server->rooms_mutex);
+
+    pthread_mutex_lock(&server->clients_mutex);
+    Client *client1 = find_client_by_id(server, player1);
+    Client *client2 = find_client_by_id(server, player2);
+    pthread_mutex_unlock(&server->clients_mutex);
+    // A player removed meanwhile has no client; the room still gets the start
+    if (client1) transition_client_state(client1, CLIENT_GAME_STATE_IN_GAME);
+    if (client2) transition_client_state(client2, CLIENT_GAME_STATE_IN_GAME);
+    broadcast_to_room(server, room_name, OP_GAME_START, game_start_msg);
+
+    // Send initial board state
+    broadcast_to_room(server, room_name, OP_GAME_STATE, board_json);
+}
+
 /**
  * Handles player request to join a room.
  * Validates room availability and player eligibility, then adds player to room.
@@ -1487,74 +2173,51 @@ void handle_create_room(Server *server, Client *client, const char *data) {
  *
  * @param server Pointer to the server
  * @param client Pointer to the client joining
- * @param data Join request data
+ * @param args Player and room name
  */
-void handle_join_room(Server *server, Client *client, const char *data) {
-
-    if (!client->logged_in) {
-        send_message(client->socket, OP_ROOM_FAIL, "Not logged in");
-        return;
-    }
-
-    char player_name[MAX_PLAYER_NAME];
-    char room_name[MAX_ROOM_NAME];
-
-    if (sscanf(data, "%[^,],%s", player_name, room_name) != 2) {
-        send_message(client->socket, OP_ROOM_FAIL, "Invalid format");
-        return;
-    }
+void handle_join_room(Server *server, Client *client, const HandlerArgs *args) {
+    const char *player_name = args->room.player;
+    const char *room_name = args->room.room;
 
     int result = join_room(server, room_name, player_name);
 
     // Handle various error conditions
     if (result == -1) {
-        send_message(client->socket, OP_ROOM_FAIL, "Room not found");
+        send_to_client(client, OP_ROOM_FAIL, "Room not found");
         return;
     } else if (result == -2) {
-        send_message(client->socket, OP_ROOM_FULL, "Room is full");
+        send_to_client(client, OP_ROOM_FULL, "Room is full");
         return;
     } else if (result == -3) {
-        send_message(client->socket, OP_ROOM_FAIL, "You are already in this room");
+        send_to_client(client, OP_ROOM_FAIL, "You are already in this room");
         return;
     } else if (result == -4) {
-        send_message(client->socket, OP_ROOM_FAIL, "Already in another room. Leave first.");
+        send_to_client(client, OP_ROOM_FAIL, "Already in another room. Leave first.");
         return;
     }  else if (result == -5) {
-        send_message(client->socket, OP_ROOM_FAIL, "Client not found");
+        send_to_client(client, OP_ROOM_FAIL, "Client not found");
         return;
     }
 
     // Update client's current room
     strncpy(client->current_room, room_name, MAX_ROOM_NAME - 1);
     client->current_room[MAX_ROOM_NAME - 1] = '\0';
+    matchmaking_remove(client->player_id);
 
     Room *room = find_room(server, room_name);
     if (!room) {
-        send_message(client->socket, OP_ROOM_FAIL, "Room disappeared");
+        send_to_client(client, OP_ROOM_FAIL, "Room disappeared");
         return;
     }
 
     // Notify client of successful join
     char response[256];
     snprintf(response, sizeof(response), "%s,%d", room_name, room->players_count);
-    send_message(client->socket, OP_ROOM_JOINED, response);
+    send_to_client(client, OP_ROOM_JOINED, response);
 
     // Start game only if 2 players joined
     if (room->game_started) {
-        pthread_mutex_lock(&server->clients_mutex);
-        Client *client1 = find_client(server, room->player1);
-        Client *client2 = find_client(server, room->player2);
-        pthread_mutex_unlock(&server->clients_mutex);
-        transition_client_state(client1, CLIENT_GAME_STATE_IN_GAME);
-        transition_client_state(client2, CLIENT_GAME_STATE_IN_GAME);
-        char game_start_msg[512];
-        snprintf(game_start_msg, sizeof(game_start_msg), "%s,%s,%s,%s",
-                room_name, room->player1, room->player2, room->game.current_turn);
-        broadcast_to_room(server, room_name, OP_GAME_START, game_start_msg);
-
-        // Send initial board state
-        char *board_json = game_board_to_json(&room->game);
-        broadcast_to_room(server, room_name, OP_GAME_STATE, board_json);
+        announce_game_start(server, room_name);
     }else {
         transition_client_state(client, CLIENT_GAME_STATE_IN_ROOM_WAITING);
     }
@@ -1562,6 +2225,119 @@ void handle_join_room(Server *server, Client *client, const char *data) {
     printf("Player %s joined room %s (players: %d/2)\n", player_name, room_name, room->players_count);
 }
 
+/**
+ * Starts the game of a matched pair: creates a room for them and joins
+ * both through the same path as OP_JOIN_ROOM, so the game is
+ * initialized by join_room. Releases the pair's name references.
+ *
+ * @param server Pointer to the server
+ * @param pair Players taken out of the matchmaking queue
+ */
+static void start_matched_game(Server *server, const MatchPair *pair) {
+    const char *first_name = symtab_name(pair->first);
+    const char *second_name = symtab_name(pair->second);
+    char room_name[MAX_ROOM_NAME];
+    snprintf(room_name, sizeof(room_name), QUICK_MATCH_ROOM_PREFIX "%llu",
+             (unsigned long long)STATS_ADD(quick_matches, 1) + 1);
+
+    int joined = 0;
+    if (create_room(server, room_name, first_name)) {
+        if (join_room(server, room_name, first_name) == 0) {
+            joined++;
+            if (join_room(server, room_name, second_name) == 0) {
+                joined++;
+            }
+        }
+    }
+
+    pthread_mutex_lock(&server->clients_mutex);
+    Client *client1 = find_client_by_id(server, pair->first);
+    Client *client2 = find_client_by_id(server, pair->second);
+    pthread_mutex_unlock(&server->clients_mutex);
+
+    // The room may already be changing: read it under rooms_mutex
+    int players_count = 0;
+    bool game_started = false;
+    pthread_mutex_lock(&server->rooms_mutex);
+    Room *room = find_room(server, room_name);
+    if (room) {
+        players_count = room->players_count;
+        game_started = room->game_started;
+    }
+    bool started = joined == 2 && client1 && client2 && game_started;
+    if (!started && room) {
+        room_free(server, room);
+    }
+    pthread_mutex_unlock(&server->rooms_mutex);
+
+    if (!started) {
+        // A player logged out, was removed or found a room between matching and joining
+        if (client1) send_to_client(client1, OP_ROOM_FAIL, "Match could not be started");
+        if (client2) send_to_client(client2, OP_ROOM_FAIL, "Match could not be started");
+        printf("Quick match %s vs %s failed\n", first_name, second_name);
+    } else {
+        Client *players[2] = { client1, client2 };
+        // Other clients' rooms are set under clients_mutex, as in cleanup_finished_game
+        pthread_mutex_lock(&server->clients_mutex);
+        for (int i = 0; i < 2; i++) {
+            strncpy(players[i]->current_room, room_name, MAX_ROOM_NAME - 1);
+            players[i]->current_room[MAX_ROOM_NAME - 1] = '\0';
+        }
+        pthread_mutex_unlock(&server->clients_mutex);
+
+        char response[256];
+        snprintf(response, sizeof(response), "%s,%d", room_name, players_count);
+        for (int i = 0; i < 2; i++) {
+            send_to_client(players[i], OP_ROOM_JOINED, response);
+        }
+        announce_game_start(server, room_name);
+        printf("Quick match in room %s: %s vs %s\n", room_name, first_name, second_name);
+    }
+
+    symtab_release(pair->first);
+    symtab_release(pair->second);
+}
+
+/**
+ * Handles a request to be matched with an opponent of similar rating.
+ * Starts a game right away if a queued player is within the rating
+ * band, otherwise queues the player until the heartbeat sweep finds one
+ * as the bands widen.
+ *
+ * Protocol format: "player_name"
+ *
+ * @param server Pointer to the server
+ * @param client Pointer to the client asking for a match
+ * @param args Player name
+ */
+void handle_quick_match(Server *server, Client *client, const HandlerArgs *args) {
+    if (client->player_id == PLAYER_NONE || strcmp(args->login.player, client->client_id) != 0) {
+        send_to_client(client, OP_ROOM_FAIL, "Invalid player");
+        return;
+    }
+    if (client->current_room[0] != '\0') {
+        send_to_client(client, OP_ROOM_FAIL, "Already in a room. Leave first.");
+        return;
+    }
+
+    int rating = ratings_get(client->player_id);
+    MatchPair pair;
+    int result = matchmaking_enqueue(client->player_id, rating, time(NULL), &pair);
+    if (result < 0) {
+        send_to_client(client, OP_ROOM_FAIL, "Already waiting for a match");
+        return;
+    }
+    if (result == 0) {
+        char response[16];
+        snprintf(response, sizeof(response), "%d", rating);
+        send_to_client(client, OP_QUICK_MATCH_QUEUED, response);
+        printf("Player %s queued for a quick match (rating %d)\n", client->client_id, rating);
+        return;
+    }
+
+    start_matched_game(server, &pair);
+}
+
 
 /**
  * Handles a single move in the checkers game.
@@ -1571,40 +2347,40 @@ void handle_join_room(Server *server, Client *client, const char *data) {
  *
  * @param server Pointer to the server
  * @param client Pointer to the client making the move
- * @param data Move data
+ * @param args Room, player and move squares
  */
-void handle_move(Server *server, Client *client, const char *data) {
-    if (!client->logged_in || client->current_room[0] == '\0') {
-        send_message(client->socket, OP_ERROR, "Not in a game");
+void handle_move(Server *server, Client *client, const HandlerArgs *args) {
+    if (client->current_room[0] == '\0') {
+        send_to_client(client, OP_ERROR, "Not in a game");
         return;
     }
 
-    // Parse: room_name,player_name,from_row,from_col,to_row,to_col
-    char room_name[MAX_ROOM_NAME];
-    char player_name[MAX_PLAYER_NAME];
-    int from_row, from_col, to_row, to_col;
-
-    if (sscanf(data, "%[^,],%[^,],%d,%d,%d,%d",
-               room_name, player_name, &from_row, &from_col, &to_row, &to_col) != 6) {
-        send_message(client->socket, OP_INVALID_MOVE, "Invalid move format");
-        return;
-    }
+    const char *room_name = args->move.room;
+    const char *player_name = args->move.player;
+    int from_row = args->move.from_row;
+    int from_col = args->move.from_col;
+    int to_row = args->move.to_row;
+    int to_col = args->move.to_col;
 
     Room *room = find_room(server, room_name);
     if (!room || !room->game_started) {
-        send_message(client->socket, OP_ERROR, "Game not found");
+        send_to_client(client, OP_ERROR, "Game not found");
         return;
     }
 
     print_board(&room->game);
     // Validate move according to game rules
-    if (!validate_move(&room->game, from_row, from_col, to_row, to_col, player_name)) {
-        send_message(client->socket, OP_INVALID_MOVE, "Invalid move");
+    PlayerId player = symtab_lookup(player_name);
+    if (!validate_move(&room->game, from_row, from_col, to_row, to_col, player)) {
+        PROBE4(move__validated, room_name, player_name, 0, 1);
+        send_to_client(client, OP_INVALID_MOVE, "Invalid move");
         return;
     }
+    PROBE4(move__validated, room_name, player_name, 1, 1);
 
     // Apply move
     apply_move(&room->game, from_row, from_col, to_row, to_col);
+    PROBE3(move__applied, room_name, player_name, 1);
     change_turn(&room->game);
 
     // Send updated board to both players
@@ -1612,14 +2388,7 @@ void handle_move(Server *server, Client *client, const char *data) {
     broadcast_to_room(server, room_name, OP_GAME_STATE, board_json);
 
     // Check for game over
-    char winner[MAX_PLAYER_NAME];
-    if (check_game_over(&room->game, winner)) {
-        char end_msg[256];
-        snprintf(end_msg, sizeof(end_msg), "%s,no_pieces", winner);
-        broadcast_to_room(server, room_name, OP_GAME_END, end_msg);
-        cleanup_finished_game(server, room);
-        printf("Game over! Winner: %s\n", winner);
-    }
+    check_game_end(server, room);
 }
 
 /**
@@ -1631,69 +2400,39 @@ void handle_move(Server *server, Client *client, const char *data) {
  *
  * @param server Pointer to the server
  * @param client Pointer to the client making the multi-move
- * @param data Multi-move data containing the complete path
+ * @param args Room, player and the complete path
  */
-void handle_multi_move(Server *server, Client *client, const char *data) {
-    if (!client->logged_in || client->current_room[0] == '\0') {
-        send_message(client->socket, OP_ERROR, "Not in a game");
+void handle_multi_move(Server *server, Client *client, const HandlerArgs *args) {
+    if (client->current_room[0] == '\0') {
+        send_to_client(client, OP_ERROR, "Not in a game");
         return;
     }
 
     printf("\n=== HANDLE MULTI MOVE ===\n");
-    printf("Data: %s\n", data);
-
-    // Parse: room_name,player_name,path_length,r1,c1,r2,c2,...
-    char room_name[MAX_ROOM_NAME];
-    char player_name[MAX_PLAYER_NAME];
-    int path_length;
-
-    // Parse first three fields
-    int parsed = sscanf(data, "%[^,],%[^,],%d", room_name, player_name, &path_length);
 
-    if (parsed != 3 || path_length < 2 || path_length > 20) {
-        send_message(client->socket, OP_INVALID_MOVE, "Invalid multi-move format");
-        printf("Parse error: parsed=%d, path_length=%d\n", parsed, path_length);
-        return;
-    }
+    const char *room_name = args->multi_move.room;
+    const char *player_name = args->multi_move.player;
+    int path_length = args->multi_move.path_length;
+    const int (*path)[2] = args->multi_move.path;
 
     printf("Room: %s, Player: %s, Path length: %d\n", room_name, player_name, path_length);
 
     Room *room = find_room(server, room_name);
     if (!room || !room->game_started) {
-        send_message(client->socket, OP_ERROR, "Game not found");
+        send_to_client(client, OP_ERROR, "Game not found");
         return;
     }
 
-    int path[20][2];  // Maximum 20 positions
-    const char *ptr = data;
-
-    // Skip first three fields
-    for (int i = 0; i < 3; i++) {
-        ptr = strchr(ptr, ',');
-        if (!ptr) {
-            send_message(client->socket, OP_INVALID_MOVE, "Invalid path data");
-            return;
-        }
-        ptr++; // // Skip comma
-    }
-
-    // // Parse coordinate pairs
-    for (int i = 0; i < path_length; i++) {
-        if (sscanf(ptr, "%d,%d", &path[i][0], &path[i][1]) != 2) {
-            send_message(client->socket, OP_INVALID_MOVE, "Invalid coordinates");
-            printf("Failed to parse position %d\n", i);
-            return;
-        }
-
-        printf("Position %d: (%d, %d)\n", i, path[i][0], path[i][1]);
-        ptr = strchr(ptr, ',');
-        if (ptr) ptr++;
-        ptr = strchr(ptr, ',');
-        if (ptr && i < path_length - 1) ptr++;
+    if (args->multi_move.coord_count != 2 * path_length) {
+        send_to_client(client, OP_INVALID_MOVE, "Invalid coordinates");
+        printf("Expected %d coordinates, got %d\n",
+               2 * path_length, args->multi_move.coord_count);
+        return;
     }
 
     // // Validate and apply the chain of moves
     printf("\n=== VALIDATING MULTI-MOVE CHAIN ===\n");
+    PlayerId player = symtab_lookup(player_name);
 
     for (int i = 0; i < path_length - 1; i++) {
         int from_row = path[i][0];
@@ -1704,8 +2443,9 @@ void handle_multi_move(Server *server, Client *client, const char *data) {
         printf("Step %d: (%d,%d) -> (%d,%d)\n", i + 1, from_row, from_col, to_row, to_col);
 
         print_board(&room->game);
-        if (!validate_move(&room->game, from_row, from_col, to_row, to_col, player_name)) {
-            send_message(client->socket, OP_INVALID_MOVE, "Invalid move in chain");
+        if (!validate_move(&room->game, from_row, from_col, to_row, to_col, player)) {
+            PROBE4(move__validated, room_name, player_name, 0, i + 1);
+            send_to_client(client, OP_INVALID_MOVE, "Invalid move in chain");
             printf("Step %d failed validation\n", i + 1);
             return;
         }
@@ -1716,6 +2456,8 @@ void handle_multi_move(Server *server, Client *client, const char *data) {
     }
 
     printf("=== MULTI-MOVE CHAIN COMPLETED ===\n\n");
+    PROBE4(move__validated, room_name, player_name, 1, path_length - 1);
+    PROBE3(move__applied, room_name, player_name, path_length - 1);
 
     // Change turn
     change_turn(&room->game);
@@ -1725,14 +2467,45 @@ void handle_multi_move(Server *server, Client *client, const char *data) {
     broadcast_to_room(server, room_name, OP_GAME_STATE, board_json);
 
     // Check for game over
-    char winner[MAX_PLAYER_NAME];
-    if (check_game_over(&room->game, winner)) {
-        char end_msg[256];
-        snprintf(end_msg, sizeof(end_msg), "%s,no_pieces", winner);
-        broadcast_to_room(server, room_name, OP_GAME_END, end_msg);
-        cleanup_finished_game(server, room);
-        printf("Game over! Winner: %s\n", winner);
+    check_game_end(server, room);
+}
+
+/**
+ * Ends the game after a move if it is over.
+ * A side without pieces loses; otherwise the adjudication service
+ * decides games where the side to move is stuck or the move limit is reached.
+ *
+ * @param server Pointer to the server
+ * @param room Room where the move was played
+ */
+void check_game_end(Server *server, Room *room) {
+    PlayerId winner;
+    char end_msg[256];
+    AdjudicationOutcome outcome;
+
+    // The opponent's thread may already have finished and cleared the room
+    if (!room->game_started) {
+        return;
+    }
+
+    if (check_game_over(&room->game, &winner)) {
+        snprintf(end_msg, sizeof(end_msg), "%s,no_pieces", symtab_name(winner));
+        printf("Game over! Winner: %s\n", symtab_name(winner));
+        outcome = winner == room->game.player1 ? ADJUDICATION_PLAYER1_WINS
+                                               : ADJUDICATION_PLAYER2_WINS;
+    } else {
+        Adjudication verdict;
+        if (!adjudicate_if_needed(&room->game, &verdict)) {
+            return;
+        }
+        adjudication_format_end(&room->game, &verdict, end_msg, sizeof(end_msg));
+        printf("Game adjudicated after %d moves: %s\n", room->game.move_count, end_msg);
+        outcome = verdict.outcome;
     }
+
+    rate_finished_game(&room->game, outcome);
+    broadcast_to_room(server, room->name, OP_GAME_END, end_msg);
+    cleanup_finished_game(server, room);
 }
 
 /**
@@ -1744,7 +2517,12 @@ void handle_multi_move(Server *server, Client *client, const char *data) {
  * @param room Pointer to the room to clean up
  */
 void cleanup_finished_game(Server *server, Room *room) {
+    if (room->name[0] == '\0') {
+        return; // Already released by the other player's thread
+    }
+
     printf("Cleaning up finished game in room: %s\n", room->name);
+    STATS_ADD(games_finished, 1);
 
     pthread_mutex_lock(&server->clients_mutex);
     for (int i = 0; i < MAX_CLIENTS; i++) {
@@ -1755,15 +2533,13 @@ void cleanup_finished_game(Server *server, Room *room) {
             printf("Removing player %s from room\n", client->client_id);
             transition_client_state(client, CLIENT_GAME_STATE_IN_LOBBY);
             client->current_room[0] = '\0';
-            send_message(client->socket, OP_ROOM_LEFT, room->name);
+            send_to_client(client, OP_ROOM_LEFT, room->name);
             }
     }
     pthread_mutex_unlock(&server->clients_mutex);
 
     pthread_mutex_lock(&server->rooms_mutex);
-    pthread_mutex_destroy(&room->room_mutex);
-    memset(room, 0, sizeof(Room));
-    server->room_count--;
+    room_free(server, room);
     pthread_mutex_unlock(&server->rooms_mutex);
 
     printf("Room %s cleaned up\n", room->name);
@@ -1777,23 +2553,18 @@ void cleanup_finished_game(Server *server, Room *room) {
  *
  * @param server Pointer to the server
  * @param client Pointer to the client leaving
- * @param data Leave request data
+ * @param args Room and player name
  */
-void handle_leave_room(Server *server, Client *client, const char *data) {
-    char room_name[MAX_ROOM_NAME];
-    char player_name[MAX_PLAYER_NAME];
-
-    if (sscanf(data, "%[^,],%s", room_name, player_name) != 2) {
-        send_message(client->socket, OP_ERROR, "Invalid format");
-        return;
-    }
+void handle_leave_room(Server *server, Client *client, const HandlerArgs *args) {
+    const char *room_name = args->room.room;
+    const char *player_name = args->room.player;
 
     leave_room(server, room_name, player_name);
     client->current_room[0] = '\0';
     transition_client_state(client, CLIENT_GAME_STATE_IN_LOBBY);
     char response[256];
     snprintf(response, sizeof(response), "%s", room_name);
-    send_message(client->socket, OP_ROOM_LEFT, response);
+    send_to_client(client, OP_ROOM_LEFT, response);
     log_client(client);
 }
 
@@ -1803,13 +2574,28 @@ void handle_leave_room(Server *server, Client *client, const char *data) {
  *
  * @param server Pointer to the server
  * @param client Pointer to the client that sent PING
+ * @param args Unused
  */
-void handle_ping(Server *server, Client *client) {
+void handle_ping(Server *server, Client *client, const HandlerArgs *args) {
     (void)server;
-    send_message(client->socket, OP_PONG, "");
+    (void)args;
+    send_to_client(client, OP_PONG, "");
     printf("PONG TO SOCKET %d\n", client->socket);
 }
 
+/**
+ * Handles PONG message from client (answer to a heartbeat PING).
+ *
+ * @param server Pointer to the server
+ * @param client Pointer to the client that sent PONG
+ * @param args Unused
+ */
+void handle_pong(Server *server, Client *client, const HandlerArgs *args) {
+    (void)server;
+    (void)args;
+    client_update_pong(client);
+}
+
 /**
  * Handles request for list of available rooms.
  * Returns JSON array of room information.
@@ -1818,65 +2604,418 @@ void handle_ping(Server *server, Client *client) {
  *
  * @param server Pointer to the server
  * @param client Pointer to the requesting client
+ * @param args Unused
  */
-void handle_list_rooms(Server *server, Client *client) {
+void handle_list_rooms(Server *server, Client *client, const HandlerArgs *args) {
+    (void)args;
     pthread_mutex_lock(&server->rooms_mutex);
 
-    // Format: [{"id":1,"name":"Room1","players":1},{"id":2,"name":"Room2","players":2}]
+    // Format: [{"id":1,"name":"Room1","players":1,"rating":1500},...], rating of the owner
+    // Sized to the rooms listed, from this thread's arena
+    ArenaMark mark = arena_mark(&worker_arena);
+    size_t size = (size_t)server->room_count * ROOM_JSON_MAX + 3;
+    char *json = arena_alloc(&worker_arena, size);
+    if (!json) {
+        pthread_mutex_unlock(&server->rooms_mutex);
+        return;
+    }
 
-    char json[4096] = "[";
-    int first = 1;
+    size_t length = 0;
+    json[length++] = '[';
 
     for (int i = 0; i < MAX_ROOMS; i++) {
-        if (server->rooms[i].players_count > 0 || strlen(server->rooms[i].owner) > 0) {
-            if (!first) {
-                strcat(json, ",");
+        if (server->room_keys[i] != 0) {
+            // Leaves room for the closing bracket
+            int written = snprintf(json + length, size - length - 1,
+                                   "%s{\"id\":%d,\"name\":\"%s\",\"players\":%d,\"rating\":%d}",
+                                   length > 1 ? "," : "",
+                                   i,
+                                   server->rooms[i].name,
+                                   server->rooms[i].players_count,
+                                   ratings_get(server->rooms[i].owner));
+            if (written < 0 || (size_t)written >= size - length - 1) {
+                break;
             }
-            first = 0;
-
-            char room_json[256];
-            snprintf(room_json, sizeof(room_json),
-                    "{\"id\":%d,\"name\":\"%s\",\"players\":%d}",
-                    i,
-                    server->rooms[i].name,
-                    server->rooms[i].players_count);
-
-            strcat(json, room_json);
+            length += (size_t)written;
         }
     }
 
-    strcat(json, "]");
+    json[length++] = ']';
+    json[length] = '\0';
 
     pthread_mutex_unlock(&server->rooms_mutex);
 
-    send_message(client->socket, OP_ROOMS_LIST, json);
+    send_to_client(client, OP_ROOMS_LIST, json);
     printf("Sent rooms list to client: %s\n", json);
+    arena_release(&worker_arena, mark);
 }
 
 /**
- * Main client handler thread.
- * Processes incoming messages from a client connection.
- * Implements TCP stream parsing with message buffering to handle partial receives.
- * Handles client disconnection detection and reconnection logic.
+ * Handles a leaderboard request: a page of players by rating from a
+ * given rank, and the requesting player's own rank. Only the requested
+ * page is visited, however many players are rated.
  *
- * Message format: Messages are delimited by newline characters (\n)
+ * Protocol format: "[first_rank[,count]]"
+ * Reply: {"players":N,"first":R,"entries":[{"rank":R,"name":"...","rating":X,
+ *         "wins":W,"losses":L,"draws":D},...],"you":{"rank":R,"rating":X}}
+ * ("rank":0 for a player without games)
  *
- * @param arg Pointer to ClientThreadArgs structure
- * @return NULL when thread exits
+ * @param server Pointer to the server
+ * @param client Pointer to the client asking
+ * @param args First rank and page size
  */
-void* client_handler(void *arg) {
-    ClientThreadArgs *args = (ClientThreadArgs*)arg;
-    Server *server = args->server;
-    int my_socket = args->client_socket;
+void handle_leaderboard(Server *server, Client *client, const HandlerArgs *args) {
+    (void)server;
+    int first_rank = args->leaderboard.first_rank > 0 ? args->leaderboard.first_rank : 1;
+    int count = args->leaderboard.count > 0 ? args->leaderboard.count : LEADERBOARD_PAGE_DEFAULT;
+
+    ArenaMark mark = arena_mark(&worker_arena);
+    RatingRecord *page = arena_alloc(&worker_arena, (size_t)count * sizeof(RatingRecord));
+    size_t size = (size_t)count * LEADERBOARD_JSON_MAX + 128;
+    char *json = arena_alloc(&worker_arena, size);
+    if (!page || !json) {
+        arena_release(&worker_arena, mark);
+        return;
+    }
 
-    printf("Thread started for socket %d\n", my_socket);
-    free(args);
+    int found = ratings_leaderboard(first_rank, page, count);
+    RatingRecord own;
+    int own_rank = ratings_rank(client->player_id, &own);
 
-    char recv_buffer[BUFFER_SIZE];
-    char message_buffer[BUFFER_SIZE * 2];
-    int message_pos = 0;
+    size_t length = (size_t)snprintf(json, size, "{\"players\":%d,\"first\":%d,\"entries\":[",
+                                     ratings_count(), first_rank);
+    for (int i = 0; i < found; i++) {
+        length += (size_t)snprintf(json + length, size - length,
+                                   "%s{\"rank\":%d,\"name\":\"%s\",\"rating\":%d"
+                                   ",\"wins\":%u,\"losses\":%u,\"draws\":%u}",
+                                   i ? "," : "", first_rank + i, page[i].name, (int)page[i].rating,
+                                   page[i].wins, page[i].losses, page[i].draws);
+    }
+    snprintf(json + length, size - length, "],\"you\":{\"rank\":%d,\"rating\":%d}}",
+             own_rank, own_rank > 0 ? (int)own.rating : ratings_get(client->player_id));
+
+    send_to_client(client, OP_LEADERBOARD_PAGE, json);
+    arena_release(&worker_arena, mark);
+}
+
+// ========== MESSAGE DISPATCH ==========
+
+/**
+ * Token bucket limits per rate class. Generous enough for any real
+ * client; they stop floods from a single connection.
+ */
+static const struct {
+    double per_sec;                      // Refill rate
+    double burst;                        // Bucket size
+} rate_limits[RATE_CLASS_COUNT] = {
+    [RATE_CLASS_NONE]    = { 0, 0 },
+    [RATE_CLASS_SESSION] = { 2, 10 },
+    [RATE_CLASS_LOBBY]   = { 20, 40 },
+    [RATE_CLASS_GAME]    = { 500, 1000 },
+};
+
+// Payload layouts (protocol formats are documented on the handlers)
+static const PayloadSchema login_schema = {
+    1, 1, { PAYLOAD_TEXT(LoginArgs, player, 0) }
+};
+
+static const PayloadSchema player_room_schema = {
+    2, 2, { PAYLOAD_TEXT(RoomArgs, player, 1), PAYLOAD_WORD(RoomArgs, room) }
+};
+
+static const PayloadSchema room_player_schema = {
+    2, 2, { PAYLOAD_TEXT(RoomArgs, room, 1), PAYLOAD_WORD(RoomArgs, player) }
+};
+
+static const PayloadSchema move_schema = {
+    6, 6, {
+        PAYLOAD_TEXT(MoveArgs, room, 1),
+        PAYLOAD_TEXT(MoveArgs, player, 1),
+        PAYLOAD_INT(MoveArgs, from_row, INT_MIN, INT_MAX),
+        PAYLOAD_INT(MoveArgs, from_col, INT_MIN, INT_MAX),
+        PAYLOAD_INT(MoveArgs, to_row, INT_MIN, INT_MAX),
+        PAYLOAD_INT(MoveArgs, to_col, INT_MIN, INT_MAX)
+    }
+};
+
+static const PayloadSchema multi_move_schema = {
+    4, 4, {
+        PAYLOAD_TEXT(MultiMoveArgs, room, 1),
+        PAYLOAD_TEXT(MultiMoveArgs, player, 1),
+        PAYLOAD_INT(MultiMoveArgs, path_length, 2, MAX_PATH_LENGTH),
+        PAYLOAD_INT_LIST(MultiMoveArgs, path, coord_count, INT_MIN, INT_MAX)
+    }
+};
+
+static const PayloadSchema leaderboard_schema = {
+    2, 0, {
+        PAYLOAD_INT(LeaderboardArgs, first_rank, 1, INT_MAX),
+        PAYLOAD_INT(LeaderboardArgs, count, 1, LEADERBOARD_PAGE_MAX)
+    }
+};
+
+// Lobby form "player_name,session_token" leaves the third field empty
+static const PayloadSchema reconnect_schema = {
+    4, 2, {
+        PAYLOAD_TEXT(ReconnectArgs, fields[0], 0),
+        PAYLOAD_TEXT(ReconnectArgs, fields[1], 0),
+        PAYLOAD_TEXT(ReconnectArgs, fields[2], 0),
+        PAYLOAD_SEQ(ReconnectArgs, last_seq)
+    }
+};
+
+typedef void (*MessageHandler)(Server *server, Client *client, const HandlerArgs *args);
+
+/**
+ * How a client operation is handled. The states it is allowed in are
+ * its OPCODE_LIST mask, checked by validate_operation before dispatch.
+ */
+typedef struct {
+    MessageHandler handler;              // NULL: not accepted from clients
+    const PayloadSchema *schema;         // NULL: payload ignored
+    OpCode reject_op;                    // Reply to a payload the schema rejects
+    const char *reject_reason;
+    RateClass rate;
+} DispatchEntry;
+
+/**
+ * Client operations by dense opcode index (opcodes.h).
+ */
+static const DispatchEntry dispatch_table[OPCODE_COUNT] = {
+    [OPCODE_INDEX_LOGIN] = {
+        handle_login, &login_schema, OP_LOGIN_FAIL, "Invalid name", RATE_CLASS_SESSION },
+    [OPCODE_INDEX_CREATE_ROOM] = {
+        handle_create_room, &player_room_schema, OP_ROOM_FAIL, "Invalid format", RATE_CLASS_LOBBY },
+    [OPCODE_INDEX_JOIN_ROOM] = {
+        handle_join_room, &player_room_schema, OP_ROOM_FAIL, "Invalid format", RATE_CLASS_LOBBY },
+    [OPCODE_INDEX_LEAVE_ROOM] = {
+        handle_leave_room, &room_player_schema, OP_ERROR, "Invalid format", RATE_CLASS_LOBBY },
+    [OPCODE_INDEX_LIST_ROOMS] = {
+        handle_list_rooms, NULL, OP_ERROR, NULL, RATE_CLASS_LOBBY },
+    [OPCODE_INDEX_QUICK_MATCH] = {
+        handle_quick_match, &login_schema, OP_ROOM_FAIL, "Invalid name", RATE_CLASS_LOBBY },
+    [OPCODE_INDEX_LEADERBOARD] = {
+        handle_leaderboard, &leaderboard_schema, OP_ERROR, "Invalid format", RATE_CLASS_LOBBY },
+    [OPCODE_INDEX_MOVE] = {
+        handle_move, &move_schema, OP_INVALID_MOVE, "Invalid move format", RATE_CLASS_GAME },
+    [OPCODE_INDEX_MULTI_MOVE] = {
+        handle_multi_move, &multi_move_schema, OP_INVALID_MOVE, "Invalid multi-move format",
+        RATE_CLASS_GAME },
+    [OPCODE_INDEX_PING] = {
+        handle_ping, NULL, OP_ERROR, NULL, RATE_CLASS_NONE },
+    [OPCODE_INDEX_PONG] = {
+        handle_pong, NULL, OP_ERROR, NULL, RATE_CLASS_NONE },
+    [OPCODE_INDEX_RECONNECT_REQUEST] = {
+        handle_reconnect_request, &reconnect_schema, OP_RECONNECT_FAIL, "Invalid format",
+        RATE_CLASS_SESSION },
+};
+
+/**
+ * Gets the payload schema of a client operation.
+ *
+ * @param op Operation code
+ * @return Schema, NULL if the payload is ignored or the opcode is not handled
+ */
+const PayloadSchema* dispatch_schema(OpCode op) {
+    return dispatch_table[opcode_index(op)].schema;
+}
+
+/**
+ * Takes one operation from a client's token bucket.
+ *
+ * @param client Client sending the operation
+ * @param rate Rate class of the operation
+ * @param now_ns Current time (metrics_now_ns)
+ * @return true if the operation is within the limit
+ */
+static bool rate_allow(Client *client, RateClass rate, uint64_t now_ns) {
+    if (rate == RATE_CLASS_NONE) {
+        return true;
+    }
+
+    RateBucket *bucket = &client->rate_buckets[rate];
+    double burst = rate_limits[rate].burst;
+
+    if (bucket->refilled_ns == 0) {
+        bucket->tokens = burst;
+    } else {
+        bucket->tokens += (double)(now_ns - bucket->refilled_ns) * rate_limits[rate].per_sec / 1e9;
+        if (bucket->tokens > burst) {
+            bucket->tokens = burst;
+        }
+    }
+    bucket->refilled_ns = now_ns;
+
+    if (bucket->tokens < 1.0) {
+        return false;
+    }
+    bucket->tokens -= 1.0;
+    return true;
+}
+
+/**
+ * Runs the handler of a validated message. The payload is decoded into
+ * the handler's arguments by the opcode's schema, so handlers never
+ * parse; a payload that does not match gets the opcode's reject reply.
+ *
+ * @param server Pointer to the server
+ * @param client Client that sent the message
+ * @param msg Parsed message
+ * @param now_ns Receive time (metrics_now_ns)
+ */
+static void dispatch_message(Server *server, Client *client, const Message *msg, uint64_t now_ns) {
+    const DispatchEntry *entry = &dispatch_table[opcode_index(msg->op)];
+
+    if (!entry->handler) {
+        fprintf(stderr, "Unknown OpCode %d\n", msg->op);
+        send_to_client(client, OP_ERROR, "Unknown operation");
+        return;
+    }
 
+    if (!rate_allow(client, entry->rate, now_ns)) {
+        STATS_ADD(frames_rate_limited, 1);
+        send_to_client(client, OP_ERROR, "Rate limited");
+        return;
+    }
+
+    HandlerArgs args;
+    if (entry->schema && payload_decode(entry->schema, msg->data, &args) < 0) {
+        STATS_ADD(frames_rejected, 1);
+        printf("Rejected payload of OpCode %d: '%s'\n", msg->op, msg->data);
+        if (entry->reject_op == OP_RECONNECT_FAIL) {
+            // Reconnect replies are not numbered (outbox.h)
+            send_message(client->socket, entry->reject_op, entry->reject_reason);
+        } else {
+            send_to_client(client, entry->reject_op, entry->reject_reason);
+        }
+        return;
+    }
+
+    entry->handler(server, client, &args);
+}
+
+/**
+ * Unhandled input of one connection, owned by its handler thread.
+ * Storage is taken from the buffer pool when input arrives and returned
+ * once every frame in it has been handled, so an idle connection holds
+ * none; it grows past a pooled block only for long frames.
+ */
+typedef struct {
+    char *data;                          // NULL while no input is pending
+    size_t length;                       // Bytes received but not yet handled
+    size_t capacity;                     // Bytes of data, one kept for a NUL
+} RecvBuffer;
+
+/**
+ * Makes room for the next read: takes a pooled block for new input,
+ * or doubles a full buffer up to the longest frame.
+ *
+ * @param input Receive buffer
+ * @return 0 on success, -1 if out of memory
+ */
+static int recv_buffer_reserve(RecvBuffer *input) {
+    size_t capacity = input->capacity;
+    if (!input->data) {
+        capacity = BUFPOOL_BLOCK_SIZE;
+    } else if (input->length + 1 == input->capacity && input->capacity <= MAX_FRAME_LEN) {
+        capacity = input->capacity * 2 > MAX_FRAME_LEN + 1 ? MAX_FRAME_LEN + 1 : input->capacity * 2;
+    } else {
+        return 0;
+    }
+
+    char *data = bufpool_resize(input->data, input->capacity, capacity);
+    if (!data) {
+        return -1;
+    }
+    input->data = data;
+    input->capacity = capacity;
+    return 0;
+}
+
+/**
+ * Returns the storage of a receive buffer.
+ *
+ * @param input Receive buffer
+ */
+static void recv_buffer_release(RecvBuffer *input) {
+    bufpool_free(input->data, input->capacity);
+    input->data = NULL;
+    input->length = 0;
+    input->capacity = 0;
+}
+
+/**
+ * Disconnects the client on a socket that sent more than MAX_FRAME_LEN
+ * bytes without a newline.
+ *
+ * @param server Pointer to the server
+ * @param socket Client socket
+ * @param raw_message Offending input, NUL-terminated
+ */
+static void disconnect_overflow(Server *server, int socket, const char *raw_message) {
+    fprintf(stderr, "SECURITY: Buffer overflow from socket %d\n", socket);
+
+    pthread_mutex_lock(&server->clients_mutex);
+    Client *overflow_client = NULL;
+    for (int j = 0; j < MAX_CLIENTS; j++) {
+        if (server->clients[j].socket == socket) {
+            overflow_client = &server->clients[j];
+            break;
+        }
+    }
+    pthread_mutex_unlock(&server->clients_mutex);
+
+    if (overflow_client) {
+        disconnect_malicious_client(server, overflow_client,
+                                   DISCONNECT_REASON_BUFFER_OVERFLOW,
+                                   raw_message);
+    }
+}
+
+/**
+ * Disconnects the client still attached to a socket whose connection
+ * was lost. A socket already transferred to another client is left alone.
+ *
+ * @param server Pointer to the server
+ * @param my_socket Lost socket
+ */
+static void connection_lost(Server *server, int my_socket) {
+    pthread_mutex_lock(&server->clients_mutex);
+    Client *disconnect_client = NULL;
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (server->clients[i].socket == my_socket &&
+            server->clients[i].active) {
+            disconnect_client = &server->clients[i];
+            break;
+        }
+    }
+    pthread_mutex_unlock(&server->clients_mutex);
+
+    if (!disconnect_client) {
+        printf("Socket was transferred during recv\n");
+        return;
+    }
+
+    // Handle disconnection
+    handle_client_disconnect(server, disconnect_client, my_socket);
+}
+
+/**
+ * Serves a client connection until it closes or its client is removed,
+ * or until it goes idle outside a game on a transport that can park it.
+ * A parked connection owns no thread: the reactor hands it back through
+ * server_resume once input arrives.
+ *
+ * @param server Pointer to the server
+ * @param my_socket Client socket
+ * @param input Receive buffer of the connection, empty when parked
+ * @return true if the connection was parked, false if it ended
+ */
+static bool serve_connection(Server *server, int my_socket, RecvBuffer *input) {
     while (server->running) {
+        // Every frame of the previous read has been handled
+        recorder_input_done();
+
         pthread_mutex_lock(&server->clients_mutex);
         // Find client structure for this socket
         Client *client = NULL;
@@ -1891,14 +3030,15 @@ void* client_handler(void *arg) {
 
         if (!client) {
             printf("No client for socket %d, closing\n", my_socket);
-            close(my_socket);
-            return NULL;
+            transport_close(my_socket);
+            return false;
         }
 
         pthread_mutex_lock(&client->state_mutex);
         // Check client state
         bool is_active = client->active;
         ClientState state = client->state;
+        bool in_game = client->game_state == CLIENT_GAME_STATE_IN_GAME;
         pthread_mutex_unlock(&client->state_mutex);
 
         if (!is_active) {
@@ -1917,175 +3057,295 @@ void* client_handler(void *arg) {
 
             if (!check) {
                 printf("Socket %d transferred, exiting\n", my_socket);
-                return NULL; // Don't close socket (transferred to another thread)
+                return false; // Don't close socket (transferred to another thread)
             }
 
-            close(my_socket);
-            return NULL;
+            transport_close(my_socket);
+            return false;
         }
 
         if (state == CLIENT_STATE_REMOVED) {
             printf("Client removed, closing socket %d\n", my_socket);
-            close(my_socket);
-            return NULL;
+            transport_close(my_socket);
+            return false;
+        }
+
+        // Between frames a lobby or waiting connection gives up its thread;
+        // games keep theirs, since moves follow each other closely
+        if (input->length == 0 && !in_game && transport_park(my_socket) == 0) {
+            return true;
         }
 
         // ========== READ DATA ==========
-        memset(recv_buffer, 0, BUFFER_SIZE);
-        int bytes = recv(my_socket, recv_buffer, BUFFER_SIZE - 1, 0);
+        // Appended to the unhandled tail of the stream. Without one, the
+        // buffer is only taken once input has arrived
+        int bytes = -1;
+        if ((input->length > 0 || transport_wait(my_socket) == 0) &&
+            recv_buffer_reserve(input) == 0) {
+            bytes = (int)transport_read(my_socket, input->data + input->length,
+                                        input->capacity - 1 - input->length);
+        }
 
         if (bytes <= 0) {
             // Connection closed or error
+            recorder_connection_closed(my_socket);
             printf("📡 Connection closed on socket %d (bytes=%d)\n",
                    my_socket, bytes);
 
+            connection_lost(server, my_socket);
+            recorder_input_done();
+            return false;
+        }
+
+        size_t scanned = input->length;
+        input->length += (size_t)bytes;
+        metrics_record_recv((size_t)bytes);
+
+        // ========== PROCESS MESSAGES ==========
+        // TCP stream may contain partial messages or multiple messages;
+        // each complete one (delimited by \n) is parsed in place
+        size_t start = 0;
+        char *newline;
+        while ((newline = memchr(input->data + scanned, '\n', input->length - scanned)) != NULL) {
+            char *frame = input->data + start;
+            size_t frame_len = (size_t)(newline - frame) + 1;
+            start += frame_len;
+            scanned = start;
+
+            if (frame_len > MAX_FRAME_LEN) {
+                *newline = '\0';
+                disconnect_overflow(server, my_socket, frame);
+                recorder_input_done();
+                return false;
+            }
+
+            recorder_frame_in(my_socket, frame, frame_len);
+            *newline = '\0';
+            PROBE2(frame__received, my_socket, frame_len - 1);
+            // Find client again (may have changed after reconnect)
             pthread_mutex_lock(&server->clients_mutex);
-            Client *disconnect_client = NULL;
-            for (int i = 0; i < MAX_CLIENTS; i++) {
-                if (server->clients[i].socket == my_socket &&
-                    server->clients[i].active) {
-                    disconnect_client = &server->clients[i];
+            Client *msg_client = NULL;
+            for (int j = 0; j < MAX_CLIENTS; j++) {
+                if (server->clients[j].socket == my_socket &&
+                    server->clients[j].active) {
+                    msg_client = &server->clients[j];
                     break;
                 }
             }
             pthread_mutex_unlock(&server->clients_mutex);
 
-            if (!disconnect_client) {
-                printf("Socket was transferred during recv\n");
-                return NULL;
+            if (!msg_client) {
+                printf("Client disappeared during message processing\n");
+                continue;
             }
 
-            // Handle disconnection
-            handle_client_disconnect(server, disconnect_client, my_socket);
-            return NULL;
-        }
-
-        // ========== PROCESS MESSAGES ==========
-        // TCP stream may contain partial messages or multiple messages
-        // Buffer until we find complete messages (delimited by \n)
-        for (int i = 0; i < bytes; i++) {
-            char current_char = recv_buffer[i];
-
-            // Prevent buffer overflow
-            if ((size_t)message_pos >= sizeof(message_buffer) - 1) {
-                fprintf(stderr, "SECURITY: Buffer overflow from socket %d\n",
-                        my_socket);
-
-                pthread_mutex_lock(&server->clients_mutex);
-                Client *overflow_client = NULL;
-                for (int j = 0; j < MAX_CLIENTS; j++) {
-                    if (server->clients[j].socket == my_socket) {
-                        overflow_client = &server->clients[j];
-                        break;
-                    }
+            Message msg;
+            DisconnectReason disconnect_reason;
+            // Parse message according to protocol
+            uint64_t parse_start = metrics_now_ns();
+            int parse_result = parse_message(frame, &msg, &disconnect_reason);
+            uint64_t dispatch_start = metrics_now_ns();
+            metrics_record_frame_in(parse_result == 0);
+            metrics_record(METRICS_PHASE_PARSE,
+                           parse_result == 0 ? (int)msg.op : 0,
+                           dispatch_start - parse_start);
+            PROBE3(parse__done, my_socket, parse_result == 0 ? (int)msg.op : 0, parse_result);
+
+            if (parse_result == 0) {
+                log_message("RECV", &msg);
+                // Validate operation is allowed in current state
+                if (!validate_operation(server, msg_client, msg.op)) {
+                    continue;
                 }
-                pthread_mutex_unlock(&server->clients_mutex);
+                PROBE2(handler__enter, my_socket, (int)msg.op);
+                dispatch_message(server, msg_client, &msg, dispatch_start);
+                PROBE2(handler__exit, my_socket, (int)msg.op);
+                metrics_record(METRICS_PHASE_HANDLER, msg.op,
+                               metrics_now_ns() - dispatch_start);
+            } else {
+                // Message parsing failed
+                fprintf(stderr, "Failed to parse message from socket %d\n",
+                        my_socket);
 
-                if (overflow_client) {
-                    disconnect_malicious_client(server, overflow_client,
-                                               DISCONNECT_REASON_BUFFER_OVERFLOW,
-                                               message_buffer);
+                if (should_disconnect_client(&msg_client->violations)) {
+                    disconnect_malicious_client(server, msg_client,
+                                               disconnect_reason,
+                                               frame);
+                    recorder_input_done();
+                    return false;
                 }
-                return NULL;
             }
+        }
 
-            message_buffer[message_pos++] = current_char;
+        // Keep the partial frame at the front
+        input->length -= start;
+        memmove(input->data, input->data + start, input->length);
+        input->data[input->length] = '\0';
 
-            // Complete message received (newline delimiter)
-            if (current_char == '\n') {
-                message_buffer[message_pos - 1] = '\0';
-                // Find client again (may have changed after reconnect)
-                pthread_mutex_lock(&server->clients_mutex);
-                Client *msg_client = NULL;
-                for (int j = 0; j < MAX_CLIENTS; j++) {
-                    if (server->clients[j].socket == my_socket &&
-                        server->clients[j].active) {
-                        msg_client = &server->clients[j];
-                        break;
-                    }
-                }
-                pthread_mutex_unlock(&server->clients_mutex);
+        if (input->length >= MAX_FRAME_LEN) {
+            disconnect_overflow(server, my_socket, input->data);
+            recorder_input_done();
+            return false;
+        }
 
-                if (!msg_client) {
-                    printf("Client disappeared during message processing\n");
-                    message_pos = 0;
-                    memset(message_buffer, 0, sizeof(message_buffer));
-                    continue;
-                }
+        if (input->length == 0) {
+            recv_buffer_release(input);
+        }
+    }
 
-                Message msg;
-                DisconnectReason disconnect_reason;
-                // Parse message according to protocol
-                int parse_result = parse_message(message_buffer, &msg,
-                                                 &disconnect_reason);
-
-                if (parse_result == 0) {
-                    log_message("RECV", &msg);
-                    // Validate operation is allowed in current state
-                    if (!validate_operation(server, msg_client, msg.op)) {
-                        message_pos = 0;
-                        memset(message_buffer, 0, sizeof(message_buffer));
-                        continue;
-                    }
-                    // Dispatch to appropriate handler
-                    switch (msg.op) {
-                        case OP_LOGIN:
-                            handle_login(server, msg_client, msg.data);
-                            break;
-                        case OP_CREATE_ROOM:
-                            handle_create_room(server, msg_client, msg.data);
-                            break;
-                        case OP_JOIN_ROOM:
-                            handle_join_room(server, msg_client, msg.data);
-                            break;
-                        case OP_MOVE:
-                            handle_move(server, msg_client, msg.data);
-                            break;
-                        case OP_MULTI_MOVE:
-                            handle_multi_move(server, msg_client, msg.data);
-                            break;
-                        case OP_LEAVE_ROOM:
-                            handle_leave_room(server, msg_client, msg.data);
-                            break;
-                        case OP_PING:
-                            handle_ping(server, msg_client);
-                            break;
-                        case OP_PONG:
-                            client_update_pong(msg_client);
-                            break;
-                        case OP_LIST_ROOMS:
-                            handle_list_rooms(server, msg_client);
-                            break;
-                        case OP_RECONNECT_REQUEST:
-                            handle_reconnect_request(server, msg_client, msg.data);
-                            break;
-                        default:
-                            fprintf(stderr, "Unknown OpCode %d\n", msg.op);
-                            send_message(my_socket, OP_ERROR, "Unknown operation");
-                            break;
-                    }
-                } else {
-                    // Message parsing failed
-                    fprintf(stderr, "Failed to parse message from socket %d\n",
-                            my_socket);
-
-                    if (should_disconnect_client(&msg_client->violations)) {
-                        disconnect_malicious_client(server, msg_client,
-                                                   disconnect_reason,
-                                                   message_buffer);
-                        return NULL;
-                    }
-                }
-                // Reset buffer for next message
-                message_pos = 0;
-                memset(message_buffer, 0, sizeof(message_buffer));
+    recorder_input_done();
+    return false;
+}
+
+/**
+ * Serves connections resumed by the reactor on the calling handler
+ * thread. Returns once the queue is empty and HANDLER_IDLE_MAX other
+ * handler threads are already waiting, or the server stops.
+ *
+ * @param server Pointer to the server
+ * @param input Receive buffer of the thread
+ */
+static void handler_pool_serve(Server *server, RecvBuffer *input) {
+    pthread_mutex_lock(&server->handlers_mutex);
+    while (server->running) {
+        if (server->resume_count == 0) {
+            if (server->idle_handlers >= HANDLER_IDLE_MAX) {
+                break;
             }
+            server->idle_handlers++;
+            pthread_cond_wait(&server->handlers_cond, &server->handlers_mutex);
+            server->idle_handlers--;
+            continue;
         }
+
+        int socket = server->resume_queue[server->resume_head];
+        server->resume_head = (server->resume_head + 1) % MAX_CLIENTS;
+        server->resume_count--;
+        pthread_mutex_unlock(&server->handlers_mutex);
+
+        printf("Resuming socket %d\n", socket);
+        serve_connection(server, socket, input);
+
+        pthread_mutex_lock(&server->handlers_mutex);
     }
+    pthread_mutex_unlock(&server->handlers_mutex);
+}
+
+/**
+ * Main client handler thread.
+ * Processes incoming messages from a client connection.
+ * Implements TCP stream parsing with message buffering to handle partial receives.
+ * Handles client disconnection detection and reconnection logic.
+ *
+ * Message format: Messages are delimited by newline characters (\n)
+ *
+ * The thread runs on a small stack (THREAD_STACK_SIZE): input is kept
+ * in a pooled buffer sized to the pending frames and outgoing frames come
+ * from the thread's arena, both held only while there is data.
+ *
+ * @param arg Pointer to ClientThreadArgs structure
+ * @return NULL when thread exits
+ */
+void* client_handler(void *arg) {
+    ClientThreadArgs *args = (ClientThreadArgs*)arg;
+    Server *server = args->server;
+    int my_socket = args->client_socket;
+
+    printf("Thread started for socket %d\n", my_socket);
+    free(args);
 
+    RecvBuffer input = {0};
+    if (serve_connection(server, my_socket, &input)) {
+        // Parked: stay to serve whichever connections resume next
+        handler_pool_serve(server, &input);
+    }
+
+    recv_buffer_release(&input);
+    arena_free(&worker_arena);
+    return NULL;
+}
+
+/**
+ * Handler thread started for a resumed connection when no handler
+ * thread was idle.
+ *
+ * @param arg Pointer to the server
+ * @return NULL when thread exits
+ */
+static void* resume_handler(void *arg) {
+    Server *server = (Server*)arg;
+    RecvBuffer input = {0};
+    handler_pool_serve(server, &input);
+
+    recv_buffer_release(&input);
+    arena_free(&worker_arena);
     return NULL;
 }
 
+/**
+ * Hands a parked connection that has input again to a handler thread:
+ * an idle one if any, else a new one.
+ *
+ * @param server Pointer to the server
+ * @param client_socket Parked connection handle
+ * @return 0 on success, -1 if the connection cannot be served; its
+ *         client is then disconnected and the caller closes the socket
+ */
+int server_resume(Server *server, int client_socket) {
+    pthread_mutex_lock(&server->handlers_mutex);
+    // Every parked connection has a client slot, so the queue cannot fill
+    if (server->resume_count == MAX_CLIENTS) {
+        pthread_mutex_unlock(&server->handlers_mutex);
+        return -1;
+    }
+    server->resume_queue[(server->resume_head + server->resume_count) % MAX_CLIENTS] = client_socket;
+    server->resume_count++;
+    bool idle = server->idle_handlers > 0;
+    if (idle) {
+        pthread_cond_signal(&server->handlers_cond);
+    }
+    pthread_mutex_unlock(&server->handlers_mutex);
+
+    if (idle) {
+        return 0;
+    }
+
+    pthread_t thread;
+    int result = pthread_create(&thread, &server->thread_attr, resume_handler, server);
+    if (result == 0) {
+        pthread_detach(thread);
+        return 0;
+    }
+    printf("Failed to create thread: %d\n", result);
+
+    // Nothing may ever take the socket off the queue, so withdraw it
+    // unless a handler thread freed up meanwhile and already has
+    pthread_mutex_lock(&server->handlers_mutex);
+    bool withdrawn = false;
+    for (int i = 0; i < server->resume_count; i++) {
+        int slot = (server->resume_head + i) % MAX_CLIENTS;
+        if (server->resume_queue[slot] != client_socket) {
+            continue;
+        }
+        for (int j = i + 1; j < server->resume_count; j++) {
+            int next = (server->resume_head + j) % MAX_CLIENTS;
+            server->resume_queue[slot] = server->resume_queue[next];
+            slot = next;
+        }
+        server->resume_count--;
+        withdrawn = true;
+        break;
+    }
+    pthread_mutex_unlock(&server->handlers_mutex);
+
+    if (!withdrawn) {
+        return 0;
+    }
+    // The caller closes the connection; its client goes as on a lost one
+    connection_lost(server, client_socket);
+    return -1;
+}
+
 /**
  * Handles client disconnection detected by the client handler thread.
  * Differentiates between anonymous and logged-in clients:
@@ -2105,9 +3365,11 @@ void handle_client_disconnect(Server *server, Client *client, int socket) {
     if (!client->logged_in || client->client_id[0] == '\0') {
         pthread_mutex_unlock(&client->state_mutex);
         printf("Anonymous client, removing immediately\n");
-        close(socket);
+        client_detach_socket(client);
+        transport_close(socket);
         pthread_mutex_lock(&server->clients_mutex);
         client->active = false;
+        client_untrack(client);
         server->client_count--;
         pthread_mutex_unlock(&server->clients_mutex);
         return;
@@ -2116,12 +3378,14 @@ void handle_client_disconnect(Server *server, Client *client, int socket) {
     printf("Logged-in client '%s', preserving for reconnect\n",
            client->client_id);
 
-    client->state = CLIENT_STATE_DISCONNECTED;
+    client_set_state(client, CLIENT_STATE_DISCONNECTED);
     client->disconnect_time = time(NULL);
     client->missed_pongs = 0;
+    // A match found now could not be played until the client is back
+    matchmaking_remove(client->player_id);
 
-    close(socket);
-    client->socket = -1;
+    client_detach_socket(client);
+    transport_close(socket);
 
     pthread_mutex_unlock(&client->state_mutex);
 
@@ -2164,7 +3428,7 @@ bool validate_operation(Server *server, Client *client, OpCode op) {
                  "Operation %d not allowed in state %s. Warning %d/3",
                  op, client_game_state_to_string(client->game_state),
                  client->violations.unknown_opcode_count);
-        send_message(client->socket, OP_ERROR, warning);
+        send_to_client(client, OP_ERROR, warning);
 
         return false;
     }
@@ -2173,72 +3437,171 @@ bool validate_operation(Server *server, Client *client, OpCode op) {
 }
 
 /**
- * Starts the server and begins accepting client connections.
- * Spawns the heartbeat monitoring thread and enters the main accept loop.
- * For each new connection, creates a client structure and spawns a handler thread.
+ * Marks the server running and spawns the heartbeat monitoring thread
+ * without accepting connections.
  *
  * @param server Pointer to the server to start
+ * @return 0 on success, -1 on failure
  */
-void server_start(Server *server) {
+int server_start_local(Server *server) {
     server->running = true;
 
-    if (pthread_create(&server->heartbeat_thread, NULL, heartbeat_thread, server) != 0) {
+    // Buffers of the message path live on the heap, so threads need
+    // far less than the default stack
+    pthread_attr_init(&server->thread_attr);
+    int stack_result = pthread_attr_setstacksize(&server->thread_attr, THREAD_STACK_SIZE);
+    if (stack_result != 0) {
+        printf("Keeping default thread stacks: %s\n", strerror(stack_result));
+    }
+
+    if (pthread_create(&server->heartbeat_thread, &server->thread_attr, heartbeat_thread, server) != 0) {
         perror("Failed to create heartbeat thread");
-        return;
+        server->running = false;
+        return -1;
     }
 
     printf("💓 Heartbeat thread started\n");
-    printf("Server started. Waiting for connections...\n");
+    return 0;
+}
 
+/**
+ * Registers an accepted connection and starts its handler thread.
+ * The connection is closed if it cannot be served.
+ *
+ * @param server Pointer to the server
+ * @param client_socket Connection handle (see transport.h)
+ * @return Client index, or -1 if the connection was refused
+ */
+int server_attach(Server *server, int client_socket) {
+    STATS_ADD(connections_accepted, 1);
+    recorder_connection_opened(client_socket);
+
+    int client_idx = add_client(server, client_socket);
+    if (client_idx < 0) {
+        STATS_ADD(connections_rejected, 1);
+        send_message(client_socket, OP_ERROR, "Server full");
+        transport_close(client_socket);
+        return -1;
+    }
 
-    while (server->running) {
-        struct sockaddr_in client_addr;
-        socklen_t client_len = sizeof(client_addr);
+    // Create thread for client
 
-        int client_socket = accept(server->server_socket,
-                                   (struct sockaddr*)&client_addr, &client_len);
+    ClientThreadArgs *args = malloc(sizeof(ClientThreadArgs));
+    if (!args) {
+        transport_close(client_socket);
+        server->clients[client_idx].active = false;
+        client_untrack(&server->clients[client_idx]);
+        return -1;
+    }
 
-        if (client_socket < 0) {
-            if (server->running) {
-                perror("Accept failed");
-            }
-            continue;
-        }
+    args->server = server;
+    args->client_socket = client_socket;
+    args->client_idx = client_idx;
 
-        printf("New connection from %s:%d\n",
-               inet_ntoa(client_addr.sin_addr), ntohs(client_addr.sin_port));
+    int result = pthread_create(&server->clients[client_idx].thread, &server->thread_attr,
+                                client_handler, args);
 
-        int client_idx = add_client(server, client_socket);
-        if (client_idx < 0) {
-            send_message(client_socket, OP_ERROR, "Server full");
-            close(client_socket);
-            continue;
+    if (result != 0) {
+        printf("Failed to create thread: %d\n", result);
+        free(args);
+        transport_close(client_socket);
+        server->clients[client_idx].active = false;
+        client_untrack(&server->clients[client_idx]);
+        return -1;
+    }
+
+    printf("New %s client thread created successfully\n", transport_of(client_socket)->name);
+    pthread_detach(server->clients[client_idx].thread);
+    return client_idx;
+}
+
+/**
+ * Adds a Unix-domain listener next to the TCP one.
+ * Must be called before server_start.
+ *
+ * @param server Pointer to the server
+ * @param path Filesystem path of the socket
+ * @return 0 on success, -1 on failure
+ */
+int server_listen_unix(Server *server, const char *path) {
+    int fd = transport_listen_unix(path);
+    if (fd < 0) {
+        return -1;
+    }
+
+    server->unix_socket = fd;
+    snprintf(server->unix_path, sizeof(server->unix_path), "%s", path);
+    printf("Listening on unix:%s\n", path);
+    return 0;
+}
+
+/**
+ * Starts the server and begins accepting client connections.
+ * Spawns the heartbeat monitoring thread and enters the main accept loop.
+ * For each new TCP or Unix-domain connection, creates a client structure
+ * and spawns a handler thread. With the io_uring backend the reactor
+ * accepts and receives instead.
+ *
+ * @param server Pointer to the server to start
+ */
+void server_start(Server *server) {
+    if (server_start_local(server) < 0) {
+        return;
+    }
+
+    printf("Server started. Waiting for connections...\n");
+
+    if (server->backend == SERVER_BACKEND_URING) {
+        if (uring_run(server) == 0) {
+            return;
         }
+        fprintf(stderr, "Falling back to the blocking backend\n");
+    }
 
-        // Create thread for client
+    struct pollfd listeners[2] = {
+        {server->server_socket, POLLIN, 0},
+        {server->unix_socket, POLLIN, 0}
+    };
+    int listener_count = server->unix_socket >= 0 ? 2 : 1;
 
-        ClientThreadArgs *args = malloc(sizeof(ClientThreadArgs));
-        if (!args) {
-            close(client_socket);
-            server->clients[client_idx].active = false;
+    while (server->running) {
+        if (poll(listeners, listener_count, -1) < 0) {
+            if (errno != EINTR && server->running) {
+                perror("Poll failed");
+            }
             continue;
         }
 
-        args->server = server;
-        args->client_socket = client_socket;
-        args->client_idx = client_idx;
+        if (listeners[0].revents & POLLIN) {
+            struct sockaddr_in client_addr;
+            socklen_t client_len = sizeof(client_addr);
 
-        int result = pthread_create(&server->clients[client_idx].thread, NULL,
-                                    client_handler, args);
+            int client_socket = accept(server->server_socket,
+                                       (struct sockaddr*)&client_addr, &client_len);
 
-        if (result != 0) {
-            printf("Failed to create thread: %d\n", result);
-            free(args);
-            close(client_socket);
-            server->clients[client_idx].active = false;
-        } else {
-            printf("New client thread created successfully\n");
-            pthread_detach(server->clients[client_idx].thread);
+            if (client_socket < 0) {
+                if (server->running) {
+                    perror("Accept failed");
+                }
+            } else {
+                printf("New connection from %s:%d\n",
+                       inet_ntoa(client_addr.sin_addr), ntohs(client_addr.sin_port));
+                server_attach(server, client_socket);
+            }
+        }
+
+        if (listener_count > 1 && (listeners[1].revents & POLLIN)) {
+            int client_socket = accept(server->unix_socket, NULL, NULL);
+
+            if (client_socket < 0) {
+                if (server->running) {
+                    perror("Unix accept failed");
+                }
+            } else {
+                printf("New connection on unix:%s\n", server->unix_path);
+                transport_attach(client_socket, &transport_unix);
+                server_attach(server, client_socket);
+            }
         }
     }
 }
@@ -2253,14 +3616,26 @@ void server_start(Server *server) {
 void server_stop(Server *server) {
     server->running = false;
 
+    // Idle handler threads exit
+    pthread_mutex_lock(&server->handlers_mutex);
+    pthread_cond_broadcast(&server->handlers_cond);
+    pthread_mutex_unlock(&server->handlers_mutex);
+
     pthread_cancel(server->heartbeat_thread);
     pthread_join(server->heartbeat_thread, NULL);
 
+    admin_stop();
+    metrics_http_stop();
+    recorder_close();
+    ratings_close();
+
     pthread_mutex_lock(&server->clients_mutex);
     for (int i = 0; i < MAX_CLIENTS; i++) {
         if (server->clients[i].active) {
-            close(server->clients[i].socket);
+            transport_close(server->clients[i].socket);
+            outbox_free(&server->clients[i].outbox);
             pthread_mutex_destroy(&server->clients[i].state_mutex);
+            pthread_mutex_destroy(&server->clients[i].outbox_mutex);
         }
     }
     pthread_mutex_unlock(&server->clients_mutex);
@@ -2273,7 +3648,18 @@ void server_stop(Server *server) {
     }
     pthread_mutex_unlock(&server->rooms_mutex);
 
-    close(server->server_socket);
+    metrics_print_report(stdout);
+
+    // Shutdown releases the port even while an io_uring accept holds the socket
+    if (server->server_socket >= 0) {
+        shutdown(server->server_socket, SHUT_RDWR);
+        close(server->server_socket);
+    }
+    if (server->unix_socket >= 0) {
+        shutdown(server->unix_socket, SHUT_RDWR);
+        close(server->unix_socket);
+        unlink(server->unix_path);
+    }
     pthread_mutex_destroy(&server->clients_mutex);
     pthread_mutex_destroy(&server->rooms_mutex);
 
@@ -2313,10 +3699,13 @@ void log_invalid_operation_attempt(Client *client, OpCode attempted_op) {
     fprintf(stderr, "Timestamp: %ld\n", time(NULL));
 
     fprintf(stderr, "Allowed Operations in this state: ");
-    AllowedOperations ops = get_allowed_operations(client->game_state);
-    for (int i = 0; i < ops.count; i++) {
-        fprintf(stderr, "%d", ops.allowed_ops[i]);
-        if (i < ops.count - 1) fprintf(stderr, ", ");
+    uint64_t allowed = get_allowed_operations(client->game_state);
+    bool first = true;
+    for (int i = 1; i < OPCODE_COUNT; i++) {
+        if (allowed & (1ull << i)) {
+            fprintf(stderr, "%s%d", first ? "" : ", ", (int)opcode_at(i));
+            first = false;
+        }
     }
     fprintf(stderr, "\n");
     fprintf(stderr, "═══════════════════════════════════════════════════\n");
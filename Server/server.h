@@ -11,10 +11,23 @@
 #include "game.h"
 #include "protocol.h"
 #include "client_state_machine.h"
+#include "outbox.h"
+#include "payload.h"
 
-#define MAX_CLIENTS 100
+#ifndef MAX_CLIENTS
+#define MAX_CLIENTS 100                  // Override with make LIMITS="-DMAX_CLIENTS=n"
+#endif
+#ifndef MAX_ROOMS
 #define MAX_ROOMS 50
+#endif
 #define BUFFER_SIZE 8192
+#ifndef THREAD_STACK_SIZE
+#define THREAD_STACK_SIZE (256 * 1024)   // Stack of client and heartbeat threads
+#endif
+#define HANDLER_IDLE_MAX 16              // Idle handler threads kept for resumed connections
+#define SESSION_INDEX_SIZE (4 * MAX_CLIENTS) // Token index slots, at most a quarter used
+#define MAX_PATH_LENGTH 20               // Squares in an OP_MULTI_MOVE path
+#define QUICK_MATCH_ROOM_PREFIX "quick-" // Names of matchmaking rooms, refused for OP_CREATE_ROOM
 
 /**
  * Client connection states for heartbeat monitoring and reconnection.
@@ -27,48 +40,109 @@ typedef enum {
     CLIENT_STATE_REMOVED         // Permanently removed from server
 } ClientState;
 
+#define CLIENT_STATE_COUNT (CLIENT_STATE_REMOVED + 1)
+#define ROOM_STATE_COUNT (ROOM_STATE_FINISHED + 1)
+
+/**
+ * Rate-limit classes of client operations; each class has its own
+ * token bucket per connection (limits in server.c).
+ */
+typedef enum {
+    RATE_CLASS_NONE,             // Not limited (heartbeat, errors)
+    RATE_CLASS_SESSION,          // Login and reconnect
+    RATE_CLASS_LOBBY,            // Room management
+    RATE_CLASS_GAME,             // Moves
+    RATE_CLASS_COUNT
+} RateClass;
+
+/**
+ * Token bucket of one rate class.
+ */
+typedef struct {
+    double tokens;               // Operations currently allowed
+    uint64_t refilled_ns;        // Last refill (metrics_now_ns), 0 if never used
+} RateBucket;
+
 /**
  * Client connection structure.
  * Represents a single client connection with state tracking,
  * heartbeat monitoring, and security violation tracking.
+ *
+ * Fields read for every frame and every heartbeat tick come first so
+ * they share the first cache line; names, buffers and locks follow.
  */
 typedef struct Client {
+    // Hot: per frame and per heartbeat tick
     int socket;                          // Client socket descriptor
-    char client_id[MAX_PLAYER_NAME];     // Unique client identifier
-    pthread_t thread;                    // Handler thread
     bool active;                         // Connection is active
     bool logged_in;                      // Client has completed login
-    char current_room[MAX_ROOM_NAME];    // Currently joined room (empty if in lobby)
-
-    // Heartbeat and reconnection state
-    ClientState state;                   // Connection state
+    bool waiting_for_pong;              // Waiting for PONG response to PING
+    bool outbox_live;                    // Frames go out as sent; false while a reconnect takes over
+    PlayerId player_id;                  // Interned client_id while logged in, else PLAYER_NONE
+    bool state_tallied;                  // state is counted in server_stats.clients_by_state
+    ClientState state;                   // Connection state (change via client_set_state)
     ClientGameState game_state;          // Game logic state (lobby, room, in-game)
+    int missed_pongs;                   // Count of missed PONG responses
     time_t last_pong_time;              // Timestamp of last PONG received
     time_t disconnect_time;             // When disconnection was detected
-    int missed_pongs;                   // Count of missed PONG responses
-    bool waiting_for_pong;              // Waiting for PONG response to PING
+    ClientViolations violations;         // Protocol violation tracking
+
+    // Cold: names, session and locks
+    char client_id[MAX_PLAYER_NAME];     // Unique client identifier
+    char current_room[MAX_ROOM_NAME];    // Currently joined room (empty if in lobby)
+    char session_token[SESSION_TOKEN_LEN + 1]; // Issued at login, empty until then
+    pthread_t thread;                    // Handler thread
     pthread_mutex_t state_mutex;        // Thread-safe state access
 
-    // Security tracking
-    ClientViolations violations;         // Protocol violation tracking
+    // Numbered frames kept for resuming the session
+    Outbox outbox;                       // Recent frames since OP_LOGIN_OK
+    pthread_mutex_t outbox_mutex;        // Outbox and socket writes, taken after state_mutex
+
+    RateBucket rate_buckets[RATE_CLASS_COUNT]; // Touched by the handler thread only
 } Client;
 
+/**
+ * Network backends serving the listeners.
+ */
+typedef enum {
+    SERVER_BACKEND_BLOCKING,     // accept loop, blocking recv/send per client thread
+    SERVER_BACKEND_URING         // io_uring reactor feeding the client threads (uring.h)
+} ServerBackend;
+
 /**
  * Main server structure.
  * Manages all clients, rooms, and threading infrastructure.
  */
 typedef struct {
-    int server_socket;                   // Listening socket
+    int server_socket;                   // Listening socket (-1 for in-process servers)
+    int unix_socket;                     // Unix-domain listener or -1
+    char unix_path[108];                 // Path of the Unix-domain listener
+    ServerBackend backend;               // Set before server_start
     int port;                            // Server port
     bool running;                        // Server is running
     Client clients[MAX_CLIENTS];         // All client connections
     Room rooms[MAX_ROOMS];               // All game rooms
+    // Scan keys, one per slot, packed apart from the slots so lookups and
+    // the heartbeat sweep read a few bytes per slot instead of a whole struct
+    PlayerId client_keys[MAX_CLIENTS];   // player_id of logged-in slots, else PLAYER_NONE
+    uint32_t room_keys[MAX_ROOMS];       // room_key(name) of used slots, else 0
     int client_count;                    // Number of active clients
     int room_count;                      // Number of active rooms
     pthread_mutex_t clients_mutex;       // Client list protection
     pthread_mutex_t rooms_mutex;         // Room list protection
+    Client *sessions[SESSION_INDEX_SIZE]; // Session token index (linear probing)
+    pthread_mutex_t sessions_mutex;      // Token index protection, taken before state_mutex
+
+    // Parked connections with input again, waiting for a handler thread
+    int resume_queue[MAX_CLIENTS];       // Ring of connection handles
+    int resume_head;
+    int resume_count;
+    int idle_handlers;                   // Handler threads waiting on handlers_cond
+    pthread_mutex_t handlers_mutex;      // Resume queue protection
+    pthread_cond_t handlers_cond;        // Signalled when a connection is queued
 
     pthread_t heartbeat_thread;          // Heartbeat monitoring thread
+    pthread_attr_t thread_attr;          // Client and heartbeat threads (THREAD_STACK_SIZE stack)
 } Server;
 
 /**
@@ -88,11 +162,42 @@ typedef struct {
  */
 int server_init(Server *server, int port, const char *bind_address);
 
+/**
+ * Initializes server state without a listener (in-process transports).
+ * @return 0 on success
+ */
+int server_init_local(Server *server);
+
+/**
+ * Adds a Unix-domain listener; call before server_start.
+ * @return 0 on success, -1 on failure
+ */
+int server_listen_unix(Server *server, const char *path);
+
 /**
  * Starts server and begins accepting connections.
  */
 void server_start(Server *server);
 
+/**
+ * Starts the heartbeat thread without accepting connections.
+ * @return 0 on success, -1 on failure
+ */
+int server_start_local(Server *server);
+
+/**
+ * Registers a connected handle and starts its handler thread.
+ * @return Client index or -1 if the connection was refused
+ */
+int server_attach(Server *server, int client_socket);
+
+/**
+ * Hands a parked connection with new input to a handler thread.
+ * @return 0 on success, -1 if the connection cannot be served (its
+ *         client is disconnected; the caller closes the socket)
+ */
+int server_resume(Server *server, int client_socket);
+
 /**
  * Stops server and cleans up all resources.
  */
@@ -117,6 +222,34 @@ int add_client(Server *server, int socket);
  */
 Client* find_client(Server *server, const char *client_id);
 
+/**
+ * Finds a logged-in client by its interned name.
+ * @return Pointer to client or NULL if not found
+ */
+Client* find_client_by_id(Server *server, PlayerId player);
+
+// ========== SESSIONS ==========
+
+/**
+ * Issues a random session token to a logged-in client and indexes it.
+ * Must not be called with the client's state_mutex held.
+ * @return 0 on success, -1 if no random bytes were available
+ */
+int session_issue(Server *server, Client *client);
+
+/**
+ * Finds the client owning a session token. Caller holds sessions_mutex.
+ * @return Pointer to client or NULL if the token is unknown
+ */
+Client* session_find(Server *server, const char *token);
+
+/**
+ * Removes a client's token from the index and releases its outbox
+ * and interned name; no-op without a token.
+ * Must not be called with the client's state_mutex held.
+ */
+void session_revoke(Server *server, Client *client);
+
 // ========== ROOM MANAGEMENT ==========
 
 /**
@@ -125,6 +258,11 @@ Client* find_client(Server *server, const char *client_id);
  */
 Room* create_room(Server *server, const char *room_name, const char *creator);
 
+/**
+ * Hashes a room name into its room_keys entry; never 0.
+ */
+uint32_t room_key(const char *room_name);
+
 /**
  * Finds room by name.
  * @return Pointer to room or NULL if not found
@@ -154,15 +292,73 @@ void leave_room_on_disconnect(Server *server, const char *room_name, const char
 
 // ========== MESSAGE HANDLERS ==========
 
-void handle_login(Server *server, Client *client, const char *data);
-void handle_create_room(Server *server, Client *client, const char *data);
-void handle_join_room(Server *server, Client *client, const char *data);
-void handle_multi_move(Server *server, Client *client, const char *data);
-void handle_move(Server *server, Client *client, const char *data);
-void handle_leave_room(Server *server, Client *client, const char *data);
-void handle_ping(Server *server, Client *client);
-void handle_list_rooms(Server *server, Client *client);
-void handle_reconnect_request(Server *server, Client *client, const char *data);
+/**
+ * Handler arguments, decoded from the payload by the dispatch table's
+ * schema (server.c) before the handler runs.
+ */
+typedef struct {
+    char player[MAX_PLAYER_NAME];
+} LoginArgs;                             // OP_LOGIN, OP_QUICK_MATCH
+
+typedef struct {
+    char player[MAX_PLAYER_NAME];
+    char room[MAX_ROOM_NAME];
+} RoomArgs;                              // OP_CREATE_ROOM, OP_JOIN_ROOM, OP_LEAVE_ROOM
+
+typedef struct {
+    char room[MAX_ROOM_NAME];
+    char player[MAX_PLAYER_NAME];
+    int from_row;
+    int from_col;
+    int to_row;
+    int to_col;
+} MoveArgs;
+
+typedef struct {
+    char room[MAX_ROOM_NAME];
+    char player[MAX_PLAYER_NAME];
+    int path_length;                     // Squares announced
+    int coord_count;                     // Coordinates received (2 per square)
+    int path[MAX_PATH_LENGTH][2];        // Row and column of each square
+} MultiMoveArgs;
+
+typedef struct {
+    char fields[3][MAX_ROOM_NAME];       // [room_name,]player_name,session_token
+    uint32_t last_seq;
+} ReconnectArgs;
+
+typedef struct {
+    int first_rank;                      // 0: from the top
+    int count;                           // 0: default page size
+} LeaderboardArgs;
+
+typedef union {
+    LoginArgs login;
+    RoomArgs room;
+    MoveArgs move;
+    MultiMoveArgs multi_move;
+    ReconnectArgs reconnect;
+    LeaderboardArgs leaderboard;
+} HandlerArgs;
+
+/**
+ * Gets the payload schema of a client operation.
+ * @return Schema, NULL if the payload is ignored or the opcode is not handled
+ */
+const PayloadSchema* dispatch_schema(OpCode op);
+
+void handle_login(Server *server, Client *client, const HandlerArgs *args);
+void handle_create_room(Server *server, Client *client, const HandlerArgs *args);
+void handle_join_room(Server *server, Client *client, const HandlerArgs *args);
+void handle_multi_move(Server *server, Client *client, const HandlerArgs *args);
+void handle_move(Server *server, Client *client, const HandlerArgs *args);
+void handle_leave_room(Server *server, Client *client, const HandlerArgs *args);
+void handle_ping(Server *server, Client *client, const HandlerArgs *args);
+void handle_pong(Server *server, Client *client, const HandlerArgs *args);
+void handle_list_rooms(Server *server, Client *client, const HandlerArgs *args);
+void handle_reconnect_request(Server *server, Client *client, const HandlerArgs *args);
+void handle_quick_match(Server *server, Client *client, const HandlerArgs *args);
+void handle_leaderboard(Server *server, Client *client, const HandlerArgs *args);
 
 // ========== UTILITY FUNCTIONS ==========
 
@@ -171,11 +367,29 @@ void handle_reconnect_request(Server *server, Client *client, const char *data);
  */
 void cleanup_finished_game(Server *server, Room *room);
 
+/**
+ * Ends the game if it is over or must be adjudicated after a move.
+ */
+void check_game_end(Server *server, Room *room);
+
 /**
  * Sends protocol message to client socket.
  */
 void send_message(int socket, OpCode op, const char *data);
 
+/**
+ * Sends a message within a client's session: numbered and kept in the
+ * outbox once logged in, written to the socket unless a reconnect is
+ * taking it over. Must not be called with outbox_mutex held.
+ */
+void send_to_client(Client *client, OpCode op, const char *data);
+
+/**
+ * Sends an unnumbered control message on a client's live socket.
+ * @return true if the message was written
+ */
+bool send_control_to_client(Client *client, OpCode op, const char *data);
+
 /**
  * Broadcasts message to all players in a room.
  */
@@ -188,6 +402,16 @@ void broadcast_to_room(Server *server, const char *room_name, OpCode op, const c
  */
 void* heartbeat_thread(void *arg);
 
+/**
+ * Sets client connection state and updates the per-state tallies.
+ */
+void client_set_state(Client *client, ClientState state);
+
+/**
+ * Removes a released client slot from the per-state tallies.
+ */
+void client_untrack(Client *client);
+
 /**
  * Initializes heartbeat system for client.
  */
@@ -242,6 +466,16 @@ const char* client_get_state_string(ClientState state);
 
 // ========== ROOM STATE MANAGEMENT ==========
 
+/**
+ * Sets room state and updates the per-state tallies.
+ */
+void room_set_state(Room *room, RoomState state);
+
+/**
+ * Removes a released room slot from the per-state tallies.
+ */
+void room_untrack(Room *room);
+
 /**
  * Initializes room state tracking.
  */
@@ -250,7 +484,7 @@ void room_init_state(Room *room);
 /**
  * Pauses game due to player disconnect.
  */
-void room_pause_game(Room *room, const char *player_name);
+void room_pause_game(Room *room, PlayerId player);
 
 /**
  * Resumes paused game after reconnection.
@@ -286,7 +520,7 @@ const char* room_get_state_string(RoomState state);
 void handle_player_disconnect(Server *server, Client *client);
 
 /**
- * Handles player long-term disconnect (ends game, awards opponent).
+ * Handles player long-term disconnect (ends game by adjudication).
  */
 void handle_player_long_disconnect(Server *server, Client *client);
 
@@ -0,0 +1,168 @@
+#include <pthread.h>
+#include <string.h>
+#include "symtab.h"
+#include "game.h"
+
+/**
+ * Interned name and its reference count.
+ */
+typedef struct {
+    char name[MAX_PLAYER_NAME];
+    uint32_t refs;                       // 0: free, linked through next_free
+    PlayerId next_free;
+} Symbol;
+
+static Symbol symbols[SYMTAB_CAPACITY];
+static PlayerId name_index[SYMTAB_INDEX_SIZE]; // Name -> ID (linear probing, 0 = empty)
+static PlayerId free_list;               // First free ID, 0 if none
+static PlayerId next_unused = 1;         // IDs from here on were never handed out
+static pthread_mutex_t symtab_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Home slot of a name in the name index (FNV-1a).
+ *
+ * @param name Player name
+ * @return Slot index
+ */
+static size_t symtab_slot(const char *name) {
+    uint32_t hash = 2166136261u;
+    for (const char *p = name; *p; p++) {
+        hash = (hash ^ (unsigned char)*p) * 16777619u;
+    }
+    return hash % SYMTAB_INDEX_SIZE;
+}
+
+/**
+ * Finds the index slot holding a name, or the empty slot ending its probe chain.
+ * Caller holds symtab_mutex.
+ *
+ * @param name Player name
+ * @return Slot index
+ */
+static size_t symtab_find_slot(const char *name) {
+    size_t slot = symtab_slot(name);
+    while (name_index[slot] && strcmp(symbols[name_index[slot]].name, name) != 0) {
+        slot = (slot + 1) % SYMTAB_INDEX_SIZE;
+    }
+    return slot;
+}
+
+/**
+ * Interns a name and takes a reference to it.
+ *
+ * @param name Player name
+ * @return ID of the name, PLAYER_NONE if the name is empty, too long or the table is full
+ */
+PlayerId symtab_intern(const char *name) {
+    if (name[0] == '\0' || strlen(name) >= MAX_PLAYER_NAME) {
+        return PLAYER_NONE;
+    }
+
+    pthread_mutex_lock(&symtab_mutex);
+    size_t slot = symtab_find_slot(name);
+    PlayerId id = name_index[slot];
+
+    if (id) {
+        symbols[id].refs++;
+    } else {
+        if (free_list) {
+            id = free_list;
+            free_list = symbols[id].next_free;
+        } else if (next_unused < SYMTAB_CAPACITY) {
+            id = next_unused++;
+        } else {
+            pthread_mutex_unlock(&symtab_mutex);
+            return PLAYER_NONE;
+        }
+        strcpy(symbols[id].name, name);
+        symbols[id].refs = 1;
+        name_index[slot] = id;
+    }
+    pthread_mutex_unlock(&symtab_mutex);
+    return id;
+}
+
+/**
+ * Takes another reference to an interned name.
+ *
+ * @param id ID held by the caller
+ */
+void symtab_retain(PlayerId id) {
+    if (id == PLAYER_NONE) {
+        return;
+    }
+    pthread_mutex_lock(&symtab_mutex);
+    symbols[id].refs++;
+    pthread_mutex_unlock(&symtab_mutex);
+}
+
+/**
+ * Drops a reference. The last one removes the name from the index,
+ * shifting later entries of the probe chain back so lookups never
+ * need tombstones, and frees the ID.
+ *
+ * @param id ID held by the caller
+ */
+void symtab_release(PlayerId id) {
+    if (id == PLAYER_NONE) {
+        return;
+    }
+
+    pthread_mutex_lock(&symtab_mutex);
+    if (--symbols[id].refs > 0) {
+        pthread_mutex_unlock(&symtab_mutex);
+        return;
+    }
+
+    size_t hole = symtab_find_slot(symbols[id].name);
+    name_index[hole] = 0;
+    size_t next = hole;
+    for (;;) {
+        next = (next + 1) % SYMTAB_INDEX_SIZE;
+        if (!name_index[next]) {
+            break;
+        }
+        // An entry may fill the hole unless its home lies in (hole, next]
+        size_t home = symtab_slot(symbols[name_index[next]].name);
+        bool stays = hole < next ? (home > hole && home <= next)
+                                 : (home > hole || home <= next);
+        if (!stays) {
+            name_index[hole] = name_index[next];
+            name_index[next] = 0;
+            hole = next;
+        }
+    }
+
+    symbols[id].name[0] = '\0';
+    symbols[id].next_free = free_list;
+    free_list = id;
+    pthread_mutex_unlock(&symtab_mutex);
+}
+
+/**
+ * Finds the ID of a name without taking a reference.
+ *
+ * @param name Player name
+ * @return ID of the name, PLAYER_NONE if it is not interned
+ */
+PlayerId symtab_lookup(const char *name) {
+    if (name[0] == '\0' || strlen(name) >= MAX_PLAYER_NAME) {
+        return PLAYER_NONE;
+    }
+
+    pthread_mutex_lock(&symtab_mutex);
+    PlayerId id = name_index[symtab_find_slot(name)];
+    pthread_mutex_unlock(&symtab_mutex);
+    return id;
+}
+
+/**
+ * Gets the name of an ID. The name does not change while a reference
+ * is held, so no lock is taken.
+ *
+ * @param id Interned ID or PLAYER_NONE
+ * @return Name, "" for PLAYER_NONE
+ */
+const char* symtab_name(PlayerId id) {
+    return symbols[id].name;
+}
@@ -0,0 +1,49 @@
+#ifndef SERVER_SYMTAB_H
+#define SERVER_SYMTAB_H
+
+#include <stdint.h>
+
+#ifndef SYMTAB_CAPACITY
+#define SYMTAB_CAPACITY 8192             // Names interned at once, including the unused ID 0
+#endif
+#define SYMTAB_INDEX_SIZE (2 * SYMTAB_CAPACITY) // Name index slots, at most half used
+
+/**
+ * Interned player name. Rooms and games store these instead of names,
+ * so comparing two players is an integer comparison.
+ */
+typedef uint16_t PlayerId;
+
+#define PLAYER_NONE 0                    // No player; symtab_name gives ""
+
+/**
+ * Interns a name and takes a reference to it. Equal names get the same
+ * ID while any reference is held.
+ * @return ID of the name, PLAYER_NONE if the name is empty or the table is full
+ */
+PlayerId symtab_intern(const char *name);
+
+/**
+ * Takes another reference to an interned name.
+ */
+void symtab_retain(PlayerId id);
+
+/**
+ * Drops a reference; the ID is reused once the last one is dropped.
+ * PLAYER_NONE is ignored.
+ */
+void symtab_release(PlayerId id);
+
+/**
+ * Finds the ID of a name without taking a reference.
+ * @return ID of the name, PLAYER_NONE if it is not interned
+ */
+PlayerId symtab_lookup(const char *name);
+
+/**
+ * Gets the name of an ID. Valid while a reference is held; needs no lock.
+ * @return Name, "" for PLAYER_NONE
+ */
+const char* symtab_name(PlayerId id);
+
+#endif //SERVER_SYMTAB_H
@@ -0,0 +1,642 @@
+#include "tablebase.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define PLAYABLE_SQUARES 32
+#define TB_DIM (TB_MAX_PIECES + 1)
+
+/**
+ * Material signature: counts of white men, white kings, black men, black kings.
+ * Tables are stored for white to move only; black-to-move positions are probed
+ * through the color-flipped (180 degree rotated) position.
+ */
+enum { SIG_WM = 0, SIG_WK = 1, SIG_BM = 2, SIG_BK = 3 };
+
+/**
+ * On-disk file header.
+ */
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t max_pieces;
+    uint32_t table_count;
+} TBFileHeader;
+
+/**
+ * On-disk directory entry, one per material signature.
+ * Table data is 2 bits per position (TBResult), four positions per byte.
+ */
+typedef struct {
+    uint8_t counts[4];
+    uint32_t reserved;
+    uint64_t offset;
+    uint64_t entries;
+} TBDirectoryEntry;
+
+static uint64_t binomial[PLAYABLE_SQUARES + 1][TB_DIM];
+static uint8_t playable_square[PLAYABLE_SQUARES];
+static int8_t playable_index[SQUARE_COUNT];
+static uint64_t playable_mask;
+static pthread_once_t tb_once = PTHREAD_ONCE_INIT;
+
+// Registered tables indexed by signature (mapped file or generator buffers)
+static const uint8_t *tb_data[TB_DIM][TB_DIM][TB_DIM][TB_DIM];
+static int tb_pieces = 0;
+static void *tb_map = NULL;
+static size_t tb_map_size = 0;
+
+/**
+ * Builds binomial coefficients and the playable square numbering.
+ * Playable squares are the dark squares used by init_game ((row + col) even).
+ */
+static void tb_init_tables(void) {
+    for (int n = 0; n <= PLAYABLE_SQUARES; n++) {
+        binomial[n][0] = 1;
+        for (int k = 1; k < TB_DIM; k++) {
+            binomial[n][k] = (n == 0) ? 0 : binomial[n - 1][k - 1] + binomial[n - 1][k];
+        }
+    }
+
+    int count = 0;
+    for (int sq = 0; sq < SQUARE_COUNT; sq++) {
+        playable_index[sq] = -1;
+        if ((SQUARE_ROW(sq) + SQUARE_COL(sq)) % 2 == 0) {
+            playable_index[sq] = (int8_t)count;
+            playable_square[count++] = (uint8_t)sq;
+            playable_mask |= 1ULL << sq;
+        }
+    }
+}
+
+/**
+ * Returns number of positions in a table with the given signature.
+ */
+static uint64_t table_entries(const int counts[4]) {
+    uint64_t size = 1;
+    for (int i = 0; i < 4; i++) {
+        size *= binomial[PLAYABLE_SQUARES][counts[i]];
+    }
+    return size;
+}
+
+/**
+ * Reads a 2-bit value from packed table data.
+ */
+static inline TBResult table_get(const uint8_t *data, uint64_t index) {
+    return (TBResult)((data[index >> 2] >> ((index & 3) * 2)) & 3);
+}
+
+/**
+ * Writes a 2-bit value into packed table data.
+ */
+static inline void table_set(uint8_t *data, uint64_t index, TBResult value) {
+    int shift = (int)(index & 3) * 2;
+    data[index >> 2] = (uint8_t)((data[index >> 2] & ~(3 << shift)) | (value << shift));
+}
+
+/**
+ * Reverses bit order of a 64-bit board (square sq maps to 63 - sq).
+ */
+static uint64_t reverse_bits64(uint64_t x) {
+    x = ((x >> 1) & 0x5555555555555555ULL) | ((x & 0x5555555555555555ULL) << 1);
+    x = ((x >> 2) & 0x3333333333333333ULL) | ((x & 0x3333333333333333ULL) << 2);
+    x = ((x >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((x & 0x0F0F0F0F0F0F0F0FULL) << 4);
+    return __builtin_bswap64(x);
+}
+
+/**
+ * Rotates position 180 degrees and swaps colors (same as rotate_board),
+ * so black to move becomes white to move with identical value.
+ *
+ * @param src Source position
+ * @param dst Output flipped position
+ */
+static void position_flip(const Position *src, Position *dst) {
+    dst->white = reverse_bits64(src->black);
+    dst->black = reverse_bits64(src->white);
+    dst->kings = reverse_bits64(src->kings);
+    dst->side = src->side == COLOR_WHITE ? COLOR_BLACK : COLOR_WHITE;
+    dst->hash = 0;
+}
+
+/**
+ * Ranks a set of squares with the combinatorial number system.
+ *
+ * @param bits Squares of one piece group (all playable)
+ * @return Rank in [0, C(32, popcount))
+ */
+static uint64_t rank_group(uint64_t bits) {
+    uint64_t rank = 0;
+    int i = 1;
+
+    while (bits) {
+        int sq = __builtin_ctzll(bits);
+        bits &= bits - 1;
+        rank += binomial[playable_index[sq]][i++];
+    }
+    return rank;
+}
+
+/**
+ * Converts a rank back into a set of squares.
+ *
+ * @param rank Rank produced by rank_group
+ * @param count Number of squares in the group
+ * @return Bitboard of the group
+ */
+static uint64_t unrank_group(uint64_t rank, int count) {
+    uint64_t bits = 0;
+    int p = PLAYABLE_SQUARES - 1;
+
+    for (int i = count; i >= 1; i--) {
+        while (binomial[p][i] > rank) p--;
+        rank -= binomial[p][i];
+        bits |= 1ULL << playable_square[p];
+        p--;
+    }
+    return bits;
+}
+
+/**
+ * Fills signature counts of a white-to-move position.
+ */
+static void position_signature(const Position *pos, int counts[4]) {
+    counts[SIG_WM] = __builtin_popcountll(pos->white & ~pos->kings);
+    counts[SIG_WK] = __builtin_popcountll(pos->white & pos->kings);
+    counts[SIG_BM] = __builtin_popcountll(pos->black & ~pos->kings);
+    counts[SIG_BK] = __builtin_popcountll(pos->black & pos->kings);
+}
+
+/**
+ * Computes table index of a white-to-move position.
+ *
+ * @param pos Position (white to move)
+ * @param counts Signature of the position
+ * @param index Output index
+ * @return false if a piece stands on a non-playable square
+ */
+static bool position_index(const Position *pos, const int counts[4], uint64_t *index) {
+    if ((pos->white | pos->black) & ~playable_mask) {
+        return false;
+    }
+
+    uint64_t groups[4] = {
+        pos->white & ~pos->kings, pos->white & pos->kings,
+        pos->black & ~pos->kings, pos->black & pos->kings
+    };
+    uint64_t idx = 0;
+
+    for (int i = 0; i < 4; i++) {
+        idx = idx * binomial[PLAYABLE_SQUARES][counts[i]] + rank_group(groups[i]);
+    }
+    *index = idx;
+    return true;
+}
+
+/**
+ * Decodes a table index into a white-to-move position.
+ *
+ * @param counts Table signature
+ * @param index Table index
+ * @param pos Output position
+ * @return false if pieces overlap (index does not describe a position)
+ */
+static bool position_decode(const int counts[4], uint64_t index, Position *pos) {
+    uint64_t groups[4];
+
+    for (int i = 3; i >= 0; i--) {
+        uint64_t size = binomial[PLAYABLE_SQUARES][counts[i]];
+        groups[i] = unrank_group(index % size, counts[i]);
+        index /= size;
+    }
+
+    uint64_t all = 0;
+    for (int i = 0; i < 4; i++) {
+        if (all & groups[i]) return false;
+        all |= groups[i];
+    }
+
+    pos->white = groups[SIG_WM] | groups[SIG_WK];
+    pos->black = groups[SIG_BM] | groups[SIG_BK];
+    pos->kings = groups[SIG_WK] | groups[SIG_BK];
+    pos->side = COLOR_WHITE;
+    pos->hash = 0;
+    return true;
+}
+
+// ========== PROBING ==========
+
+/**
+ * Looks up a position in the registered tables.
+ * Runs in O(1): signature selects the table, combinatorial rank the entry.
+ *
+ * @param pos Position with either side to move
+ * @return Value for side to move, TB_UNKNOWN if not covered
+ */
+TBResult tb_probe(const Position *pos) {
+    Position flipped;
+    const Position *p = pos;
+
+    pthread_once(&tb_once, tb_init_tables);
+    if (pos->side == COLOR_BLACK) {
+        position_flip(pos, &flipped);
+        p = &flipped;
+    }
+
+    int own = __builtin_popcountll(p->white);
+    int opponent = __builtin_popcountll(p->black);
+
+    if (own == 0) return TB_LOSS;
+    if (opponent == 0) return TB_WIN;
+    if (own + opponent > tb_pieces) return TB_UNKNOWN;
+
+    int counts[4];
+    position_signature(p, counts);
+
+    const uint8_t *data = tb_data[counts[SIG_WM]][counts[SIG_WK]][counts[SIG_BM]][counts[SIG_BK]];
+    uint64_t index;
+    if (!data || !position_index(p, counts, &index)) {
+        return TB_UNKNOWN;
+    }
+    return table_get(data, index);
+}
+
+/**
+ * Largest piece count covered by loaded tables.
+ *
+ * @return Piece count, 0 if no tablebase is loaded
+ */
+int tb_max_pieces(void) {
+    return tb_pieces;
+}
+
+/**
+ * Converts tablebase result to string.
+ *
+ * @param result Result to convert
+ * @return String representation
+ */
+const char* tb_result_string(TBResult result) {
+    switch (result) {
+        case TB_WIN: return "WIN";
+        case TB_LOSS: return "LOSS";
+        case TB_DRAW: return "DRAW";
+        default: return "UNKNOWN";
+    }
+}
+
+/**
+ * Memory-maps a tablebase file and registers its tables.
+ * Pages are faulted in on demand, so only probed regions occupy RAM.
+ *
+ * @param path Path to the tablebase file
+ * @return 0 on success, -1 on failure
+ */
+int tb_init(const char *path) {
+    pthread_once(&tb_once, tb_init_tables);
+    tb_close();
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror("Tablebase open failed");
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(TBFileHeader)) {
+        fprintf(stderr, "Tablebase %s is truncated\n", path);
+        close(fd);
+        return -1;
+    }
+
+    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror("Tablebase mmap failed");
+        return -1;
+    }
+    madvise(map, st.st_size, MADV_RANDOM);
+
+    const TBFileHeader *header = (const TBFileHeader*)map;
+    size_t directory_end = sizeof(TBFileHeader) +
+                           (size_t)header->table_count * sizeof(TBDirectoryEntry);
+
+    if (memcmp(header->magic, TB_MAGIC, 4) != 0 || header->version != TB_VERSION ||
+        header->max_pieces > TB_MAX_PIECES || directory_end > (size_t)st.st_size) {
+        fprintf(stderr, "Tablebase %s has invalid header\n", path);
+        munmap(map, st.st_size);
+        return -1;
+    }
+
+    const TBDirectoryEntry *directory = (const TBDirectoryEntry*)(header + 1);
+    for (uint32_t i = 0; i < header->table_count; i++) {
+        const TBDirectoryEntry *entry = &directory[i];
+        int counts[4];
+        for (int j = 0; j < 4; j++) counts[j] = entry->counts[j];
+
+        if (counts[0] + counts[1] + counts[2] + counts[3] > (int)header->max_pieces ||
+            entry->entries != table_entries(counts) ||
+            entry->offset + (entry->entries + 3) / 4 > (uint64_t)st.st_size) {
+            fprintf(stderr, "Tablebase %s has invalid directory entry %u\n", path, i);
+            memset(tb_data, 0, sizeof(tb_data));
+            munmap(map, st.st_size);
+            return -1;
+        }
+        tb_data[counts[0]][counts[1]][counts[2]][counts[3]] = (const uint8_t*)map + entry->offset;
+    }
+
+    tb_map = map;
+    tb_map_size = st.st_size;
+    tb_pieces = (int)header->max_pieces;
+
+    printf("Tablebase loaded: %s (%u tables, up to %d pieces, %zu KB mapped)\n",
+           path, header->table_count, tb_pieces, tb_map_size / 1024);
+    return 0;
+}
+
+/**
+ * Unmaps the tablebase file and clears the table registry.
+ */
+void tb_close(void) {
+    if (tb_map) {
+        munmap(tb_map, tb_map_size);
+        tb_map = NULL;
+        tb_map_size = 0;
+    }
+    memset(tb_data, 0, sizeof(tb_data));
+    tb_pieces = 0;
+}
+
+// ========== GENERATION ==========
+
+/**
+ * Table being generated.
+ */
+typedef struct {
+    int counts[4];
+    uint64_t entries;
+    uint8_t *data;
+    uint64_t wins, losses, draws;
+} TBBuildTable;
+
+/**
+ * Resolves one position from its successors.
+ * Successors in the same signature class read the table under construction,
+ * all others come from tables finished earlier.
+ *
+ * @param pos Position (white to move)
+ * @return WIN/LOSS if decided, TB_UNKNOWN otherwise
+ */
+static TBResult resolve_position(const Position *pos) {
+    MoveList list;
+    if (generate_moves(pos, &list) == 0) {
+        return TB_LOSS;
+    }
+
+    bool all_win = true;
+    for (int i = 0; i < list.count; i++) {
+        Position child = *pos;
+        make_move(&child, &list.moves[i]);
+
+        TBResult value = tb_probe(&child);
+        if (value == TB_LOSS) {
+            return TB_WIN;
+        }
+        if (value != TB_WIN) {
+            all_win = false;
+        }
+    }
+    return all_win ? TB_LOSS : TB_UNKNOWN;
+}
+
+/**
+ * Solves a signature class ({signature, flipped signature}) to a fixpoint.
+ * Quiet moves swap the side to move, so a table depends on its flipped
+ * partner; captures and promotions lead to classes solved earlier.
+ * Positions still undecided at the fixpoint are draws.
+ *
+ * @param tables Tables of the class (1 or 2)
+ * @param count Number of tables
+ * @return Number of fixpoint passes
+ */
+static int solve_class(TBBuildTable *tables, int count) {
+    int passes = 0;
+    bool changed = true;
+
+    while (changed) {
+        changed = false;
+        passes++;
+
+        for (int t = 0; t < count; t++) {
+            TBBuildTable *table = &tables[t];
+
+            for (uint64_t index = 0; index < table->entries; index++) {
+                if (table_get(table->data, index) != TB_UNKNOWN) continue;
+
+                Position pos;
+                if (!position_decode(table->counts, index, &pos)) {
+                    table_set(table->data, index, TB_DRAW);
+                    continue;
+                }
+
+                TBResult value = resolve_position(&pos);
+                if (value != TB_UNKNOWN) {
+                    table_set(table->data, index, value);
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    for (int t = 0; t < count; t++) {
+        TBBuildTable *table = &tables[t];
+        for (uint64_t index = 0; index < table->entries; index++) {
+            Position pos;
+            TBResult value = table_get(table->data, index);
+            if (!position_decode(table->counts, index, &pos)) continue;
+
+            if (value == TB_UNKNOWN) {
+                table_set(table->data, index, TB_DRAW);
+                value = TB_DRAW;
+            }
+            if (value == TB_WIN) table->wins++;
+            else if (value == TB_LOSS) table->losses++;
+            else table->draws++;
+        }
+    }
+    return passes;
+}
+
+/**
+ * Compares signatures by (total pieces, men) so every table is built after
+ * the tables its captures and promotions lead to.
+ */
+static int compare_signatures(const void *a, const void *b) {
+    const TBBuildTable *x = a;
+    const TBBuildTable *y = b;
+    int total_x = x->counts[0] + x->counts[1] + x->counts[2] + x->counts[3];
+    int total_y = y->counts[0] + y->counts[1] + y->counts[2] + y->counts[3];
+    if (total_x != total_y) return total_x - total_y;
+    return (x->counts[SIG_WM] + x->counts[SIG_BM]) - (y->counts[SIG_WM] + y->counts[SIG_BM]);
+}
+
+/**
+ * Writes generated tables to disk.
+ *
+ * @param path Output file
+ * @param tables Generated tables
+ * @param count Number of tables
+ * @param max_pieces Piece ceiling
+ * @return 0 on success, -1 on failure
+ */
+static int write_tables(const char *path, const TBBuildTable *tables, int count, int max_pieces) {
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        perror("Tablebase create failed");
+        return -1;
+    }
+
+    TBFileHeader header;
+    memcpy(header.magic, TB_MAGIC, 4);
+    header.version = TB_VERSION;
+    header.max_pieces = (uint32_t)max_pieces;
+    header.table_count = (uint32_t)count;
+
+    uint64_t offset = sizeof(header) + (uint64_t)count * sizeof(TBDirectoryEntry);
+    offset = (offset + 63) & ~63ULL;
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (int i = 0; i < count && ok; i++) {
+        TBDirectoryEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        for (int j = 0; j < 4; j++) entry.counts[j] = (uint8_t)tables[i].counts[j];
+        entry.offset = offset;
+        entry.entries = tables[i].entries;
+        ok = fwrite(&entry, sizeof(entry), 1, file) == 1;
+        offset = (offset + (tables[i].entries + 3) / 4 + 63) & ~63ULL;
+    }
+
+    for (int i = 0; i < count && ok; i++) {
+        static const uint8_t zeros[64] = {0};
+        long position = ftell(file);
+        long aligned = (position + 63) & ~63L;
+        ok = fwrite(zeros, 1, aligned - position, file) == (size_t)(aligned - position) &&
+             fwrite(tables[i].data, 1, (tables[i].entries + 3) / 4, file) == (tables[i].entries + 3) / 4;
+    }
+
+    if (fclose(file) != 0 || !ok) {
+        fprintf(stderr, "Failed to write tablebase %s\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Builds all tables with 2..max_pieces pieces and writes them to a file.
+ * Tables are registered while generated, so later classes probe earlier ones
+ * through the same code path the server uses.
+ *
+ * @param path Output file
+ * @param max_pieces Largest piece count (2..TB_MAX_PIECES)
+ * @param verbose Print per-table statistics
+ * @return 0 on success, -1 on failure
+ */
+int tb_generate(const char *path, int max_pieces, bool verbose) {
+    if (max_pieces < 2 || max_pieces > TB_MAX_PIECES) {
+        fprintf(stderr, "Piece count must be 2..%d\n", TB_MAX_PIECES);
+        return -1;
+    }
+
+    movegen_init();
+    pthread_once(&tb_once, tb_init_tables);
+    tb_close();
+    tb_pieces = max_pieces;
+
+    // Enumerate signatures with at least one piece per side
+    TBBuildTable *tables = calloc(TB_DIM * TB_DIM * TB_DIM * TB_DIM, sizeof(TBBuildTable));
+    if (!tables) return -1;
+    int count = 0;
+
+    for (int wm = 0; wm <= max_pieces; wm++)
+    for (int wk = 0; wm + wk <= max_pieces; wk++)
+    for (int bm = 0; wm + wk + bm <= max_pieces; bm++)
+    for (int bk = 0; wm + wk + bm + bk <= max_pieces; bk++) {
+        if (wm + wk == 0 || bm + bk == 0) continue;
+        TBBuildTable *table = &tables[count++];
+        table->counts[SIG_WM] = wm;
+        table->counts[SIG_WK] = wk;
+        table->counts[SIG_BM] = bm;
+        table->counts[SIG_BK] = bk;
+        table->entries = table_entries(table->counts);
+    }
+    qsort(tables, count, sizeof(TBBuildTable), compare_signatures);
+
+    int result = 0;
+    for (int i = 0; i < count && result == 0; i++) {
+        if (tables[i].data) continue;
+
+        // Pair the table with its color-flipped partner
+        TBBuildTable *class_tables[2] = { &tables[i], NULL };
+        int class_size = 1;
+        for (int j = i + 1; j < count; j++) {
+            if (tables[j].counts[SIG_WM] == tables[i].counts[SIG_BM] &&
+                tables[j].counts[SIG_WK] == tables[i].counts[SIG_BK] &&
+                tables[j].counts[SIG_BM] == tables[i].counts[SIG_WM] &&
+                tables[j].counts[SIG_BK] == tables[i].counts[SIG_WK]) {
+                class_tables[class_size++] = &tables[j];
+                break;
+            }
+        }
+
+        for (int t = 0; t < class_size; t++) {
+            TBBuildTable *table = class_tables[t];
+            table->data = calloc((table->entries + 3) / 4, 1);
+            if (!table->data) {
+                fprintf(stderr, "Out of memory generating tablebase\n");
+                result = -1;
+                break;
+            }
+            tb_data[table->counts[0]][table->counts[1]][table->counts[2]][table->counts[3]] = table->data;
+        }
+        if (result != 0) break;
+
+        // Solve with contiguous copies so both tables see each other's progress
+        TBBuildTable solved[2];
+        for (int t = 0; t < class_size; t++) solved[t] = *class_tables[t];
+
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        int passes = solve_class(solved, class_size);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        for (int t = 0; t < class_size; t++) {
+            *class_tables[t] = solved[t];
+            if (verbose) {
+                const TBBuildTable *table = class_tables[t];
+                printf("  %dwm %dwk %dbm %dbk: %10llu positions, %8llu W %8llu L %8llu D (%d passes, %.2fs)\n",
+                       table->counts[0], table->counts[1], table->counts[2], table->counts[3],
+                       (unsigned long long)table->entries,
+                       (unsigned long long)table->wins, (unsigned long long)table->losses,
+                       (unsigned long long)table->draws, passes,
+                       (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9);
+            }
+        }
+    }
+
+    if (result == 0) {
+        result = write_tables(path, tables, count, max_pieces);
+    }
+
+    for (int i = 0; i < count; i++) free(tables[i].data);
+    free(tables);
+    memset(tb_data, 0, sizeof(tb_data));
+    tb_pieces = 0;
+    return result;
+}
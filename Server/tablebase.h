@@ -0,0 +1,61 @@
+#ifndef SERVER_TABLEBASE_H
+#define SERVER_TABLEBASE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "movegen.h"
+
+#define TB_MAX_PIECES 5                  // Hard ceiling for generation and probing
+#define TB_DEFAULT_PIECES 4              // Default generator ceiling
+#define TB_DEFAULT_PATH "checkers.tb"    // Default tablebase file
+#define TB_MAGIC "CKTB"
+#define TB_VERSION 1
+
+/**
+ * Game-theoretic value from the side to move's point of view.
+ */
+typedef enum {
+    TB_UNKNOWN = 0,          // Position not covered by loaded tables
+    TB_WIN = 1,
+    TB_LOSS = 2,
+    TB_DRAW = 3
+} TBResult;
+
+// ========== PROBING ==========
+
+/**
+ * Memory-maps a tablebase file and registers its tables.
+ * @return 0 on success, -1 on failure
+ */
+int tb_init(const char *path);
+
+/**
+ * Unmaps the tablebase file.
+ */
+void tb_close(void);
+
+/**
+ * Largest piece count covered by loaded tables (0 if none).
+ */
+int tb_max_pieces(void);
+
+/**
+ * Looks up a position in O(1).
+ * @return Value for side to move, TB_UNKNOWN if not covered
+ */
+TBResult tb_probe(const Position *pos);
+
+/**
+ * Converts result to string.
+ */
+const char* tb_result_string(TBResult result);
+
+// ========== GENERATION ==========
+
+/**
+ * Builds all tables up to max_pieces by retrograde analysis and writes them to path.
+ * @return 0 on success, -1 on failure
+ */
+int tb_generate(const char *path, int max_pieces, bool verbose);
+
+#endif //SERVER_TABLEBASE_H
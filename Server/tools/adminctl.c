@@ -0,0 +1,77 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "../protocol.h"
+
+/**
+ * Prints usage information.
+ *
+ * @param program_name Name of the executable
+ */
+static void print_usage(const char *program_name) {
+    printf("Usage: %s SOCKET\n", program_name);
+    printf("Queries a server started with --admin-socket SOCKET and prints\n");
+    printf("the OP_ADMIN_STATS JSON snapshot.\n");
+}
+
+/**
+ * Admin client entry point.
+ *
+ * @param argc Argument count
+ * @param argv Argument vector
+ * @return 0 on success, 1 on connection or protocol failure
+ */
+int main(int argc, char *argv[]) {
+    if (argc != 2 || argv[1][0] == '-') {
+        print_usage(argv[0]);
+        return argc == 2 ? 0 : 1;
+    }
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(argv[1]) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Socket path too long\n");
+        return 1;
+    }
+    strcpy(addr.sun_path, argv[1]);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("Connect failed");
+        return 1;
+    }
+
+    char frame[MAX_MESSAGE_LEN];
+    int len = create_message(frame, OP_ADMIN_STATS, "");
+    if (send(fd, frame, len, 0) != len) {
+        perror("Send failed");
+        close(fd);
+        return 1;
+    }
+
+    len = 0;
+    while (len < (int)sizeof(frame) - 1) {
+        ssize_t n = recv(fd, frame + len, sizeof(frame) - 1 - len, 0);
+        if (n <= 0) {
+            break;
+        }
+        len += (int)n;
+    }
+    close(fd);
+    frame[len] = '\0';
+    frame[strcspn(frame, "\n")] = '\0';
+
+    Message msg;
+    DisconnectReason reason;
+    if (parse_message(frame, &msg, &reason) < 0 || msg.op != OP_ADMIN_STATS) {
+        fprintf(stderr, "Unexpected reply: %s\n", frame);
+        return 1;
+    }
+
+    printf("%s\n", msg.data);
+    return 0;
+}
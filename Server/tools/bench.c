@@ -0,0 +1,582 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "../server.h"
+#include "../protocol.h"
+#include "../game.h"
+#include "../client_state_machine.h"
+#include "../metrics.h"
+
+#define BENCH_DEFAULT_SAMPLES 200        // Timed batches per benchmark
+#define BENCH_BATCH_NS 50000             // Target duration of one batch
+#define BENCH_WARMUP_CALLS 500           // Untimed calls before calibration
+#define BENCH_MAX_RESULTS 64             // Upper bound of registered benchmarks
+
+/**
+ * Output formats for benchmark results.
+ */
+typedef enum {
+    FORMAT_TEXT,
+    FORMAT_JSON,
+    FORMAT_CSV
+} OutputFormat;
+
+/**
+ * Summary of one benchmark, all times in ns/op.
+ */
+typedef struct {
+    char name[64];
+    long iterations;
+    double mean;
+    double min;
+    double p50;
+    double p90;
+    double p99;
+    double max;
+    double l1d_misses;       // L1 data read misses per op, -1 if not counted
+    double llc_misses;       // Last-level cache misses per op, -1 if not counted
+} BenchResult;
+
+/**
+ * Shared fixture for all benchmarks.
+ */
+typedef struct {
+    Server *server;
+    Game game;
+    Game king_game;
+    char move_frame[MAX_MESSAGE_LEN];
+    char state_frame[MAX_MESSAGE_LEN];
+    char board_json[MAX_MESSAGE_LEN];
+    char names[MAX_CLIENTS > MAX_ROOMS ? MAX_CLIENTS : MAX_ROOMS][MAX_PLAYER_NAME];
+    int fill;                // Occupied slots for lookup benchmarks
+    int cursor;              // Rotates lookups over occupied slots
+} BenchContext;
+
+typedef void (*BenchFn)(BenchContext *ctx);
+
+static volatile long sink;   // Keeps results alive under optimisation
+static int samples = BENCH_DEFAULT_SAMPLES;
+static BenchResult results[BENCH_MAX_RESULTS];
+static int result_count = 0;
+static bool count_misses = false;
+static int l1d_counter = -1;     // perf event descriptors, -1 if unavailable
+static int llc_counter = -1;
+
+/**
+ * Prints usage information for the benchmark.
+ *
+ * @param program_name Name of the executable
+ */
+static void print_usage(const char *program_name) {
+    printf("Usage: %s [-n samples] [-f text|json|csv] [-b filter] [-c]\n", program_name);
+    printf("  -n samples   Timed batches per benchmark (default: %d)\n", BENCH_DEFAULT_SAMPLES);
+    printf("  -f format    Output format (default: text)\n");
+    printf("  -b filter    Run only benchmarks whose name contains filter\n");
+    printf("  -c           Count cache misses per op (needs hardware perf counters)\n");
+}
+
+/**
+ * Returns monotonic clock time in nanoseconds.
+ */
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * Opens a user-space hardware counter for this thread.
+ *
+ * @param type PERF_TYPE_HARDWARE or PERF_TYPE_HW_CACHE
+ * @param config Event of that type
+ * @return Descriptor, -1 if the event is unavailable
+ */
+static int open_counter(uint32_t type, uint64_t config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+/**
+ * Opens the L1D and LLC miss counters.
+ * Most VMs and containers expose neither; results then show "-".
+ */
+static void open_counters(void) {
+    l1d_counter = open_counter(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+                               (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                               (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+    llc_counter = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    if (l1d_counter < 0 && llc_counter < 0) {
+        fprintf(stderr, "Cache counters unavailable: %s\n", strerror(errno));
+    }
+}
+
+/**
+ * Starts a counter from zero.
+ */
+static void counter_start(int fd) {
+    if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+/**
+ * Stops a counter and gets its count per operation.
+ *
+ * @param fd Counter descriptor
+ * @param ops Operations run while it counted
+ * @return Events per op, -1 if the counter is unavailable
+ */
+static double counter_stop(int fd, long ops) {
+    uint64_t count;
+    if (fd < 0) {
+        return -1;
+    }
+    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    if (read(fd, &count, sizeof(count)) != (ssize_t)sizeof(count)) {
+        return -1;
+    }
+    return (double)count / ops;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Times a benchmark function.
+ * After BENCH_WARMUP_CALLS untimed calls, so one-time setup (first-use
+ * allocations, cold caches) does not cut calibration short, the batch
+ * size is calibrated so one batch takes about BENCH_BATCH_NS, then every
+ * sample records the mean ns/op of one batch.
+ *
+ * @param name Benchmark name
+ * @param fn Operation to time
+ * @param ctx Benchmark fixture
+ */
+static void run_bench(const char *name, BenchFn fn, BenchContext *ctx) {
+    for (int i = 0; i < BENCH_WARMUP_CALLS; i++) fn(ctx);
+
+    long batch = 1;
+    for (;;) {
+        long long start = now_ns();
+        for (long i = 0; i < batch; i++) fn(ctx);
+        long long elapsed = now_ns() - start;
+        if (elapsed >= BENCH_BATCH_NS || batch >= (1L << 24)) break;
+        batch *= 2;
+    }
+
+    double *times = malloc(sizeof(double) * samples);
+    double total = 0.0;
+
+    counter_start(l1d_counter);
+    counter_start(llc_counter);
+    for (int s = 0; s < samples; s++) {
+        long long start = now_ns();
+        for (long i = 0; i < batch; i++) fn(ctx);
+        times[s] = (double)(now_ns() - start) / batch;
+        total += times[s];
+    }
+    double l1d_misses = counter_stop(l1d_counter, batch * samples);
+    double llc_misses = counter_stop(llc_counter, batch * samples);
+
+    qsort(times, samples, sizeof(double), compare_double);
+
+    if (result_count < BENCH_MAX_RESULTS) {
+        BenchResult *r = &results[result_count++];
+        snprintf(r->name, sizeof(r->name), "%s", name);
+        r->iterations = batch * samples;
+        r->mean = total / samples;
+        r->min = times[0];
+        r->p50 = times[(samples - 1) * 50 / 100];
+        r->p90 = times[(samples - 1) * 90 / 100];
+        r->p99 = times[(samples - 1) * 99 / 100];
+        r->max = times[samples - 1];
+        r->l1d_misses = l1d_misses;
+        r->llc_misses = llc_misses;
+    }
+
+    free(times);
+}
+
+// ========== BENCHMARKS ==========
+
+static void bench_parse_move(BenchContext *ctx) {
+    Message msg;
+    DisconnectReason reason;
+    sink += parse_message(ctx->move_frame, &msg, &reason);
+}
+
+static void bench_parse_state(BenchContext *ctx) {
+    Message msg;
+    DisconnectReason reason;
+    sink += parse_message(ctx->state_frame, &msg, &reason);
+}
+
+static void bench_decode_move(BenchContext *ctx) {
+    (void)ctx;
+    HandlerArgs args;
+    sink += payload_decode(dispatch_schema(OP_MOVE), "room1,alice,5,0,4,1", &args);
+    sink += args.move.to_col;
+}
+
+static void bench_sscanf_move(BenchContext *ctx) {
+    // Parsing handle_move did before payload schemas
+    (void)ctx;
+    char room_name[MAX_ROOM_NAME];
+    char player_name[MAX_PLAYER_NAME];
+    int from_row, from_col, to_row, to_col;
+    sink += sscanf("room1,alice,5,0,4,1", "%[^,],%[^,],%d,%d,%d,%d",
+                   room_name, player_name, &from_row, &from_col, &to_row, &to_col);
+    sink += to_col;
+}
+
+static void bench_decode_multi_move(BenchContext *ctx) {
+    (void)ctx;
+    HandlerArgs args;
+    sink += payload_decode(dispatch_schema(OP_MULTI_MOVE), "room1,alice,3,5,0,3,2,1,4", &args);
+    sink += args.multi_move.path[2][1];
+}
+
+static void bench_sscanf_multi_move(BenchContext *ctx) {
+    // Parsing handle_multi_move did before payload schemas
+    (void)ctx;
+    const char *data = "room1,alice,3,5,0,3,2,1,4";
+    char room_name[MAX_ROOM_NAME];
+    char player_name[MAX_PLAYER_NAME];
+    int path_length;
+    int path[20][2];
+
+    if (sscanf(data, "%[^,],%[^,],%d", room_name, player_name, &path_length) != 3) return;
+    const char *ptr = data;
+    for (int i = 0; i < 3; i++) {
+        ptr = strchr(ptr, ',') + 1;
+    }
+    for (int i = 0; i < path_length; i++) {
+        sscanf(ptr, "%d,%d", &path[i][0], &path[i][1]);
+        ptr = strchr(ptr, ',');
+        if (ptr) ptr++;
+        ptr = strchr(ptr, ',');
+        if (ptr && i < path_length - 1) ptr++;
+    }
+    sink += path[2][1];
+}
+
+static void bench_create_move(BenchContext *ctx) {
+    (void)ctx;
+    char buffer[MAX_MESSAGE_LEN];
+    sink += create_message(buffer, OP_MOVE, "room1,alice,5,0,4,1");
+}
+
+static void bench_create_state(BenchContext *ctx) {
+    char buffer[MAX_MESSAGE_LEN];
+    sink += create_message(buffer, OP_GAME_STATE, ctx->board_json);
+}
+
+static void bench_board_to_json(BenchContext *ctx) {
+    sink += game_board_to_json(&ctx->game)[0];
+}
+
+static void bench_validate_man(BenchContext *ctx) {
+    sink += validate_move(&ctx->game, 5, 0, 4, 1, ctx->game.player1);
+}
+
+static void bench_validate_king(BenchContext *ctx) {
+    sink += validate_move(&ctx->king_game, 7, 7, 1, 1, ctx->king_game.player1);
+}
+
+static void bench_apply(BenchContext *ctx) {
+    // Forward and back keeps the board unchanged; counts as two operations
+    apply_move(&ctx->game, 5, 0, 4, 1);
+    apply_move(&ctx->game, 4, 1, 5, 0);
+    sink += ctx->game.board[5][0];
+}
+
+static void bench_game_over(BenchContext *ctx) {
+    PlayerId winner;
+    sink += check_game_over(&ctx->game, &winner);
+}
+
+static void bench_operation_allowed(BenchContext *ctx) {
+    static const OpCode ops[] = {OP_LOGIN, OP_MOVE, OP_JOIN_ROOM, OP_PONG, OP_LIST_ROOMS};
+    ClientGameState state = (ClientGameState)(ctx->cursor % 4);
+    sink += is_operation_allowed(state, ops[ctx->cursor % 5]);
+    ctx->cursor++;
+}
+
+static void bench_metrics_record(BenchContext *ctx) {
+    metrics_record(METRICS_PHASE_HANDLER, OP_MOVE, 1000 + (ctx->cursor++ & 0xffff));
+}
+
+static void bench_metrics_timed(BenchContext *ctx) {
+    (void)ctx;
+    uint64_t start = metrics_now_ns();
+    metrics_record(METRICS_PHASE_PARSE, OP_MOVE, metrics_now_ns() - start);
+}
+
+static void bench_find_client_hit(BenchContext *ctx) {
+    sink += find_client(ctx->server, ctx->names[ctx->cursor++ % ctx->fill]) != NULL;
+}
+
+static void bench_find_client_miss(BenchContext *ctx) {
+    sink += find_client(ctx->server, "nobody") != NULL;
+}
+
+static void bench_find_room_last(BenchContext *ctx) {
+    // Full scan: the match is in the last occupied slot
+    sink += find_room(ctx->server, ctx->names[ctx->fill - 1]) != NULL;
+}
+
+static void bench_find_client_by_id(BenchContext *ctx) {
+    PlayerId player = ctx->server->clients[ctx->cursor++ % ctx->fill].player_id;
+    sink += find_client_by_id(ctx->server, player) != NULL;
+}
+
+static void bench_find_room_hit(BenchContext *ctx) {
+    sink += find_room(ctx->server, ctx->names[ctx->cursor++ % ctx->fill]) != NULL;
+}
+
+static void bench_find_room_miss(BenchContext *ctx) {
+    sink += find_room(ctx->server, "nowhere") != NULL;
+}
+
+// ========== FIXTURE ==========
+
+/**
+ * Occupies the first fill client and room slots.
+ * Names are "player%03d" for clients and rooms alike, so one name table
+ * serves both lookup benchmarks.
+ *
+ * @param ctx Benchmark fixture
+ * @param fill Number of slots to occupy
+ */
+static void fill_tables(BenchContext *ctx, int fill) {
+    Server *server = ctx->server;
+    memset(server->clients, 0, sizeof(server->clients));
+    memset(server->rooms, 0, sizeof(server->rooms));
+    memset(server->client_keys, 0, sizeof(server->client_keys));
+    memset(server->room_keys, 0, sizeof(server->room_keys));
+
+    for (int i = 0; i < MAX_CLIENTS && i < fill; i++) {
+        snprintf(ctx->names[i], MAX_PLAYER_NAME, "player%03d", i);
+        strcpy(server->clients[i].client_id, ctx->names[i]);
+        server->clients[i].player_id = symtab_intern(ctx->names[i]);
+        server->client_keys[i] = server->clients[i].player_id;
+        server->clients[i].active = true;
+    }
+    for (int i = 0; i < MAX_ROOMS && i < fill; i++) {
+        strcpy(server->rooms[i].name, ctx->names[i]);
+        server->rooms[i].owner = symtab_intern(ctx->names[i]);
+        server->room_keys[i] = room_key(ctx->names[i]);
+        server->rooms[i].players_count = 1;
+    }
+
+    ctx->fill = fill;
+    ctx->cursor = 0;
+}
+
+/**
+ * Builds games and protocol frames used by the benchmarks.
+ *
+ * @param ctx Benchmark fixture
+ */
+static void init_fixture(BenchContext *ctx) {
+    ctx->server = calloc(1, sizeof(Server));
+
+    PlayerId alice = symtab_intern("alice");
+    PlayerId bob = symtab_intern("bob");
+    init_game(&ctx->game, alice, bob);
+
+    init_game(&ctx->king_game, alice, bob);
+    memset(ctx->king_game.board, 0, sizeof(ctx->king_game.board));
+    ctx->king_game.board[7][7] = WHITE_KING;
+    ctx->king_game.board[3][3] = BLACK_PIECE;
+
+    snprintf(ctx->board_json, sizeof(ctx->board_json), "%s", game_board_to_json(&ctx->game));
+    create_message(ctx->move_frame, OP_MOVE, "room1,alice,5,0,4,1");
+    create_message(ctx->state_frame, OP_GAME_STATE, ctx->board_json);
+}
+
+/**
+ * Checks if a benchmark is selected by the name filter.
+ */
+static bool selected(const char *filter, const char *name) {
+    return !filter || strstr(name, filter) != NULL;
+}
+
+// ========== OUTPUT ==========
+
+/**
+ * Prints a miss count column, "-" if it was not counted.
+ */
+static void print_misses(double misses) {
+    if (misses < 0) {
+        printf(" %9s", "-");
+    } else {
+        printf(" %9.2f", misses);
+    }
+}
+
+static void print_text(void) {
+    printf("%-28s %12s %9s %9s %9s %9s %9s %9s",
+           "benchmark", "iterations", "mean", "min", "p50", "p90", "p99", "max");
+    if (count_misses) printf(" %9s %9s", "L1D/op", "LLC/op");
+    printf("\n");
+    for (int i = 0; i < result_count; i++) {
+        BenchResult *r = &results[i];
+        printf("%-28s %12ld %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f",
+               r->name, r->iterations, r->mean, r->min, r->p50, r->p90, r->p99, r->max);
+        if (count_misses) {
+            print_misses(r->l1d_misses);
+            print_misses(r->llc_misses);
+        }
+        printf("\n");
+    }
+    printf("(all times in ns/op)\n");
+}
+
+static void print_json(void) {
+    printf("{\n  \"unit\": \"ns/op\",\n  \"samples\": %d,\n  \"benchmarks\": [\n", samples);
+    for (int i = 0; i < result_count; i++) {
+        BenchResult *r = &results[i];
+        printf("    {\"name\":\"%s\",\"iterations\":%ld,\"mean\":%.2f,\"min\":%.2f,"
+               "\"p50\":%.2f,\"p90\":%.2f,\"p99\":%.2f,\"max\":%.2f",
+               r->name, r->iterations, r->mean, r->min, r->p50, r->p90, r->p99, r->max);
+        if (r->l1d_misses >= 0) printf(",\"l1d_misses\":%.3f", r->l1d_misses);
+        if (r->llc_misses >= 0) printf(",\"llc_misses\":%.3f", r->llc_misses);
+        printf("}%s\n", i + 1 < result_count ? "," : "");
+    }
+    printf("  ]\n}\n");
+}
+
+static void print_csv(void) {
+    printf("name,iterations,mean_ns,min_ns,p50_ns,p90_ns,p99_ns,max_ns,l1d_misses,llc_misses\n");
+    for (int i = 0; i < result_count; i++) {
+        BenchResult *r = &results[i];
+        printf("%s,%ld,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,",
+               r->name, r->iterations, r->mean, r->min, r->p50, r->p90, r->p99, r->max);
+        if (r->l1d_misses >= 0) printf("%.3f", r->l1d_misses);
+        printf(",");
+        if (r->llc_misses >= 0) printf("%.3f", r->llc_misses);
+        printf("\n");
+    }
+}
+
+/**
+ * Microbenchmark entry point.
+ * Times protocol, rules and lookup hot paths and prints ns/op percentiles.
+ *
+ * @param argc Argument count
+ * @param argv Argument vector
+ * @return 0 on success, 1 on invalid arguments
+ */
+int main(int argc, char *argv[]) {
+    OutputFormat format = FORMAT_TEXT;
+    const char *filter = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:f:b:ch")) != -1) {
+        switch (opt) {
+            case 'n': samples = atoi(optarg); break;
+            case 'f':
+                if (strcmp(optarg, "json") == 0) format = FORMAT_JSON;
+                else if (strcmp(optarg, "csv") == 0) format = FORMAT_CSV;
+                else if (strcmp(optarg, "text") == 0) format = FORMAT_TEXT;
+                else {
+                    print_usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'b': filter = optarg; break;
+            case 'c': count_misses = true; break;
+            default:
+                print_usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    if (samples < 10) samples = 10;
+    if (count_misses) open_counters();
+
+    game_set_logging(false);
+
+    BenchContext ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    init_fixture(&ctx);
+
+    static const struct {
+        const char *name;
+        BenchFn fn;
+    } fixed[] = {
+        {"parse_message/move", bench_parse_move},
+        {"parse_message/game_state", bench_parse_state},
+        {"payload_decode/move", bench_decode_move},
+        {"payload_sscanf/move", bench_sscanf_move},
+        {"payload_decode/multi_move", bench_decode_multi_move},
+        {"payload_sscanf/multi_move", bench_sscanf_multi_move},
+        {"create_message/move", bench_create_move},
+        {"create_message/game_state", bench_create_state},
+        {"game_board_to_json", bench_board_to_json},
+        {"validate_move/man", bench_validate_man},
+        {"validate_move/king", bench_validate_king},
+        {"apply_move/x2", bench_apply},
+        {"check_game_over", bench_game_over},
+        {"is_operation_allowed", bench_operation_allowed},
+        {"metrics_record", bench_metrics_record},
+        {"metrics_record/timed", bench_metrics_timed},
+    };
+
+    for (size_t i = 0; i < sizeof(fixed) / sizeof(fixed[0]); i++) {
+        if (selected(filter, fixed[i].name)) {
+            run_bench(fixed[i].name, fixed[i].fn, &ctx);
+        }
+    }
+
+    // Lookups at 1 slot, a quarter, half and full tables
+    const int fill_percent[] = {0, 25, 50, 100};
+    for (size_t f = 0; f < sizeof(fill_percent) / sizeof(fill_percent[0]); f++) {
+        char name[64];
+        int clients = fill_percent[f] ? MAX_CLIENTS * fill_percent[f] / 100 : 1;
+        int rooms = fill_percent[f] ? MAX_ROOMS * fill_percent[f] / 100 : 1;
+
+        fill_tables(&ctx, clients);
+        snprintf(name, sizeof(name), "find_client/hit/%d", clients);
+        if (selected(filter, name)) run_bench(name, bench_find_client_hit, &ctx);
+        snprintf(name, sizeof(name), "find_client/miss/%d", clients);
+        if (selected(filter, name)) run_bench(name, bench_find_client_miss, &ctx);
+        snprintf(name, sizeof(name), "find_client/id/%d", clients);
+        if (selected(filter, name)) run_bench(name, bench_find_client_by_id, &ctx);
+
+        fill_tables(&ctx, rooms);
+        snprintf(name, sizeof(name), "find_room/hit/%d", rooms);
+        if (selected(filter, name)) run_bench(name, bench_find_room_hit, &ctx);
+        snprintf(name, sizeof(name), "find_room/miss/%d", rooms);
+        if (selected(filter, name)) run_bench(name, bench_find_room_miss, &ctx);
+        snprintf(name, sizeof(name), "find_room/last/%d", rooms);
+        if (selected(filter, name)) run_bench(name, bench_find_room_last, &ctx);
+    }
+
+    switch (format) {
+        case FORMAT_JSON: print_json(); break;
+        case FORMAT_CSV: print_csv(); break;
+        default: print_text(); break;
+    }
+
+    free(ctx.server);
+    return 0;
+}
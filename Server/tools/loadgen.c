@@ -0,0 +1,974 @@
+#define _GNU_SOURCE                      // RUSAGE_THREAD
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "../protocol.h"
+#include "../game.h"
+#include "../movegen.h"
+#include "../server.h"
+#include "../metrics.h"
+#include "../transport.h"
+#include "../uring.h"
+
+#define LOADGEN_MAX_EVENTS 256           // epoll events handled per wakeup
+#define LOADGEN_INBUF 16384              // Per-connection receive buffer
+#define LOADGEN_OUTBUF 16384             // Per-connection pending send buffer
+#define LOADGEN_TICK_MS 10               // Timer resolution for think time and reconnects
+#define LOADGEN_RETRY_MS 100             // Delay before retrying after OP_INVALID_MOVE
+
+/**
+ * Lifecycle of one simulated player.
+ */
+typedef enum {
+    BOT_CONNECTING,          // TCP connect in progress
+    BOT_LOGGING_IN,          // OP_LOGIN sent
+    BOT_LOBBY,               // Logged in, not in a room
+    BOT_CREATING,            // OP_CREATE_ROOM sent (host)
+    BOT_JOINING,             // OP_JOIN_ROOM sent
+    BOT_WAITING,             // In room, waiting for opponent
+    BOT_PLAYING,             // Game running
+    BOT_FINISHED,            // OP_GAME_END received, waiting for OP_ROOM_LEFT
+    BOT_OFFLINE,             // Simulated disconnect, reconnect pending
+    BOT_RECONNECTING,        // OP_RECONNECT_REQUEST sent
+    BOT_DEAD                 // Unrecoverable error, bot stopped
+} BotPhase;
+
+/**
+ * One simulated player. Bots are paired: even index hosts the room,
+ * odd index joins it.
+ */
+typedef struct Bot {
+    int index;
+    int fd;
+    BotPhase phase;
+    bool host;
+    struct Bot *peer;
+    char name[MAX_PLAYER_NAME];
+    char room[MAX_ROOM_NAME];
+    char token[SESSION_TOKEN_LEN + 1]; // From OP_LOGIN_OK, proves identity on reconnect
+    uint32_t last_seq;       // Session frames received, counted from OP_LOGIN_OK
+    bool my_turn;            // Latest OP_GAME_STATE gave us the move
+    int game_number;         // Host increments per game for unique room names
+
+    char inbuf[LOADGEN_INBUF];
+    int inlen;
+    char outbuf[LOADGEN_OUTBUF];
+    int outlen;
+    bool want_write;
+
+    int board[BOARD_SIZE][BOARD_SIZE];
+    int moved_from[BOARD_SIZE][BOARD_SIZE]; // Board of the move in flight
+    bool is_player1;
+    bool awaiting_state;     // Move sent, waiting for own OP_GAME_STATE
+    long long move_sent_ns;
+    long long move_due_ns;   // Think time deadline, 0 if no move pending
+    long long reconnect_ns;  // Reconnect deadline while offline
+} Bot;
+
+/**
+ * Load generator configuration.
+ */
+typedef struct {
+    const char *host;
+    int port;
+    int connections;
+    int duration_sec;
+    int think_ms;
+    double disconnect_pct;   // Chance per own move to drop the connection
+    int reconnect_ms;
+    bool full_resync;        // Reconnect without last_seq (-R)
+    unsigned int seed;
+    const char *prefix;
+    const char *unix_path;   // Connect to a Unix-domain listener instead of TCP
+    bool in_process;         // Run the server in this process over memory connections
+    const char *backend;     // Run the server in this process on a Unix socket (-S)
+} LoadConfig;
+
+/**
+ * Counters and latency samples.
+ */
+typedef struct {
+    long long logins;
+    long long games_started;
+    long long games_finished;
+    long long moves;
+    long long invalid_moves;
+    long long disconnects;
+    long long reconnects;
+    long long reconnect_failures;
+    long long resumes;       // Reconnects served by replaying missed frames
+    long long errors;
+    long long pings;
+    long long bytes_in;
+    long long bytes_out;
+    long long transport_calls;   // Reads, writes and closes made by the bots
+    long long *latency_ns;   // Move round-trip samples
+    long long latency_count;
+    long long latency_capacity;
+} LoadStats;
+
+static LoadConfig config = {"127.0.0.1", 12345, 100, 30, 0, 0.0, 500, false, 1, NULL, NULL, false, NULL};
+static LoadStats stats;
+static Server server;        // In-process server (-M, -S)
+static FILE *out;            // Report stream; stdout carries the server log with -M and -S
+static int epoll_fd = -1;
+static unsigned long long rng_state;
+
+/**
+ * Prints usage information for the load generator.
+ *
+ * @param program_name Name of the executable
+ */
+static void print_usage(const char *program_name) {
+    printf("Usage: %s [-H host] [-p port | -U path | -M | -S backend] [-c connections]\n"
+           "          [-d seconds] [-t think_ms] [-x disconnect_pct] [-r reconnect_ms]\n"
+           "          [-s seed] [-n prefix]\n",
+           program_name);
+    printf("  -H host           Server address (default: 127.0.0.1)\n");
+    printf("  -p port           Server port (default: 12345)\n");
+    printf("  -U path           Connect to the server's --unix socket instead\n");
+    printf("  -M                Run the server in-process over memory connections; its log\n"
+           "                    is discarded and its metrics report follows the summary.\n"
+           "                    Needs make LIMITS=\"-DMAX_CLIENTS=n\" above %d players.\n",
+           MAX_CLIENTS);
+    printf("  -S backend        Run the server in-process with the blocking or io_uring\n"
+           "                    backend on a private Unix socket and report its CPU time,\n"
+           "                    network system calls and context switches per move\n");
+    printf("  -c connections    Simulated players, rounded up to even (default: 100)\n");
+    printf("  -d seconds        Test duration (default: 30)\n");
+    printf("  -t think_ms       Delay before each move (default: 0, closed loop)\n");
+    printf("  -x disconnect_pct Chance per move to drop and reconnect (default: 0)\n");
+    printf("  -r reconnect_ms   Delay before OP_RECONNECT_REQUEST (default: 500)\n");
+    printf("  -R                Reconnect without the last frame number, forcing a full resync\n");
+    printf("  -s seed           Random seed (default: 1)\n");
+    printf("  -n prefix         Player and room name prefix (default: lg<pid>)\n");
+}
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static unsigned int next_random(void) {
+    rng_state = rng_state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (unsigned int)(rng_state >> 33);
+}
+
+static void record_latency(long long ns) {
+    if (stats.latency_count == stats.latency_capacity) {
+        stats.latency_capacity = stats.latency_capacity ? stats.latency_capacity * 2 : 65536;
+        stats.latency_ns = realloc(stats.latency_ns, sizeof(long long) * stats.latency_capacity);
+    }
+    stats.latency_ns[stats.latency_count++] = ns;
+}
+
+// ========== CONNECTION I/O ==========
+
+/**
+ * Updates epoll interest for a bot's socket.
+ */
+static void bot_update_events(Bot *bot) {
+    struct epoll_event ev;
+    ev.events = EPOLLIN | (bot->want_write ? EPOLLOUT : 0);
+    ev.data.ptr = bot;
+    epoll_ctl(epoll_fd, EPOLL_CTL_MOD, bot->fd, &ev);
+}
+
+/**
+ * Writes as much pending output as the socket accepts.
+ *
+ * @return 0 on success, -1 if the connection failed
+ */
+static int bot_flush(Bot *bot) {
+    while (bot->outlen > 0) {
+        ssize_t n = transport_write(bot->fd, bot->outbuf, bot->outlen);
+        stats.transport_calls++;
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return -1;
+        }
+        stats.bytes_out += n;
+        memmove(bot->outbuf, bot->outbuf + n, bot->outlen - n);
+        bot->outlen -= n;
+    }
+
+    bool want_write = bot->outlen > 0;
+    if (want_write != bot->want_write) {
+        bot->want_write = want_write;
+        bot_update_events(bot);
+    }
+    return 0;
+}
+
+/**
+ * Queues one DENTCP frame and tries to send it.
+ */
+static void bot_send(Bot *bot, OpCode op, const char *data) {
+    char frame[MAX_MESSAGE_LEN];
+    int len = create_message(frame, op, data);
+
+    if (len < 0 || bot->outlen + len > LOADGEN_OUTBUF) {
+        stats.errors++;
+        return;
+    }
+    memcpy(bot->outbuf + bot->outlen, frame, len);
+    bot->outlen += len;
+    bot_flush(bot);
+}
+
+/**
+ * Opens a connection of the configured transport.
+ * TCP and Unix-domain connects complete asynchronously; in-memory
+ * connections are attached to the in-process server immediately.
+ *
+ * @return Connection handle or -1 on failure
+ */
+static int open_connection(void) {
+    if (config.in_process) {
+        int fd, server_end;
+        if (transport_memory_pair(&fd, &server_end) < 0) {
+            perror("transport_memory_pair");
+            return -1;
+        }
+        server_attach(&server, server_end);
+        return fd;
+    }
+
+    if (config.unix_path) {
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", config.unix_path);
+
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        if (fd < 0) {
+            perror("socket");
+            return -1;
+        }
+        if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 && errno != EINPROGRESS) {
+            perror("connect");
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(config.port);
+    if (inet_pton(AF_INET, config.host, &addr.sin_addr) != 1) {
+        fprintf(stderr, "Invalid host address: %s\n", config.host);
+        return -1;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 && errno != EINPROGRESS) {
+        perror("connect");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * Starts a non-blocking connect for a bot.
+ *
+ * @return 0 on success, -1 on failure
+ */
+static int bot_connect(Bot *bot) {
+    int fd = open_connection();
+    if (fd < 0) {
+        return -1;
+    }
+
+    bot->fd = fd;
+    bot->inlen = 0;
+    bot->outlen = 0;
+    bot->want_write = true;
+
+    struct epoll_event ev;
+    ev.events = EPOLLIN | EPOLLOUT;
+    ev.data.ptr = bot;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+    return 0;
+}
+
+static void bot_close(Bot *bot) {
+    if (bot->fd >= 0) {
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, bot->fd, NULL);
+        transport_close(bot->fd);
+        stats.transport_calls++;
+        bot->fd = -1;
+    }
+}
+
+/**
+ * Runs the in-process server's accept loop or reactor (-S).
+ */
+static void* run_server(void *arg) {
+    server_start((Server *)arg);
+    return NULL;
+}
+
+// ========== GAME LOGIC ==========
+
+/**
+ * Parses board and current_turn from an OP_GAME_STATE JSON payload.
+ *
+ * @return true if the bot is to move
+ */
+static bool parse_game_state(Bot *bot, const char *json) {
+    const char *p = strstr(json, "\"board\"");
+    if (p) {
+        for (int i = 0; i < BOARD_SIZE * BOARD_SIZE && *p; p++) {
+            if (*p >= '0' && *p <= '9') {
+                bot->board[i / BOARD_SIZE][i % BOARD_SIZE] = *p - '0';
+                i++;
+            }
+        }
+    }
+
+    const char *turn = strstr(json, "\"current_turn\":\"");
+    if (!turn) {
+        return false;
+    }
+    turn += strlen("\"current_turn\":\"");
+    size_t len = strlen(bot->name);
+    return strncmp(turn, bot->name, len) == 0 && turn[len] == '"';
+}
+
+/**
+ * Picks a random legal move and sends OP_MOVE or OP_MULTI_MOVE.
+ * May instead drop the connection to exercise reconnects.
+ */
+static void bot_play_move(Bot *bot) {
+    bot->move_due_ns = 0;
+
+    Position pos;
+    MoveList list;
+    position_from_board(&pos, bot->board, bot->is_player1 ? COLOR_WHITE : COLOR_BLACK);
+    if (generate_moves(&pos, &list) == 0) {
+        return;  // Game is over; OP_GAME_END follows
+    }
+
+    if (config.disconnect_pct > 0 &&
+        next_random() % 10000 < (unsigned int)(config.disconnect_pct * 100)) {
+        stats.disconnects++;
+        bot_close(bot);
+        bot->phase = BOT_OFFLINE;
+        bot->reconnect_ns = now_ns() + config.reconnect_ms * 1000000LL;
+        return;
+    }
+
+    const Move *move = &list.moves[next_random() % list.count];
+    char data[512];
+    int len;
+
+    if (move->path_len == 2) {
+        len = snprintf(data, sizeof(data), "%s,%s,%d,%d,%d,%d", bot->room, bot->name,
+                       SQUARE_ROW(move->path[0]), SQUARE_COL(move->path[0]),
+                       SQUARE_ROW(move->path[1]), SQUARE_COL(move->path[1]));
+        bot_send(bot, OP_MOVE, data);
+    } else {
+        len = snprintf(data, sizeof(data), "%s,%s,%d", bot->room, bot->name, move->path_len);
+        for (int i = 0; i < move->path_len; i++) {
+            len += snprintf(data + len, sizeof(data) - len, ",%d,%d",
+                            SQUARE_ROW(move->path[i]), SQUARE_COL(move->path[i]));
+        }
+        bot_send(bot, OP_MULTI_MOVE, data);
+    }
+
+    memcpy(bot->moved_from, bot->board, sizeof(bot->board));
+    bot->awaiting_state = true;
+    bot->move_sent_ns = now_ns();
+}
+
+/**
+ * Schedules the bot's next move after the configured think time.
+ */
+static void bot_schedule_move(Bot *bot) {
+    if (config.think_ms == 0) {
+        bot_play_move(bot);
+    } else {
+        bot->move_due_ns = now_ns() + config.think_ms * 1000000LL;
+    }
+}
+
+/**
+ * Host creates a fresh room for the next game.
+ */
+static void host_create_room(Bot *bot) {
+    char data[256];
+    bot->game_number++;
+    snprintf(bot->room, sizeof(bot->room), "%s-r%d-%d", config.prefix, bot->index / 2,
+             bot->game_number);
+    snprintf(data, sizeof(data), "%s,%s", bot->name, bot->room);
+    bot_send(bot, OP_CREATE_ROOM, data);
+    bot->phase = BOT_CREATING;
+}
+
+/**
+ * Guest joins once the host waits in its room.
+ */
+static void guest_try_join(Bot *guest) {
+    Bot *host = guest->peer;
+    if (guest->phase != BOT_LOBBY || host->phase != BOT_WAITING) {
+        return;
+    }
+
+    char data[256];
+    strcpy(guest->room, host->room);
+    snprintf(data, sizeof(data), "%s,%s", guest->name, guest->room);
+    bot_send(guest, OP_JOIN_ROOM, data);
+    guest->phase = BOT_JOINING;
+}
+
+/**
+ * Bot arrived in the lobby (after login or after a finished game).
+ */
+static void bot_enter_lobby(Bot *bot) {
+    bot->phase = BOT_LOBBY;
+    bot->awaiting_state = false;
+    bot->move_due_ns = 0;
+
+    if (bot->host) {
+        host_create_room(bot);
+    } else {
+        guest_try_join(bot);
+    }
+}
+
+/**
+ * Handles one parsed server frame.
+ */
+static void bot_handle_message(Bot *bot, const Message *msg) {
+    // Number session frames the way the server does
+    if (msg->op == OP_LOGIN_OK) {
+        bot->last_seq = 1;
+    } else if (msg->op != OP_PING && msg->op != OP_RECONNECT_OK &&
+               msg->op != OP_RECONNECT_FAIL && bot->last_seq > 0) {
+        bot->last_seq++;
+    }
+
+    switch (msg->op) {
+        case OP_PING:
+            stats.pings++;
+            bot_send(bot, OP_PONG, "");
+            break;
+
+        case OP_LOGIN_OK: {
+            const char *token = strrchr(msg->data, ',');
+            if (token) {
+                snprintf(bot->token, sizeof(bot->token), "%s", token + 1);
+            }
+            if (bot->phase == BOT_LOGGING_IN) {
+                stats.logins++;
+                bot_enter_lobby(bot);
+            } else if (bot->phase == BOT_RECONNECTING) {
+                // Game ended while offline, server restored us to the lobby
+                bot_enter_lobby(bot);
+            }
+            break;
+        }
+
+        case OP_ROOM_CREATED: {
+            char data[256];
+            snprintf(data, sizeof(data), "%s,%s", bot->name, bot->room);
+            bot_send(bot, OP_JOIN_ROOM, data);
+            bot->phase = BOT_JOINING;
+            break;
+        }
+
+        case OP_ROOM_JOINED:
+            if (bot->phase == BOT_JOINING) {
+                bot->phase = BOT_WAITING;
+                if (bot->host) guest_try_join(bot->peer);
+            }
+            break;
+
+        case OP_GAME_START: {
+            char p1[MAX_PLAYER_NAME];
+            if (sscanf(msg->data, "%*[^,],%63[^,]", p1) == 1) {
+                bot->is_player1 = strcmp(p1, bot->name) == 0;
+            }
+            bot->phase = BOT_PLAYING;
+            if (bot->host) stats.games_started++;
+            break;
+        }
+
+        case OP_GAME_STATE:
+            if (bot->phase != BOT_PLAYING && bot->phase != BOT_RECONNECTING) {
+                break;
+            }
+            bot->phase = BOT_PLAYING;
+            bot->my_turn = parse_game_state(bot, msg->data);
+            if (bot->my_turn) {
+                // A move always passes the turn, so while one is in flight a
+                // state with our turn and the board we moved from is a repeat
+                if (bot->awaiting_state &&
+                    memcmp(bot->board, bot->moved_from, sizeof(bot->board)) == 0) {
+                    break;
+                }
+                if (bot->awaiting_state) {
+                    bot->awaiting_state = false;
+                    stats.moves++;
+                    record_latency(now_ns() - bot->move_sent_ns);
+                }
+                bot_schedule_move(bot);
+            } else if (bot->awaiting_state) {
+                bot->awaiting_state = false;
+                stats.moves++;
+                record_latency(now_ns() - bot->move_sent_ns);
+            }
+            break;
+
+        case OP_INVALID_MOVE:
+            // Board view was stale; retry shortly unless a new state arrives
+            stats.invalid_moves++;
+            bot->awaiting_state = false;
+            bot->move_due_ns = now_ns() + LOADGEN_RETRY_MS * 1000000LL;
+            break;
+
+        case OP_GAME_END:
+            bot->phase = BOT_FINISHED;
+            bot->awaiting_state = false;
+            bot->my_turn = false;
+            bot->move_due_ns = 0;
+            if (bot->host) stats.games_finished++;
+            break;
+
+        case OP_ROOM_LEFT:
+            bot_enter_lobby(bot);
+            break;
+
+        case OP_RECONNECT_OK: {
+            stats.reconnects++;
+            const char *from = strrchr(msg->data, ',');
+            uint32_t next = from ? (uint32_t)strtoul(from + 1, NULL, 10) : 0;
+            bool resumed = !config.full_resync && next == bot->last_seq + 1;
+            if (next > 0) {
+                bot->last_seq = next - 1;
+            }
+            if (resumed && bot->phase == BOT_RECONNECTING) {
+                // Missed frames follow; without any, our turn is still pending
+                stats.resumes++;
+                bot->phase = BOT_PLAYING;
+                if (bot->my_turn) {
+                    bot_schedule_move(bot);
+                }
+            }
+            break;
+        }
+
+        case OP_RECONNECT_FAIL:
+            stats.reconnect_failures++;
+            bot->phase = BOT_DEAD;
+            bot_close(bot);
+            break;
+
+        case OP_LOGIN_FAIL:
+        case OP_ROOM_FAIL:
+        case OP_ROOM_FULL:
+        case OP_ERROR:
+            stats.errors++;
+            if (bot->phase == BOT_LOGGING_IN) {
+                bot->phase = BOT_DEAD;
+                bot_close(bot);
+            } else if (bot->phase == BOT_CREATING) {
+                host_create_room(bot);
+            } else if (bot->phase == BOT_JOINING && !bot->host) {
+                bot->phase = BOT_LOBBY;
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+/**
+ * Reads from a bot's socket and dispatches complete frames.
+ *
+ * @return 0 on success, -1 if the connection closed
+ */
+static int bot_read(Bot *bot) {
+    for (;;) {
+        ssize_t n = transport_read(bot->fd, bot->inbuf + bot->inlen, LOADGEN_INBUF - 1 - bot->inlen);
+        stats.transport_calls++;
+        if (n == 0) return -1;
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+            return -1;
+        }
+        stats.bytes_in += n;
+        bot->inlen += n;
+
+        int start = 0;
+        for (int i = 0; i < bot->inlen; i++) {
+            if (bot->inbuf[i] != '\n') continue;
+
+            bot->inbuf[i] = '\0';
+            Message msg;
+            DisconnectReason reason;
+            if (parse_message(bot->inbuf + start, &msg, &reason) == 0) {
+                bot_handle_message(bot, &msg);
+            } else {
+                stats.errors++;
+            }
+            if (bot->fd < 0) return 0;
+            start = i + 1;
+        }
+
+        memmove(bot->inbuf, bot->inbuf + start, bot->inlen - start);
+        bot->inlen -= start;
+        if (bot->inlen >= LOADGEN_INBUF - 1) {
+            return -1;
+        }
+    }
+}
+
+/**
+ * Handles readiness of a bot's socket.
+ */
+static void bot_on_event(Bot *bot, uint32_t events) {
+    if (bot->phase == BOT_CONNECTING || (bot->phase == BOT_OFFLINE && bot->fd >= 0)) {
+        int err = 0;
+        socklen_t len = sizeof(err);
+        getsockopt(bot->fd, SOL_SOCKET, SO_ERROR, &err, &len);
+        if (err != 0 || (events & (EPOLLERR | EPOLLHUP))) {
+            stats.errors++;
+            bot_close(bot);
+            bot->phase = BOT_DEAD;
+            return;
+        }
+
+        if (bot->phase == BOT_CONNECTING) {
+            bot->phase = BOT_LOGGING_IN;
+            bot_send(bot, OP_LOGIN, bot->name);
+        } else {
+            char data[256];
+            bot->phase = BOT_RECONNECTING;
+            if (config.full_resync) {
+                snprintf(data, sizeof(data), "%s,%s,%s", bot->room, bot->name, bot->token);
+            } else {
+                snprintf(data, sizeof(data), "%s,%s,%s,%u", bot->room, bot->name, bot->token,
+                         bot->last_seq);
+            }
+            bot_send(bot, OP_RECONNECT_REQUEST, data);
+        }
+        bot_flush(bot);
+        return;
+    }
+
+    if ((events & EPOLLOUT) && bot_flush(bot) < 0) {
+        stats.errors++;
+        bot_close(bot);
+        bot->phase = BOT_DEAD;
+        return;
+    }
+
+    if ((events & (EPOLLIN | EPOLLHUP | EPOLLERR)) && bot_read(bot) < 0) {
+        stats.errors++;
+        bot_close(bot);
+        bot->phase = BOT_DEAD;
+    }
+}
+
+/**
+ * Fires due think-time moves and reconnects.
+ */
+static void run_timers(Bot *bots, int count) {
+    long long now = now_ns();
+
+    for (int i = 0; i < count; i++) {
+        Bot *bot = &bots[i];
+
+        if (bot->phase == BOT_PLAYING && bot->move_due_ns && bot->move_due_ns <= now) {
+            bot_play_move(bot);
+        } else if (bot->phase == BOT_OFFLINE && bot->fd < 0 && bot->reconnect_ns <= now) {
+            if (bot_connect(bot) < 0) {
+                bot->phase = BOT_DEAD;
+            }
+        }
+    }
+}
+
+// ========== REPORTING ==========
+
+static int compare_ll(const void *a, const void *b) {
+    long long x = *(const long long *)a;
+    long long y = *(const long long *)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile_us(double pct) {
+    if (stats.latency_count == 0) return 0.0;
+    long long idx = (long long)(pct / 100.0 * (stats.latency_count - 1));
+    return stats.latency_ns[idx] / 1000.0;
+}
+
+/**
+ * CPU time and context switches consumed by the server threads so far:
+ * the whole process minus the calling (load generator) thread.
+ */
+typedef struct {
+    double cpu_sec;
+    long switches;
+    uint64_t syscalls;
+} ServerUsage;
+
+static void sample_server_usage(ServerUsage *usage) {
+    struct rusage process, self;
+    getrusage(RUSAGE_SELF, &process);
+    getrusage(RUSAGE_THREAD, &self);
+
+    usage->cpu_sec = (process.ru_utime.tv_sec - self.ru_utime.tv_sec) +
+                     (process.ru_stime.tv_sec - self.ru_stime.tv_sec) +
+                     ((process.ru_utime.tv_usec - self.ru_utime.tv_usec) +
+                      (process.ru_stime.tv_usec - self.ru_stime.tv_usec)) / 1e6;
+    usage->switches = (process.ru_nvcsw - self.ru_nvcsw) + (process.ru_nivcsw - self.ru_nivcsw);
+    // Each bot call is one counted socket operation
+    usage->syscalls = transport_syscalls() - (uint64_t)stats.transport_calls;
+}
+
+/**
+ * Prints the in-process server's cost per move (-S).
+ */
+static void print_server_cost(const ServerUsage *before, const ServerUsage *after) {
+    double moves = stats.moves > 0 ? (double)stats.moves : 1.0;
+
+    fprintf(out, "\n=== Server cost (%s backend) ===\n", server.backend == SERVER_BACKEND_URING ?
+            "io_uring" : "blocking");
+    fprintf(out, "CPU per move:       %.1f us\n", (after->cpu_sec - before->cpu_sec) * 1e6 / moves);
+    fprintf(out, "Syscalls per move:  %.2f (socket I/O, io_uring_enter, wakeups)\n",
+            (double)(after->syscalls - before->syscalls) / moves);
+    fprintf(out, "Switches per move:  %.2f\n", (after->switches - before->switches) / moves);
+}
+
+static void print_report(double elapsed_sec, int connections) {
+    qsort(stats.latency_ns, stats.latency_count, sizeof(long long), compare_ll);
+
+    fprintf(out, "\n=== Load test summary ===\n");
+    fprintf(out, "Connections:        %d\n", connections);
+    fprintf(out, "Duration:           %.1f s\n", elapsed_sec);
+    fprintf(out, "Logins:             %lld\n", stats.logins);
+    fprintf(out, "Games started:      %lld\n", stats.games_started);
+    fprintf(out, "Games finished:     %lld\n", stats.games_finished);
+    fprintf(out, "Moves:              %lld (%.0f moves/s)\n", stats.moves, stats.moves / elapsed_sec);
+    fprintf(out, "Invalid moves:      %lld\n", stats.invalid_moves);
+    fprintf(out, "Disconnects:        %lld (reconnected %lld, resumed %lld, failed %lld)\n",
+           stats.disconnects, stats.reconnects, stats.resumes, stats.reconnect_failures);
+    fprintf(out, "Pings answered:     %lld\n", stats.pings);
+    fprintf(out, "Errors:             %lld\n", stats.errors);
+    fprintf(out, "Bytes in/out:       %lld / %lld\n", stats.bytes_in, stats.bytes_out);
+    fprintf(out, "Move RTT (us):      p50 %.0f  p99 %.0f  p999 %.0f  max %.0f\n",
+           percentile_us(50.0), percentile_us(99.0), percentile_us(99.9), percentile_us(100.0));
+}
+
+/**
+ * Load generator entry point.
+ * Drives paired simulated players through login, room setup and
+ * continuous random games until the duration expires.
+ *
+ * @param argc Argument count
+ * @param argv Argument vector
+ * @return 0 on success, 1 on failure
+ */
+int main(int argc, char *argv[]) {
+    int opt;
+
+    while ((opt = getopt(argc, argv, "H:p:U:MS:c:d:t:x:r:Rs:n:h")) != -1) {
+        switch (opt) {
+            case 'H': config.host = optarg; break;
+            case 'p': config.port = atoi(optarg); break;
+            case 'U': config.unix_path = optarg; break;
+            case 'M': config.in_process = true; break;
+            case 'S': config.backend = optarg; break;
+            case 'c': config.connections = atoi(optarg); break;
+            case 'd': config.duration_sec = atoi(optarg); break;
+            case 't': config.think_ms = atoi(optarg); break;
+            case 'x': config.disconnect_pct = atof(optarg); break;
+            case 'r': config.reconnect_ms = atoi(optarg); break;
+            case 'R': config.full_resync = true; break;
+            case 's': config.seed = (unsigned int)atoi(optarg); break;
+            case 'n': config.prefix = optarg; break;
+            default:
+                print_usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    // Names of a previous run stay reserved until its players time out
+    char default_prefix[32];
+    if (!config.prefix) {
+        snprintf(default_prefix, sizeof(default_prefix), "lg%d", (int)getpid());
+        config.prefix = default_prefix;
+    }
+
+    if (config.connections < 2) config.connections = 2;
+    config.connections += config.connections % 2;
+    rng_state = config.seed;
+
+    // Each bot holds one descriptor, reconnects briefly hold none
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    movegen_init();
+
+    out = stdout;
+    char target[128];
+    char socket_path[108];
+    if (config.in_process || config.backend) {
+        // The server logs every frame; keep it away from the report
+        fflush(stdout);
+        int report_fd = dup(STDOUT_FILENO);
+        int null_fd = open("/dev/null", O_WRONLY);
+        if (report_fd < 0 || null_fd < 0 || !(out = fdopen(report_fd, "w"))) {
+            perror("Failed to redirect server log");
+            return 1;
+        }
+        dup2(null_fd, STDOUT_FILENO);
+        close(null_fd);
+    }
+
+    if (config.in_process) {
+        server_init_local(&server);
+        if (server_start_local(&server) < 0) {
+            return 1;
+        }
+        snprintf(target, sizeof(target), "in-process server");
+    } else if (config.backend) {
+        snprintf(socket_path, sizeof(socket_path), "/tmp/loadgen-%d.sock", (int)getpid());
+        server_init_local(&server);
+        if (server_listen_unix(&server, socket_path) < 0) {
+            return 1;
+        }
+        if (strcmp(config.backend, "io_uring") == 0 && uring_supported()) {
+            server.backend = SERVER_BACKEND_URING;
+        } else if (strcmp(config.backend, "blocking") != 0) {
+            fprintf(stderr, "Backend '%s' unavailable, using blocking\n", config.backend);
+        }
+
+        pthread_t server_thread;
+        if (pthread_create(&server_thread, NULL, run_server, &server) != 0) {
+            perror("Failed to start server thread");
+            return 1;
+        }
+        pthread_detach(server_thread);
+        config.unix_path = socket_path;
+        snprintf(target, sizeof(target), "in-process %s server",
+                 server.backend == SERVER_BACKEND_URING ? "io_uring" : "blocking");
+    } else if (config.unix_path) {
+        snprintf(target, sizeof(target), "unix:%s", config.unix_path);
+    } else {
+        snprintf(target, sizeof(target), "%s:%d", config.host, config.port);
+    }
+
+    if ((config.in_process || config.backend) && config.connections > MAX_CLIENTS) {
+        fprintf(stderr, "Warning: %d players but MAX_CLIENTS is %d\n",
+                config.connections, MAX_CLIENTS);
+    }
+
+    epoll_fd = epoll_create1(0);
+    if (epoll_fd < 0) {
+        perror("epoll_create1");
+        return 1;
+    }
+
+    Bot *bots = calloc(config.connections, sizeof(Bot));
+    if (!bots) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    for (int i = 0; i < config.connections; i++) {
+        Bot *bot = &bots[i];
+        bot->index = i;
+        bot->fd = -1;
+        bot->host = (i % 2) == 0;
+        bot->peer = bot->host ? &bots[i + 1] : &bots[i - 1];
+        snprintf(bot->name, sizeof(bot->name), "%s%d", config.prefix, i);
+        bot->phase = BOT_CONNECTING;
+        if (bot_connect(bot) < 0) {
+            bot->phase = BOT_DEAD;
+        }
+    }
+
+    fprintf(out, "Load generator: %d players against %s for %d s (think %d ms, disconnect %.2f%%)\n",
+           config.connections, target, config.duration_sec,
+           config.think_ms, config.disconnect_pct);
+
+    struct epoll_event events[LOADGEN_MAX_EVENTS];
+    long long start = now_ns();
+    long long end = start + config.duration_sec * 1000000000LL;
+    long long next_report = start + 1000000000LL;
+    long long last_moves = 0;
+    ServerUsage usage_start, usage_end;
+    sample_server_usage(&usage_start);
+
+    while (now_ns() < end) {
+        int n = epoll_wait(epoll_fd, events, LOADGEN_MAX_EVENTS, LOADGEN_TICK_MS);
+        for (int i = 0; i < n; i++) {
+            bot_on_event((Bot *)events[i].data.ptr, events[i].events);
+        }
+
+        run_timers(bots, config.connections);
+
+        long long now = now_ns();
+        if (now >= next_report) {
+            fprintf(out, "[%3llds] moves/s %lld, games %lld, rtt samples %lld\n",
+                   (now - start) / 1000000000LL, stats.moves - last_moves,
+                   stats.games_finished, stats.latency_count);
+            fflush(out);
+            last_moves = stats.moves;
+            next_report += 1000000000LL;
+        }
+    }
+
+    sample_server_usage(&usage_end);
+    print_report((now_ns() - start) / 1e9, config.connections);
+    if (config.backend) {
+        print_server_cost(&usage_start, &usage_end);
+    }
+    if (config.in_process || config.backend) {
+        fprintf(out, "\n");
+        metrics_print_report(out);
+    }
+    fflush(out);
+
+    for (int i = 0; i < config.connections; i++) {
+        bot_close(&bots[i]);
+    }
+    if (config.backend) {
+        unlink(socket_path);
+    }
+    free(bots);
+    free(stats.latency_ns);
+    close(epoll_fd);
+    return 0;
+}
@@ -0,0 +1,522 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include "../server.h"
+#include "../payload.h"
+
+#define FUZZ_DEFAULT_CASES 200000        // Payloads generated per opcode
+#define FUZZ_MAX_REPORTS 10              // Mismatches printed before going quiet
+#define LEGACY_TEXT MAX_DATA_LEN         // Legacy buffers: large enough that sscanf cannot overflow
+
+/**
+ * Opcodes whose payloads are checked against their legacy parsers.
+ */
+typedef enum {
+    FUZZ_LOGIN,
+    FUZZ_PLAYER_ROOM,        // OP_CREATE_ROOM, OP_JOIN_ROOM
+    FUZZ_ROOM_PLAYER,        // OP_LEAVE_ROOM
+    FUZZ_MOVE,
+    FUZZ_MULTI_MOVE,
+    FUZZ_RECONNECT,
+    FUZZ_TARGET_COUNT
+} FuzzTarget;
+
+/**
+ * Values accepted by a legacy parser.
+ */
+typedef struct {
+    char text[3][LEGACY_TEXT];
+    int ints[4];
+    int path_length;
+    int path[20][2];
+    uint32_t seq;
+} LegacyResult;
+
+/**
+ * Counters of one target.
+ */
+typedef struct {
+    long cases;
+    long legacy_accepted;
+    long decoder_accepted;
+    long canonical;          // Legacy input written in its exact format, within limits
+    long cut;                // Text after a line end, not compared
+    long mismatches;
+} FuzzStats;
+
+static const char *TARGET_NAMES[FUZZ_TARGET_COUNT] = {
+    "login", "player,room", "room,player", "move", "multi_move", "reconnect"
+};
+
+static const OpCode TARGET_OPS[FUZZ_TARGET_COUNT] = {
+    OP_LOGIN, OP_CREATE_ROOM, OP_LEAVE_ROOM, OP_MOVE, OP_MULTI_MOVE, OP_RECONNECT_REQUEST
+};
+
+static uint64_t rng_state = 0x9e3779b97f4a7c15ull;
+static int reports = 0;
+
+/**
+ * Prints usage information for the fuzzer.
+ *
+ * @param program_name Name of the executable
+ */
+static void print_usage(const char *program_name) {
+    printf("Usage: %s [-n cases] [-s seed]\n", program_name);
+    printf("  -n cases   Payloads per opcode (default: %d)\n", FUZZ_DEFAULT_CASES);
+    printf("  -s seed    Random seed\n");
+}
+
+/**
+ * Returns the next pseudo-random number (xorshift64*).
+ */
+static uint64_t rng_next(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545f4914f6cdd1dull;
+}
+
+/**
+ * Returns a random number below bound.
+ */
+static int rng_below(int bound) {
+    return (int)(rng_next() % (uint64_t)bound);
+}
+
+// ========== LEGACY PARSERS ==========
+// The sscanf-based parsing the handlers used before payload schemas,
+// with buffers too large to overflow.
+
+static bool legacy_login(const char *data, LegacyResult *r) {
+    snprintf(r->text[0], MAX_PLAYER_NAME, "%s", data);
+    r->text[0][strcspn(r->text[0], "\r\n")] = '\0';
+    return true;
+}
+
+static bool legacy_two_fields(const char *data, LegacyResult *r) {
+    return sscanf(data, "%[^,],%s", r->text[0], r->text[1]) == 2;
+}
+
+static bool legacy_move(const char *data, LegacyResult *r) {
+    return sscanf(data, "%[^,],%[^,],%d,%d,%d,%d", r->text[0], r->text[1],
+                  &r->ints[0], &r->ints[1], &r->ints[2], &r->ints[3]) == 6;
+}
+
+static bool legacy_multi_move(const char *data, LegacyResult *r) {
+    if (sscanf(data, "%[^,],%[^,],%d", r->text[0], r->text[1], &r->path_length) != 3 ||
+        r->path_length < 2 || r->path_length > 20) {
+        return false;
+    }
+
+    const char *ptr = data;
+    for (int i = 0; i < 3; i++) {
+        ptr = strchr(ptr, ',');
+        if (!ptr) {
+            return false;
+        }
+        ptr++;
+    }
+
+    for (int i = 0; i < r->path_length; i++) {
+        // The legacy loop passed NULL to sscanf here when pairs ran out
+        if (!ptr || sscanf(ptr, "%d,%d", &r->path[i][0], &r->path[i][1]) != 2) {
+            return false;
+        }
+        ptr = strchr(ptr, ',');
+        if (ptr) ptr++;
+        ptr = ptr ? strchr(ptr, ',') : NULL;
+        if (ptr && i < r->path_length - 1) ptr++;
+    }
+    return true;
+}
+
+static bool legacy_reconnect(const char *data, LegacyResult *r) {
+    char fields[4][MAX_ROOM_NAME];
+    int parsed = 0;
+
+    for (const char *p = data; parsed >= 0;) {
+        size_t length = strcspn(p, ",");
+        if (parsed == 4 || length >= MAX_ROOM_NAME) {
+            parsed = -1;
+            break;
+        }
+        memcpy(fields[parsed], p, length);
+        fields[parsed][length] = '\0';
+        parsed++;
+        if (p[length] != ',') {
+            break;
+        }
+        p += length + 1;
+    }
+
+    if (parsed < 2) {
+        return false;
+    }
+    r->seq = 0;
+    if (parsed == 4) {
+        char *end;
+        fields[3][strcspn(fields[3], "\r\n")] = '\0';
+        unsigned long seq = strtoul(fields[3], &end, 10);
+        if (end == fields[3] || *end != '\0' || seq > UINT32_MAX) {
+            return false;
+        }
+        r->seq = (uint32_t)seq;
+    }
+    for (int i = 0; i < 3; i++) {
+        if (i < parsed) {
+            fields[i][strcspn(fields[i], "\r\n")] = '\0';
+            snprintf(r->text[i], sizeof(r->text[i]), "%s", fields[i]);
+        } else {
+            r->text[i][0] = '\0';
+        }
+    }
+    return true;
+}
+
+// ========== COMPARISON ==========
+
+/**
+ * Runs the legacy parser of a target.
+ */
+static bool legacy_parse(FuzzTarget target, const char *data, LegacyResult *r) {
+    switch (target) {
+        case FUZZ_LOGIN: return legacy_login(data, r);
+        case FUZZ_PLAYER_ROOM:
+        case FUZZ_ROOM_PLAYER: return legacy_two_fields(data, r);
+        case FUZZ_MOVE: return legacy_move(data, r);
+        case FUZZ_MULTI_MOVE: return legacy_multi_move(data, r);
+        default: return legacy_reconnect(data, r);
+    }
+}
+
+/**
+ * Writes legacy values back in the exact protocol format.
+ *
+ * @return Whether every name fits the server's buffers and has no comma or line end
+ */
+static bool legacy_format(FuzzTarget target, const LegacyResult *r, char *out, size_t size) {
+    int n = 0;
+    switch (target) {
+        case FUZZ_LOGIN:
+            n = snprintf(out, size, "%s", r->text[0]);
+            break;
+        case FUZZ_PLAYER_ROOM:
+        case FUZZ_ROOM_PLAYER:
+            n = snprintf(out, size, "%s,%s", r->text[0], r->text[1]);
+            break;
+        case FUZZ_MOVE:
+            n = snprintf(out, size, "%s,%s,%d,%d,%d,%d", r->text[0], r->text[1],
+                         r->ints[0], r->ints[1], r->ints[2], r->ints[3]);
+            break;
+        case FUZZ_MULTI_MOVE:
+            n = snprintf(out, size, "%s,%s,%d", r->text[0], r->text[1], r->path_length);
+            for (int i = 0; i < r->path_length && n > 0 && (size_t)n < size; i++) {
+                n += snprintf(out + n, size - (size_t)n, ",%d,%d", r->path[i][0], r->path[i][1]);
+            }
+            break;
+        default:
+            if (r->text[2][0] == '\0') {
+                n = snprintf(out, size, "%s,%s", r->text[0], r->text[1]);
+            } else if (r->seq == 0) {
+                n = snprintf(out, size, "%s,%s,%s", r->text[0], r->text[1], r->text[2]);
+            } else {
+                n = snprintf(out, size, "%s,%s,%s,%u", r->text[0], r->text[1], r->text[2], r->seq);
+            }
+            break;
+    }
+    if (n < 0 || (size_t)n >= size) {
+        return false;
+    }
+    // Commas and line ends inside names cannot be told apart from the framing
+    for (int i = 0; i < 3; i++) {
+        if (strlen(r->text[i]) >= MAX_ROOM_NAME || strpbrk(r->text[i], ",\r\n")) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Checks decoded arguments against the legacy values.
+ */
+static bool same_values(FuzzTarget target, const HandlerArgs *args, const LegacyResult *r) {
+    switch (target) {
+        case FUZZ_LOGIN:
+            return strcmp(args->login.player, r->text[0]) == 0;
+        case FUZZ_PLAYER_ROOM:
+            return strcmp(args->room.player, r->text[0]) == 0 &&
+                   strcmp(args->room.room, r->text[1]) == 0;
+        case FUZZ_ROOM_PLAYER:
+            return strcmp(args->room.room, r->text[0]) == 0 &&
+                   strcmp(args->room.player, r->text[1]) == 0;
+        case FUZZ_MOVE:
+            return strcmp(args->move.room, r->text[0]) == 0 &&
+                   strcmp(args->move.player, r->text[1]) == 0 &&
+                   args->move.from_row == r->ints[0] && args->move.from_col == r->ints[1] &&
+                   args->move.to_row == r->ints[2] && args->move.to_col == r->ints[3];
+        case FUZZ_MULTI_MOVE:
+            return strcmp(args->multi_move.room, r->text[0]) == 0 &&
+                   strcmp(args->multi_move.player, r->text[1]) == 0 &&
+                   args->multi_move.path_length == r->path_length &&
+                   memcmp(args->multi_move.path, r->path,
+                          sizeof(int) * 2 * (size_t)r->path_length) == 0;
+        default:
+            for (int i = 0; i < 3; i++) {
+                if (strcmp(args->reconnect.fields[i], r->text[i]) != 0) {
+                    return false;
+                }
+            }
+            return args->reconnect.last_seq == r->seq;
+    }
+}
+
+/**
+ * Decodes a payload as the server would: schema, then the handler's
+ * own checks that follow decoding.
+ */
+static bool decoder_accepts(FuzzTarget target, const char *data, HandlerArgs *args) {
+    if (payload_decode(dispatch_schema(TARGET_OPS[target]), data, args) < 0) {
+        return false;
+    }
+    if (target == FUZZ_MULTI_MOVE) {
+        return args->multi_move.coord_count == 2 * args->multi_move.path_length;
+    }
+    return true;
+}
+
+/**
+ * Checks one payload.
+ * The decoder must accept every legacy payload written in the exact
+ * format within the server's limits, and anything it accepts must
+ * have been accepted by the legacy parser with the same values.
+ *
+ * The decoder ends every payload at its first line end. The legacy
+ * parsers disagreed there (the reconnect splitter read fields past a
+ * CR), so payloads with text after a line end are only counted.
+ */
+static void check_payload(FuzzTarget target, const char *data, FuzzStats *stats) {
+    static LegacyResult legacy;
+    char canonical[MAX_DATA_LEN];
+    HandlerArgs args;
+
+    size_t line_end = strcspn(data, "\r\n");
+    if (data[line_end + strspn(data + line_end, "\r\n")] != '\0') {
+        stats->cases++;
+        stats->cut++;
+        return;
+    }
+
+    memset(&legacy, 0, sizeof(legacy));
+    bool legacy_ok = legacy_parse(target, data, &legacy);
+    bool decoded = decoder_accepts(target, data, &args);
+    bool exact = legacy_ok && legacy_format(target, &legacy, canonical, sizeof(canonical)) &&
+                 strcmp(canonical, data) == 0;
+
+    stats->cases++;
+    stats->legacy_accepted += legacy_ok;
+    stats->decoder_accepted += decoded;
+    stats->canonical += exact;
+
+    const char *problem = NULL;
+    if (decoded && !legacy_ok) {
+        problem = "decoder accepts, legacy rejects";
+    } else if (decoded && !same_values(target, &args, &legacy)) {
+        problem = "values differ";
+    } else if (exact && !decoded) {
+        problem = "decoder rejects exact payload";
+    }
+
+    if (problem) {
+        stats->mismatches++;
+        if (reports++ < FUZZ_MAX_REPORTS) {
+            printf("MISMATCH %s: %s: \"", TARGET_NAMES[target], problem);
+            for (const char *c = data; *c; c++) {
+                if (*c == '\r') printf("\\r");
+                else if (*c == '\n') printf("\\n");
+                else if (*c == '\t') printf("\\t");
+                else putchar(*c);
+            }
+            printf("\"\n");
+        }
+    }
+}
+
+// ========== GENERATOR ==========
+
+/**
+ * Appends a name: mostly short, sometimes empty, blank or over-long.
+ */
+static void gen_name(char *out, size_t *pos, size_t size) {
+    static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz0123456789_- ";
+    int length;
+    switch (rng_below(8)) {
+        case 0: length = 0; break;
+        case 1: length = 60 + rng_below(10); break;
+        default: length = 1 + rng_below(12); break;
+    }
+    for (int i = 0; i < length && *pos + 1 < size; i++) {
+        char c = alphabet[rng_below((int)sizeof(alphabet) - 1)];
+        out[(*pos)++] = (rng_below(12) == 0) ? ' ' : c;
+    }
+}
+
+/**
+ * Appends a number, mostly a board coordinate, sometimes malformed.
+ */
+static void gen_number(char *out, size_t *pos, size_t size) {
+    static const char *odd[] = {
+        "", "-", "+3", " 4", "\t5", "-0", "007", "1x", "x1", "0x10", "1e3", "2147483647",
+        "2147483648", "-2147483648", "-2147483649", "4294967295", "4294967296",
+        "99999999999999999999", "3 ", "1.5"
+    };
+    char number[32];
+    if (rng_below(6) == 0) {
+        snprintf(number, sizeof(number), "%s", odd[rng_below((int)(sizeof(odd) / sizeof(odd[0])))]);
+    } else {
+        snprintf(number, sizeof(number), "%d", rng_below(10) - 1);
+    }
+    size_t length = strlen(number);
+    if (*pos + length < size) {
+        memcpy(out + *pos, number, length);
+        *pos += length;
+    }
+}
+
+/**
+ * Appends a session token or sequence number field.
+ */
+static void gen_token(char *out, size_t *pos, size_t size) {
+    if (rng_below(2) == 0) {
+        gen_number(out, pos, size);
+        return;
+    }
+    for (int i = 0; i < SESSION_TOKEN_LEN && *pos + 1 < size; i++) {
+        out[(*pos)++] = "0123456789abcdef"[rng_below(16)];
+    }
+}
+
+/**
+ * Builds a payload around the target's format, then maybe mutates it.
+ */
+static void gen_payload(FuzzTarget target, char *out, size_t size) {
+    static const char *names_then_ints[FUZZ_TARGET_COUNT] = {
+        "n", "nn", "nn", "nniiii", "nni", "nntt"
+    };
+    const char *shape = names_then_ints[target];
+    int fields = (int)strlen(shape);
+    size_t pos = 0;
+
+    // Field count off by up to two in either direction
+    int count = fields + (rng_below(4) == 0 ? rng_below(5) - 2 : 0);
+    if (target == FUZZ_MULTI_MOVE) {
+        count = fields + 2 * (1 + rng_below(21)) + (rng_below(4) == 0 ? rng_below(3) - 1 : 0);
+    }
+    if (target == FUZZ_RECONNECT && rng_below(3) == 0) {
+        count = 2 + rng_below(3);
+    }
+
+    for (int i = 0; i < count && pos + 2 < size; i++) {
+        if (i > 0) {
+            out[pos++] = ',';
+        }
+        char kind = i < fields ? shape[i] : 'i';
+        if (target == FUZZ_RECONNECT && count == 2 && i == 1) {
+            kind = 't';
+        }
+        if (kind == 'n') gen_name(out, &pos, size);
+        else if (kind == 't') gen_token(out, &pos, size);
+        else gen_number(out, &pos, size);
+    }
+    out[pos] = '\0';
+
+    // Multi-move: path_length usually matches the pairs sent
+    if (target == FUZZ_MULTI_MOVE && rng_below(4) != 0) {
+        int pairs = (count - fields) / 2;
+        char *third = strchr(out, ',');
+        third = third ? strchr(third + 1, ',') : NULL;
+        char *after = third ? strchr(third + 1, ',') : NULL;
+        if (third && after) {
+            char rest[MAX_DATA_LEN];
+            snprintf(rest, sizeof(rest), "%s", after);
+            snprintf(third + 1, size - (size_t)(third + 1 - out), "%d%s", pairs, rest);
+        }
+    }
+
+    // Mutations: line endings, trailing junk, a character inserted, dropped or replaced
+    size_t length = strlen(out);
+    switch (rng_below(10)) {
+        case 0:
+            if (length + 2 < size) strcat(out, rng_below(2) ? "\r\n" : "\r");
+            break;
+        case 1:
+            if (length + 2 < size) strcat(out, rng_below(2) ? "x" : " ");
+            break;
+        case 2:
+            if (length > 0) {
+                size_t at = (size_t)rng_below((int)length);
+                memmove(out + at, out + at + 1, length - at);
+            }
+            break;
+        case 3:
+            if (length > 0) out[rng_below((int)length)] = ",, \r-x"[rng_below(6)];
+            break;
+        case 4:
+            if (length + 2 < size) {
+                size_t at = (size_t)rng_below((int)length + 1);
+                memmove(out + at + 1, out + at, length - at + 1);
+                out[at] = ",\t\r+"[rng_below(4)];
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * Payload fuzzer entry point.
+ * Compares the schema decoder with the legacy sscanf parsing of every
+ * client payload on generated and mutated inputs.
+ *
+ * @param argc Argument count
+ * @param argv Argument vector
+ * @return 0 if no mismatch was found, 1 otherwise
+ */
+int main(int argc, char *argv[]) {
+    long cases = FUZZ_DEFAULT_CASES;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:s:h")) != -1) {
+        switch (opt) {
+            case 'n': cases = atol(optarg); break;
+            case 's': rng_state = strtoull(optarg, NULL, 10) | 1; break;
+            default:
+                print_usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    FuzzStats stats[FUZZ_TARGET_COUNT];
+    memset(stats, 0, sizeof(stats));
+    char payload[MAX_DATA_LEN];
+
+    for (int t = 0; t < FUZZ_TARGET_COUNT; t++) {
+        for (long i = 0; i < cases; i++) {
+            gen_payload((FuzzTarget)t, payload, sizeof(payload));
+            check_payload((FuzzTarget)t, payload, &stats[t]);
+        }
+    }
+
+    long mismatches = 0;
+    printf("%-14s %10s %10s %10s %10s %10s %10s\n",
+           "payload", "cases", "cut", "legacy", "decoder", "exact", "mismatch");
+    for (int t = 0; t < FUZZ_TARGET_COUNT; t++) {
+        printf("%-14s %10ld %10ld %10ld %10ld %10ld %10ld\n", TARGET_NAMES[t], stats[t].cases,
+               stats[t].cut, stats[t].legacy_accepted, stats[t].decoder_accepted,
+               stats[t].canonical, stats[t].mismatches);
+        mismatches += stats[t].mismatches;
+    }
+    printf("%s\n", mismatches ? "FAIL" : "PASS");
+    return mismatches ? 1 : 0;
+}
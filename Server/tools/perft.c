@@ -0,0 +1,412 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "../game.h"
+#include "../movegen.h"
+
+#define PERFT_MAX_DEPTH 12               // Deepest depth accepted on the command line
+#define PERFT_REFERENCE_DEPTH 8          // Depths with embedded reference counts
+#define PERFT_MAX_ERRORS 10              // Rule mismatches printed before going quiet
+
+/**
+ * Perft test position.
+ * Rows use the print_board legend (w, W, b, B, .); NULL rows mean the
+ * init_game start position. Reference counts are leaf counts per depth,
+ * 0 where no reference is recorded.
+ */
+typedef struct {
+    const char *name;
+    const char *rows[BOARD_SIZE];
+    PlayerColor side;
+    uint64_t reference[PERFT_REFERENCE_DEPTH + 1];
+} PerftPosition;
+
+/**
+ * Counters collected while walking the move tree.
+ */
+typedef struct {
+    uint64_t steps;          // Steps passed through validate_move/apply_move
+    uint64_t errors;         // Moves rejected or misapplied by game.c
+} PerftStats;
+
+static const PerftPosition POSITIONS[] = {
+    {
+        "start",
+        {NULL},
+        COLOR_WHITE,
+        {1, 7, 49, 302, 1469, 7482, 37986, 190146, 929984}
+    },
+    {
+        "kings",
+        {
+            "........",
+            ".b...b..",
+            "..B.....",
+            ".....w..",
+            "....b...",
+            ".W...w..",
+            "..b.....",
+            ".....W.."
+        },
+        COLOR_WHITE,
+        {1, 4, 12, 56, 296, 2405, 18478, 146581, 1144004}
+    },
+    {
+        "chains",
+        {
+            "........",
+            "........",
+            ".b.b....",
+            "........",
+            ".b.b.b..",
+            "w.......",
+            "....b...",
+            "...w...W"
+        },
+        COLOR_WHITE,
+        {1, 4, 28, 71, 541, 4557, 43155, 436515, 4448996}
+    }
+};
+
+#define POSITION_COUNT ((int)(sizeof(POSITIONS) / sizeof(POSITIONS[0])))
+
+static int printed_errors = 0;
+
+/**
+ * Prints usage information for the perft tool.
+ *
+ * @param program_name Name of the executable
+ */
+static void print_usage(const char *program_name) {
+    printf("Usage: %s [-d depth] [-p position] [-e] [-v] [-D]\n", program_name);
+    printf("  -d depth     Deepest perft depth (default: 6, max: %d)\n", PERFT_MAX_DEPTH);
+    printf("  -p position  Run only the named position (default: all)\n");
+    printf("  -e           Engine only: bitboard make_move, no game.c\n");
+    printf("  -v           Verify every game.c move against the engine result\n");
+    printf("  -D           Print per-move leaf counts at the root (divide)\n");
+    printf("\nPositions:");
+    for (int i = 0; i < POSITION_COUNT; i++) {
+        printf(" %s", POSITIONS[i].name);
+    }
+    printf("\n");
+}
+
+/**
+ * Returns monotonic wall clock time in milliseconds.
+ */
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+/**
+ * Sets up a game from a perft position.
+ *
+ * @param def Position definition
+ * @param game Output game, player1 ("white") plays white
+ */
+static void load_position(const PerftPosition *def, Game *game) {
+    init_game(game, symtab_intern("white"), symtab_intern("black"));
+
+    if (def->rows[0]) {
+        for (int row = 0; row < BOARD_SIZE; row++) {
+            for (int col = 0; col < BOARD_SIZE; col++) {
+                switch (def->rows[row][col]) {
+                    case 'w': game->board[row][col] = WHITE_PIECE; break;
+                    case 'W': game->board[row][col] = WHITE_KING; break;
+                    case 'b': game->board[row][col] = BLACK_PIECE; break;
+                    case 'B': game->board[row][col] = BLACK_KING; break;
+                    default: game->board[row][col] = EMPTY; break;
+                }
+            }
+        }
+    }
+
+    game->player2_to_move = def->side != COLOR_WHITE;
+}
+
+/**
+ * Reports a move that game.c rejected or applied differently from the engine.
+ *
+ * @param game Game before the move
+ * @param move Offending move
+ * @param what Description of the mismatch
+ */
+static void report_error(const Game *game, const Move *move, const char *what) {
+    if (printed_errors++ >= PERFT_MAX_ERRORS) {
+        return;
+    }
+
+    char path[128];
+    move_to_string(move, path, sizeof(path));
+    printf("MISMATCH: %s for %s move %s\n", what, symtab_name(game_turn_player(game)), path);
+    print_board(game);
+}
+
+/**
+ * Plays one engine move through the game.c rules engine.
+ * Every step of the path goes through validate_move and apply_move,
+ * exactly as handle_move/handle_multi_move do on the server.
+ *
+ * @param game Game to modify
+ * @param move Move to play
+ * @param stats Step and error counters
+ * @return true if game.c accepted every step
+ */
+static bool play_move(Game *game, const Move *move, PerftStats *stats) {
+    PlayerId player = game_turn_player(game);
+
+    for (int i = 0; i + 1 < move->path_len; i++) {
+        int from_row = SQUARE_ROW(move->path[i]);
+        int from_col = SQUARE_COL(move->path[i]);
+        int to_row = SQUARE_ROW(move->path[i + 1]);
+        int to_col = SQUARE_COL(move->path[i + 1]);
+
+        stats->steps++;
+        if (!validate_move(game, from_row, from_col, to_row, to_col, player)) {
+            return false;
+        }
+        apply_move(game, from_row, from_col, to_row, to_col);
+    }
+
+    change_turn(game);
+    return true;
+}
+
+/**
+ * Counts leaves by executing every move through game.c.
+ *
+ * @param game Current game state
+ * @param depth Remaining depth
+ * @param verify Compare each resulting board with make_move
+ * @param stats Step and error counters
+ * @return Leaf count
+ */
+static uint64_t perft_game(const Game *game, int depth, bool verify, PerftStats *stats) {
+    if (depth == 0) {
+        return 1;
+    }
+
+    Position pos;
+    MoveList list;
+    position_from_game(&pos, game);
+    generate_moves(&pos, &list);
+
+    uint64_t leaves = 0;
+    for (int i = 0; i < list.count; i++) {
+        Game child = *game;
+
+        if (!play_move(&child, &list.moves[i], stats)) {
+            stats->errors++;
+            report_error(game, &list.moves[i], "step rejected by validate_move");
+            continue;
+        }
+
+        if (verify) {
+            Position expected = pos;
+            Position actual;
+            make_move(&expected, &list.moves[i]);
+            position_from_game(&actual, &child);
+
+            if (expected.white != actual.white || expected.black != actual.black ||
+                expected.kings != actual.kings || expected.side != actual.side) {
+                stats->errors++;
+                report_error(game, &list.moves[i], "board differs after apply_move");
+                continue;
+            }
+        }
+
+        leaves += perft_game(&child, depth - 1, verify, stats);
+    }
+
+    return leaves;
+}
+
+/**
+ * Counts leaves with the bitboard engine only (bulk counted at depth 1).
+ *
+ * @param pos Current position
+ * @param depth Remaining depth
+ * @return Leaf count
+ */
+static uint64_t perft_engine(const Position *pos, int depth) {
+    if (depth == 0) {
+        return 1;
+    }
+
+    MoveList list;
+    generate_moves(pos, &list);
+    if (depth == 1) {
+        return list.count;
+    }
+
+    uint64_t leaves = 0;
+    for (int i = 0; i < list.count; i++) {
+        Position child = *pos;
+        make_move(&child, &list.moves[i]);
+        leaves += perft_engine(&child, depth - 1);
+    }
+
+    return leaves;
+}
+
+/**
+ * Prints leaf counts for every root move.
+ *
+ * @param game Root game state
+ * @param depth Perft depth
+ * @param engine_only Use the bitboard engine instead of game.c
+ */
+static void divide(const Game *game, int depth, bool engine_only) {
+    Position pos;
+    MoveList list;
+    position_from_game(&pos, game);
+    generate_moves(&pos, &list);
+
+    uint64_t total = 0;
+    for (int i = 0; i < list.count; i++) {
+        char path[128];
+        uint64_t leaves = 0;
+        move_to_string(&list.moves[i], path, sizeof(path));
+
+        if (engine_only) {
+            Position child = pos;
+            make_move(&child, &list.moves[i]);
+            leaves = perft_engine(&child, depth - 1);
+        } else {
+            Game child = *game;
+            PerftStats stats = {0, 0};
+            if (play_move(&child, &list.moves[i], &stats)) {
+                leaves = perft_game(&child, depth - 1, false, &stats);
+            }
+        }
+
+        printf("  %-24s %llu\n", path, (unsigned long long)leaves);
+        total += leaves;
+    }
+    printf("  %-24s %llu\n", "total", (unsigned long long)total);
+}
+
+/**
+ * Runs perft 1..depth on one position and compares with references.
+ *
+ * @param def Position definition
+ * @param depth Deepest depth
+ * @param engine_only Use the bitboard engine instead of game.c
+ * @param verify Cross-check game.c boards with the engine
+ * @param show_divide Print per-move counts at the deepest depth
+ * @return Number of failures (reference mismatches and rule errors)
+ */
+static int run_position(const PerftPosition *def, int depth, bool engine_only,
+                        bool verify, bool show_divide) {
+    Game game;
+    Position pos;
+    int failures = 0;
+
+    load_position(def, &game);
+    position_from_game(&pos, &game);
+
+    printf("=== %s (%s to move) ===\n", def->name, def->side == COLOR_WHITE ? "white" : "black");
+    printf("%5s %14s %10s %14s %14s %s\n",
+           "depth", "leaves", "time_ms", "leaves/s", "steps", "reference");
+
+    for (int d = 1; d <= depth; d++) {
+        PerftStats stats = {0, 0};
+        double start = now_ms();
+        uint64_t leaves = engine_only ? perft_engine(&pos, d)
+                                      : perft_game(&game, d, verify, &stats);
+        double elapsed = now_ms() - start;
+
+        uint64_t reference = d <= PERFT_REFERENCE_DEPTH ? def->reference[d] : 0;
+        const char *status = "-";
+        if (reference != 0) {
+            status = leaves == reference ? "ok" : "FAIL";
+            if (leaves != reference) failures++;
+        }
+        failures += (int)stats.errors;
+
+        printf("%5d %14llu %10.1f %14.0f %14llu %s",
+               d, (unsigned long long)leaves, elapsed,
+               elapsed > 0 ? leaves / (elapsed / 1000.0) : 0.0,
+               (unsigned long long)stats.steps, status);
+        if (reference != 0 && leaves != reference) {
+            printf(" (expected %llu)", (unsigned long long)reference);
+        }
+        if (stats.errors) {
+            printf(" [%llu rule errors]", (unsigned long long)stats.errors);
+        }
+        printf("\n");
+    }
+
+    if (show_divide) {
+        printf("divide at depth %d:\n", depth);
+        divide(&game, depth, engine_only);
+    }
+
+    printf("\n");
+    return failures;
+}
+
+/**
+ * Perft entry point.
+ * Walks all legal move sequences, by default executing each step through
+ * validate_move/apply_move, and checks leaf counts against references.
+ *
+ * @param argc Argument count
+ * @param argv Argument vector
+ * @return 0 if all counts match and no rule errors were found, 1 otherwise
+ */
+int main(int argc, char *argv[]) {
+    int depth = 6;
+    const char *only = NULL;
+    bool engine_only = false;
+    bool verify = false;
+    bool show_divide = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "d:p:evDh")) != -1) {
+        switch (opt) {
+            case 'd': depth = atoi(optarg); break;
+            case 'p': only = optarg; break;
+            case 'e': engine_only = true; break;
+            case 'v': verify = true; break;
+            case 'D': show_divide = true; break;
+            default:
+                print_usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    if (depth < 1 || depth > PERFT_MAX_DEPTH) {
+        fprintf(stderr, "Depth must be 1..%d\n", PERFT_MAX_DEPTH);
+        return 1;
+    }
+
+    game_set_logging(false);
+    movegen_init();
+
+    printf("Perft mode: %s%s\n\n", engine_only ? "engine (bitboards)" : "game.c rules",
+           verify && !engine_only ? ", verified against engine" : "");
+
+    int failures = 0;
+    int ran = 0;
+    for (int i = 0; i < POSITION_COUNT; i++) {
+        if (only && strcmp(only, POSITIONS[i].name) != 0) {
+            continue;
+        }
+        failures += run_position(&POSITIONS[i], depth, engine_only, verify, show_divide);
+        ran++;
+    }
+
+    if (ran == 0) {
+        fprintf(stderr, "Unknown position: %s\n", only);
+        return 1;
+    }
+
+    printf("%s (%d failure%s)\n", failures ? "FAILED" : "PASSED", failures,
+           failures == 1 ? "" : "s");
+    return failures ? 1 : 0;
+}
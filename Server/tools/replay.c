@@ -0,0 +1,730 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include "../protocol.h"
+#include "../recorder.h"
+
+#define REPLAY_INBUF (2 * MAX_MESSAGE_LEN)   // Per-connection receive buffer
+#define REPLAY_MAX_IGNORED 16                // Opcodes excluded from verification
+#define REPLAY_SHOWN_MISMATCHES 10           // Mismatches printed without -v
+
+/**
+ * One capture record loaded into memory.
+ */
+typedef struct {
+    uint64_t timestamp_ns;
+    uint32_t connection;
+    uint32_t cause;
+    uint8_t direction;
+    uint16_t length;
+    const char *data;            // Points into the capture image
+    int position;                // Verified OUT: frames its connection has received with it
+    int first_effect;            // Input: first verified OUT it caused, -1 if none
+    int next_effect;             // Verified OUT: next frame with the same cause, -1 at end
+} ReplayEvent;
+
+/**
+ * Replayed client connection.
+ */
+typedef struct {
+    int fd;                      // -1 before OPEN and after close
+    char inbuf[REPLAY_INBUF];
+    int inlen;
+
+    int *expected;               // Event indices of verified OUT frames
+    int expected_count;
+    int next_expected;
+
+    long long pending_since;     // Send time of the oldest unanswered frame, 0 if none
+} ReplayConn;
+
+/**
+ * Session token issued in the capture and its counterpart in this run.
+ */
+typedef struct {
+    char recorded[SESSION_TOKEN_LEN + 1];
+    char live[SESSION_TOKEN_LEN + 1];
+} ReplayToken;
+
+static ReplayEvent *events;
+static int event_count;
+static ReplayConn *conns;        // Indexed by connection id
+static uint32_t conn_count;
+
+static const char *host = "127.0.0.1";
+static int port = 12345;
+static double speed = 1.0;       // 0 replays as fast as possible
+static int timeout_ms = 5000;
+static bool verbose = false;
+static int ignored_ops[REPLAY_MAX_IGNORED] = { OP_PING };
+static int ignored_count = 1;
+
+// Results
+static long frames_sent;
+static long frames_matched;
+static long frames_mismatched;
+static long frames_unexpected;
+static long frames_dropped;      // Inbound frames for connections the server closed
+static long stalls;
+static long long *latencies;
+static long latency_count;
+static ReplayToken *tokens;      // Session tokens seen in OP_LOGIN_OK
+static int token_count;
+static int token_capacity;
+
+/**
+ * Prints usage information.
+ *
+ * @param program_name Name of the executable
+ */
+static void print_usage(const char *program_name) {
+    printf("Usage: %s [-H host] [-p port] [-s speed] [-t timeout_ms] [-i ops] [-v] CAPTURE\n",
+           program_name);
+    printf("Replays a capture written by checkers_server --record against a fresh server\n");
+    printf("started with --serialize (or --record) and verifies that every connection\n");
+    printf("receives the recorded frames. Pings are answered live; frames the server\n");
+    printf("sends on its own clock (pause after a dropped connection, timeouts) may\n");
+    printf("differ when the replay runs faster than recorded.\n");
+    printf("  -H host        Server address (default: 127.0.0.1)\n");
+    printf("  -p port        Server port (default: 12345)\n");
+    printf("  -s speed       Time scale, 1 = recorded pace, 0 = as fast as possible (default: 1)\n");
+    printf("  -t timeout_ms  Wait for an expected frame before giving up (default: 5000)\n");
+    printf("  -i ops         Comma separated opcodes not verified (default: %d)\n", OP_PING);
+    printf("  -v             Print every mismatch\n");
+}
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * Extracts the opcode of a raw DENTCP frame.
+ *
+ * @return Opcode, or -1 if the frame has no valid header
+ */
+static int frame_opcode(const char *frame, int length) {
+    if (length < 10 || memcmp(frame, PREFIX "|", 7) != 0) {
+        return -1;
+    }
+    return atoi(frame + 7);
+}
+
+static bool is_ignored(int op) {
+    for (int i = 0; i < ignored_count; i++) {
+        if (ignored_ops[i] == op) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static int compare_ll(const void *a, const void *b) {
+    long long x = *(const long long*)a;
+    long long y = *(const long long*)b;
+    return (x > y) - (x < y);
+}
+
+// ========== CAPTURE LOADING ==========
+
+/**
+ * Reads a capture file and indexes its records.
+ * Computes for each connection the OUT frames to verify and links every
+ * verified frame to the input record that caused it.
+ *
+ * @param path Capture file path
+ * @return 0 on success, -1 on failure
+ */
+static int load_capture(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        perror("Failed to open capture");
+        return -1;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char *image = malloc(size > 0 ? (size_t)size : 1);
+    if (!image || fread(image, 1, (size_t)size, file) != (size_t)size) {
+        fprintf(stderr, "Failed to read capture\n");
+        fclose(file);
+        free(image);
+        return -1;
+    }
+    fclose(file);
+
+    CaptureHeader header;
+    if ((size_t)size < sizeof(header)) {
+        fprintf(stderr, "Capture too short\n");
+        return -1;
+    }
+    memcpy(&header, image, sizeof(header));
+    if (memcmp(header.magic, CAPTURE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != CAPTURE_VERSION) {
+        fprintf(stderr, "Not a version %d capture file\n", CAPTURE_VERSION);
+        return -1;
+    }
+
+    // First pass: count records and connections
+    size_t offset = sizeof(header);
+    int capacity = 0;
+    while (offset + sizeof(CaptureRecord) <= (size_t)size) {
+        CaptureRecord record;
+        memcpy(&record, image + offset, sizeof(record));
+        if (record.direction > CAPTURE_CLOSE || record.connection == 0) {
+            fprintf(stderr, "Corrupt record at offset %zu\n", offset);
+            return -1;
+        }
+        if (offset + sizeof(record) + record.length > (size_t)size) {
+            fprintf(stderr, "Capture truncated, replaying %d records\n", capacity);
+            break;
+        }
+        offset += sizeof(record) + record.length;
+        if (record.connection > conn_count) {
+            conn_count = record.connection;
+        }
+        capacity++;
+    }
+
+    events = calloc(capacity > 0 ? capacity : 1, sizeof(ReplayEvent));
+    conns = calloc(conn_count + 1, sizeof(ReplayConn));
+    latencies = calloc(capacity > 0 ? capacity : 1, sizeof(long long));
+    if (!events || !conns || !latencies) {
+        fprintf(stderr, "Out of memory\n");
+        return -1;
+    }
+
+    for (uint32_t c = 0; c <= conn_count; c++) {
+        conns[c].fd = -1;
+    }
+
+    // Second pass: fill events and count verified frames per connection
+    offset = sizeof(header);
+    for (int i = 0; i < capacity; i++) {
+        CaptureRecord record;
+        memcpy(&record, image + offset, sizeof(record));
+        offset += sizeof(record);
+
+        ReplayEvent *ev = &events[event_count++];
+        ev->timestamp_ns = record.timestamp_ns;
+        ev->connection = record.connection;
+        ev->cause = record.cause;
+        ev->first_effect = -1;
+        ev->next_effect = -1;
+        ev->direction = record.direction;
+        ev->length = record.length;
+        ev->data = image + offset;
+        offset += record.length;
+
+        ReplayConn *conn = &conns[ev->connection];
+        if (ev->direction == CAPTURE_OUT && !is_ignored(frame_opcode(ev->data, ev->length))) {
+            conn->expected_count++;
+        }
+    }
+
+    for (uint32_t c = 1; c <= conn_count; c++) {
+        conns[c].expected = calloc(conns[c].expected_count + 1, sizeof(int));
+        if (!conns[c].expected) {
+            fprintf(stderr, "Out of memory\n");
+            return -1;
+        }
+        conns[c].expected_count = 0;
+    }
+
+    for (int i = 0; i < event_count; i++) {
+        ReplayEvent *ev = &events[i];
+        ReplayConn *conn = &conns[ev->connection];
+        if (ev->direction == CAPTURE_OUT && !is_ignored(frame_opcode(ev->data, ev->length))) {
+            conn->expected[conn->expected_count++] = i;
+            ev->position = conn->expected_count;
+        }
+    }
+
+    // Effects are prepended, so walk backwards to keep them in file order
+    for (int i = event_count - 1; i >= 0; i--) {
+        ReplayEvent *ev = &events[i];
+        if (ev->position > 0 && ev->cause > 0 && ev->cause <= (uint32_t)i) {
+            ev->next_effect = events[ev->cause - 1].first_effect;
+            events[ev->cause - 1].first_effect = i;
+        }
+    }
+
+    return 0;
+}
+
+// ========== SESSION TOKENS ==========
+
+/**
+ * Gets the session token field of an OP_LOGIN_OK ("...,token") or
+ * OP_RECONNECT_REQUEST ("...,token" or "...,token,last_seq") frame.
+ *
+ * @param frame Frame without the newline
+ * @param length Frame length
+ * @return Offset of the token in the frame, -1 if there is none
+ */
+static int frame_token(const char *frame, int length) {
+    for (int offset = length - SESSION_TOKEN_LEN; offset >= 1; offset--) {
+        int end = offset + SESSION_TOKEN_LEN;
+        if (frame[offset - 1] != ',' || (end < length && frame[end] != ',')) {
+            continue;
+        }
+        int i = offset;
+        while (i < end && isxdigit((unsigned char)frame[i])) {
+            i++;
+        }
+        if (i == end) {
+            return offset;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Matches an OP_LOGIN_OK frame except for its random session token and
+ * remembers which live token stands for the recorded one.
+ *
+ * @return true if the frames are equal apart from the token
+ */
+static bool match_login_ok(const char *expected, const char *received, int length) {
+    int offset = frame_token(received, length);
+    if (offset < 0 || frame_token(expected, length) != offset ||
+        memcmp(expected, received, offset) != 0) {
+        return false;
+    }
+
+    if (token_count == token_capacity) {
+        token_capacity = token_capacity ? token_capacity * 2 : 64;
+        tokens = realloc(tokens, sizeof(ReplayToken) * token_capacity);
+    }
+    ReplayToken *token = &tokens[token_count++];
+    memcpy(token->recorded, expected + offset, SESSION_TOKEN_LEN);
+    token->recorded[SESSION_TOKEN_LEN] = '\0';
+    memcpy(token->live, received + offset, SESSION_TOKEN_LEN);
+    token->live[SESSION_TOKEN_LEN] = '\0';
+    return true;
+}
+
+/**
+ * Replaces a recorded session token in an outgoing frame by the live one.
+ *
+ * @param frame Copy of the frame to patch, newline included
+ * @param length Frame length
+ */
+static void substitute_token(char *frame, int length) {
+    int offset = frame_token(frame, length > 0 && frame[length - 1] == '\n' ? length - 1 : length);
+    if (offset < 0) {
+        return;
+    }
+    // Newest first: a name that logged in again reconnects with its latest token
+    for (int i = token_count - 1; i >= 0; i--) {
+        if (memcmp(frame + offset, tokens[i].recorded, SESSION_TOKEN_LEN) == 0) {
+            memcpy(frame + offset, tokens[i].live, SESSION_TOKEN_LEN);
+            return;
+        }
+    }
+}
+
+// ========== CONNECTION I/O ==========
+
+static void close_conn(ReplayConn *conn) {
+    if (conn->fd >= 0) {
+        close(conn->fd);
+        conn->fd = -1;
+    }
+}
+
+/**
+ * Sends a recorded inbound frame. OP_RECONNECT_REQUEST carries the live
+ * session token in place of the recorded one.
+ *
+ * @param conn Connection
+ * @param ev Inbound event
+ * @return 0 on success, -1 if the connection failed
+ */
+static int send_frame(ReplayConn *conn, const ReplayEvent *ev) {
+    char frame[MAX_MESSAGE_LEN + 1];
+    const char *data = ev->data;
+
+    if (frame_opcode(ev->data, ev->length) == OP_RECONNECT_REQUEST &&
+        ev->length <= (int)sizeof(frame)) {
+        memcpy(frame, ev->data, ev->length);
+        substitute_token(frame, ev->length);
+        data = frame;
+    }
+    return send(conn->fd, data, ev->length, MSG_NOSIGNAL) == ev->length ? 0 : -1;
+}
+
+/**
+ * Verifies one received frame against the next expected frame.
+ *
+ * @param id Connection id
+ * @param frame Frame without the newline
+ * @param length Frame length
+ */
+static void verify_frame(uint32_t id, const char *frame, int length) {
+    ReplayConn *conn = &conns[id];
+
+    if (is_ignored(frame_opcode(frame, length))) {
+        return;
+    }
+
+    if (conn->pending_since) {
+        latencies[latency_count++] = now_ns() - conn->pending_since;
+        conn->pending_since = 0;
+    }
+
+    if (conn->next_expected >= conn->expected_count) {
+        frames_unexpected++;
+        if (verbose || frames_unexpected + frames_mismatched <= REPLAY_SHOWN_MISMATCHES) {
+            printf("conn %u: unexpected frame '%.*s'\n", id, length, frame);
+        }
+        return;
+    }
+
+    const ReplayEvent *ev = &events[conn->expected[conn->next_expected++]];
+    int expected_length = ev->length;
+    if (expected_length > 0 && ev->data[expected_length - 1] == '\n') {
+        expected_length--;
+    }
+
+    if (expected_length == length && memcmp(ev->data, frame, length) == 0) {
+        frames_matched++;
+        return;
+    }
+
+    if (expected_length == length && frame_opcode(frame, length) == OP_LOGIN_OK &&
+        match_login_ok(ev->data, frame, length)) {
+        frames_matched++;
+        return;
+    }
+
+    frames_mismatched++;
+    if (verbose || frames_unexpected + frames_mismatched <= REPLAY_SHOWN_MISMATCHES) {
+        printf("conn %u frame %d mismatch:\n  expected '%.*s'\n  received '%.*s'\n",
+               id, conn->next_expected, expected_length, ev->data, length, frame);
+    }
+}
+
+/**
+ * Reads whatever a connection has buffered and verifies complete frames.
+ *
+ * @param id Connection id
+ */
+static void read_conn(uint32_t id) {
+    ReplayConn *conn = &conns[id];
+
+    ssize_t n = recv(conn->fd, conn->inbuf + conn->inlen,
+                     sizeof(conn->inbuf) - conn->inlen, MSG_DONTWAIT);
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+        close_conn(conn);
+        return;
+    }
+    if (n < 0) {
+        return;
+    }
+    conn->inlen += (int)n;
+
+    int start = 0;
+    for (int i = 0; i < conn->inlen; i++) {
+        if (conn->inbuf[i] == '\n') {
+            // Heartbeats run on the server's clock, so answer them live
+            if (frame_opcode(conn->inbuf + start, i - start) == OP_PING) {
+                char pong[MAX_MESSAGE_LEN];
+                int len = create_message(pong, OP_PONG, "");
+                send(conn->fd, pong, len, MSG_NOSIGNAL);
+            }
+            verify_frame(id, conn->inbuf + start, i - start);
+            start = i + 1;
+        }
+    }
+
+    if (start == 0 && conn->inlen == (int)sizeof(conn->inbuf)) {
+        fprintf(stderr, "conn %u: frame exceeds buffer, dropping\n", id);
+        conn->inlen = 0;
+        return;
+    }
+    memmove(conn->inbuf, conn->inbuf + start, conn->inlen - start);
+    conn->inlen -= start;
+}
+
+/**
+ * Polls all open connections once.
+ *
+ * @param wait_ms Poll timeout
+ */
+static void pump(int wait_ms) {
+    static struct pollfd *fds;
+    static uint32_t *ids;
+    if (!fds) {
+        fds = calloc(conn_count + 1, sizeof(struct pollfd));
+        ids = calloc(conn_count + 1, sizeof(uint32_t));
+    }
+
+    int nfds = 0;
+    for (uint32_t c = 1; c <= conn_count; c++) {
+        if (conns[c].fd >= 0) {
+            fds[nfds].fd = conns[c].fd;
+            fds[nfds].events = POLLIN;
+            fds[nfds].revents = 0;
+            ids[nfds++] = c;
+        }
+    }
+
+    if (nfds == 0) {
+        if (wait_ms > 0) {
+            usleep(wait_ms * 1000);
+        }
+        return;
+    }
+
+    if (poll(fds, nfds, wait_ms) <= 0) {
+        return;
+    }
+
+    for (int i = 0; i < nfds; i++) {
+        if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+            read_conn(ids[i]);
+        }
+    }
+}
+
+/**
+ * Pumps connections until a connection has received `count` verified
+ * frames, it is closed, or the timeout expires.
+ *
+ * @return true if the frames arrived
+ */
+static bool await_frames(uint32_t id, int count) {
+    ReplayConn *conn = &conns[id];
+    long long deadline = now_ns() + (long long)timeout_ms * 1000000LL;
+
+    while (conn->next_expected < count) {
+        if (conn->fd < 0) {
+            return false;
+        }
+        long long left = deadline - now_ns();
+        if (left <= 0) {
+            return false;
+        }
+        pump((int)(left / 1000000LL) + 1);
+    }
+    return true;
+}
+
+/**
+ * Waits for the server to close a connection after our half-close.
+ */
+static void await_eof(uint32_t id) {
+    long long deadline = now_ns() + (long long)timeout_ms * 1000000LL;
+    while (conns[id].fd >= 0 && now_ns() < deadline) {
+        pump(10);
+    }
+    close_conn(&conns[id]);
+}
+
+static int open_conn(uint32_t id) {
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, host, &addr.sin_addr) != 1) {
+        fprintf(stderr, "Invalid host %s\n", host);
+        return -1;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("Connect failed");
+        if (fd >= 0) {
+            close(fd);
+        }
+        return -1;
+    }
+
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    conns[id].fd = fd;
+    return 0;
+}
+
+// ========== REPLAY ==========
+
+/**
+ * Waits until every verified frame caused by an input has arrived.
+ *
+ * @param index Input event index
+ */
+static void settle(int index) {
+    for (int k = events[index].first_effect; k >= 0; k = events[k].next_effect) {
+        const ReplayEvent *ev = &events[k];
+        if (!await_frames(ev->connection, ev->position) && conns[ev->connection].fd >= 0) {
+            stalls++;
+            if (verbose || stalls <= REPLAY_SHOWN_MISMATCHES) {
+                printf("conn %u: timed out waiting for frame %d\n",
+                       ev->connection, ev->position);
+            }
+        }
+    }
+}
+
+/**
+ * Replays all input events in capture order, which is the order the
+ * recording server handled them. After each input the replay waits for
+ * every frame the server sent while handling it, so the server sees the
+ * recorded state at any speed.
+ */
+static void replay(void) {
+    long long start = now_ns();
+    uint64_t first_ns = event_count > 0 ? events[0].timestamp_ns : 0;
+
+    for (int i = 0; i < event_count; i++) {
+        ReplayEvent *ev = &events[i];
+        ReplayConn *conn = &conns[ev->connection];
+
+        if (ev->direction == CAPTURE_OUT) {
+            continue;
+        }
+
+        if (speed > 0) {
+            long long due = start + (long long)((ev->timestamp_ns - first_ns) / speed);
+            while (now_ns() < due) {
+                long long left = due - now_ns();
+                pump(left > 1000000LL ? (int)(left / 1000000LL) : 0);
+            }
+        }
+
+        if (ev->direction == CAPTURE_OPEN) {
+            open_conn(ev->connection);
+        } else if (conn->fd < 0) {
+            if (ev->direction == CAPTURE_IN) {
+                frames_dropped++;
+            }
+            continue;
+        } else if (frame_opcode(ev->data, ev->length) == OP_PONG) {
+            // Recorded answers to recorded pings; replay answers live
+            continue;
+        } else if (ev->direction == CAPTURE_CLOSE) {
+            // The server closes its end once the disconnect is handled
+            shutdown(conn->fd, SHUT_WR);
+            await_eof(ev->connection);
+        } else if (send_frame(conn, ev) < 0) {
+            close_conn(conn);
+            frames_dropped++;
+            continue;
+        } else {
+            frames_sent++;
+            if (ev->first_effect >= 0) {
+                conn->pending_since = now_ns();
+            }
+        }
+
+        settle(i);
+    }
+
+    // Frames sent by the heartbeat have no cause; collect what is still owed
+    for (uint32_t c = 1; c <= conn_count; c++) {
+        await_frames(c, conns[c].expected_count);
+    }
+}
+
+/**
+ * Replay tool entry point.
+ *
+ * @param argc Argument count
+ * @param argv Argument vector
+ * @return 0 if every frame matched, 1 on mismatch or error
+ */
+int main(int argc, char *argv[]) {
+    int opt;
+    while ((opt = getopt(argc, argv, "H:p:s:t:i:vh")) != -1) {
+        switch (opt) {
+            case 'H': host = optarg; break;
+            case 'p': port = atoi(optarg); break;
+            case 's': speed = atof(optarg); break;
+            case 't': timeout_ms = atoi(optarg); break;
+            case 'v': verbose = true; break;
+            case 'i': {
+                ignored_count = 0;
+                char *list = strdup(optarg);
+                for (char *tok = strtok(list, ","); tok && ignored_count < REPLAY_MAX_IGNORED;
+                     tok = strtok(NULL, ",")) {
+                    ignored_ops[ignored_count++] = atoi(tok);
+                }
+                free(list);
+                break;
+            }
+            case 'h':
+                print_usage(argv[0]);
+                return 0;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (optind != argc - 1) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    if (load_capture(argv[optind]) < 0) {
+        return 1;
+    }
+
+    long expected_total = 0;
+    for (uint32_t c = 1; c <= conn_count; c++) {
+        expected_total += conns[c].expected_count;
+    }
+    printf("Replaying %d records, %u connections, %ld verified frames to %s:%d",
+           event_count, conn_count, expected_total, host, port);
+    if (speed > 0) {
+        printf(" at %.2fx\n", speed);
+    } else {
+        printf(" as fast as possible\n");
+    }
+
+    long long start = now_ns();
+    replay();
+    double elapsed = (now_ns() - start) / 1e9;
+
+    long missing = expected_total - frames_matched - frames_mismatched;
+    for (uint32_t c = 1; c <= conn_count; c++) {
+        close_conn(&conns[c]);
+    }
+
+    printf("\n=== Replay results ===\n");
+    printf("Elapsed:         %.3f s\n", elapsed);
+    printf("Frames sent:     %ld (%.0f/s)\n", frames_sent,
+           elapsed > 0 ? frames_sent / elapsed : 0.0);
+    printf("Frames matched:  %ld / %ld\n", frames_matched, expected_total);
+    printf("Mismatched:      %ld\n", frames_mismatched);
+    printf("Missing:         %ld\n", missing);
+    printf("Unexpected:      %ld\n", frames_unexpected);
+    printf("Dropped inbound: %ld\n", frames_dropped);
+    printf("Stalls:          %ld\n", stalls);
+
+    if (latency_count > 0) {
+        qsort(latencies, latency_count, sizeof(long long), compare_ll);
+        printf("Response latency (us): p50 %.1f  p90 %.1f  p99 %.1f  max %.1f\n",
+               latencies[latency_count / 2] / 1000.0,
+               latencies[latency_count * 90 / 100] / 1000.0,
+               latencies[latency_count * 99 / 100] / 1000.0,
+               latencies[latency_count - 1] / 1000.0);
+    }
+
+    bool ok = frames_mismatched == 0 && missing == 0 && frames_unexpected == 0;
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,147 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../game.h"
+#include "../movegen.h"
+#include "../search.h"
+#include "../tablebase.h"
+
+#define SUITE_SIZE 5
+
+// Plies of deterministic play applied to the init_game start position
+static const int SUITE_PLIES[SUITE_SIZE] = {0, 4, 8, 12, 20};
+
+/**
+ * Prints usage information for the benchmark.
+ *
+ * @param program_name Name of the executable
+ */
+static void print_usage(const char *program_name) {
+    printf("Usage: %s [-d depth] [-t max_threads] [-m tt_mb] [-b tablebase]\n", program_name);
+    printf("  -d depth        Search depth per position (default: 10)\n");
+    printf("  -t max_threads  Highest thread count to measure (default: online CPUs)\n");
+    printf("  -m tt_mb        Transposition table size in MB (default: %d)\n",
+           SEARCH_DEFAULT_TT_MB);
+    printf("  -b tablebase    Endgame tablebase file to probe during search\n");
+}
+
+/**
+ * Builds the benchmark position suite.
+ * Every position is reached from init_game by playing pseudo-random legal
+ * moves with a fixed seed, so the suite is identical between runs.
+ *
+ * @param suite Output positions
+ */
+static void build_suite(Position suite[SUITE_SIZE]) {
+    Game game;
+    init_game(&game, symtab_intern("white"), symtab_intern("black"));
+
+    for (int i = 0; i < SUITE_SIZE; i++) {
+        Position pos;
+        uint64_t seed = 0x5EED;
+        position_from_game(&pos, &game);
+
+        for (int ply = 0; ply < SUITE_PLIES[i]; ply++) {
+            MoveList list;
+            if (generate_moves(&pos, &list) == 0) break;
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            make_move(&pos, &list.moves[(seed >> 33) % list.count]);
+        }
+        suite[i] = pos;
+    }
+}
+
+/**
+ * Search benchmark entry point.
+ * Measures nodes/second and time-to-depth for 1..N Lazy SMP threads.
+ *
+ * @param argc Argument count
+ * @param argv Argument vector
+ * @return 0 on success, 1 on failure
+ */
+int main(int argc, char *argv[]) {
+    int depth = 10;
+    int max_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    size_t tt_mb = SEARCH_DEFAULT_TT_MB;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "d:t:m:b:h")) != -1) {
+        switch (opt) {
+            case 'd': depth = atoi(optarg); break;
+            case 't': max_threads = atoi(optarg); break;
+            case 'm': tt_mb = (size_t)atol(optarg); break;
+            case 'b':
+                if (tb_init(optarg) < 0) return 1;
+                break;
+            default:
+                print_usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    if (depth < 1 || depth > SEARCH_MAX_DEPTH) depth = 10;
+    if (max_threads < 1) max_threads = 1;
+    if (max_threads > SEARCH_MAX_THREADS) max_threads = SEARCH_MAX_THREADS;
+
+    if (tt_init(tt_mb) < 0) {
+        return 1;
+    }
+
+    Position suite[SUITE_SIZE];
+    build_suite(suite);
+
+    printf("=== Search benchmark ===\n");
+    printf("Positions: %d, depth: %d, TT: %zu MB\n\n", SUITE_SIZE, depth, tt_mb);
+    printf("%7s %14s %10s %12s %8s %14s\n",
+           "threads", "nodes", "time_ms", "nps", "speedup", "ttd_speedup");
+
+    double base_time = 0.0;
+    double base_ttd = 0.0;
+
+    for (int threads = 1; ; threads *= 2) {
+        if (threads > max_threads) threads = max_threads;
+
+        uint64_t nodes = 0;
+        double time_ms = 0.0;
+        double ttd_ms = 0.0;
+        double depth_ms[SEARCH_MAX_DEPTH + 1] = {0};
+
+        for (int i = 0; i < SUITE_SIZE; i++) {
+            SearchLimits limits = { .max_depth = depth, .threads = threads, .time_limit_ms = 0 };
+            SearchResult result;
+
+            tt_clear();
+            search_position(&suite[i], &limits, &result);
+
+            nodes += result.nodes;
+            time_ms += result.elapsed_ms;
+            for (int d = 1; d <= depth; d++) {
+                depth_ms[d] += result.depth_time_ms[d];
+            }
+            ttd_ms += result.depth_time_ms[result.depth];
+        }
+
+        if (threads == 1) {
+            base_time = time_ms;
+            base_ttd = ttd_ms;
+        }
+
+        printf("%7d %14llu %10.1f %12.0f %8.2f %14.2f\n",
+               threads, (unsigned long long)nodes, time_ms,
+               time_ms > 0 ? nodes / (time_ms / 1000.0) : 0.0,
+               time_ms > 0 ? base_time / time_ms : 0.0,
+               ttd_ms > 0 ? base_ttd / ttd_ms : 0.0);
+
+        printf("        time-to-depth (ms):");
+        for (int d = 1; d <= depth; d++) {
+            printf(" %d:%.1f", d, depth_ms[d]);
+        }
+        printf("\n");
+
+        if (threads == max_threads) break;
+    }
+
+    tt_free();
+    return 0;
+}
@@ -0,0 +1,484 @@
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "transport.h"
+#include "bufpool.h"
+
+/**
+ * In-memory connection. End 0 is the client, end 1 the server;
+ * inbound[i] is read by end i and written by the other end.
+ */
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t readable;
+    ByteQueue inbound[2];
+    bool closed[2];
+    int handle[2];               // eventfd per end, signalled while it is readable
+    int refs;                    // Open ends plus calls in progress (slots_mutex)
+} MemoryConn;
+
+/**
+ * Per-handle transport state.
+ */
+typedef struct {
+    _Atomic(const TransportOps *) ops;   // Read without slots_mutex on every call
+    MemoryConn *memory;
+    int end;
+} TransportSlot;
+
+static TransportSlot slots[TRANSPORT_MAX_HANDLES];
+static pthread_mutex_t slots_mutex = PTHREAD_MUTEX_INITIALIZER;
+static atomic_uint_fast64_t syscall_count = 0;
+
+// ========== BYTE QUEUES ==========
+
+/**
+ * Appends bytes to a queue. Consumed space at the front is reclaimed
+ * before the storage grows.
+ *
+ * @param queue Queue to append to
+ * @param data Bytes to append
+ * @param length Number of bytes
+ * @return 0 on success, -1 if out of memory
+ */
+int byte_queue_append(ByteQueue *queue, const void *data, size_t length) {
+    if (queue->head + queue->length + length > queue->capacity) {
+        if (queue->head > 0) {
+            memmove(queue->data, queue->data + queue->head, queue->length);
+            queue->head = 0;
+        }
+        if (queue->length + length > queue->capacity) {
+            size_t capacity = queue->capacity ? queue->capacity : BUFPOOL_BLOCK_SIZE;
+            while (capacity < queue->length + length) {
+                capacity *= 2;
+            }
+            char *grown = bufpool_resize(queue->data, queue->capacity, capacity);
+            if (!grown) {
+                return -1;
+            }
+            queue->data = grown;
+            queue->capacity = capacity;
+        }
+    }
+
+    memcpy(queue->data + queue->head + queue->length, data, length);
+    queue->length += length;
+    return 0;
+}
+
+/**
+ * Removes bytes from the front of a queue. A drained queue returns its
+ * storage, so idle connections hold none.
+ *
+ * @param queue Queue to read from
+ * @param buffer Destination
+ * @param length Maximum number of bytes
+ * @return Bytes copied
+ */
+size_t byte_queue_take(ByteQueue *queue, void *buffer, size_t length) {
+    size_t n = queue->length < length ? queue->length : length;
+    memcpy(buffer, queue->data + queue->head, n);
+    queue->head += n;
+    queue->length -= n;
+    if (queue->length == 0) {
+        byte_queue_free(queue);
+    }
+    return n;
+}
+
+void byte_queue_free(ByteQueue *queue) {
+    bufpool_free(queue->data, queue->capacity);
+    memset(queue, 0, sizeof(*queue));
+}
+
+// ========== SOCKETS ==========
+
+static int socket_wait(int handle) {
+    struct pollfd pfd = {handle, POLLIN, 0};
+    int ready;
+    do {
+        transport_count_syscall();
+        ready = poll(&pfd, 1, -1);
+    } while (ready < 0 && errno == EINTR);
+    return ready < 0 ? -1 : 0;
+}
+
+static ssize_t socket_read(int handle, void *buffer, size_t length) {
+    transport_count_syscall();
+    return recv(handle, buffer, length, 0);
+}
+
+static ssize_t socket_write(int handle, const void *buffer, size_t length) {
+    transport_count_syscall();
+    return send(handle, buffer, length, MSG_NOSIGNAL);
+}
+
+static void socket_close(int handle) {
+    transport_count_syscall();
+    close(handle);
+}
+
+const TransportOps transport_tcp = {"tcp", socket_wait, socket_read, socket_write, socket_close, NULL, NULL};
+const TransportOps transport_unix = {"unix", socket_wait, socket_read, socket_write, socket_close, NULL, NULL};
+
+/**
+ * Creates a listening Unix-domain stream socket.
+ * A stale socket file from a previous run is replaced.
+ *
+ * @param path Filesystem path of the socket
+ * @return Listening socket or -1 on failure
+ */
+int transport_listen_unix(const char *path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Unix socket path too long: %s\n", path);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("Unix socket creation failed");
+        return -1;
+    }
+
+    unlink(path);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("Unix bind failed");
+        close(fd);
+        return -1;
+    }
+
+    if (listen(fd, TRANSPORT_UNIX_BACKLOG) < 0) {
+        perror("Unix listen failed");
+        close(fd);
+        unlink(path);
+        return -1;
+    }
+
+    return fd;
+}
+
+// ========== IN-MEMORY ==========
+
+/**
+ * Looks up the in-memory connection of a handle and pins it.
+ *
+ * @param handle Connection handle
+ * @param end Receives the end owned by the handle
+ * @return Connection or NULL if the handle is closed
+ */
+static MemoryConn* memory_acquire(int handle, int *end) {
+    MemoryConn *conn = NULL;
+
+    pthread_mutex_lock(&slots_mutex);
+    if (handle >= 0 && handle < TRANSPORT_MAX_HANDLES && slots[handle].memory) {
+        conn = slots[handle].memory;
+        *end = slots[handle].end;
+        conn->refs++;
+    }
+    pthread_mutex_unlock(&slots_mutex);
+
+    return conn;
+}
+
+/**
+ * Drops a reference and frees the connection with the last one.
+ *
+ * @param conn Connection to release
+ */
+static void memory_release(MemoryConn *conn) {
+    pthread_mutex_lock(&slots_mutex);
+    bool last = --conn->refs == 0;
+    pthread_mutex_unlock(&slots_mutex);
+
+    if (last) {
+        byte_queue_free(&conn->inbound[0]);
+        byte_queue_free(&conn->inbound[1]);
+        pthread_cond_destroy(&conn->readable);
+        pthread_mutex_destroy(&conn->mutex);
+        free(conn);
+    }
+}
+
+/**
+ * Raises or clears the readiness of an end's eventfd.
+ * Called with the connection mutex held.
+ *
+ * @param conn Connection
+ * @param end End to update
+ * @param ready Whether the end has data or end of stream pending
+ */
+static void memory_signal(MemoryConn *conn, int end, bool ready) {
+    uint64_t value = 1;
+    if (conn->closed[end]) {
+        return;                  // The eventfd is gone with the end
+    }
+    transport_count_syscall();
+    if (ready) {
+        if (write(conn->handle[end], &value, sizeof(value)) < 0) {
+            // Counter already set; the end stays readable
+        }
+    } else if (read(conn->handle[end], &value, sizeof(value)) < 0) {
+        // Counter already clear
+    }
+}
+
+/**
+ * Blocks the server end like recv until input or end of stream is
+ * pending; closing either end wakes it. The client end never blocks.
+ * Called with the connection mutex held.
+ *
+ * @param conn Connection
+ * @param end End being read
+ */
+static void memory_wait_locked(MemoryConn *conn, int end) {
+    while (end == 1 && conn->inbound[end].length == 0 && !conn->closed[0] && !conn->closed[1]) {
+        transport_count_syscall();
+        pthread_cond_wait(&conn->readable, &conn->mutex);
+    }
+}
+
+static int memory_wait(int handle) {
+    int end;
+    MemoryConn *conn = memory_acquire(handle, &end);
+    if (!conn) {
+        errno = EBADF;
+        return -1;
+    }
+
+    pthread_mutex_lock(&conn->mutex);
+    memory_wait_locked(conn, end);
+    pthread_mutex_unlock(&conn->mutex);
+    memory_release(conn);
+    return 0;
+}
+
+static ssize_t memory_read(int handle, void *buffer, size_t length) {
+    int end;
+    MemoryConn *conn = memory_acquire(handle, &end);
+    if (!conn) {
+        errno = EBADF;
+        return -1;
+    }
+
+    pthread_mutex_lock(&conn->mutex);
+    ByteQueue *queue = &conn->inbound[end];
+    memory_wait_locked(conn, end);
+
+    ssize_t result;
+    if (queue->length > 0) {
+        result = (ssize_t)byte_queue_take(queue, buffer, length);
+        if (queue->length == 0 && !conn->closed[1 - end]) {
+            memory_signal(conn, end, false);
+        }
+    } else if (conn->closed[0] || conn->closed[1]) {
+        result = 0;
+    } else {
+        errno = EAGAIN;
+        result = -1;
+    }
+
+    pthread_mutex_unlock(&conn->mutex);
+    memory_release(conn);
+    return result;
+}
+
+static ssize_t memory_write(int handle, const void *buffer, size_t length) {
+    int end;
+    MemoryConn *conn = memory_acquire(handle, &end);
+    if (!conn) {
+        errno = EBADF;
+        return -1;
+    }
+
+    pthread_mutex_lock(&conn->mutex);
+    int peer = 1 - end;
+    ByteQueue *queue = &conn->inbound[peer];
+    ssize_t result = (ssize_t)length;
+
+    if (conn->closed[0] || conn->closed[1]) {
+        errno = EPIPE;
+        result = -1;
+    } else {
+        bool was_empty = queue->length == 0;
+        if (byte_queue_append(queue, buffer, length) < 0) {
+            errno = ENOMEM;
+            result = -1;
+        } else if (was_empty) {
+            memory_signal(conn, peer, true);
+            pthread_cond_broadcast(&conn->readable);
+        }
+    }
+
+    pthread_mutex_unlock(&conn->mutex);
+    memory_release(conn);
+    return result;
+}
+
+static void memory_close(int handle) {
+    pthread_mutex_lock(&slots_mutex);
+    MemoryConn *conn = NULL;
+    int end = 0;
+    if (handle >= 0 && handle < TRANSPORT_MAX_HANDLES && slots[handle].memory) {
+        conn = slots[handle].memory;
+        end = slots[handle].end;
+        atomic_store(&slots[handle].ops, NULL);
+        slots[handle].memory = NULL;
+    }
+    pthread_mutex_unlock(&slots_mutex);
+
+    if (!conn) {
+        return;
+    }
+
+    pthread_mutex_lock(&conn->mutex);
+    memory_signal(conn, 1 - end, true);
+    conn->closed[end] = true;
+    close(conn->handle[end]);
+    conn->handle[end] = -1;
+    pthread_cond_broadcast(&conn->readable);
+    pthread_mutex_unlock(&conn->mutex);
+
+    memory_release(conn);
+}
+
+const TransportOps transport_memory = {"memory", memory_wait, memory_read, memory_write, memory_close, NULL, NULL};
+
+/**
+ * Creates a connected in-memory pair. Each end is backed by an eventfd
+ * that reserves the handle number and reports readability.
+ *
+ * @param client_handle Receives the non-blocking client end
+ * @param server_handle Receives the blocking server end
+ * @return 0 on success, -1 on failure
+ */
+int transport_memory_pair(int *client_handle, int *server_handle) {
+    MemoryConn *conn = calloc(1, sizeof(MemoryConn));
+    if (!conn) {
+        return -1;
+    }
+
+    conn->handle[0] = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    conn->handle[1] = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (conn->handle[0] < 0 || conn->handle[1] < 0 ||
+        conn->handle[0] >= TRANSPORT_MAX_HANDLES || conn->handle[1] >= TRANSPORT_MAX_HANDLES) {
+        if (conn->handle[0] >= 0) close(conn->handle[0]);
+        if (conn->handle[1] >= 0) close(conn->handle[1]);
+        free(conn);
+        errno = EMFILE;
+        return -1;
+    }
+
+    pthread_mutex_init(&conn->mutex, NULL);
+    pthread_cond_init(&conn->readable, NULL);
+    conn->refs = 2;
+
+    pthread_mutex_lock(&slots_mutex);
+    for (int end = 0; end < 2; end++) {
+        TransportSlot *slot = &slots[conn->handle[end]];
+        slot->memory = conn;
+        slot->end = end;
+        atomic_store(&slot->ops, &transport_memory);
+    }
+    pthread_mutex_unlock(&slots_mutex);
+
+    *client_handle = conn->handle[0];
+    *server_handle = conn->handle[1];
+    return 0;
+}
+
+// ========== DISPATCH ==========
+
+/**
+ * Selects the operations used for a socket handle.
+ *
+ * @param handle Connection handle
+ * @param ops Operations, NULL for transport_tcp
+ */
+void transport_attach(int handle, const TransportOps *ops) {
+    if (handle < 0 || handle >= TRANSPORT_MAX_HANDLES) {
+        return;
+    }
+    atomic_store(&slots[handle].ops, ops);
+}
+
+/**
+ * Gets the operations used for a handle.
+ *
+ * @param handle Connection handle
+ * @return Attached operations, transport_tcp if none
+ */
+const TransportOps* transport_of(int handle) {
+    const TransportOps *ops = NULL;
+    if (handle >= 0 && handle < TRANSPORT_MAX_HANDLES) {
+        ops = atomic_load_explicit(&slots[handle].ops, memory_order_acquire);
+    }
+    return ops ? ops : &transport_tcp;
+}
+
+int transport_wait(int handle) {
+    return transport_of(handle)->wait(handle);
+}
+
+int transport_park(int handle) {
+    const TransportOps *ops = transport_of(handle);
+    return ops->park ? ops->park(handle) : -1;
+}
+
+ssize_t transport_read(int handle, void *buffer, size_t length) {
+    return transport_of(handle)->read(handle, buffer, length);
+}
+
+ssize_t transport_write(int handle, const void *buffer, size_t length) {
+    return transport_of(handle)->write(handle, buffer, length);
+}
+
+/**
+ * Closes a connection. Plain socket handles are detached here; the
+ * buffering backends detach themselves once the handle is released.
+ *
+ * @param handle Connection handle
+ */
+void transport_close(int handle) {
+    const TransportOps *ops = transport_of(handle);
+    if (ops == &transport_tcp || ops == &transport_unix) {
+        transport_attach(handle, NULL);
+    }
+    ops->close(handle);
+}
+
+/**
+ * Submits queued writes of every backend that buffers them.
+ */
+void transport_flush(void) {
+    static const TransportOps *const backends[] = {
+        &transport_tcp, &transport_unix, &transport_memory, &transport_uring
+    };
+
+    for (size_t i = 0; i < sizeof(backends) / sizeof(backends[0]); i++) {
+        if (backends[i]->flush) {
+            backends[i]->flush();
+        }
+    }
+}
+
+void transport_count_syscall(void) {
+    atomic_fetch_add_explicit(&syscall_count, 1, memory_order_relaxed);
+}
+
+uint64_t transport_syscalls(void) {
+    return atomic_load_explicit(&syscall_count, memory_order_relaxed);
+}
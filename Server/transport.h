@@ -0,0 +1,150 @@
+#ifndef SERVER_TRANSPORT_H
+#define SERVER_TRANSPORT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#define TRANSPORT_MAX_HANDLES 65536      // Handles above this always use socket I/O
+#define TRANSPORT_UNIX_BACKLOG 128       // Listen backlog of the Unix-domain listener
+
+/**
+ * Byte stream operations behind a connection handle.
+ * Handles are file descriptor numbers, so code that keys state on the
+ * socket (client lookup, recorder, probes) works for every transport.
+ * Semantics follow recv/send/close: read returns 0 at end of stream,
+ * -1 with errno on failure. wait blocks until read would not, so a
+ * reader needs no buffer while the connection is idle. Backends that
+ * queue writes submit them in flush (NULL if writes are immediate).
+ * Backends driven by a reactor can park an idle connection instead of
+ * having a thread wait on it (NULL if they cannot).
+ */
+typedef struct {
+    const char *name;
+    int (*wait)(int handle);
+    ssize_t (*read)(int handle, void *buffer, size_t length);
+    ssize_t (*write)(int handle, const void *buffer, size_t length);
+    void (*close)(int handle);
+    void (*flush)(void);
+    int (*park)(int handle);
+} TransportOps;
+
+extern const TransportOps transport_tcp;
+extern const TransportOps transport_unix;
+extern const TransportOps transport_memory;
+extern const TransportOps transport_uring;     // See uring.h
+
+/**
+ * Growable FIFO of bytes shared by buffering backends.
+ * Storage comes from the buffer pool and is returned when the queue drains.
+ */
+typedef struct {
+    char *data;                  // NULL while empty
+    size_t head;                 // Offset of the first unread byte
+    size_t length;               // Unread bytes
+    size_t capacity;
+} ByteQueue;
+
+// ========== DISPATCH ==========
+
+/**
+ * Selects the operations used for a handle.
+ * Handles never attached use transport_tcp.
+ */
+void transport_attach(int handle, const TransportOps *ops);
+
+/**
+ * Gets the operations used for a handle.
+ */
+const TransportOps* transport_of(int handle);
+
+/**
+ * Blocks until a connection has input, end of stream or an error to report.
+ * @return 0 once read will not block, -1 on error
+ */
+int transport_wait(int handle);
+
+/**
+ * Parks a connection without input: no thread waits on it, and the
+ * backend hands it to server_resume once input or end of stream arrives.
+ * @return 0 if parked (the caller must stop serving it), -1 if input is
+ *         pending or the backend cannot park
+ */
+int transport_park(int handle);
+
+/**
+ * Reads up to length bytes from a connection.
+ * @return Bytes read, 0 at end of stream, -1 on error
+ */
+ssize_t transport_read(int handle, void *buffer, size_t length);
+
+/**
+ * Writes bytes to a connection.
+ * @return Bytes written, -1 on error
+ */
+ssize_t transport_write(int handle, const void *buffer, size_t length);
+
+/**
+ * Closes a connection and detaches its operations.
+ */
+void transport_close(int handle);
+
+/**
+ * Submits writes queued by this or other threads on every backend.
+ * Called where a thread stops producing output for a while.
+ */
+void transport_flush(void);
+
+/**
+ * Counts one system call made on behalf of a connection.
+ */
+void transport_count_syscall(void);
+
+/**
+ * Gets the number of system calls made by the transports so far:
+ * socket I/O, io_uring_enter, eventfd signals and blocking waits.
+ */
+uint64_t transport_syscalls(void);
+
+// ========== BYTE QUEUES ==========
+
+/**
+ * Appends bytes, growing the queue as needed.
+ * @return 0 on success, -1 if out of memory
+ */
+int byte_queue_append(ByteQueue *queue, const void *data, size_t length);
+
+/**
+ * Removes up to length bytes from the front of the queue.
+ * The storage is released when the queue drains.
+ * @return Bytes copied
+ */
+size_t byte_queue_take(ByteQueue *queue, void *buffer, size_t length);
+
+/**
+ * Releases the queue's storage.
+ */
+void byte_queue_free(ByteQueue *queue);
+
+// ========== LISTENERS ==========
+
+/**
+ * Creates a listening Unix-domain stream socket, replacing a stale file.
+ * @return Listening socket or -1 on failure
+ */
+int transport_listen_unix(const char *path);
+
+// ========== IN-MEMORY CONNECTIONS ==========
+
+/**
+ * Creates a connected in-memory pair.
+ * The server end blocks in read like a socket. The client end never
+ * blocks (read fails with EAGAIN) and its handle is an eventfd that
+ * polls readable while data or end of stream is pending, so it can be
+ * driven from epoll. Writes are buffered without limit.
+ * @return 0 on success, -1 on failure
+ */
+int transport_memory_pair(int *client_handle, int *server_handle);
+
+#endif //SERVER_TRANSPORT_H
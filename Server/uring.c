@@ -0,0 +1,1000 @@
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include "uring.h"
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#endif
+#endif
+
+#ifdef IORING_RECV_MULTISHOT              // Linux 6.0 headers, which also provide buffer rings
+
+#include <sched.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#define URING_TAG_ACCEPT 0               // user_data: listener index << 2
+#define URING_TAG_RECV 1                 // user_data: UringConn pointer | tag
+#define URING_TAG_SEND 2
+#define URING_TAG_WAKE 3                 // user_data: read of the wakeup eventfd,
+                                         // or UringConn pointer | tag: recv cancel
+#define URING_TAG_MASK 3
+
+/**
+ * Mapped submission and completion rings.
+ */
+typedef struct {
+    int fd;
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned sq_mask;
+    struct io_uring_sqe *sqes;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned cq_mask;
+    struct io_uring_cqe *cqes;
+    void *rings;
+    size_t rings_size;
+    size_t sqes_size;
+} Ring;
+
+/**
+ * Provided buffer ring the kernel picks receive buffers from.
+ */
+typedef struct {
+    struct io_uring_buf_ring *ring;
+    size_t ring_size;
+    char *base;
+    unsigned count;
+    unsigned short tail;
+} BufferRing;
+
+/**
+ * State of one connection served by the reactor.
+ * The fields below mutex are guarded by it; refs by map_mutex.
+ */
+typedef struct UringConn {
+    int fd;
+    int refs;                    // Handle, armed recv, send in flight, calls in progress
+    pthread_mutex_t mutex;
+    pthread_cond_t readable;
+    ByteQueue inbound;           // Received, not yet read by the handler
+    ByteQueue outbound;          // Written while a send was in flight
+    ByteQueue inflight;          // Bytes of the send in flight
+    int waiters;                 // Readers blocked on readable
+    bool sending;
+    bool eof;                    // Multishot recv ended
+    bool throttled;              // Recv cancelled with inbound above URING_INBOUND_MAX
+    bool recv_parked;            // Throttled recv ended; the reader re-arms it
+    bool reader_parked;          // No handler thread; input resumes one
+    bool closed;                 // Closed by the server
+    bool failed;                 // A send failed; further writes fail
+    bool released;               // Socket shut down and closed
+} UringConn;
+
+static Ring ring = {.fd = -1};
+static BufferRing buffers;
+static Server *uring_server = NULL;
+static int listeners[2] = {-1, -1};
+static atomic_bool ready = false;
+static atomic_bool pending_submit = false;   // SQEs written since the last io_uring_enter
+static atomic_bool wake_sent = false;        // Wakeup posted, not yet seen by the reactor
+static atomic_bool reactor_idle = false;     // Reactor is (about to be) waiting for completions
+static int wake_fd = -1;
+static uint64_t wake_value;
+static __thread bool on_reactor = false;
+static pthread_mutex_t sq_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t map_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t flush_key;
+static UringConn *conns[TRANSPORT_MAX_HANDLES];
+
+// ========== RING ==========
+
+static int ring_enter(Ring *r, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    transport_count_syscall();
+    return (int)syscall(__NR_io_uring_enter, r->fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+/**
+ * Creates a ring and maps its queues.
+ *
+ * @param r Ring to set up
+ * @param entries Submission queue size
+ * @param cq_entries Completion queue size
+ * @return 0 on success, -1 on failure
+ */
+static int ring_setup(Ring *r, unsigned entries, unsigned cq_entries) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = cq_entries;
+
+    r->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (r->fd < 0) {
+        return -1;
+    }
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP)) {
+        close(r->fd);
+        r->fd = -1;
+        errno = ENOSYS;
+        return -1;
+    }
+
+    size_t sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    size_t cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    r->rings_size = sq_size > cq_size ? sq_size : cq_size;
+    r->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    r->rings = mmap(NULL, r->rings_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    r->fd, IORING_OFF_SQ_RING);
+    if (r->rings == MAP_FAILED) {
+        close(r->fd);
+        r->fd = -1;
+        return -1;
+    }
+    r->sqes = mmap(NULL, r->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   r->fd, IORING_OFF_SQES);
+    if (r->sqes == MAP_FAILED) {
+        munmap(r->rings, r->rings_size);
+        close(r->fd);
+        r->fd = -1;
+        return -1;
+    }
+
+    char *base = r->rings;
+    r->sq_head = (unsigned *)(base + params.sq_off.head);
+    r->sq_tail = (unsigned *)(base + params.sq_off.tail);
+    r->sq_mask = *(unsigned *)(base + params.sq_off.ring_mask);
+    r->cq_head = (unsigned *)(base + params.cq_off.head);
+    r->cq_tail = (unsigned *)(base + params.cq_off.tail);
+    r->cq_mask = *(unsigned *)(base + params.cq_off.ring_mask);
+    r->cqes = (struct io_uring_cqe *)(base + params.cq_off.cqes);
+
+    // SQE slots are used in ring order, so the index array is the identity
+    unsigned *array = (unsigned *)(base + params.sq_off.array);
+    for (unsigned i = 0; i < params.sq_entries; i++) {
+        array[i] = i;
+    }
+    return 0;
+}
+
+static void ring_teardown(Ring *r) {
+    if (r->fd < 0) {
+        return;
+    }
+    munmap(r->sqes, r->sqes_size);
+    munmap(r->rings, r->rings_size);
+    close(r->fd);
+    r->fd = -1;
+}
+
+/**
+ * Gets a free SQE. Called with sq_mutex held for the shared ring.
+ *
+ * @param r Ring
+ * @return Zeroed SQE or NULL if the submission queue is full
+ */
+static struct io_uring_sqe* ring_get_sqe(Ring *r) {
+    unsigned head = __atomic_load_n(r->sq_head, __ATOMIC_ACQUIRE);
+    unsigned tail = *r->sq_tail;
+    if (tail - head > r->sq_mask) {
+        return NULL;
+    }
+    struct io_uring_sqe *sqe = &r->sqes[tail & r->sq_mask];
+    memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+static void ring_commit_sqe(Ring *r) {
+    __atomic_store_n(r->sq_tail, *r->sq_tail + 1, __ATOMIC_RELEASE);
+}
+
+// ========== PROVIDED BUFFERS ==========
+
+static void buffers_add(BufferRing *b, unsigned bid) {
+    struct io_uring_buf *buf = &b->ring->bufs[b->tail & (b->count - 1)];
+    buf->addr = (uint64_t)(uintptr_t)(b->base + (size_t)bid * URING_BUFFER_SIZE);
+    buf->len = URING_BUFFER_SIZE;
+    buf->bid = (unsigned short)bid;
+    b->tail++;
+}
+
+static void buffers_publish(BufferRing *b) {
+    __atomic_store_n(&b->ring->tail, b->tail, __ATOMIC_RELEASE);
+}
+
+/**
+ * Allocates and registers a provided buffer ring.
+ *
+ * @param r Ring to register with
+ * @param b Buffer ring to set up
+ * @param count Number of buffers (power of two)
+ * @return 0 on success, -1 on failure
+ */
+static int buffers_setup(Ring *r, BufferRing *b, unsigned count) {
+    memset(b, 0, sizeof(*b));
+    b->count = count;
+    b->ring_size = count * sizeof(struct io_uring_buf);
+    b->ring = mmap(NULL, b->ring_size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (b->ring == MAP_FAILED) {
+        b->ring = NULL;
+        return -1;
+    }
+    b->base = malloc((size_t)count * URING_BUFFER_SIZE);
+    if (!b->base) {
+        munmap(b->ring, b->ring_size);
+        b->ring = NULL;
+        return -1;
+    }
+
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = (uint64_t)(uintptr_t)b->ring;
+    reg.ring_entries = count;
+    reg.bgid = URING_BUFFER_GROUP;
+    if (syscall(__NR_io_uring_register, r->fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        free(b->base);
+        munmap(b->ring, b->ring_size);
+        b->ring = NULL;
+        return -1;
+    }
+
+    for (unsigned i = 0; i < count; i++) {
+        buffers_add(b, i);
+    }
+    buffers_publish(b);
+    return 0;
+}
+
+static void buffers_teardown(BufferRing *b) {
+    if (!b->ring) {
+        return;
+    }
+    free(b->base);
+    munmap(b->ring, b->ring_size);
+    b->ring = NULL;
+}
+
+static void prep_recv_multishot(struct io_uring_sqe *sqe, int fd, uint64_t user_data) {
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = fd;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = URING_BUFFER_GROUP;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->user_data = user_data;
+}
+
+/**
+ * Probes the kernel: multishot recv with a provided buffer ring on a
+ * socket pair must deliver data and stay armed (Linux 6.0+).
+ *
+ * @return true if the backend can run
+ */
+bool uring_supported(void) {
+    Ring probe = {.fd = -1};
+    BufferRing probe_buffers;
+    int pair[2] = {-1, -1};
+    bool supported = false;
+
+    if (ring_setup(&probe, 4, 8) < 0) {
+        return false;
+    }
+    if (buffers_setup(&probe, &probe_buffers, 2) < 0) {
+        ring_teardown(&probe);
+        return false;
+    }
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) == 0) {
+        struct io_uring_sqe *sqe = ring_get_sqe(&probe);
+        prep_recv_multishot(sqe, pair[0], 1);
+        ring_commit_sqe(&probe);
+
+        if (ring_enter(&probe, 1, 0, 0) == 1 && write(pair[1], "x", 1) == 1 &&
+            ring_enter(&probe, 0, 1, IORING_ENTER_GETEVENTS) >= 0) {
+            unsigned head = *probe.cq_head;
+            if (head != __atomic_load_n(probe.cq_tail, __ATOMIC_ACQUIRE)) {
+                struct io_uring_cqe *cqe = &probe.cqes[head & probe.cq_mask];
+                supported = cqe->res == 1 && (cqe->flags & IORING_CQE_F_BUFFER) &&
+                            (cqe->flags & IORING_CQE_F_MORE);
+            }
+        }
+        close(pair[0]);
+        close(pair[1]);
+    }
+
+    buffers_teardown(&probe_buffers);
+    ring_teardown(&probe);
+    return supported;
+}
+
+// ========== SUBMISSION ==========
+
+/**
+ * Gets queued SQEs submitted. Only the reactor enters the ring: the
+ * kernel cancels requests of a thread that exits, and handler threads
+ * exit with their connection. Other threads post a wakeup instead,
+ * unless the reactor is busy and submits before it waits again.
+ */
+static void uring_flush(void) {
+    if (!atomic_load_explicit(&ready, memory_order_acquire) ||
+        !atomic_load(&pending_submit)) {
+        return;
+    }
+    if (on_reactor) {
+        atomic_store(&pending_submit, false);
+        ring_enter(&ring, URING_ENTRIES, 0, 0);
+    } else if (atomic_load(&reactor_idle) && !atomic_exchange(&wake_sent, true)) {
+        transport_count_syscall();
+        eventfd_write(wake_fd, 1);
+    }
+}
+
+static void flush_at_exit(void *value) {
+    (void)value;
+    uring_flush();
+}
+
+/**
+ * Gets a free SQE of the shared ring, waiting for the reactor to
+ * submit queued ones if the queue is full. Returns with sq_mutex held; finish with sqe_queue.
+ *
+ * @return Zeroed SQE
+ */
+static struct io_uring_sqe* sqe_begin(void) {
+    pthread_mutex_lock(&sq_mutex);
+    struct io_uring_sqe *sqe;
+    while (!(sqe = ring_get_sqe(&ring))) {
+        pthread_mutex_unlock(&sq_mutex);
+        uring_flush();
+        if (!on_reactor) {
+            sched_yield();
+        }
+        pthread_mutex_lock(&sq_mutex);
+    }
+    return sqe;
+}
+
+/**
+ * Queues the SQE from sqe_begin. It is submitted after the next flush;
+ * a thread that exits before reading again flushes on exit.
+ */
+static void sqe_queue(void) {
+    ring_commit_sqe(&ring);
+    pthread_mutex_unlock(&sq_mutex);
+    atomic_store(&pending_submit, true);
+    if (!pthread_getspecific(flush_key)) {
+        pthread_setspecific(flush_key, &ring);
+    }
+}
+
+static void arm_accept(int index) {
+    struct io_uring_sqe *sqe = sqe_begin();
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = listeners[index];
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->user_data = ((uint64_t)index << 2) | URING_TAG_ACCEPT;
+    sqe_queue();
+}
+
+static void arm_wake(void) {
+    struct io_uring_sqe *sqe = sqe_begin();
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = wake_fd;
+    sqe->addr = (uint64_t)(uintptr_t)&wake_value;
+    sqe->len = sizeof(wake_value);
+    sqe->user_data = URING_TAG_WAKE;
+    sqe_queue();
+}
+
+static void arm_recv(UringConn *conn) {
+    struct io_uring_sqe *sqe = sqe_begin();
+    prep_recv_multishot(sqe, conn->fd, (uint64_t)(uintptr_t)conn | URING_TAG_RECV);
+    sqe_queue();
+}
+
+/**
+ * Cancels a connection's multishot recv. Its last completion arrives
+ * without IORING_CQE_F_MORE.
+ *
+ * @param conn Connection with a recv armed
+ */
+static void cancel_recv(UringConn *conn) {
+    struct io_uring_sqe *sqe = sqe_begin();
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = (uint64_t)(uintptr_t)conn | URING_TAG_RECV;
+    sqe->user_data = (uint64_t)(uintptr_t)conn | URING_TAG_WAKE;
+    sqe_queue();
+}
+
+/**
+ * Queues a send of the in-flight bytes. Called with conn->mutex held.
+ *
+ * @param conn Connection with sending set
+ */
+static void submit_send(UringConn *conn) {
+    struct io_uring_sqe *sqe = sqe_begin();
+    sqe->opcode = IORING_OP_SEND;
+    sqe->fd = conn->fd;
+    sqe->addr = (uint64_t)(uintptr_t)(conn->inflight.data + conn->inflight.head);
+    sqe->len = (unsigned)conn->inflight.length;
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = (uint64_t)(uintptr_t)conn | URING_TAG_SEND;
+    sqe_queue();
+}
+
+// ========== CONNECTIONS ==========
+
+static UringConn* conn_acquire(int handle) {
+    UringConn *conn = NULL;
+    pthread_mutex_lock(&map_mutex);
+    if (handle >= 0 && handle < TRANSPORT_MAX_HANDLES && conns[handle]) {
+        conn = conns[handle];
+        conn->refs++;
+    }
+    pthread_mutex_unlock(&map_mutex);
+    return conn;
+}
+
+static void conn_ref(UringConn *conn) {
+    pthread_mutex_lock(&map_mutex);
+    conn->refs++;
+    pthread_mutex_unlock(&map_mutex);
+}
+
+static void conn_release(UringConn *conn) {
+    pthread_mutex_lock(&map_mutex);
+    bool last = --conn->refs == 0;
+    pthread_mutex_unlock(&map_mutex);
+
+    if (last) {
+        byte_queue_free(&conn->inbound);
+        byte_queue_free(&conn->outbound);
+        byte_queue_free(&conn->inflight);
+        pthread_cond_destroy(&conn->readable);
+        pthread_mutex_destroy(&conn->mutex);
+        free(conn);
+    }
+}
+
+/**
+ * Shuts down and closes the socket once the server closed the
+ * connection and no send is in flight. Shutdown ends the multishot
+ * recv, which drops its reference. Called with conn->mutex held.
+ *
+ * @param conn Connection
+ */
+static void conn_finish_close(UringConn *conn) {
+    if (!conn->closed || conn->sending || conn->released) {
+        return;
+    }
+    conn->released = true;
+    transport_attach(conn->fd, NULL);
+    transport_count_syscall();
+    shutdown(conn->fd, SHUT_RDWR);
+    transport_count_syscall();
+    close(conn->fd);
+}
+
+/**
+ * Moves queued output into flight and submits it.
+ * Called with conn->mutex held.
+ *
+ * @param conn Connection
+ * @return true if a send was submitted
+ */
+static bool conn_start_send(UringConn *conn) {
+    if (conn->outbound.length == 0 || conn->failed) {
+        return false;
+    }
+    // The drained batch returns its storage; the next writes get fresh
+    byte_queue_free(&conn->inflight);
+    conn->inflight = conn->outbound;
+    memset(&conn->outbound, 0, sizeof(conn->outbound));
+    submit_send(conn);
+    return true;
+}
+
+/**
+ * Blocks until the reactor has queued input or the stream ended.
+ * Called with conn->mutex held.
+ *
+ * @param conn Connection
+ */
+static void conn_wait_readable(UringConn *conn) {
+    while (conn->inbound.length == 0 && !conn->eof && !conn->closed) {
+        conn->waiters++;
+        transport_count_syscall();
+        pthread_cond_wait(&conn->readable, &conn->mutex);
+        conn->waiters--;
+    }
+}
+
+static int uring_wait(int handle) {
+    // Whatever this thread queued while handling the last input goes out now
+    uring_flush();
+
+    UringConn *conn = conn_acquire(handle);
+    if (!conn) {
+        errno = EBADF;
+        return -1;
+    }
+
+    pthread_mutex_lock(&conn->mutex);
+    conn_wait_readable(conn);
+    pthread_mutex_unlock(&conn->mutex);
+
+    conn_release(conn);
+    return 0;
+}
+
+/**
+ * Parks an idle connection: its handler thread leaves, and the reactor
+ * passes the connection to server_resume when input arrives.
+ *
+ * @param handle Connection handle
+ * @return 0 if parked, -1 if input or end of stream is pending
+ */
+static int uring_park(int handle) {
+    // Whatever this thread queued while handling the last input goes out now
+    uring_flush();
+
+    UringConn *conn = conn_acquire(handle);
+    if (!conn) {
+        errno = EBADF;
+        return -1;
+    }
+
+    int result = -1;
+    pthread_mutex_lock(&conn->mutex);
+    if (conn->inbound.length == 0 && !conn->eof && !conn->closed) {
+        conn->reader_parked = true;
+        result = 0;
+    }
+    pthread_mutex_unlock(&conn->mutex);
+
+    conn_release(conn);
+    return result;
+}
+
+/**
+ * Wakes the reader of a connection: a parked connection goes to a
+ * handler thread, a waiting one is signalled. Called with conn->mutex held.
+ *
+ * @param conn Connection
+ * @param all Whether every waiting reader must wake (end of stream)
+ * @return true if the connection must be passed to server_resume
+ */
+static bool conn_wake_reader(UringConn *conn, bool all) {
+    if (conn->reader_parked) {
+        conn->reader_parked = false;
+        return true;
+    }
+    if (conn->waiters > 0) {
+        transport_count_syscall();
+        if (all) {
+            pthread_cond_broadcast(&conn->readable);
+        } else {
+            pthread_cond_signal(&conn->readable);
+        }
+    }
+    return false;
+}
+
+static ssize_t uring_read(int handle, void *buffer, size_t length) {
+    // Whatever this thread queued while handling the last input goes out now
+    uring_flush();
+
+    UringConn *conn = conn_acquire(handle);
+    if (!conn) {
+        errno = EBADF;
+        return -1;
+    }
+
+    pthread_mutex_lock(&conn->mutex);
+    conn_wait_readable(conn);
+
+    ssize_t result = 0;
+    if (conn->inbound.length > 0) {
+        result = (ssize_t)byte_queue_take(&conn->inbound, buffer, length);
+    }
+    // A paused recv resumes once the handler has caught up; the recv
+    // keeps the reference it held while parked
+    bool resume = conn->recv_parked && conn->inbound.length < URING_INBOUND_RESUME &&
+                  !conn->closed;
+    if (resume) {
+        conn->recv_parked = false;
+        conn->throttled = false;
+        arm_recv(conn);
+    }
+    pthread_mutex_unlock(&conn->mutex);
+
+    if (resume) {
+        uring_flush();
+    }
+    conn_release(conn);
+    return result;
+}
+
+static ssize_t uring_write(int handle, const void *buffer, size_t length) {
+    UringConn *conn = conn_acquire(handle);
+    if (!conn) {
+        errno = EBADF;
+        return -1;
+    }
+
+    ssize_t result = (ssize_t)length;
+    pthread_mutex_lock(&conn->mutex);
+    if (conn->closed || conn->failed) {
+        errno = EPIPE;
+        result = -1;
+    } else if (byte_queue_append(&conn->outbound, buffer, length) < 0) {
+        errno = ENOMEM;
+        result = -1;
+    } else if (!conn->sending) {
+        conn->sending = true;
+        conn_ref(conn);
+        conn_start_send(conn);
+    }
+    pthread_mutex_unlock(&conn->mutex);
+
+    conn_release(conn);
+    return result;
+}
+
+static void uring_close(int handle) {
+    pthread_mutex_lock(&map_mutex);
+    UringConn *conn = NULL;
+    if (handle >= 0 && handle < TRANSPORT_MAX_HANDLES) {
+        conn = conns[handle];
+        conns[handle] = NULL;
+    }
+    pthread_mutex_unlock(&map_mutex);
+
+    // Repeated closes of the same handle are ignored until the socket is gone
+    if (!conn) {
+        return;
+    }
+
+    uring_flush();
+
+    pthread_mutex_lock(&conn->mutex);
+    conn->closed = true;
+    // A parked connection closed by the server is not resumed; its
+    // client has already been detached from the socket
+    conn->reader_parked = false;
+    if (conn->waiters > 0) {
+        transport_count_syscall();
+        pthread_cond_broadcast(&conn->readable);
+    }
+    conn_finish_close(conn);
+    // A parked recv is not armed, so no completion drops its reference
+    bool parked = conn->recv_parked;
+    conn->recv_parked = false;
+    pthread_mutex_unlock(&conn->mutex);
+
+    if (parked) {
+        conn_release(conn);
+    }
+    conn_release(conn);
+}
+
+const TransportOps transport_uring = {"io_uring", uring_wait, uring_read, uring_write, uring_close, uring_flush, uring_park};
+
+// ========== REACTOR ==========
+
+/**
+ * Passes a parked connection with input to a handler thread, or closes
+ * it if none can take it.
+ *
+ * @param conn Connection
+ */
+static void conn_resume(UringConn *conn) {
+    // A refused resume may already have closed the connection
+    int fd = conn->fd;
+    if (server_resume(uring_server, fd) < 0) {
+        fprintf(stderr, "io_uring: cannot resume socket %d, closing\n", fd);
+        uring_close(fd);
+    }
+}
+
+/**
+ * Registers an accepted socket and hands it to the server.
+ *
+ * @param fd Accepted socket
+ * @param index Listener index (0 TCP, 1 Unix-domain)
+ */
+static void on_accept(int fd, int index) {
+    if (fd >= TRANSPORT_MAX_HANDLES) {
+        fprintf(stderr, "io_uring: socket %d above handle limit, closing\n", fd);
+        close(fd);
+        return;
+    }
+
+    UringConn *conn = calloc(1, sizeof(UringConn));
+    if (!conn) {
+        close(fd);
+        return;
+    }
+    conn->fd = fd;
+    conn->refs = 2;              // Handle and the armed recv
+    pthread_mutex_init(&conn->mutex, NULL);
+    pthread_cond_init(&conn->readable, NULL);
+
+    pthread_mutex_lock(&map_mutex);
+    conns[fd] = conn;
+    pthread_mutex_unlock(&map_mutex);
+    transport_attach(fd, &transport_uring);
+    arm_recv(conn);
+
+    printf("New %s connection via io_uring (socket %d)\n", index ? "unix" : "tcp", fd);
+    server_attach(uring_server, fd);
+}
+
+/**
+ * Queues received bytes for the handler thread. A handler that falls
+ * behind gets its recv cancelled until it catches up, and input that
+ * cannot be queued ends the stream rather than leaving a gap in it.
+ *
+ * @param conn Connection
+ * @param data Received bytes
+ * @param length Number of bytes
+ */
+static void on_recv(UringConn *conn, const char *data, size_t length) {
+    bool resume = false;
+    pthread_mutex_lock(&conn->mutex);
+    if (!conn->closed && !conn->eof) {
+        bool queued = byte_queue_append(&conn->inbound, data, length) == 0;
+        if (!queued) {
+            fprintf(stderr, "io_uring: cannot queue input of socket %d, closing\n", conn->fd);
+            conn->eof = true;
+        }
+        if ((!queued || conn->inbound.length > URING_INBOUND_MAX) && !conn->throttled) {
+            conn->throttled = true;
+            cancel_recv(conn);
+        }
+        resume = conn_wake_reader(conn, !queued);
+    }
+    pthread_mutex_unlock(&conn->mutex);
+
+    if (resume) {
+        conn_resume(conn);
+    }
+}
+
+/**
+ * Ends the connection's receive side and wakes its reader.
+ *
+ * @param conn Connection
+ */
+static void on_recv_end(UringConn *conn) {
+    pthread_mutex_lock(&conn->mutex);
+    conn->eof = true;
+    // Closed by the server: nothing is left for a parked reader to handle
+    bool resume = conn_wake_reader(conn, true) && !conn->closed;
+    pthread_mutex_unlock(&conn->mutex);
+
+    if (resume) {
+        conn_resume(conn);
+    }
+    conn_release(conn);
+}
+
+/**
+ * Continues a partial send or starts the next batch of queued output.
+ *
+ * @param conn Connection
+ * @param res Bytes sent or negative errno
+ */
+static void on_send(UringConn *conn, int res) {
+    bool in_flight = true;
+
+    pthread_mutex_lock(&conn->mutex);
+    if (res < 0) {
+        conn->failed = true;
+        conn->inflight.length = 0;
+        conn->outbound.length = 0;
+    } else {
+        conn->inflight.head += (size_t)res;
+        conn->inflight.length -= (size_t)res;
+    }
+
+    if (conn->inflight.length > 0) {
+        submit_send(conn);
+    } else if (!conn_start_send(conn)) {
+        byte_queue_free(&conn->inflight);
+        byte_queue_free(&conn->outbound);
+        conn->sending = false;
+        in_flight = false;
+        conn_finish_close(conn);
+    }
+    pthread_mutex_unlock(&conn->mutex);
+
+    if (!in_flight) {
+        conn_release(conn);
+    }
+}
+
+static void handle_cqe(const struct io_uring_cqe *cqe) {
+    uint64_t user_data = cqe->user_data;
+    UringConn *conn = (UringConn *)(uintptr_t)(user_data & ~(uint64_t)URING_TAG_MASK);
+
+    switch (user_data & URING_TAG_MASK) {
+        case URING_TAG_ACCEPT: {
+            int index = (int)(user_data >> 2);
+            if (cqe->res >= 0) {
+                on_accept(cqe->res, index);
+            } else if (uring_server->running) {
+                fprintf(stderr, "io_uring accept failed: %s\n", strerror(-cqe->res));
+            }
+            if (!(cqe->flags & IORING_CQE_F_MORE) && uring_server->running) {
+                arm_accept(index);
+            }
+            break;
+        }
+
+        case URING_TAG_RECV:
+            if (cqe->res > 0) {
+                unsigned bid = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+                on_recv(conn, buffers.base + (size_t)bid * URING_BUFFER_SIZE, (size_t)cqe->res);
+                buffers_add(&buffers, bid);
+            }
+            if (!(cqe->flags & IORING_CQE_F_MORE)) {
+                // Out of buffers or a full completion queue ends multishot; re-arm.
+                // A throttled recv stays parked until its reader drains the input
+                bool rearm = (cqe->res > 0 || cqe->res == -ENOBUFS);
+                bool park = false;
+                pthread_mutex_lock(&conn->mutex);
+                rearm = (rearm || (cqe->res == -ECANCELED && conn->throttled)) &&
+                        !conn->closed && !conn->eof;
+                if (rearm && conn->throttled) {
+                    park = conn->inbound.length >= URING_INBOUND_RESUME;
+                    conn->recv_parked = park;
+                    conn->throttled = park;
+                }
+                pthread_mutex_unlock(&conn->mutex);
+                if (park) {
+                    break;
+                }
+                if (rearm) {
+                    arm_recv(conn);
+                } else {
+                    on_recv_end(conn);
+                }
+            }
+            break;
+
+        case URING_TAG_SEND:
+            on_send(conn, cqe->res);
+            break;
+
+        case URING_TAG_WAKE:
+            if (conn) {
+                // Completion of a recv cancel; the recv reports its own end
+                break;
+            }
+            // Queued SQEs go out with the next io_uring_enter of the loop
+            atomic_store(&wake_sent, false);
+            arm_wake();
+            break;
+    }
+}
+
+/**
+ * Runs the reactor on the server's listeners until the server stops.
+ *
+ * @param server Pointer to the server
+ * @return 0 after the server stopped, -1 on setup failure
+ */
+int uring_run(Server *server) {
+    if (ring_setup(&ring, URING_ENTRIES, URING_CQ_ENTRIES) < 0) {
+        perror("io_uring setup failed");
+        return -1;
+    }
+    if (buffers_setup(&ring, &buffers, URING_BUFFER_COUNT) < 0) {
+        perror("io_uring buffer ring registration failed");
+        ring_teardown(&ring);
+        return -1;
+    }
+    wake_fd = eventfd(0, EFD_CLOEXEC);
+    if (wake_fd < 0 || pthread_key_create(&flush_key, flush_at_exit) != 0) {
+        if (wake_fd >= 0) {
+            close(wake_fd);
+        }
+        buffers_teardown(&buffers);
+        ring_teardown(&ring);
+        return -1;
+    }
+
+    on_reactor = true;
+    uring_server = server;
+    listeners[0] = server->server_socket;
+    listeners[1] = server->unix_socket;
+    atomic_store(&ready, true);
+
+    arm_wake();
+    for (int i = 0; i < 2; i++) {
+        if (listeners[i] >= 0) {
+            arm_accept(i);
+        }
+    }
+
+    printf("io_uring reactor running (%d receive buffers of %d bytes)\n",
+           URING_BUFFER_COUNT, URING_BUFFER_SIZE);
+
+    while (server->running) {
+        // SQEs queued before this exchange are submitted now; later ones post a wakeup
+        atomic_store(&reactor_idle, true);
+        unsigned to_submit = atomic_exchange(&pending_submit, false) ? URING_ENTRIES : 0;
+        int entered = ring_enter(&ring, to_submit, 1, IORING_ENTER_GETEVENTS);
+        atomic_store(&reactor_idle, false);
+        if (entered < 0 &&
+            errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            perror("io_uring_enter failed");
+            break;
+        }
+
+        unsigned head = *ring.cq_head;
+        unsigned tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+        while (head != tail) {
+            handle_cqe(&ring.cqes[head & ring.cq_mask]);
+            head++;
+        }
+        __atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+        buffers_publish(&buffers);
+    }
+
+    return 0;
+}
+
+#else
+
+bool uring_supported(void) {
+    return false;
+}
+
+int uring_run(Server *server) {
+    (void)server;
+    fprintf(stderr, "io_uring backend not built (kernel headers too old)\n");
+    return -1;
+}
+
+static int uring_unsupported_wait(int handle) {
+    (void)handle;
+    return 0;
+}
+
+static ssize_t uring_unsupported_io(int handle, void *buffer, size_t length) {
+    (void)handle;
+    (void)buffer;
+    (void)length;
+    errno = ENOSYS;
+    return -1;
+}
+
+static ssize_t uring_unsupported_write(int handle, const void *buffer, size_t length) {
+    (void)handle;
+    (void)buffer;
+    (void)length;
+    errno = ENOSYS;
+    return -1;
+}
+
+static void uring_unsupported_close(int handle) {
+    close(handle);
+}
+
+const TransportOps transport_uring = {"io_uring", uring_unsupported_wait, uring_unsupported_io,
+                                      uring_unsupported_write, uring_unsupported_close, NULL, NULL};
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef SERVER_URING_H
+#define SERVER_URING_H
+
+#include <stdbool.h>
+#include "server.h"
+#include "transport.h"
+
+#define URING_ENTRIES 1024               // Submission queue size
+#define URING_CQ_ENTRIES 8192            // Completion queue size
+#define URING_BUFFER_COUNT 1024          // Provided receive buffers (power of two)
+#define URING_BUFFER_SIZE 4096           // Bytes per provided receive buffer
+#define URING_BUFFER_GROUP 0             // Buffer group id of the receive ring
+#define URING_INBOUND_MAX (2 * MAX_MESSAGE_LEN)      // Queued input that pauses a connection's recv
+#define URING_INBOUND_RESUME (MAX_MESSAGE_LEN / 2)   // Queued input below which it resumes
+
+/**
+ * io_uring network backend (Linux 6.0+, raw system calls, no liburing).
+ *
+ * One reactor thread owns the ring: multishot accept on the listeners,
+ * multishot recv into a provided buffer ring for every connection.
+ * Received bytes are queued per connection and handed to the usual
+ * handler threads through transport_uring, so dispatch is unchanged.
+ *
+ * Writes are appended to a per-connection buffer with at most one send
+ * in flight, which keeps frames ordered and coalesces the frames queued
+ * meanwhile. Submissions are batched: a handler thread that queued SQEs
+ * wakes the reactor through an eventfd when it next reads or flushes,
+ * and the reactor submits everything queued with one io_uring_enter.
+ *
+ * A connection idle outside a game is parked rather than waited on by
+ * its handler thread; input hands it back to a pooled handler thread
+ * (server_resume), so idle lobby connections own no thread.
+ *
+ * Input is bounded per connection like a socket receive buffer: above
+ * URING_INBOUND_MAX the multishot recv is cancelled, and the handler
+ * thread re-arms it once it has drained the queue.
+ * Only the reactor enters the ring, because the kernel cancels pending
+ * requests of a thread when it exits.
+ */
+
+/**
+ * Checks that the kernel supports everything the backend needs.
+ * @return true if uring_run can be used
+ */
+bool uring_supported(void);
+
+/**
+ * Runs the reactor on the server's listeners until the server stops.
+ * Returns immediately with -1 if the ring cannot be set up, so the
+ * caller can fall back to the blocking accept loop.
+ * @return 0 after the server stopped, -1 on setup failure
+ */
+int uring_run(Server *server);
+
+#endif //SERVER_URING_H